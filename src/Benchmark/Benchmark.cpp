@@ -0,0 +1,115 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+namespace RavenousBenchmark
+{
+	static double Percentile(const vector<double>& Sorted, double P)
+	{
+		if (Sorted.empty())
+			return 0;
+
+		const auto Index = static_cast<size_t>(P * static_cast<double>(Sorted.size() - 1) + 0.5);
+		return Sorted[std::min(Index, Sorted.size() - 1)];
+	}
+
+	RBenchmarkResult RunBenchmark(const string& Name, const RBenchmarkSettings& Settings, const std::function<void()>& Op, const std::function<void()>& Setup)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		for (uint i = 0; i < Settings.WarmupIterations; i++)
+		{
+			if (Setup) Setup();
+			Op();
+		}
+
+		vector<double> Samples;
+		Samples.reserve(Settings.Iterations);
+
+		uint64 TotalAllocs = 0;
+		for (uint i = 0; i < Settings.Iterations; i++)
+		{
+			if (Setup) Setup();
+
+			const uint64 AllocsBefore = AllocationCounter;
+			const auto Start = Clock::now();
+			Op();
+			const auto End = Clock::now();
+			TotalAllocs += AllocationCounter - AllocsBefore;
+
+			Samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count()));
+		}
+
+		RBenchmarkResult Result;
+		Result.Name = Name;
+		Result.Iterations = Settings.Iterations;
+		if (Samples.empty())
+			return Result;
+
+		double Total = 0;
+		for (double Sample : Samples)
+			Total += Sample;
+
+		std::sort(Samples.begin(), Samples.end());
+		Result.NsPerOp = Total / Samples.size();
+		Result.AllocsPerOp = static_cast<double>(TotalAllocs) / Samples.size();
+		Result.P50 = Percentile(Samples, 0.50);
+		Result.P90 = Percentile(Samples, 0.90);
+		Result.P99 = Percentile(Samples, 0.99);
+		Result.Min = Samples.front();
+		Result.Max = Samples.back();
+
+		return Result;
+	}
+
+	void PrintBenchmarkResult(const RBenchmarkResult& Result)
+	{
+		printf("%-32s %8u it  %12.1f ns/op  %8.2f allocs/op  p50 %10.1f  p90 %10.1f  p99 %10.1f\n",
+			Result.Name.c_str(), Result.Iterations, Result.NsPerOp, Result.AllocsPerOp, Result.P50, Result.P90, Result.P99);
+	}
+
+	bool WriteBenchmarkResultsJson(const string& Path, const string& Suite, const map<string, string>& Scene, const vector<RBenchmarkResult>& Results)
+	{
+		std::ofstream Writer(Path);
+		if (!Writer.is_open())
+		{
+			Log("Couldn't open benchmark output file '%s'.", Path.c_str());
+			return false;
+		}
+
+		Writer << "{\n";
+		Writer << "\t\"suite\": \"" << Suite << "\",\n";
+
+		Writer << "\t\"scene\": {";
+		bool First = true;
+		for (const auto& [Key, Value] : Scene)
+		{
+			Writer << (First ? " " : ", ") << "\"" << Key << "\": " << Value;
+			First = false;
+		}
+		Writer << " },\n";
+
+		Writer << "\t\"results\": [\n";
+		for (size_t i = 0; i < Results.size(); i++)
+		{
+			const auto& R = Results[i];
+			Writer << "\t\t{ "
+				<< "\"name\": \"" << R.Name << "\", "
+				<< "\"iterations\": " << R.Iterations << ", "
+				<< "\"ns_per_op\": " << R.NsPerOp << ", "
+				<< "\"allocs_per_op\": " << R.AllocsPerOp << ", "
+				<< "\"p50_ns\": " << R.P50 << ", "
+				<< "\"p90_ns\": " << R.P90 << ", "
+				<< "\"p99_ns\": " << R.P99 << ", "
+				<< "\"min_ns\": " << R.Min << ", "
+				<< "\"max_ns\": " << R.Max
+				<< " }" << (i + 1 < Results.size() ? "," : "") << "\n";
+		}
+		Writer << "\t]\n";
+		Writer << "}\n";
+
+		return true;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include <functional>
+
+/* ==========================================
+ *	Benchmark
+ * ========================================== */
+// Small timing harness for headless microbenchmarks. Each op is timed individually so we
+// can report percentiles, not only averages. Allocations are counted through a global
+// counter that the benchmark executable increments from its operator new override.
+// Nothing in here touches GL or the window, so suites can run without a context.
+
+namespace RavenousBenchmark
+{
+	struct RBenchmarkResult
+	{
+		string Name;
+		uint Iterations = 0;
+		double NsPerOp = 0;
+		double AllocsPerOp = 0;
+		double P50 = 0;
+		double P90 = 0;
+		double P99 = 0;
+		double Min = 0;
+		double Max = 0;
+	};
+
+	struct RBenchmarkSettings
+	{
+		uint Iterations = 200;
+		uint WarmupIterations = 10;
+	};
+
+	// Incremented by the benchmark executable's operator new. Stays at zero otherwise.
+	inline uint64 AllocationCounter = 0;
+
+	// Runs Op Settings.Iterations times and collects per-op timings. Setup runs before every
+	// op and is excluded from the timing.
+	RBenchmarkResult RunBenchmark(
+		const string& Name,
+		const RBenchmarkSettings& Settings,
+		const std::function<void()>& Op,
+		const std::function<void()>& Setup = nullptr
+	);
+
+	void PrintBenchmarkResult(const RBenchmarkResult& Result);
+	bool WriteBenchmarkResultsJson(const string& Path, const string& Suite, const map<string, string>& Scene, const vector<RBenchmarkResult>& Results);
+}
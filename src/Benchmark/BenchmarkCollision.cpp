@@ -0,0 +1,243 @@
+#include "BenchmarkCollision.h"
+
+#include "engine/RavenousEngine.h"
+#include "engine/collision/ClGjk.h"
+#include "engine/collision/ClEpa.h"
+#include "engine/collision/Raycast.h"
+#include "engine/collision/TriangleBlock.h"
+#include "engine/geometry/mesh.h"
+#include "engine/world/World.h"
+#include "game/entities/Player.h"
+
+namespace RavenousBenchmark
+{
+	struct RGjkQuery
+	{
+		RCollisionMesh* EntityCollider;
+		RCollisionMesh Probe;
+	};
+
+	struct REpaQuery
+	{
+		RCollisionMesh* EntityCollider;
+		RCollisionMesh* Probe;
+		RSimplex Simplex;
+	};
+
+	// The per triangle loop TestRayAgainstCollider used before triangle blocks. Kept as the baseline
+	// the kernels are measured (and checked) against.
+	static RRaycastTest TestRayAgainstColliderReference(const RRay& Ray, RCollisionMesh* Collider, bool TestBothSides)
+	{
+		RRaycastTest MinHitTest{};
+		float MinDistance = MaxFloat;
+		const int Triangles = static_cast<int>(Collider->Indices.size() / 3);
+		for (int I = 0; I < Triangles; I++)
+		{
+			auto Test = TestRayAgainstTriangle(Ray, GetTriangleForColliderIndexedMesh(Collider, I), TestBothSides);
+			if (Test.Hit && Test.Distance < MinDistance)
+			{
+				MinHitTest = Test;
+				MinDistance = Test.Distance;
+			}
+		}
+		return MinHitTest;
+	}
+
+	static RCollisionMesh MakeProbeAt(const RCollisionMesh* Template, vec3 Position, vec3 Scale)
+	{
+		RCollisionMesh Probe = *Template;
+		for (auto& Vertex : Probe.Vertices)
+			Vertex = Position + Vertex * Scale;
+		return Probe;
+	}
+
+	vector<RBenchmarkResult> RunCollisionBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings)
+	{
+		auto* World = RWorld::Get();
+		auto* Player = EPlayer::Get();
+		RBenchmarkRandom Random(SceneSettings.Seed ^ 0x9e3779b9u);
+
+		vector<RBenchmarkResult> Results;
+
+		// -----------------------------------
+		// Query sets (built once, untimed)
+		// -----------------------------------
+		const vec3 ProbeScale = Player->Scale;
+		vector<RGjkQuery> OverlappingQueries;
+		vector<RGjkQuery> SeparatedQueries;
+
+		REntityIterator It;
+		while (auto* Entity = It())
+		{
+			if (Entity == Player || Entity->Name == "bench_floor")
+				continue;
+
+			vec3 Centroid = Entity->BoundingBox.GetCentroid();
+			OverlappingQueries.push_back(RGjkQuery{Entity->GetCollider(), MakeProbeAt(Player->CollisionMesh, Centroid, ProbeScale)});
+
+			// just above the entity's AABB, so GJK has to iterate a bit before giving up
+			vec3 Above{Centroid.x, Entity->BoundingBox.MaxY + 0.25f, Centroid.z};
+			SeparatedQueries.push_back(RGjkQuery{Entity->GetCollider(), MakeProbeAt(Player->CollisionMesh, Above, ProbeScale)});
+		}
+
+		vector<REpaQuery> EpaQueries;
+		for (auto& Query : OverlappingQueries)
+		{
+			GjkResult Gjk = ClRunGjk(Query.EntityCollider, &Query.Probe);
+			if (Gjk.Collision)
+				EpaQueries.push_back(REpaQuery{Query.EntityCollider, &Query.Probe, Gjk.Simplex});
+		}
+
+		constexpr uint RayCount = 256;
+		vector<RRay> HorizontalRays;
+		vector<RRay> DownwardRays;
+		for (uint i = 0; i < RayCount; i++)
+		{
+			vec3 Origin{Random.Range(-SceneSettings.Extent, SceneSettings.Extent), Random.Range(0.5f, 3.f), Random.Range(-SceneSettings.Extent, SceneSettings.Extent)};
+			float Angle = Random.Range(0.f, 2.f * PI);
+			HorizontalRays.push_back(RRay{Origin, vec3{cos(Angle), 0.f, sin(Angle)}});
+			DownwardRays.push_back(RRay{Origin + vec3{0.f, 6.f, 0.f}, vec3{0.f, -1.f, 0.f}});
+		}
+
+		uint Cursor = 0;
+
+		// -----------------------------------
+		// GJK / EPA
+		// -----------------------------------
+		if (!OverlappingQueries.empty())
+		{
+			Cursor = 0;
+			Results.push_back(RunBenchmark("gjk_overlapping", Settings, [&]()
+			{
+				auto& Query = OverlappingQueries[Cursor++ % OverlappingQueries.size()];
+				volatile bool Hit = ClRunGjk(Query.EntityCollider, &Query.Probe).Collision;
+			}));
+
+			Cursor = 0;
+			Results.push_back(RunBenchmark("gjk_separated", Settings, [&]()
+			{
+				auto& Query = SeparatedQueries[Cursor++ % SeparatedQueries.size()];
+				volatile bool Hit = ClRunGjk(Query.EntityCollider, &Query.Probe).Collision;
+			}));
+		}
+
+		if (!EpaQueries.empty())
+		{
+			Cursor = 0;
+			Results.push_back(RunBenchmark("epa", Settings, [&]()
+			{
+				auto& Query = EpaQueries[Cursor++ % EpaQueries.size()];
+				volatile float Penetration = ClRunEpa(Query.Simplex, Query.EntityCollider, Query.Probe).Penetration;
+			}));
+		}
+
+		// -----------------------------------
+		// World raycasts
+		// -----------------------------------
+		Cursor = 0;
+		Results.push_back(RunBenchmark("world_raycast_horizontal", Settings, [&]()
+		{
+			volatile bool Hit = World->Raycast(HorizontalRays[Cursor++ % RayCount], RayCast_TestOnlyFromOutsideIn).Hit;
+		}));
+
+		Cursor = 0;
+		Results.push_back(RunBenchmark("world_raycast_downward", Settings, [&]()
+		{
+			volatile bool Hit = World->Raycast(DownwardRays[Cursor++ % RayCount], RayCast_TestOnlyFromOutsideIn).Hit;
+		}));
+
+		// Collider raycasts against the dense meshes only, where the triangle loop dominates.
+		// Rays aim at the collider's centroid so most of them hit. The reference runs on the
+		// materialized world space collider, the kernels on the shared mesh + the entity transform.
+		vector<std::pair<RRay, EEntity*>> ColliderRays;
+		{
+			REntityIterator DenseIt;
+			while (auto* Entity = DenseIt())
+			{
+				if (Entity->CollisionMesh == nullptr || Entity->CollisionMesh->Name.rfind("bench_dense", 0) != 0)
+					continue;
+
+				vec3 Target = Entity->BoundingBox.GetCentroid();
+				for (uint i = 0; i < 8; i++)
+				{
+					vec3 Origin = Target + vec3{Random.Range(-8.f, 8.f), Random.Range(0.f, 4.f), Random.Range(-8.f, 8.f)};
+					ColliderRays.push_back({RRay{Origin, normalize(Target - Origin)}, Entity});
+				}
+			}
+		}
+
+		if (!ColliderRays.empty())
+		{
+			uint Mismatches = 0;
+			for (auto& [Ray, Entity] : ColliderRays)
+			{
+				for (bool BothSides : {false, true})
+				{
+					auto Reference = TestRayAgainstColliderReference(Ray, Entity->GetCollider(), BothSides);
+					auto Test = TestRayAgainstCollider(Ray, Entity->CollisionMesh, Entity->MatModel, BothSides ? RayCast_TestBothSidesOfTriangle : RayCast_TestOnlyFromOutsideIn);
+					if (Reference.Hit != Test.Hit || (Test.Hit && abs(Reference.Distance - Test.Distance) > 1e-4f))
+						Mismatches++;
+				}
+			}
+			if (Mismatches > 0)
+				Log("WARNING: %u collider raycasts disagree with the reference triangle loop.", Mismatches);
+
+			Cursor = 0;
+			Results.push_back(RunBenchmark("collider_raycast_reference", Settings, [&]()
+			{
+				auto& [Ray, Entity] = ColliderRays[Cursor++ % ColliderRays.size()];
+				volatile bool Hit = TestRayAgainstColliderReference(Ray, Entity->GetCollider(), false).Hit;
+			}));
+
+			const NRaycastKernel DefaultKernel = GetRaycastKernel();
+			for (int Kernel = 0; Kernel < RaycastKernel_Count; Kernel++)
+			{
+				if (!SetRaycastKernel(static_cast<NRaycastKernel>(Kernel)))
+					continue;
+
+				Cursor = 0;
+				Results.push_back(RunBenchmark(string("collider_raycast_") + GetRaycastKernelName(static_cast<NRaycastKernel>(Kernel)), Settings, [&]()
+				{
+					auto& [Ray, Entity] = ColliderRays[Cursor++ % ColliderRays.size()];
+					volatile bool Hit = TestRayAgainstCollider(Ray, Entity->CollisionMesh, Entity->MatModel, RayCast_TestOnlyFromOutsideIn).Hit;
+				}));
+			}
+			SetRaycastKernel(DefaultKernel);
+		}
+
+		// Same shape as the ledge grab check the player does each frame
+		Cursor = 0;
+		Results.push_back(RunBenchmark("linear_raycast_array", Settings, [&]()
+		{
+			const RRay& Ray = HorizontalRays[Cursor++ % RayCount];
+			volatile bool Hit = World->LinearRaycastArray(RRay{Ray.Origin, Ray.Direction}, 12, 0.04f).Hit;
+		}));
+
+		// Model matrix + AABB for every entity, what the editor does when moving things around
+		Results.push_back(RunBenchmark("world_update_transforms", Settings, [&]()
+		{
+			World->UpdateTransforms();
+		}));
+
+		// -----------------------------------
+		// Player
+		// -----------------------------------
+		// Full standing update: stepover vtrace + iterative collision resolution against the collision buffer.
+		RavenousEngine::GetFrame().Duration = 1.f / 60.f;
+		Results.push_back(RunBenchmark("player_update_state", Settings,
+			[&]()
+			{
+				Player->UpdateState();
+			},
+			[&]()
+			{
+				Player->Position = Player->PlayerInitialPosition;
+				Player->Velocity = vec3{0.f};
+				Player->PlayerState = NPlayerState::Standing;
+				Player->Update();
+			}
+		));
+
+		return Results;
+	}
+}
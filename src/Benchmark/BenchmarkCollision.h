@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	// GJK, EPA, world raycasts, the grab raycast array and a full player state update, all
+	// against the same synthetic scene. Requires BuildBenchmarkScene to have run.
+	vector<RBenchmarkResult> RunCollisionBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings);
+}
@@ -0,0 +1,106 @@
+#include "BenchmarkCulling.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/render/Culling.h"
+
+namespace RavenousBenchmark
+{
+	constexpr uint BoxesPerOp = 65536;
+
+	vector<RBenchmarkResult> RunCullingBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings)
+	{
+		RBenchmarkRandom Random(SceneSettings.Seed ^ 0x2c1b3c6du);
+		vector<RBenchmarkResult> Results;
+
+		RCullingInput Input;
+		for (uint i = 0; i < BoxesPerOp; i++)
+		{
+			const float E = SceneSettings.Extent;
+			const vec3 Center{Random.Range(-E, E), Random.Range(0.f, 10.f), Random.Range(-E, E)};
+			const vec3 Extent{Random.Range(0.1f, 2.f), Random.Range(0.1f, 2.f), Random.Range(0.1f, 2.f)};
+
+			RBoundingBox Box;
+			Box.MinX = Center.x - Extent.x;
+			Box.MaxX = Center.x + Extent.x;
+			Box.MinY = Center.y - Extent.y;
+			Box.MaxY = Center.y + Extent.y;
+			Box.MinZ = Center.z - Extent.z;
+			Box.MaxZ = Center.z + Extent.z;
+			Input.Add(nullptr, Box);
+		}
+
+		// a camera in the middle of the boxes looking down +x, and a point light with its six faces
+		const mat4 CameraProjection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+		const RFrustum CameraFrustum = RFrustum::FromMatrix(CameraProjection * glm::lookAt(vec3(0, 2, 0), vec3(1, 2, 0), vec3(0, 1, 0)));
+
+		const vec3 LightPosition{5, 3, 5};
+		const mat4 FaceProjection = glm::perspective(glm::radians(90.0f), 1.f, 1.f, 25.f);
+		const vec3 FaceDirections[6] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+		const vec3 FaceUps[6] = {{0, -1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0, -1, 0}, {0, -1, 0}};
+		RFrustum FaceFrusta[6];
+		for (uint i = 0; i < 6; i++)
+			FaceFrusta[i] = RFrustum::FromMatrix(FaceProjection * glm::lookAt(LightPosition, LightPosition + FaceDirections[i], FaceUps[i]));
+
+		vector<uint8> Visible(BoxesPerOp);
+
+		auto CullScalar = [&Input, &Visible](const RFrustum* Frusta, uint FrustumCount)
+		{
+			for (uint i = 0; i < BoxesPerOp; i++)
+			{
+				const vec3 Center(Input.CenterX[i], Input.CenterY[i], Input.CenterZ[i]);
+				const vec3 Extent(Input.ExtentX[i], Input.ExtentY[i], Input.ExtentZ[i]);
+				Visible[i] = 0;
+				for (uint f = 0; f < FrustumCount && !Visible[i]; f++)
+					Visible[i] = Frusta[f].TestBox(Center, Extent);
+			}
+		};
+
+		// the kernel has to agree with the scalar test box for box
+		for (auto [Frusta, FrustumCount] : {std::pair{&CameraFrustum, 1u}, std::pair{(const RFrustum*)FaceFrusta, 6u}})
+		{
+			CullScalar(Frusta, FrustumCount);
+			const vector<uint8> Expected = Visible;
+			CullBoxes(Input, Frusta, FrustumCount, 0, BoxesPerOp, Visible.data());
+
+			uint Mismatches = 0, VisibleCount = 0;
+			for (uint i = 0; i < BoxesPerOp; i++)
+			{
+				Mismatches += Visible[i] != Expected[i];
+				VisibleCount += Visible[i];
+			}
+
+			Log("culling: %u frusta, %u/%u boxes visible, %u mismatches against the scalar test.", FrustumCount, VisibleCount, BoxesPerOp, Mismatches);
+			if (Mismatches > 0)
+				Log("WARNING: culling kernel disagrees with RFrustum::TestBox.");
+		}
+
+		Results.push_back(RunBenchmark("cull_scalar_camera_65536", Settings, [&]()
+		{
+			CullScalar(&CameraFrustum, 1);
+		}));
+
+		Results.push_back(RunBenchmark("cull_simd_camera_65536", Settings, [&]()
+		{
+			CullBoxes(Input, &CameraFrustum, 1, 0, BoxesPerOp, Visible.data());
+		}));
+
+		Results.push_back(RunBenchmark("cull_simd_cube_faces_65536", Settings, [&]()
+		{
+			CullBoxes(Input, FaceFrusta, 6, 0, BoxesPerOp, Visible.data());
+		}));
+
+		auto* JobSystem = RJobSystem::Get();
+		JobSystem->Initialize();
+		Results.push_back(RunBenchmark("cull_simd_camera_65536_jobs", Settings, [&]()
+		{
+			JobSystem->ParallelFor(BoxesPerOp, RCulling::JobBatchSize, [&](uint Begin, uint End)
+			{
+				CullBoxes(Input, &CameraFrustum, 1, Begin, End, Visible.data());
+			});
+		}));
+
+		Log("culling: %.2f ns per box scalar, %.2f ns per box SSE.", Results[0].NsPerOp / BoxesPerOp, Results[1].NsPerOp / BoxesPerOp);
+
+		return Results;
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	// Frustum culling of world AABBs: the per box scalar test against the SSE kernel, for a camera
+	// frustum and for the six cubemap faces, single threaded and through the job system. Synthetic
+	// boxes, doesn't need a scene.
+	vector<RBenchmarkResult> RunCullingBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings);
+}
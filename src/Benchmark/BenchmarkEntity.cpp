@@ -0,0 +1,55 @@
+#include "BenchmarkEntity.h"
+
+#include "engine/entities/StaticMesh.h"
+#include "engine/world/World.h"
+#include "game/entities/Player.h"
+
+namespace RavenousBenchmark
+{
+	vector<RBenchmarkResult> RunEntityBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkEntitySettings& EntitySettings, const RBenchmarkSettings& Settings)
+	{
+		auto* World = RWorld::Get();
+		RBenchmarkRandom Random(SceneSettings.Seed ^ 0x2545f491u);
+		vector<RBenchmarkResult> Results;
+
+		RCollisionMesh* Box = MakeBenchmarkBoxCollisionMesh();
+		for (uint i = 0; i < EntitySettings.Entities; i++)
+		{
+			auto* Entity = *SpawnEntity<EStaticMesh>();
+			Entity->Name = "bench_crowd_" + std::to_string(i);
+			Entity->CollisionMesh = Box;
+			Entity->Position = vec3{Random.Range(-SceneSettings.Extent, SceneSettings.Extent), 0.f, Random.Range(-SceneSettings.Extent, SceneSettings.Extent)};
+			Entity->Rotation = vec3{0.f, Random.Range(0.f, 360.f), 0.f};
+			Entity->Scale = vec3{Random.Range(0.5f, 3.f)};
+			Entity->Update();
+		}
+
+		Log("sizeof(EEntity) = %zu, sizeof(EStaticMesh) = %zu, sizeof(EPlayer) = %zu", sizeof(EEntity), sizeof(EStaticMesh), sizeof(EPlayer));
+
+		// What building the render list touches per entity
+		Results.push_back(RunBenchmark("entity_iterate_render_fields", Settings, [&]()
+		{
+			uint64 Checksum = 0;
+			float Accumulator = 0.f;
+			REntityIterator It;
+			while (auto* Entity = It())
+			{
+				if (Entity->Flags & EntityFlags_InvisibleEntity)
+					continue;
+
+				Checksum += reinterpret_cast<uintptr_t>(Entity->Mesh) ^ reinterpret_cast<uintptr_t>(Entity->Shader);
+				Checksum += Entity->TextureDiffuse.GetGLID();
+				Accumulator += Entity->MatModel[3][0] + Entity->BoundingBox.MaxY;
+			}
+			volatile uint64 Sink = Checksum + static_cast<uint64>(Accumulator);
+		}));
+
+		// What the transform update touches per entity
+		Results.push_back(RunBenchmark("entity_update_transforms", Settings, [&]()
+		{
+			World->UpdateTransforms();
+		}));
+
+		return Results;
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	struct RBenchmarkEntitySettings
+	{
+		uint Entities = 10000;
+	};
+
+	// Spawns a crowd of static meshes and measures walking them the way the renderer and the
+	// transform update do. Reports the entity layout size so changes to EEntity show up here.
+	vector<RBenchmarkResult> RunEntityBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkEntitySettings& EntitySettings, const RBenchmarkSettings& Settings);
+}
@@ -0,0 +1,65 @@
+#include "BenchmarkLights.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/render/LightClusters.h"
+
+namespace RavenousBenchmark
+{
+	vector<RBenchmarkResult> RunLightsBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings)
+	{
+		RBenchmarkRandom Random(SceneSettings.Seed ^ 0x5bd1e995u);
+		vector<RBenchmarkResult> Results;
+
+		// same projection the game camera uses, lights are placed in view space in front of it
+		const float Near = 0.1f;
+		const float Far = 100.f;
+		const mat4 Projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, Near, Far);
+
+		auto* Clusters = RLightClusters::Get();
+		Clusters->SetProjection(Projection, Near, Far);
+
+		auto* JobSystem = RJobSystem::Get();
+
+		for (uint LightCount : {32u, 256u, 1024u})
+		{
+			vector<RLightSphere> PointLights;
+			vector<RLightSphere> SpotLights;
+			for (uint i = 0; i < LightCount; i++)
+			{
+				const float Depth = Random.Range(1.f, Far * 0.6f);
+				const float HalfWidth = Depth * 0.7f;
+				const RLightSphere Sphere{
+					vec3{Random.Range(-HalfWidth, HalfWidth), Random.Range(-HalfWidth * 0.6f, HalfWidth * 0.6f), -Depth},
+					Random.Range(1.f, 8.f)
+				};
+				(i % 4 == 3 ? SpotLights : PointLights).push_back(Sphere);
+			}
+
+			// zero workers runs everything inline
+			JobSystem->Shutdown();
+			Clusters->Bin(PointLights, SpotLights);
+			const vector<uint> InlineGrid = Clusters->GetGrid();
+			const vector<uint16> InlineIndices = Clusters->GetIndices();
+
+			const string Name = "clusters_bin_" + std::to_string(LightCount);
+			Results.push_back(RunBenchmark(Name, Settings, [&]()
+			{
+				Clusters->Bin(PointLights, SpotLights);
+			}));
+
+			JobSystem->Initialize();
+			Results.push_back(RunBenchmark(Name + "_jobs", Settings, [&]()
+			{
+				Clusters->Bin(PointLights, SpotLights);
+			}));
+
+			const bool Identical = Clusters->GetGrid() == InlineGrid && Clusters->GetIndices() == InlineIndices;
+			const auto& Stats = Clusters->GetStats();
+			Log("clusters: %u lights, %u assignments in %u clusters, at most %u per cluster, %u dropped, jobs %s the inline result.",
+				LightCount, Stats.Assignments, Stats.OccupiedClusters, Stats.MaxLightsInCluster, Stats.Dropped,
+				Identical ? "match" : "DON'T match");
+		}
+
+		return Results;
+	}
+}
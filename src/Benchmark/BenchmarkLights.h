@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	// Clustered light binning for 32, 256 and 1024 lights (three point lights to one spot light),
+	// inline and through the job system. Synthetic lights around a camera, doesn't need a scene.
+	vector<RBenchmarkResult> RunLightsBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings);
+}
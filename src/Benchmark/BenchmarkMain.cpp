@@ -0,0 +1,150 @@
+// Entry point for the headless benchmark executable. Built by tools/bench.bat with
+// RAVENOUS_BENCHMARK defined and Ravenous.cpp left out, so no window or GL context exists.
+#ifdef RAVENOUS_BENCHMARK
+
+#include "BenchmarkCollision.h"
+#include "BenchmarkCulling.h"
+#include "BenchmarkEntity.h"
+#include "BenchmarkLights.h"
+#include "BenchmarkOcclusion.h"
+#include "BenchmarkRender.h"
+#include "BenchmarkTransform.h"
+#include "engine/render/CommandList.h"
+#include "engine/render/ImRender.h"
+#include "engine/render/RingBuffer.h"
+#include "test/TestAll.h"
+
+#include <cstdlib>
+#include <new>
+
+// ---------------------------
+// Allocation counting
+// ---------------------------
+void* operator new(size_t Size)
+{
+	RavenousBenchmark::AllocationCounter++;
+	if (void* Ptr = malloc(Size ? Size : 1))
+		return Ptr;
+	throw std::bad_alloc{};
+}
+
+void operator delete(void* Ptr) noexcept
+{
+	free(Ptr);
+}
+
+void operator delete(void* Ptr, size_t) noexcept
+{
+	free(Ptr);
+}
+
+static void PrintUsage()
+{
+	printf("usage: RavenousBenchmark [--boxes N] [--slopes N] [--dense N] [--dense-resolution N] [--seed N] [--iterations N] [--entities N] [--world DIR] [--suite all|collision|transform|entity|culling|lights|render|occlusion|tests] [--out results.json]\n");
+}
+
+int main(int Argc, char** Argv)
+{
+	using namespace RavenousBenchmark;
+
+	RBenchmarkSceneSettings SceneSettings;
+	RBenchmarkSettings Settings;
+	RBenchmarkEntitySettings EntitySettings;
+	RBenchmarkOcclusionSettings OcclusionSettings;
+	string OutputPath = "benchmark_collision.json";
+	string Suite = "all";
+
+	for (int i = 1; i < Argc; i++)
+	{
+		string Arg = Argv[i];
+		bool HasValue = i + 1 < Argc;
+
+		if (Arg == "--help" || !HasValue)
+		{
+			PrintUsage();
+			return Arg == "--help" ? 0 : 1;
+		}
+
+		string Value = Argv[++i];
+		if (Arg == "--boxes")                 SceneSettings.Boxes = std::stoul(Value);
+		else if (Arg == "--slopes")           SceneSettings.Slopes = std::stoul(Value);
+		else if (Arg == "--dense")            SceneSettings.DenseMeshes = std::stoul(Value);
+		else if (Arg == "--dense-resolution") SceneSettings.DenseMeshResolution = std::stoul(Value);
+		else if (Arg == "--entities")         EntitySettings.Entities = std::stoul(Value);
+		else if (Arg == "--world")            OcclusionSettings.WorldPath = Value;
+		else if (Arg == "--seed")             SceneSettings.Seed = std::stoul(Value);
+		else if (Arg == "--iterations")       Settings.Iterations = std::stoul(Value);
+		else if (Arg == "--out")              OutputPath = Value;
+		else if (Arg == "--suite")            Suite = Value;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	// The test suites set up what they need themselves, and leave singletons behind no benchmark should start from
+	if (Suite == "tests")
+	{
+		RavenousTest::RunAllTestSuites();
+		return 0;
+	}
+
+	// No GL context in here
+	RImDraw::Enabled = false;
+	RRenderBackend::Get()->Type = NRenderBackend::Null;
+	RDynamicBuffers::Get()->Init(NRingBufferBackend::Memory);
+
+	vector<RBenchmarkResult> Results;
+	auto AppendSuite = [&Results](vector<RBenchmarkResult> SuiteResults)
+	{
+		Results.insert(Results.end(), SuiteResults.begin(), SuiteResults.end());
+	};
+
+	if (Suite == "all" || Suite == "collision")
+	{
+		BuildBenchmarkScene(SceneSettings);
+		AppendSuite(RunCollisionBenchmarkSuite(SceneSettings, Settings));
+	}
+	if (Suite == "all" || Suite == "transform")
+	{
+		AppendSuite(RunTransformBenchmarkSuite(SceneSettings, Settings));
+	}
+	if (Suite == "all" || Suite == "entity")
+	{
+		AppendSuite(RunEntityBenchmarkSuite(SceneSettings, EntitySettings, Settings));
+	}
+	if (Suite == "all" || Suite == "culling")
+	{
+		AppendSuite(RunCullingBenchmarkSuite(SceneSettings, Settings));
+	}
+	if (Suite == "all" || Suite == "lights")
+	{
+		AppendSuite(RunLightsBenchmarkSuite(SceneSettings, Settings));
+	}
+	if (Suite == "all" || Suite == "render")
+	{
+		AppendSuite(RunRenderBenchmarkSuite(SceneSettings, Settings));
+	}
+	if (Suite == "all" || Suite == "occlusion")
+	{
+		AppendSuite(RunOcclusionBenchmarkSuite(SceneSettings, OcclusionSettings, Settings));
+	}
+
+	if (Results.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	for (const auto& Result : Results)
+		PrintBenchmarkResult(Result);
+
+	if (!WriteBenchmarkResultsJson(OutputPath, Suite, DescribeBenchmarkScene(SceneSettings), Results))
+		return 1;
+
+	Log("Results written to '%s'.", OutputPath.c_str());
+	return 0;
+}
+
+#endif
@@ -0,0 +1,200 @@
+#include "BenchmarkOcclusion.h"
+
+#include "editor/reflection/Reflection.h"
+#include "engine/rvn.h"
+#include "engine/camera/camera.h"
+#include "engine/entities/StaticMesh.h"
+#include "engine/geometry/mesh.h"
+#include "engine/render/Culling.h"
+#include "engine/render/Occlusion.h"
+#include "engine/world/World.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace RavenousBenchmark
+{
+	constexpr uint CityBlocks = 12;				// per side
+	constexpr float CityBlockSize = 16.f;
+	constexpr uint CityProps = 4096;
+
+	struct ROcclusionScene
+	{
+		string Name;
+		vector<EEntity*> Entities;
+		mat4 ViewProjection;
+	};
+
+	static mat4 GetBenchmarkViewProjection(vec3 Position, vec3 Front)
+	{
+		RCamera Camera;
+		return glm::perspective(glm::radians(Camera.FovY), 16.f / 9.f, Camera.NearPlane, Camera.FarPlane) *
+			glm::lookAt(Position, Position + Front, Camera.Up);
+	}
+
+	// Unrendered copy of the box collision mesh, automatic occluders rasterize what's drawn
+	static RMesh* GetOcclusionRenderBox()
+	{
+		static RMesh* Box = nullptr;
+		if (!Box)
+		{
+			const RCollisionMesh* Source = MakeBenchmarkBoxCollisionMesh();
+			Box = new RMesh;
+			Box->Name = "bench_box";
+			for (const vec3& Vertex : Source->Vertices)
+				Box->Vertices.emplace_back(Vertex);
+			Box->Indices = Source->Indices;
+			Box->FacesCount = Box->Indices.size() / 3;
+		}
+		return Box;
+	}
+
+	static EEntity* SpawnOcclusionEntity(const string& Name, RCollisionMesh* CollisionMesh, vec3 Position, vec3 Rotation, vec3 Scale)
+	{
+		auto* Entity = *SpawnEntity<EStaticMesh>();
+		Entity->Name = Name;
+		Entity->CollisionMesh = CollisionMesh;
+		Entity->Mesh = GetOcclusionRenderBox();
+		Entity->Position = Position;
+		Entity->Rotation = Rotation;
+		Entity->Scale = Scale;
+		Entity->Update();
+		return Entity;
+	}
+
+	static string ReadFile(const std::filesystem::path& Path)
+	{
+		std::ifstream Reader(Path);
+		std::stringstream Contents;
+		Contents << Reader.rdbuf();
+		return Contents.str();
+	}
+
+	// Only the transforms of the .ref files are read, the player included, every collision and render
+	// mesh becomes the unit box. Generated collision meshes are the AABBs of their render meshes, so that keeps the
+	// layout, not the exact sizes.
+	static bool LoadShippedScene(const string& WorldPath, ROcclusionScene& OutScene)
+	{
+		std::error_code Error;
+		if (!std::filesystem::is_directory(WorldPath, Error))
+			return false;
+
+		auto* BoxMesh = MakeBenchmarkBoxCollisionMesh();
+		vec3 CameraPosition{0.f}, CameraFront{1.f, 0.f, 0.f};
+		for (const auto& File : std::filesystem::directory_iterator(WorldPath, Error))
+		{
+			const string Extension = File.path().extension().string();
+			string Data = ReadFile(File.path());
+			if (Extension == ".ref")
+			{
+				// first line is "Name : Type"
+				const size_t FieldsStart = Data.find('\n');
+				if (FieldsStart == string::npos)
+					continue;
+
+				map<string, string> Fields;
+				Reflection::ParseFieldsFromSerializedObject(Data.substr(FieldsStart + 1), Fields);
+				if (!Fields.contains("CollisionMesh"))
+					continue;
+
+				auto FieldOr = [&Fields](const char* Name, vec3 Default)
+				{
+					auto It = Fields.find(Name);
+					return It != Fields.end() ? Reflection::FromString<vec3>(It->second) : Default;
+				};
+				OutScene.Entities.push_back(SpawnOcclusionEntity(
+					"bench_shipped_" + File.path().stem().string(), BoxMesh, FieldOr("Position", vec3{0.f}), FieldOr("Rotation", vec3{0.f}), FieldOr("Scale", vec3{1.f})
+				));
+			}
+			else if (Extension == ".rcam")
+			{
+				map<string, string> Fields;
+				Reflection::ParseFieldsFromSerializedObject(Data, Fields);
+				if (Fields.contains("Position"))
+					CameraPosition = Reflection::FromString<vec3>(Fields["Position"]);
+				if (Fields.contains("Front"))
+					CameraFront = Reflection::FromString<vec3>(Fields["Front"]);
+			}
+		}
+
+		OutScene.Name = "shipped";
+		OutScene.ViewProjection = GetBenchmarkViewProjection(CameraPosition, CameraFront);
+		return !OutScene.Entities.empty();
+	}
+
+	// A grid of buildings with props (crates, lamps, benches) on the streets and in the blocks behind
+	// them, seen from street level at a slight angle to the streets.
+	static ROcclusionScene BuildCityScene(uint Seed)
+	{
+		RBenchmarkRandom Random(Seed);
+		auto* BoxMesh = MakeBenchmarkBoxCollisionMesh();
+		const float CityExtent = CityBlocks * CityBlockSize;
+
+		ROcclusionScene Scene;
+		Scene.Name = "city";
+		Scene.Entities.push_back(SpawnOcclusionEntity("bench_city_ground", BoxMesh, vec3{0.f, -1.f, 0.f}, vec3{0.f}, vec3{CityExtent, 1.f, CityExtent}));
+
+		for (uint z = 0; z < CityBlocks; z++)
+		{
+			for (uint x = 0; x < CityBlocks; x++)
+			{
+				const vec3 Size{Random.Range(8.f, 12.f), Random.Range(8.f, 30.f), Random.Range(8.f, 12.f)};
+				const vec3 Corner{x * CityBlockSize + 2.f, 0.f, z * CityBlockSize + 2.f};
+				Scene.Entities.push_back(SpawnOcclusionEntity("bench_city_building_" + std::to_string(z * CityBlocks + x), BoxMesh, Corner, vec3{0.f}, Size));
+			}
+		}
+
+		for (uint i = 0; i < CityProps; i++)
+		{
+			const vec3 Position{Random.Range(0.f, CityExtent), 0.f, Random.Range(0.f, CityExtent)};
+			const vec3 Size{Random.Range(0.3f, 1.5f), Random.Range(0.3f, 3.f), Random.Range(0.3f, 1.5f)};
+			Scene.Entities.push_back(SpawnOcclusionEntity("bench_city_prop_" + std::to_string(i), BoxMesh, Position, vec3{0.f, Random.Range(0.f, 360.f), 0.f}, Size));
+		}
+
+		Scene.ViewProjection = GetBenchmarkViewProjection(vec3{1.f, 1.7f, 1.f}, glm::normalize(vec3{1.f, -0.05f, 0.6f}));
+		return Scene;
+	}
+
+	vector<RBenchmarkResult> RunOcclusionBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkOcclusionSettings& OcclusionSettings, const RBenchmarkSettings& Settings)
+	{
+		vector<RBenchmarkResult> Results;
+		auto* Occlusion = ROcclusionCulling::Get();
+
+		vector<ROcclusionScene> Scenes;
+		const string WorldPath = OcclusionSettings.WorldPath.empty() ? Paths::World : OcclusionSettings.WorldPath;
+		if (ROcclusionScene Shipped; LoadShippedScene(WorldPath, Shipped))
+			Scenes.push_back(std::move(Shipped));
+		else
+			Log("occlusion: no shipped world in '%s', pass --world to point at it.", WorldPath.c_str());
+		Scenes.push_back(BuildCityScene(SceneSettings.Seed ^ 0x5bd1e995u));
+
+		for (const ROcclusionScene& Scene : Scenes)
+		{
+			// the frustum pass runs first in the renderer too
+			const RFrustum Frustum = RFrustum::FromMatrix(Scene.ViewProjection);
+			vector<EEntity*> FrustumVisible;
+			for (EEntity* Entity : Scene.Entities)
+			{
+				const RBoundingBox& Box = Entity->BoundingBox;
+				const vec3 Center = vec3(Box.MinX + Box.MaxX, Box.MinY + Box.MaxY, Box.MinZ + Box.MaxZ) * 0.5f;
+				const vec3 Extent = vec3(Box.MaxX - Box.MinX, Box.MaxY - Box.MinY, Box.MaxZ - Box.MinZ) * 0.5f;
+				if (Frustum.TestBox(Center, Extent))
+					FrustumVisible.push_back(Entity);
+			}
+
+			const string Name = "occlusion_" + Scene.Name + "_" + std::to_string(Scene.Entities.size());
+			Results.push_back(RunBenchmark(Name, Settings, [&]()
+			{
+				Occlusion->Cull(FrustumVisible, Scene.ViewProjection);
+			}));
+
+			const uint Drawn = static_cast<uint>(Occlusion->Cull(FrustumVisible, Scene.ViewProjection).size());
+			const ROcclusionStats& Stats = Occlusion->GetStats();
+			Log("occlusion: %s scene, %zu entities, %zu in the frustum, %u occluded (%.1f%% of the tested ones), %u drawn. %u occluders, %u triangles.",
+				Scene.Name.c_str(), Scene.Entities.size(), FrustumVisible.size(), Stats.Occluded, Stats.GetOccludedPercent(), Drawn, Stats.Occluders, Stats.OccluderTriangles);
+		}
+
+		return Results;
+	}
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	struct RBenchmarkOcclusionSettings
+	{
+		string WorldPath;			// folder with the .ref files and Camera.rcam of the shipped scene, Paths::World when empty
+	};
+
+	// Software occlusion culling of the camera pass on the shipped world, seen from its saved editor
+	// camera, and on a synthetic street of buildings with props scattered behind them: occluder
+	// rasterization, pyramid and box tests. Logs how many of the frustum visible entities get culled.
+	// Collision meshes in the shipped world stand in as unit boxes, their assets aren't loaded.
+	vector<RBenchmarkResult> RunOcclusionBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkOcclusionSettings& OcclusionSettings, const RBenchmarkSettings& Settings);
+}
@@ -0,0 +1,106 @@
+#include "BenchmarkRender.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/geometry/mesh.h"
+#include "engine/render/CommandList.h"
+#include "engine/render/RenderQueue.h"
+#include "engine/render/RingBuffer.h"
+#include "engine/render/Shader.h"
+
+namespace RavenousBenchmark
+{
+	constexpr uint MeshCount = 16;
+	constexpr uint ShaderCount = 4;
+	constexpr uint TextureCount = 24;
+
+	vector<RBenchmarkResult> RunRenderBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings)
+	{
+		RBenchmarkRandom Random(SceneSettings.Seed ^ 0x68e31da4u);
+		vector<RBenchmarkResult> Results;
+
+		// made up GL names, the Null backend never hands them to GL
+		vector<RMesh> Meshes(MeshCount);
+		for (uint i = 0; i < MeshCount; i++)
+		{
+			Meshes[i].Name = "bench_render_" + std::to_string(i);
+			Meshes[i].GLData.VAO = i + 1;
+			Meshes[i].Indices.resize(3 * (200 + 100 * i));
+			Meshes[i].ShortIndices = true;
+		}
+
+		RShader Shaders[ShaderCount];
+		RShader InstancedShaders[ShaderCount];
+		for (uint i = 0; i < ShaderCount; i++)
+		{
+			InstancedShaders[i].GLProgramID = 101 + i;
+			Shaders[i].GLProgramID = 1 + i;
+			// one program without an instanced variant, like the tiled texture shader
+			Shaders[i].Instanced = i + 1 < ShaderCount ? &InstancedShaders[i] : nullptr;
+		}
+
+		vector<RTextureHandle> Textures;
+		for (uint i = 0; i < TextureCount; i++)
+			Textures.push_back(RegisterTexture(RTexture{.ID = 1 + i, .Type = "texture_diffuse", .Name = "bench_render_" + std::to_string(i)}));
+
+		RRenderQueue Queue;
+		auto* Backend = RRenderBackend::Get();
+		auto* DynamicBuffers = RDynamicBuffers::Get();
+
+		for (uint ItemCount : {1024u, 8192u})
+		{
+			// a few materials used a lot and a long tail, roughly what a level looks like
+			vector<mat4> Matrices(ItemCount);
+			vector<RDrawItem> Items(ItemCount);
+			for (uint i = 0; i < ItemCount; i++)
+			{
+				Matrices[i] = glm::translate(Mat4Identity, vec3{Random.Range(-50.f, 50.f), 0.f, Random.Range(-50.f, 50.f)});
+
+				const uint Material = Random.Next() % 8 < 6 ? Random.Next() % 4 : Random.Next() % TextureCount;
+				RDrawItem& Item = Items[i];
+				Item.MatModel = &Matrices[i];
+				Item.Mesh = &Meshes[(Material * 7 + Random.Next() % 2) % MeshCount];
+				Item.Shader = &Shaders[Material % ShaderCount];
+				Item.Diffuse = Textures[Material];
+				Item.Specular = Textures[(Material + 1) % TextureCount];
+				Item.Pass = Random.Next() % 32 == 0 ? NRenderPass::Wireframe : NRenderPass::Opaque;
+			}
+
+			auto SubmitAll = [&]()
+			{
+				DynamicBuffers->BeginFrame();
+				Queue.Clear();
+				Queue.AddParallel(ItemCount, [&Items](uint Index, RDrawItem& OutItem)
+				{
+					OutItem = Items[Index];
+					return true;
+				});
+				Queue.Sort();
+				Queue.Submit();
+				DynamicBuffers->EndFrame();
+			};
+
+			Backend->ResetStats();
+			SubmitAll();
+			const auto& QueueStats = Queue.GetStats();
+			const auto& BackendStats = Backend->GetStats();
+			Log("render: %u items, %u commands, %u draws (%u instanced, %u items in them), %u state changes against %u naive.",
+				ItemCount, BackendStats.Commands, BackendStats.DrawCalls, QueueStats.InstancedDrawCalls, QueueStats.InstancedItems,
+				QueueStats.GetStateChanges(), QueueStats.GetNaiveStateChanges());
+			if (BackendStats.DrawCalls != QueueStats.DrawCalls)
+				Log("WARNING: the backend counted %u draws, the queue %u.", BackendStats.DrawCalls, QueueStats.DrawCalls);
+
+			// one worker helping the main thread, then all of them
+			auto* JobSystem = RJobSystem::Get();
+			const string Name = "render_queue_submit_null_" + std::to_string(ItemCount);
+			JobSystem->Shutdown();
+			JobSystem->Initialize(1);
+			Results.push_back(RunBenchmark(Name, Settings, SubmitAll, [Backend]() { Backend->ResetStats(); }));
+
+			JobSystem->Shutdown();
+			JobSystem->Initialize();
+			Results.push_back(RunBenchmark(Name + "_jobs", Settings, SubmitAll, [Backend]() { Backend->ResetStats(); }));
+		}
+
+		return Results;
+	}
+}
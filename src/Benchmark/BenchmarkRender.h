@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	// Recording and submitting the lit pass of the render queue for 1024 and 8192 items through the
+	// Null backend: sort, state tracking, instance upload and command recording, no GL. Synthetic
+	// meshes, shaders and textures, doesn't need a scene.
+	vector<RBenchmarkResult> RunRenderBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings);
+}
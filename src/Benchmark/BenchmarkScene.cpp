@@ -0,0 +1,206 @@
+#include "BenchmarkScene.h"
+
+#include "engine/rvn.h"
+#include "engine/geometry/mesh.h"
+#include "engine/entities/StaticMesh.h"
+#include "engine/collision/ClController.h"
+#include "engine/world/World.h"
+#include "game/entities/Player.h"
+
+namespace RavenousBenchmark
+{
+	// Axis aligned box with outward facing, counter-clockwise triangles
+	static RCollisionMesh* MakeBox(const string& Name, vec3 Min, vec3 Max)
+	{
+		auto* Box = new RCollisionMesh;
+		Box->Name = Name;
+		Box->Vertices = {
+			vec3{Min.x, Min.y, Min.z}, vec3{Max.x, Min.y, Min.z}, vec3{Max.x, Max.y, Min.z}, vec3{Min.x, Max.y, Min.z},
+			vec3{Min.x, Min.y, Max.z}, vec3{Max.x, Min.y, Max.z}, vec3{Max.x, Max.y, Max.z}, vec3{Min.x, Max.y, Max.z},
+		};
+		Box->Indices = {
+			0, 3, 2,  0, 2, 1,		// -Z
+			4, 5, 6,  4, 6, 7,		// +Z
+			0, 4, 7,  0, 7, 3,		// -X
+			1, 2, 6,  1, 6, 5,		// +X
+			0, 1, 5,  0, 5, 4,		// -Y
+			3, 7, 6,  3, 6, 2,		// +Y
+		};
+		return Box;
+	}
+
+	static RCollisionMesh* FindOrRegister(RCollisionMesh* CollisionMesh)
+	{
+		if (auto** Existing = Find(CollisionGeometryCatalogue, CollisionMesh->Name))
+		{
+			delete CollisionMesh;
+			return *Existing;
+		}
+
+		CollisionGeometryCatalogue.insert({CollisionMesh->Name, CollisionMesh});
+		return CollisionMesh;
+	}
+
+	RCollisionMesh* MakeBenchmarkBoxCollisionMesh()
+	{
+		return FindOrRegister(MakeBox("bench_box", vec3{0.f}, vec3{1.f}));
+	}
+
+	RCollisionMesh* MakeBenchmarkSlopeCollisionMesh()
+	{
+		// Wedge rising along +X
+		auto* Slope = new RCollisionMesh;
+		Slope->Name = "bench_slope";
+		Slope->Vertices = {
+			vec3{0, 0, 0}, vec3{1, 0, 0}, vec3{1, 1, 0},
+			vec3{0, 0, 1}, vec3{1, 0, 1}, vec3{1, 1, 1},
+		};
+		Slope->Indices = {
+			0, 1, 4,  0, 4, 3,		// bottom
+			1, 2, 5,  1, 5, 4,		// back
+			0, 2, 1,				// side -Z
+			3, 4, 5,				// side +Z
+			0, 3, 5,  0, 5, 2,		// ramp
+		};
+		return FindOrRegister(Slope);
+	}
+
+	RCollisionMesh* MakeBenchmarkDenseCollisionMesh(uint Resolution)
+	{
+		// UV sphere in the unit cube. Convex, so it stays valid input for GJK / EPA, but with
+		// enough vertices to make support point scans and per triangle raycasts show up.
+		const uint Rings = std::max(Resolution, 3u);
+		const uint Segments = std::max(Resolution, 3u);
+		const vec3 Center{0.5f};
+		const float Radius = 0.5f;
+
+		auto* Sphere = new RCollisionMesh;
+		Sphere->Name = "bench_dense_" + std::to_string(Resolution);
+
+		Sphere->Vertices.push_back(Center + vec3{0, Radius, 0});
+		for (uint R = 1; R < Rings; R++)
+		{
+			const float Phi = PI * static_cast<float>(R) / static_cast<float>(Rings);
+			for (uint S = 0; S < Segments; S++)
+			{
+				const float Theta = 2.f * PI * static_cast<float>(S) / static_cast<float>(Segments);
+				Sphere->Vertices.push_back(Center + Radius * vec3{sin(Phi) * cos(Theta), cos(Phi), sin(Phi) * sin(Theta)});
+			}
+		}
+		Sphere->Vertices.push_back(Center - vec3{0, Radius, 0});
+
+		const uint Bottom = static_cast<uint>(Sphere->Vertices.size()) - 1;
+		auto RingVertex = [Segments](uint R, uint S) { return 1 + (R - 1) * Segments + (S % Segments); };
+
+		auto AddTriangle = [&](uint A, uint B, uint C)
+		{
+			// keeps winding outward so one sided raycasts behave like on authored meshes
+			const vec3& VA = Sphere->Vertices[A];
+			const vec3& VB = Sphere->Vertices[B];
+			const vec3& VC = Sphere->Vertices[C];
+			const vec3 Normal = cross(VB - VA, VC - VA);
+			const vec3 Centroid = (VA + VB + VC) / 3.f;
+			if (dot(Normal, Centroid - Center) < 0)
+				std::swap(B, C);
+			Sphere->Indices.insert(Sphere->Indices.end(), {A, B, C});
+		};
+
+		for (uint S = 0; S < Segments; S++)
+			AddTriangle(0, RingVertex(1, S), RingVertex(1, S + 1));
+
+		for (uint R = 1; R < Rings - 1; R++)
+		{
+			for (uint S = 0; S < Segments; S++)
+			{
+				AddTriangle(RingVertex(R, S), RingVertex(R + 1, S), RingVertex(R + 1, S + 1));
+				AddTriangle(RingVertex(R, S), RingVertex(R + 1, S + 1), RingVertex(R, S + 1));
+			}
+		}
+
+		for (uint S = 0; S < Segments; S++)
+			AddTriangle(Bottom, RingVertex(Rings - 1, S + 1), RingVertex(Rings - 1, S));
+
+		return FindOrRegister(Sphere);
+	}
+
+	static EEntity* SpawnBenchmarkEntity(const string& Name, RCollisionMesh* CollisionMesh, vec3 Position, vec3 Rotation, vec3 Scale)
+	{
+		EHandle<EStaticMesh> Handle = SpawnEntity<EStaticMesh>();
+		auto* Entity = *Handle;
+		Entity->Name = Name;
+		Entity->CollisionMesh = CollisionMesh;
+		Entity->Position = Position;
+		Entity->Rotation = Rotation;
+		Entity->Scale = Scale;
+		Entity->Update();
+		return Entity;
+	}
+
+	void BuildBenchmarkScene(const RBenchmarkSceneSettings& Settings)
+	{
+		RBenchmarkRandom Random(Settings.Seed);
+
+		auto* BoxMesh = MakeBenchmarkBoxCollisionMesh();
+		auto* SlopeMesh = MakeBenchmarkSlopeCollisionMesh();
+		auto* DenseMesh = MakeBenchmarkDenseCollisionMesh(Settings.DenseMeshResolution);
+
+		// Floor top sits at y = 0
+		SpawnBenchmarkEntity("bench_floor", BoxMesh, vec3{-Settings.Extent, -1.f, -Settings.Extent}, vec3{0.f}, vec3{2.f * Settings.Extent, 1.f, 2.f * Settings.Extent});
+
+		// Keeps a clear area around the origin so the player spawns standing on the floor, not inside geometry.
+		auto RandomPositionOnFloor = [&Random, &Settings](float Y)
+		{
+			vec3 Position;
+			do {
+				Position = vec3{Random.Range(-Settings.Extent, Settings.Extent), Y, Random.Range(-Settings.Extent, Settings.Extent)};
+			} while (abs(Position.x) < 5.f && abs(Position.z) < 5.f);
+			return Position;
+		};
+
+		for (uint i = 0; i < Settings.Boxes; i++)
+		{
+			vec3 Scale{Random.Range(0.5f, 4.f), Random.Range(0.5f, 4.f), Random.Range(0.5f, 4.f)};
+			SpawnBenchmarkEntity("bench_box_" + std::to_string(i), BoxMesh, RandomPositionOnFloor(0.f), vec3{0.f}, Scale);
+		}
+
+		for (uint i = 0; i < Settings.Slopes; i++)
+		{
+			vec3 Rotation{0.f, 90.f * static_cast<float>(Random.Next() % 4), 0.f};
+			vec3 Scale{Random.Range(2.f, 6.f), Random.Range(1.f, 3.f), Random.Range(2.f, 4.f)};
+			auto* Slope = SpawnBenchmarkEntity("bench_slope_" + std::to_string(i), SlopeMesh, RandomPositionOnFloor(0.f), Rotation, Scale);
+			Slope->Slidable = (i % 2) == 0;
+		}
+
+		for (uint i = 0; i < Settings.DenseMeshes; i++)
+		{
+			vec3 Rotation{Random.Range(0.f, 360.f), Random.Range(0.f, 360.f), Random.Range(0.f, 360.f)};
+			const float Size = Random.Range(1.f, 3.f);
+			SpawnBenchmarkEntity("bench_dense_" + std::to_string(i), DenseMesh, RandomPositionOnFloor(Random.Range(0.f, 2.f)), Rotation, vec3{Size});
+		}
+
+		// Player: a prism the size of the capsule, feet at origin
+		EHandle<EPlayer> PlayerHandle = SpawnEntity<EPlayer>();
+		auto* Player = *PlayerHandle;
+		Player->Name = "Player";
+		Player->ID = EPlayer::PlayerID;
+		Player->CollisionMesh = FindOrRegister(MakeBox("bench_player", vec3{-0.5f, 0.f, -0.5f}, vec3{0.5f, 1.f, 0.5f}));
+		Player->Scale = vec3{2.f * Player->Radius, Player->Height, 2.f * Player->Radius};
+		Player->Position = vec3{0.f};
+		EPlayer::Initialize(Player);
+		Player->Update();
+
+		ClRecomputeCollisionBufferEntities();
+	}
+
+	map<string, string> DescribeBenchmarkScene(const RBenchmarkSceneSettings& Settings)
+	{
+		return {
+			{"boxes", std::to_string(Settings.Boxes)},
+			{"slopes", std::to_string(Settings.Slopes)},
+			{"dense_meshes", std::to_string(Settings.DenseMeshes)},
+			{"dense_mesh_resolution", std::to_string(Settings.DenseMeshResolution)},
+			{"extent", std::to_string(Settings.Extent)},
+			{"seed", std::to_string(Settings.Seed)},
+		};
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+/* ==========================================
+ *	Benchmark Scene
+ * ========================================== */
+// Deterministic synthetic scenes for the headless benchmarks. Geometry is generated in code
+// (no asset files, no GL) and registered in CollisionGeometryCatalogue under "bench_*" names,
+// so entities spawned here go through the same Update() / Collider path as loaded ones.
+
+namespace RavenousBenchmark
+{
+	struct RBenchmarkSceneSettings
+	{
+		uint Boxes = 200;
+		uint Slopes = 40;
+		uint DenseMeshes = 20;
+		uint DenseMeshResolution = 24;		// rings and segments of the dense convex meshes
+		float Extent = 60.f;				// entities are scattered in [-Extent, Extent] on XZ
+		uint Seed = 1337;
+	};
+
+	// Small LCG so scenes and query sets are identical on every machine and run.
+	struct RBenchmarkRandom
+	{
+		uint State;
+
+		explicit RBenchmarkRandom(uint Seed) : State(Seed) {}
+
+		uint Next()
+		{
+			State = State * 1664525u + 1013904223u;
+			return State;
+		}
+
+		float Range(float Min, float Max)
+		{
+			return Min + (Max - Min) * (static_cast<float>(Next() >> 8) / static_cast<float>(1u << 24));
+		}
+	};
+
+	RCollisionMesh* MakeBenchmarkBoxCollisionMesh();
+	RCollisionMesh* MakeBenchmarkSlopeCollisionMesh();
+	RCollisionMesh* MakeBenchmarkDenseCollisionMesh(uint Resolution);
+
+	// Spawns the floor, boxes, slopes and dense meshes plus the player and refreshes the collision buffer.
+	void BuildBenchmarkScene(const RBenchmarkSceneSettings& Settings);
+	map<string, string> DescribeBenchmarkScene(const RBenchmarkSceneSettings& Settings);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Benchmark.h"
+#include "BenchmarkScene.h"
+
+namespace RavenousBenchmark
+{
+	// Model matrix + world AABB computation: the per entity glm path against the SoA batch kernel,
+	// single threaded and through the job system. Synthetic data, doesn't need a scene.
+	vector<RBenchmarkResult> RunTransformBenchmarkSuite(const RBenchmarkSceneSettings& SceneSettings, const RBenchmarkSettings& Settings);
+}
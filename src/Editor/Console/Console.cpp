@@ -1,12 +1,15 @@
 #include "Editor/EditorMain.h"
 #include "editor/console/console.h"
 #include "engine/camera/camera.h"
+#include "engine/core/FrameMetrics.h"
+#include "engine/core/Profiler.h"
 #include "editor/EditorState.h"
 #include "Editor/Reflection/Serialization.h"
 #include "engine/io/display.h"
 #include "engine/io/input.h"
 #include "engine/io/InputPhase.h"
 #include "engine/render/text/TextRenderer.h"
+#include "engine/rvn.h"
 #include "engine/serialization/parsing/parser.h"
 #include "engine/world/World.h"
 #include "..\..\Game\Entities\Player.h"
@@ -183,6 +186,42 @@ void ExecuteCommand(const string& BufferLine, EPlayer* & Player, RWorld* World,
 			Camera->Position = GetParsed<vec3>(P);
 		}
 	}
+
+	// -----------------
+	// 'METRICS' COMMAND
+	// -----------------
+	// "metrics <file>" streams every frame's metrics to <file> in the project folder, "metrics off" stops
+	else if (Command == "metrics")
+	{
+		P.ParseWhitespace();
+		P.ParseToken();
+		const string Argument = GetParsed<string>(P);
+		if (Argument == "off")
+			RFrameMetrics::Get()->CloseStream();
+		else if (!Argument.empty())
+			RFrameMetrics::Get()->OpenStream(Paths::Project + "/" + Argument);
+	}
+
+	// -----------------
+	// 'PROFILE' COMMAND
+	// -----------------
+	// "profile <frames> [file]" captures the next <frames> frames as a Chrome trace, profile.json by default
+	else if (Command == "profile")
+	{
+		P.ParseWhitespace();
+		P.ParseUint();
+		if (!P.HasToken())
+		{
+			Log("Usage: profile <frames> [file]")
+			return;
+		}
+		const uint Frames = GetParsed<uint>(P);
+
+		P.ParseWhitespace();
+		P.ParseToken();
+		const string File = P.HasToken() ? GetParsed<string>(P) : "profile.json";
+		RProfiler::Get()->Capture(Frames, Paths::Project + "/" + File);
+	}
 	
 	else {
 		Log("Console command not understood: \"%s\"\n", Command.c_str());
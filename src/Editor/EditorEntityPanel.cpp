@@ -76,6 +76,10 @@ namespace Editor
 				Entity->Flags ^= EntityFlags_HiddenEntity;
 			}
 
+			// OCCLUDER
+			ImGui::SameLine();
+			ImGui::Checkbox("Occluder", &Entity->Occluder);
+
 			// MODEL PROPERTIES
 			ImGui::NewLine();
 			ImGui::Text("Model properties:");
@@ -146,10 +150,6 @@ namespace Editor
 
 			if (ImGui::Button("Build AABB Collision Mesh", ImVec2(82, 18)))
 			{
-				// Clear collider geometry
-				Entity->Collider.Vertices.clear();
-				Entity->Collider.Indices.clear();
-
 				// Create new collision mesh and copy entity mesh vertices into it
 				auto* NewCollisionMesh = new RCollisionMesh;
 				NewCollisionMesh->Name = Entity->Name + "_GeneratedCMesh";
@@ -169,7 +169,9 @@ namespace Editor
 				}
 
 				// Updates collider based on new collision mesh.
+				NewCollisionMesh->MarkDirty();
 				Entity->UpdateCollider();
+				Entity->UpdateBoundingBox();
 
 				ExportWavefrontCollisionMesh(Entity->CollisionMesh);
 			}
@@ -203,7 +205,7 @@ namespace Editor
 
 			// World Cells
 			if (ImGui::CollapsingHeader("World cells")) {
-				for (auto* Chunk : Entity->WorldChunks) {
+				for (auto* Chunk : Entity->Cold->WorldChunks) {
 					ImGui::Text(Chunk->GetChunkPositionString().c_str());
 				}
 			}
@@ -265,7 +267,7 @@ namespace Editor
 		{
 			for (const auto& [TextureName, Texture] : TextureCatalogue)
 			{
-				bool bInUse = Entity->TextureDiffuse.Name == TextureName;
+				bool bInUse = Entity->TextureDiffuse.Get().Name == TextureName;
 				if (ImGui::RadioButton(TextureName.c_str(), bInUse))
 				{
 					Entity->TextureDiffuse = Texture;
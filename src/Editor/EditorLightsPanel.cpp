@@ -104,6 +104,7 @@ namespace Editor
 					if (ImGui::DragFloat3(LabelPos.c_str(), Positions, 0.3, -10.0, 10.0))
 					{
 						Light.Position = vec3{Positions[0], Positions[1], Positions[2]};
+						World->PointLightsDirty.Mark(i);
 					}
 
 					// diffuse color 
@@ -112,6 +113,7 @@ namespace Editor
 					if (ImGui::ColorPicker3(LabelDiffuse.c_str(), Diffuse, ImGuiColorEditFlags_NoAlpha))
 					{
 						Light.Diffuse = vec3{Diffuse[0], Diffuse[1], Diffuse[2]};
+						World->PointLightsDirty.Mark(i);
 					}
 
 					// specular color 
@@ -120,18 +122,22 @@ namespace Editor
 					if (ImGui::ColorPicker3(LabelSpecular.c_str(), Specular, ImGuiColorEditFlags_NoAlpha))
 					{
 						Light.Specular = vec3{Specular[0], Specular[1], Specular[2]};
+						World->PointLightsDirty.Mark(i);
 					}
 
 					// intensity (decay)
 					ImGui::Text("Intensity decay");
 					auto LabelIntensityConst = "const##point" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityConstant, 0.05, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityConstant, 0.05, 0.0, 5.0))
+						World->PointLightsDirty.Mark(i);
 
 					auto LabelIntensityLinear = "linear##point" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityLinear.c_str(), &Light.IntensityLinear, 0.005, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityLinear.c_str(), &Light.IntensityLinear, 0.005, 0.0, 5.0))
+						World->PointLightsDirty.Mark(i);
 
 					auto LabelIntensityQuad = "quadratic##point" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityQuad.c_str(), &Light.IntensityQuadratic, 0.0005, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityQuad.c_str(), &Light.IntensityQuadratic, 0.0005, 0.0, 5.0))
+						World->PointLightsDirty.Mark(i);
 
 					ImGui::NewLine();
 				}
@@ -207,14 +213,17 @@ namespace Editor
 					if (ImGui::DragFloat3(LabelPos.c_str(), Positions, 0.3, -10.0, 10.0))
 					{
 						Light.Position = vec3{Positions[0], Positions[1], Positions[2]};
+						World->SpotLightsDirty.Mark(i);
 					}
 
 					// cones 
 					auto LabelInnercone = "innercone##spot" + std::to_string(i);
-					ImGui::DragFloat(LabelInnercone.c_str(), &Light.Innercone, 0.001, 1, MaxFloat);
+					if (ImGui::DragFloat(LabelInnercone.c_str(), &Light.Innercone, 0.001, 1, MaxFloat))
+						World->SpotLightsDirty.Mark(i);
 
 					auto LabelOutercone = "outercone##spot" + std::to_string(i);
-					ImGui::DragFloat(LabelOutercone.c_str(), &Light.Outercone, 0.001, 0, 1);
+					if (ImGui::DragFloat(LabelOutercone.c_str(), &Light.Outercone, 0.001, 0, 1))
+						World->SpotLightsDirty.Mark(i);
 
 					// direction
 					{
@@ -226,6 +235,7 @@ namespace Editor
 						if (ImGui::SliderFloat(LabelPitch.c_str(), &Pitch, -89.0, 89.0))
 						{
 							Light.Direction = ComputeDirectionFromAngles(Pitch, Yaw);
+							World->SpotLightsDirty.Mark(i);
 						}
 
 						//yaw
@@ -233,6 +243,7 @@ namespace Editor
 						if (ImGui::SliderFloat(LabelYaw.c_str(), &Yaw, -360.0, 360.0))
 						{
 							Light.Direction = ComputeDirectionFromAngles(Pitch, Yaw);
+							World->SpotLightsDirty.Mark(i);
 						}
 					}
 
@@ -242,6 +253,7 @@ namespace Editor
 					if (ImGui::ColorPicker3(LabelDiffuse.c_str(), Diffuse, ImGuiColorEditFlags_NoAlpha))
 					{
 						Light.Diffuse = vec3{Diffuse[0], Diffuse[1], Diffuse[2]};
+						World->SpotLightsDirty.Mark(i);
 					}
 
 					// specular color 
@@ -250,19 +262,23 @@ namespace Editor
 					if (ImGui::ColorPicker3(LabelSpecular.c_str(), Specular, ImGuiColorEditFlags_NoAlpha))
 					{
 						Light.Specular = vec3{Specular[0], Specular[1], Specular[2]};
+						World->SpotLightsDirty.Mark(i);
 					}
 
 					// intensity
 					// intensity (decay)
 					ImGui::Text("Intensity decay");
 					auto LabelIntensityConst = "const##spot" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityConstant, 0.05, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityConstant, 0.05, 0.0, 5.0))
+						World->SpotLightsDirty.Mark(i);
 
 					auto LabelIntensityLinear = "linear##spot" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityLinear, 0.005, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityLinear, 0.005, 0.0, 5.0))
+						World->SpotLightsDirty.Mark(i);
 
 					auto LabelIntensityQuad = "quadratic##spot" + std::to_string(i);
-					ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityQuadratic, 0.0005, 0.0, 5.0);
+					if (ImGui::DragFloat(LabelIntensityConst.c_str(), &Light.IntensityQuadratic, 0.0005, 0.0, 5.0))
+						World->SpotLightsDirty.Mark(i);
 
 
 					ImGui::NewLine();
@@ -28,7 +28,15 @@
 #include "engine/geometry/vertex.h"
 #include "engine/io/display.h"
 #include "engine/io/input.h"
+#include "engine/render/Culling.h"
 #include "engine/render/ImRender.h"
+#include "engine/render/LightClusters.h"
+#include "engine/render/LodSelector.h"
+#include "engine/render/RenderQueue.h"
+#include "engine/render/RenderStats.h"
+#include "engine/render/ShadowAtlas.h"
+#include "engine/render/ShadowCache.h"
+#include "engine/render/StaticBatches.h"
 #include "engine/render/Shader.h"
 #include "engine/render/text/face.h"
 #include "engine/render/text/TextRenderer.h"
@@ -198,6 +206,7 @@ namespace Editor
 
 	void Render(EPlayer* Player, RWorld* World, RCamera* Camera)
 	{
+		RRenderPassScope Pass(NStatsPass::Editor);
 		auto& EdContext = *GetContext();
 
 		// render world objs if toggled
@@ -326,7 +335,8 @@ namespace Editor
 			RenderEntityPanel(&Panel, World);
 			
 			if (Panel.ShowBoundingBox) {
-				RImDraw::AddCollisionMesh(IMHASH, &Panel.Entity->Collider); 
+				if (auto* Collider = Panel.Entity->GetCollider())
+					RImDraw::AddCollisionMesh(IMHASH, Collider); 
 			}
 		}
 
@@ -390,7 +400,11 @@ namespace Editor
 		RenderToolbar(World);
 
 		RenderTextOverlay(Player, Camera);
-		
+	}
+
+	void RenderDearImgui()
+	{
+		RRenderPassScope Pass(NStatsPass::Editor);
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 	}
@@ -430,9 +444,9 @@ namespace Editor
 		const auto GreenTex = LoadTextureFromFile("green.jpg", Paths::Textures);
 		const auto RedTex = LoadTextureFromFile("red.jpg", Paths::Textures);
 
-		YAxis->TextureDiffuse = RTexture{GreenTex, "texture_diffuse", "green.jpg", "green axis"};
-		XAxis->TextureDiffuse = RTexture{BlueTex, "texture_diffuse", "blue.jpg", "blue axis"};
-		ZAxis->TextureDiffuse = RTexture{RedTex, "texture_diffuse", "red.jpg", "red axis"};
+		YAxis->TextureDiffuse = RegisterTexture(RTexture{GreenTex, "texture_diffuse", "green.jpg", "green axis"});
+		XAxis->TextureDiffuse = RegisterTexture(RTexture{BlueTex, "texture_diffuse", "blue.jpg", "blue axis"});
+		ZAxis->TextureDiffuse = RegisterTexture(RTexture{RedTex, "texture_diffuse", "red.jpg", "red axis"});
 
 		const auto Shader = ShaderCatalogue.find("ortho_gui")->second;
 		XAxis->Shader = Shader;
@@ -475,9 +489,9 @@ namespace Editor
 		ZArrow->Scale = vec3(0.5, 0.5, 0.5);
 		ZArrow->Rotation = vec3(0);
 
-		YArrow->TextureDiffuse = RTexture{GreenTex, "texture_diffuse", "green.jpg", "green arrow"};
-		XArrow->TextureDiffuse = RTexture{BlueTex, "texture_diffuse", "blue.jpg", "blue arrow"};
-		ZArrow->TextureDiffuse = RTexture{RedTex, "texture_diffuse", "red.jpg", "red arrow"};
+		YArrow->TextureDiffuse = RegisterTexture(RTexture{GreenTex, "texture_diffuse", "green.jpg", "green arrow"});
+		XArrow->TextureDiffuse = RegisterTexture(RTexture{BlueTex, "texture_diffuse", "blue.jpg", "blue arrow"});
+		ZArrow->TextureDiffuse = RegisterTexture(RTexture{RedTex, "texture_diffuse", "red.jpg", "red arrow"});
 
 		// CollisionMesh
 		const auto ArrowCollider = new RCollisionMesh;
@@ -490,13 +504,10 @@ namespace Editor
 		}
 
 		XArrow->CollisionMesh = ArrowCollider;
-		XArrow->Collider = *ArrowCollider;
 
 		YArrow->CollisionMesh = ArrowCollider;
-		YArrow->Collider = *ArrowCollider;
 
 		ZArrow->CollisionMesh = ArrowCollider;
-		ZArrow->Collider = *ArrowCollider;
 
 		EdContext.EntityPanel.XArrow = XArrow;
 		EdContext.EntityPanel.YArrow = YArrow;
@@ -546,9 +557,7 @@ namespace Editor
 		NewEntity->Position = Entity->Position;
 		NewEntity->Rotation = Entity->Rotation;
 		NewEntity->Scale = Entity->Scale;
-		NewEntity->Collider = Entity->Collider;
 		NewEntity->CollisionMesh = Entity->CollisionMesh;
-		NewEntity->Collider = Entity->Collider;
 		NewEntity->Flags = Entity->Flags;
 		NewEntity->BoundingBox = Entity->BoundingBox;
 		FindNameForNewEntity(NewEntity);
@@ -587,9 +596,10 @@ namespace Editor
 		float GuiY = GlobalDisplayState::ViewportHeight - 60;
 		float ScreenHeight = GlobalDisplayState::ViewportHeight;
 
-		string Font = "consola18";
-		string FontCenter = "swanseait38";
-		string FontCenterSmall = "swanseait20";
+		auto* TextRenderer = RTextRenderer::Get();
+		static const RFontHandle Font = TextRenderer->GetFont("consola18");
+		static const RFontHandle FontCenter = TextRenderer->GetFont("swanseait38");
+		static const RFontHandle FontCenterSmall = TextRenderer->GetFont("swanseait20");
 		float CenteredTextHeight = ScreenHeight - 120;
 		float CenteredTextHeightSmall = CenteredTextHeight - 40;
 		auto ToolTextColorYellow = vec3(0.8, 0.8, 0.2);
@@ -635,13 +645,82 @@ namespace Editor
 				PlayerStateText = "PLAYER SLIDE FALLING";
 				break;
 		}
-		RenderText("consola18", GlobalDisplayState::ViewportWidth - 400, 30, PlayerStateTextColor, PlayerStateText);
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 30, PlayerStateTextColor, PlayerStateText);
 
 		// FPS
 		string Fps = std::to_string(RavenousEngine::GetFrame().Fps);
 		string FpsGui = "FPS: " + Fps;
 		RenderText(Font, GlobalDisplayState::ViewportWidth - 110, 40, FpsGui);
 
+		// RENDER QUEUE
+		const auto& QueueStats = RRenderQueue::Get()->GetStats();
+		string QueueGui = "Draws: " + std::to_string(QueueStats.DrawCalls) + "/" + std::to_string(QueueStats.Items)
+			+ "  State changes: " + std::to_string(QueueStats.GetStateChanges())
+			+ " (" + std::to_string(QueueStats.GetEliminatedStateChanges()) + " skipped)";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 115, QueueGui);
+
+		// CULLING
+		auto* Culling = RCulling::Get();
+		auto CullingText = [Culling](const char* Label, NCullPass Pass)
+		{
+			const auto& Stats = Culling->GetStats(Pass);
+			return string(Label) + " " + std::to_string(Stats.Visible) + "/" + std::to_string(Stats.Tested);
+		};
+		string CullingGui = "Visible: " + CullingText("cam", NCullPass::Camera) + "  " + CullingText("dir", NCullPass::DirectionalShadow)
+			+ "  " + CullingText("cube", NCullPass::PointShadow);
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 140, CullingGui);
+
+		// SHADOW CACHE
+		auto* ShadowCache = RShadowCache::Get();
+		auto ShadowCacheText = [ShadowCache](const char* Label, NShadowMap Map)
+		{
+			const auto& Stats = ShadowCache->GetStats(Map);
+			return string(Label) + " " + std::to_string(Stats.StaticRedraws) + " redrawn/" + std::to_string(Stats.StaticRedrawsAvoided)
+				+ " cached (" + std::to_string(Stats.DynamicCasters) + " dyn)";
+		};
+		const auto& AtlasStats = RShadowAtlas::Get()->GetStats();
+		string ShadowCacheGui = "Shadows: " + ShadowCacheText("dir", NShadowMap::Directional) + "  atlas "
+			+ std::to_string(AtlasStats.ShadowedLights) + " lights, " + std::to_string(AtlasStats.FacesRendered) + " faces drawn, "
+			+ std::to_string(AtlasStats.FacesPending) + " pending";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 165, ShadowCacheGui);
+
+		// LIGHT CLUSTERS
+		const auto& ClusterStats = RLightClusters::Get()->GetStats();
+		string ClustersGui = "Clusters: " + std::to_string(ClusterStats.OccupiedClusters) + " lit, "
+			+ std::to_string(ClusterStats.Assignments) + " assignments, max " + std::to_string(ClusterStats.MaxLightsInCluster)
+			+ " (" + std::to_string(ClusterStats.Dropped) + " dropped)";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 190, ClustersGui);
+
+		// STATIC BATCHES
+		const auto& BatchStats = RStaticBatches::Get()->GetStats();
+		string BatchesGui = "Static batches: " + std::to_string(BatchStats.BatchesDrawn) + "/" + std::to_string(BatchStats.Batches)
+			+ " drawn, " + std::to_string(BatchStats.BatchedEntities) + " entities, " + std::to_string(BatchStats.StaleCells) + " stale cells";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 215, BatchesGui);
+
+		// MESH LODS
+		const auto& LodStats = RLodSelector::Get()->GetStats();
+		string LodGui = "Triangles: scene " + std::to_string(LodStats.SceneTriangles) + "/" + std::to_string(LodStats.SceneFullTriangles)
+			+ "  shadows " + std::to_string(LodStats.ShadowTriangles) + "/" + std::to_string(LodStats.ShadowFullTriangles) + " (with/without LODs)";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 240, LodGui);
+
+		// TEXT
+		const auto& TextStats = TextRenderer->GetStats();
+		string TextGui = "Text: " + std::to_string(TextStats.Glyphs) + " glyphs, " + std::to_string(TextStats.TextCalls)
+			+ " calls in " + std::to_string(TextStats.DrawCalls) + " draws (last frame)";
+		RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 265, TextGui);
+
+		// RENDER PASSES (last frame)
+		auto* RenderStats = RRenderStats::Get();
+		for (uint Pass = 0; Pass < static_cast<uint>(NStatsPass::Count); Pass++)
+		{
+			const auto& Stats = RenderStats->GetPass(static_cast<NStatsPass>(Pass));
+			char PassGui[192];
+			snprintf(PassGui, sizeof(PassGui), "%s: %u draws, %u programs, %u textures, %u uniforms, %.1f KB up, %llu tris, %.2f ms",
+				GetStatsPassName(static_cast<NStatsPass>(Pass)), Stats.DrawCalls, Stats.ProgramBinds, Stats.TextureBinds,
+				Stats.UniformSets, Stats.UploadBytes / 1024.0, static_cast<unsigned long long>(Stats.Triangles), Stats.CpuMs);
+			RenderText(Font, GlobalDisplayState::ViewportWidth - 400, 290 + 25 * Pass, PassGui);
+		}
+
 
 		// EDITOR TOOLS INDICATORS
 
@@ -1197,6 +1276,7 @@ namespace Editor
 
 		Serialization::SaveWorldToDisk();
 		CleanupDeletedEntityFiles();
+		RStaticBatches::Get()->Bake();
 		PrintEditorMsg("World Saved");
 	}
 
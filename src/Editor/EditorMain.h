@@ -17,6 +17,8 @@ namespace Editor
 	void Initialize();
 	void Update(EPlayer* Player, RWorld* World, RCamera* Camera);
 	void Render(EPlayer* Player, RWorld* World, RCamera* Camera);
+	// after the frame's text, so the panels stay on top of it
+	void RenderDearImgui();
 	void Terminate();
 
 	EEntity* CopyEntity(EEntity* Entity);
@@ -6,6 +6,7 @@
 #include "..\Game\Entities\Player.h"
 #include "Editor/EditorMain.h"
 #include "engine/rvn.h"
+#include "engine/render/StaticBatches.h"
 
 
 bool REditorState::IsInGameMode()
@@ -41,6 +42,9 @@ void REditorState::ToggleProgramMode()
 
 		Player->MakeInvisible();
 
+		// whatever was edited gets merged back into the static batches
+		RStaticBatches::Get()->Bake();
+
 		glfwSetInputMode(GDC->GetWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 		Editor::EndDearImguiFrame();
 
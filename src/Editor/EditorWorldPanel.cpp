@@ -19,7 +19,7 @@ namespace Editor
 			auto ChunkPosition = ActiveChunk->GetChunkPosition();
 			// adds indicator in header if player is inside cell
 			string Header = ActiveChunk->GetChunkPositionString();
-			for (auto* PlayerChunk : Player->WorldChunks)
+			for (auto* PlayerChunk : Player->Cold->WorldChunks)
 			{
 				if (ChunkPosition == PlayerChunk->GetChunkPosition())
 				{
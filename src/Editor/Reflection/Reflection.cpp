@@ -103,14 +103,14 @@ string Reflection::ToString(RCollisionMesh* Field)
 	return Field->Name;
 }
 
-string Reflection::ToString(RTexture Field)
+string Reflection::ToString(RTextureHandle Field)
 {
-	if (Field.Name.empty())
+	if (Field.Get().Name.empty())
 	{
 		return "null";
 	}
 	
-	return Field.Name;
+	return Field.Get().Name;
 }
 
 string Reflection::ToString(RCylinder& Field)
@@ -226,7 +226,7 @@ RCollisionMesh* Reflection::FromString<RCollisionMesh*>(const string& Value)
 }
 
 template<>
-RTexture Reflection::FromString<RTexture>(const string& Value)
+RTextureHandle Reflection::FromString<RTextureHandle>(const string& Value)
 {
 	return GetOrLoadTexture(Value);
 }
@@ -365,7 +365,7 @@ namespace Reflection
 	string ToString(RShader* Field);
 	string ToString(RMesh* Field);
 	string ToString(RCollisionMesh* Field);
-	string ToString(RTexture Field);
+	string ToString(RTextureHandle Field);
 	string ToString(RCylinder& Field);
 
 	// default template for serialization of fields (check note on decltype usage below)
@@ -43,9 +43,11 @@ namespace Editor
 
 		if (Type == "point") {
 			World->PointLights.erase(World->PointLights.begin() + Index);
+			World->PointLightsDirty.MarkFrom(Index);
 		}
 		else if (Type == "spot") {
 			World->SpotLights.erase(World->SpotLights.begin() + Index);
+			World->SpotLightsDirty.MarkFrom(Index);
 		}
 
 		if (EdContext.LightsPanel.SelectedLight == Index) {
@@ -669,9 +671,15 @@ namespace Editor
 		}
 
 		if (Type == "point" && Index > -1)
+		{
 			World->PointLights[Index]->Position = Position;
+			World->PointLightsDirty.Mark(Index);
+		}
 		else if (Type == "spot" && Index > -1)
+		{
 			World->SpotLights[Index]->Position = Position;
+			World->SpotLightsDirty.Mark(Index);
+		}
 		else
 			assert(false);
 	}
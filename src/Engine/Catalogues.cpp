@@ -90,13 +90,13 @@ RShader* GetShader(const string& ShaderName)
 	return *FindShader;
 }
 
-RTexture GetOrLoadTexture(const string& TextureName)
+RTextureHandle GetOrLoadTexture(const string& TextureName)
 {
 	auto* FindTexture = Find(TextureCatalogue, TextureName);
 	if (!FindTexture)
 	{
 		Log("Texture '%s' not found.", TextureName.c_str());
-		return RTexture{};
+		return RTextureHandle{};
 	}
 
 	return *FindTexture;
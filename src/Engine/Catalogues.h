@@ -16,7 +16,7 @@ struct REntityAttributes
 
 struct RCatalogueSearchResult
 {
-	RTexture Textures[2];
+	RTextureHandle Textures[2];
 	int TexturesFound = 0;
 	RMesh* Mesh = nullptr;
 	RCollisionMesh* CollisionMesh = nullptr;
@@ -29,4 +29,4 @@ RCatalogueSearchResult FindEntityAssetsInCatalogue(const string& MeshName, const
 RMesh* GetOrLoadMesh(const string& MeshName);
 RCollisionMesh* GetOrLoadCollisionMesh(const string& CollisionMeshName);
 RShader* GetShader(const string& ShaderName);
-RTexture GetOrLoadTexture(const string& TextureName);
\ No newline at end of file
+RTextureHandle GetOrLoadTexture(const string& TextureName);
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <engine/collision/ClTypes.h>
 #include <engine/collision/ClController.h >
 #include "engine/world/World.h"
+#include "engine/core/Profiler.h"
 
 // ----------------------------
 // > UPDATE PLAYER WORLD CELLS   
@@ -84,6 +85,8 @@ void MarkEntityChecked(const EEntity* Entity)
 
 Array<RCollisionResults, 15> ClTestAndResolveCollisions(EPlayer* Player)
 {
+	PROFILE_ZONE("Collision");
+
 	// iterative collision detection
 	Array<RCollisionResults, 15> ResultsArray;
 	auto EntityBuffer = Rvn::EntityBuffer;
@@ -163,8 +166,8 @@ RCollisionResults ClTestPlayerVsEntity(EEntity* Entity, EPlayer* Player)
 	auto ClResults = RCollisionResults{};
 	ClResults.Entity = Entity;
 
-	RCollisionMesh* EntityCollider = &Entity->Collider;
-	RCollisionMesh* PlayerCollider = &Player->Collider;
+	RCollisionMesh* EntityCollider = Entity->GetCollider();
+	RCollisionMesh* PlayerCollider = Player->GetCollider();
 
 	GjkResult BoxGjkTest = ClRunGjk(EntityCollider, PlayerCollider);
 
@@ -249,5 +249,11 @@ GjkResult ClRunGjk(RCollisionMesh* ColliderA, RCollisionMesh* ColliderB)
 			//_Cldebug_render_simplex(gjk.Simplex);
 			return {.Simplex = Gjk.Simplex, .Collision = true};
 		}
+
+		// Touching / coplanar configurations can make the simplex cycle between the same support points forever
+		if (ItCount >= GjkMaxIterations)
+		{
+			return {};
+		}
 	}
 }
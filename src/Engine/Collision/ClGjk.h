@@ -19,6 +19,8 @@
 #include "engine/core/core.h"
 #include "simplex.h"
 
+constexpr static int GjkMaxIterations = 64;
+
 struct GjkIteration
 {
 	RSimplex Simplex;
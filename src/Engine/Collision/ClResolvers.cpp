@@ -12,6 +12,7 @@
 
 #include "engine/utils/utils.h"
 #include "engine/world/World.h"
+#include "engine/core/Profiler.h"
 
 
 // ---------------------
@@ -33,6 +34,8 @@ void ClResolveCollision(RCollisionResults Results, EPlayer* Player)
 
 ClVtraceResult ClDoStepoverVtrace(EPlayer* Player, RWorld* World)
 {
+	PROFILE_ZONE("Stepover Vtrace");
+
 	// Cast a ray at player's last point of contact with terrain to look for something steppable (terrain).
 	// Will cull out any results that are to be considered too high (is a wall) or too low (is a hole) considering
 	// player's current height.
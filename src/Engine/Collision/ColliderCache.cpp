@@ -0,0 +1,95 @@
+#include "ColliderCache.h"
+
+#include "engine/entities/Entity.h"
+
+RCollisionMesh* RColliderCache::GetWorldCollider(EEntity* Entity)
+{
+	const RCollisionMesh* Source = Entity->CollisionMesh;
+	if (Source == nullptr)
+		return nullptr;
+
+	// Reuse the entity's slot if it still owns it. The ID check covers a new entity allocated at the address of a deleted one.
+	RColliderCacheEntry* Entry = nullptr;
+	if (Entity->ColliderCacheSlot < Entries.size())
+	{
+		auto& Candidate = Entries[Entity->ColliderCacheSlot];
+		if (!Candidate.Free && Candidate.Owner == Entity && Candidate.OwnerID == Entity->ID)
+			Entry = &Candidate;
+	}
+
+	if (Entry == nullptr)
+	{
+		uint Slot;
+		if (!FreeSlots.empty())
+		{
+			Slot = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+		else
+		{
+			Slot = static_cast<uint>(Entries.size());
+			Entries.emplace_back();
+		}
+
+		Entry = &Entries[Slot];
+		Entry->Free = false;
+		Entry->Owner = Entity;
+		Entry->OwnerID = Entity->ID;
+		Entry->Source = nullptr;
+		Entity->ColliderCacheSlot = Slot;
+		UsedSlots++;
+	}
+
+	Entry->LastUsedFrame = Frame;
+
+	// a shared mesh edited in place can change size under the same pointer
+	const bool SizeChanged = Entry->Collider.Vertices.size() != Source->Vertices.size() || Entry->Collider.Indices.size() != Source->Indices.size();
+	if (Entry->Source != Source || SizeChanged)
+	{
+		// assign() keeps the slot's capacity around, so recycled slots rarely allocate
+		Entry->Collider.Name = Source->Name;
+		Entry->Collider.Indices.assign(Source->Indices.begin(), Source->Indices.end());
+		Entry->Collider.Vertices.resize(Source->Vertices.size());
+		Entry->Source = Source;
+		Entry->Version = Entity->ColliderVersion - 1;
+	}
+
+	if (Entry->Version != Entity->ColliderVersion)
+	{
+		const mat4& Model = Entity->MatModel;
+		for (size_t i = 0; i < Source->Vertices.size(); i++)
+			Entry->Collider.Vertices[i] = vec3(Model * vec4(Source->Vertices[i], 1.0));
+
+		Entry->Collider.MarkDirty();
+		Entry->Version = Entity->ColliderVersion;
+	}
+
+	return &Entry->Collider;
+}
+
+void RColliderCache::EndFrame()
+{
+	// Anything not asked for during this frame goes back to the free list. Slots keep their
+	// vectors' capacity, so a steady state scene stops allocating after a few frames.
+	for (uint Slot = 0; Slot < Entries.size(); Slot++)
+	{
+		auto& Entry = Entries[Slot];
+		if (!Entry.Free && Entry.LastUsedFrame < Frame)
+		{
+			Entry.Free = true;
+			Entry.Owner = nullptr;
+			Entry.Source = nullptr;
+			FreeSlots.push_back(Slot);
+			UsedSlots--;
+		}
+	}
+
+	Frame++;
+}
+
+void RColliderCache::Clear()
+{
+	Entries.clear();
+	FreeSlots.clear();
+	UsedSlots = 0;
+}
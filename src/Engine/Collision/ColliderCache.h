@@ -0,0 +1,52 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "CollisionMesh.h"
+#include <deque>
+
+struct EEntity;
+
+/* ==========================================
+ *	Collider Cache
+ * ========================================== */
+// Entities don't own a world-space copy of their collision mesh anymore. They point at the shared,
+// local-space RCollisionMesh from the catalogue and only hold a transform. Narrowphase code that
+// really needs world-space vertices (GJK, EPA, debug drawing) asks for them through
+// EEntity::GetCollider(), which materializes them here on demand.
+//
+// Slots stick to an entity while it keeps being used, so the index copy only happens when a slot
+// changes hands or the source mesh changes size, and vertices are only re-transformed when the entity's collider version changes.
+// Slots not touched during the last frame are recycled in EndFrame.
+
+struct RColliderCacheEntry
+{
+	RCollisionMesh Collider;
+	const RCollisionMesh* Source = nullptr;
+	const EEntity* Owner = nullptr;
+	RUUID OwnerID = 0;
+	uint Version = 0;
+	uint64 LastUsedFrame = 0;
+	bool Free = true;
+};
+
+struct RColliderCache
+{
+	static RColliderCache* Get()
+	{
+		static RColliderCache Instance{};
+		return &Instance;
+	}
+
+	RCollisionMesh* GetWorldCollider(EEntity* Entity);
+	void EndFrame();
+	void Clear();
+
+	uint GetUsedSlotCount() const { return UsedSlots; }
+
+private:
+	// deque so pointers handed out stay valid while other entries are added
+	std::deque<RColliderCacheEntry> Entries;
+	vector<uint> FreeSlots;
+	uint64 Frame = 1;
+	uint UsedSlots = 0;
+};
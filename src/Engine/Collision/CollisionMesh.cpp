@@ -24,6 +24,26 @@ RBoundingBox RCollisionMesh::ComputeBoundingBox()
 	return Box;
 }
 
+const RBoundingBox& RCollisionMesh::GetBounds()
+{
+	if (BoundsDirty)
+	{
+		Bounds = ComputeBoundingBox();
+		BoundsDirty = false;
+	}
+	return Bounds;
+}
+
+const vector<RTriangleBlock>& RCollisionMesh::GetTriangleBlocks()
+{
+	if (TriangleBlocksDirty)
+	{
+		CookTriangleBlocks(TriangleBlocks, *this);
+		TriangleBlocksDirty = false;
+	}
+	return TriangleBlocks;
+}
+
 
 // CollisionMesh* cmesh_from_mesh(Mesh* mesh)
 // {
@@ -1,6 +1,8 @@
 #pragma once
 
-struct RBoundingBox;
+#include "TriangleBlock.h"
+#include "primitives/BoundingBox.h"
+
 struct RMesh;
 
 struct RCollisionMesh
@@ -9,7 +11,16 @@ struct RCollisionMesh
 	vector<vec3> Vertices;
 	vector<uint> Indices;
 
+	// Data derived from the geometry, rebuilt lazily. Whoever writes to Vertices or Indices calls MarkDirty.
+	vector<RTriangleBlock> TriangleBlocks;
+	bool TriangleBlocksDirty = true;
+	RBoundingBox Bounds;
+	bool BoundsDirty = true;
+
 	RBoundingBox ComputeBoundingBox();
+	const RBoundingBox& GetBounds();
+	const vector<RTriangleBlock>& GetTriangleBlocks();
+	void MarkDirty() { TriangleBlocksDirty = true; BoundsDirty = true; }
 };
 
 // CollisionMesh* cmesh_from_mesh(Mesh* mesh);
@@ -72,6 +72,33 @@ struct RBoundingBox
 		MaxZ = TransMax.z;
 	}
 
+	/** Box that encloses this box after an affine transform (Arvo's method). Only touches the
+	 *  8 corners implicitly, so it costs the same regardless of how many vertices the mesh has. */
+	RBoundingBox Transform(const mat4& Matrix) const
+	{
+		const vec3 Center = vec3((MinX + MaxX) * 0.5f, (MinY + MaxY) * 0.5f, (MinZ + MaxZ) * 0.5f);
+		const vec3 Extent = vec3((MaxX - MinX) * 0.5f, (MaxY - MinY) * 0.5f, (MaxZ - MinZ) * 0.5f);
+
+		const vec3 NewCenter = vec3(Matrix * vec4(Center, 1.f));
+		vec3 NewExtent;
+		for (int Row = 0; Row < 3; Row++)
+		{
+			NewExtent[Row] =
+				abs(Matrix[0][Row]) * Extent.x +
+				abs(Matrix[1][Row]) * Extent.y +
+				abs(Matrix[2][Row]) * Extent.z;
+		}
+
+		RBoundingBox Result;
+		Result.MinX = NewCenter.x - NewExtent.x;
+		Result.MaxX = NewCenter.x + NewExtent.x;
+		Result.MinY = NewCenter.y - NewExtent.y;
+		Result.MaxY = NewCenter.y + NewExtent.y;
+		Result.MinZ = NewCenter.z - NewExtent.z;
+		Result.MaxZ = NewCenter.z + NewExtent.z;
+		return Result;
+	}
+
 	void Translate(vec3 Offset)
 	{
 		MinX += Offset.x;
@@ -7,6 +7,7 @@
 #include <engine/collision/primitives/ray.h>
 #include <glm/gtx/quaternion.hpp>
 #include <engine/collision/CollisionMesh.h>
+#include <engine/collision/TriangleBlock.h>
 
 #include "Engine/Geometry/Quad.h"
 #include "Engine/IO/Input.h"
@@ -53,9 +54,9 @@ RRaycastTest TestRayAgainstEntity(const RRay& Ray, EEntity* Entity, NRayCastType
 	//      instead of testing the collider
 
 	// first check collision with bounding box
-	if (TestRayAgainstBoundingBox(Ray, Entity->BoundingBox)) {
-		Entity->UpdateCollider();
-		return TestRayAgainstCollider(Ray, &Entity->Collider, TestType);
+	if (TestRayAgainstBoundingBox(Ray, Entity->BoundingBox) && Entity->CollisionMesh) {
+		// shared local space geometry + the entity transform, no world space vertices needed
+		return TestRayAgainstCollider(Ray, Entity->CollisionMesh, Entity->MatModel, TestType);
 	}
 	RRaycastTest Return;
 	Return.Hit = false;
@@ -68,18 +69,48 @@ RRaycastTest TestRayAgainstEntity(const RRay& Ray, EEntity* Entity, NRayCastType
 // This doesn't take a MatModel
 RRaycastTest TestRayAgainstCollider(const RRay& Ray, RCollisionMesh* Collider, NRayCastType TestType)
 {
-	int Triangles = Collider->Indices.size() / 3;
-	float MinDistance = MaxFloat;
+	bool TestBothSides = TestType == RayCast_TestBothSidesOfTriangle;
+	auto BlockHit = TestRayAgainstTriangleBlocks(Ray, Collider->GetTriangleBlocks(), TestBothSides);
+
 	RRaycastTest MinHitTest{};
-	for (int I = 0; I < Triangles; I++)
-	{
-		RTriangle T = GetTriangleForColliderIndexedMesh(Collider, I);
-		bool TestBothSides = TestType == RayCast_TestBothSidesOfTriangle;
-		auto Test = TestRayAgainstTriangle(Ray, T, TestBothSides);
-		if (Test.Hit && Test.Distance < MinDistance) {
-			MinHitTest = Test;
-			MinDistance = Test.Distance;
-		}
+	if (BlockHit.Hit) {
+		MinHitTest.Hit = true;
+		MinHitTest.Distance = BlockHit.Distance;
+		MinHitTest.Triangle = GetTriangleForColliderIndexedMesh(Collider, BlockHit.TriangleIndex);
+		MinHitTest.Ray = Ray;
+	}
+
+	return MinHitTest;
+}
+
+// Triangles are cooked once in model space and the ray is brought into model space instead.
+// The ray parameter is preserved by affine transforms, so the distance is already the world space one.
+// A mirroring transform flips the winding, which we account for by flipping the side we test.
+static RTriangleBlockHit TestRayAgainstModelSpaceBlocks(const RRay& Ray, const vector<RTriangleBlock>& Blocks, const mat4& MatModel, NRayCastType TestType)
+{
+	mat4 InvModel = Inverse(MatModel);
+	RRay ModelRay{vec3(InvModel * vec4(Ray.Origin, 1.f)), vec3(InvModel * vec4(Ray.Direction, 0.f))};
+
+	bool TestBothSides = TestType == RayCast_TestBothSidesOfTriangle;
+	bool Mirrored = glm::determinant(glm::mat3(MatModel)) < 0.f;
+	return TestRayAgainstTriangleBlocks(ModelRay, Blocks, TestBothSides, Mirrored);
+}
+
+// -----------------------------------------
+// > TEST RAY AGAINST COLLIDER (LOCAL SPACE)
+// -----------------------------------------
+// This does take a matModel
+RRaycastTest TestRayAgainstCollider(const RRay& Ray, RCollisionMesh* Collider, const mat4& MatModel, NRayCastType TestType)
+{
+	auto BlockHit = TestRayAgainstModelSpaceBlocks(Ray, Collider->GetTriangleBlocks(), MatModel, TestType);
+
+	RRaycastTest MinHitTest{};
+	if (BlockHit.Hit) {
+		RTriangle T = GetTriangleForColliderIndexedMesh(Collider, BlockHit.TriangleIndex);
+		MinHitTest.Hit = true;
+		MinHitTest.Distance = BlockHit.Distance;
+		MinHitTest.Triangle = RTriangle{MatModel * vec4(T.A, 1.f), MatModel * vec4(T.B, 1.f), MatModel * vec4(T.C, 1.f)};
+		MinHitTest.Ray = Ray;
 	}
 
 	return MinHitTest;
@@ -91,18 +122,14 @@ RRaycastTest TestRayAgainstCollider(const RRay& Ray, RCollisionMesh* Collider, N
 // This does take a matModel
 RRaycastTest TestRayAgainstMesh(const RRay& Ray, RMesh* Mesh, glm::mat4 MatModel, NRayCastType TestType)
 {
-	int Triangles = Mesh->Indices.size() / 3;
-	float MinDistance = MaxFloat;
+	auto BlockHit = TestRayAgainstModelSpaceBlocks(Ray, Mesh->GetTriangleBlocks(), MatModel, TestType);
+
 	RRaycastTest MinHitTest{};
-	for (int i = 0; i < Triangles; i++)
-	{
-		RTriangle T = GetTriangleForIndexedMesh(Mesh, MatModel, i);
-		bool TestBothSides = TestType == RayCast_TestBothSidesOfTriangle;
-		auto Test = TestRayAgainstTriangle(Ray, T, TestBothSides);
-		if (Test.Hit && Test.Distance < MinDistance) {
-			MinHitTest = Test;
-			MinDistance = Test.Distance;
-		}
+	if (BlockHit.Hit) {
+		MinHitTest.Hit = true;
+		MinHitTest.Distance = BlockHit.Distance;
+		MinHitTest.Triangle = GetTriangleForIndexedMesh(Mesh, MatModel, BlockHit.TriangleIndex);
+		MinHitTest.Ray = Ray;
 	}
 
 	return MinHitTest;
@@ -33,4 +33,5 @@ RRaycastTest TestRayAgainstMesh(const RRay& Ray, RMesh* Mesh, mat4 MatModel, NRa
 RRaycastTest TestRayAgainstTriangle(const RRay& Ray, RTriangle Triangle, bool TestBothSides = true);
 RRaycastTest TestRayAgainstQuad(const RRay& Ray, const RQuad& Quad, bool TestBothSides = true);
 RRaycastTest TestRayAgainstCollider(const RRay& Ray, RCollisionMesh* Collider, NRayCastType TestType);
+RRaycastTest TestRayAgainstCollider(const RRay& Ray, RCollisionMesh* Collider, const mat4& MatModel, NRayCastType TestType);
 bool TestRayAgainstBoundingBox(const RRay& Ray, RBoundingBox Box);
@@ -0,0 +1,337 @@
+#include "TriangleBlock.h"
+
+#include "engine/collision/CollisionMesh.h"
+#include "engine/collision/primitives/ray.h"
+#include "engine/geometry/mesh.h"
+
+#include <immintrin.h>
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+// MSVC lets us use any intrinsic in any translation unit. Other compilers need the target
+// spelled out per function, otherwise the AVX2 kernel wouldn't compile without -mavx2 (which
+// would then leak AVX instructions into the whole file and defeat the runtime check).
+#if defined(__GNUC__) || defined(__clang__)
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TARGET_AVX2
+#endif
+
+constexpr float TriangleBlockDetEpsilon = 1e-6f;
+
+// ---------------------------
+// > COOKING
+// ---------------------------
+template<typename TGetPosition>
+static void CookTriangleBlocks(vector<RTriangleBlock>& OutBlocks, const vector<uint>& Indices, TGetPosition GetPosition)
+{
+	const uint TriangleCount = static_cast<uint>(Indices.size() / 3);
+	OutBlocks.assign(GetTriangleBlockCount(TriangleCount), RTriangleBlock{});
+
+	for (uint I = 0; I < TriangleCount; I++)
+	{
+		const vec3 A = GetPosition(Indices[3 * I + 0]);
+		const vec3 B = GetPosition(Indices[3 * I + 1]);
+		const vec3 C = GetPosition(Indices[3 * I + 2]);
+		const vec3 E1 = B - A;
+		const vec3 E2 = C - A;
+		const vec3 N = cross(E1, E2);
+
+		auto& Block = OutBlocks[I / TriangleBlockWidth];
+		const uint Lane = I % TriangleBlockWidth;
+		Block.Ax[Lane] = A.x;   Block.Ay[Lane] = A.y;   Block.Az[Lane] = A.z;
+		Block.E1x[Lane] = E1.x; Block.E1y[Lane] = E1.y; Block.E1z[Lane] = E1.z;
+		Block.E2x[Lane] = E2.x; Block.E2y[Lane] = E2.y; Block.E2z[Lane] = E2.z;
+		Block.Nx[Lane] = N.x;   Block.Ny[Lane] = N.y;   Block.Nz[Lane] = N.z;
+	}
+}
+
+void CookTriangleBlocks(vector<RTriangleBlock>& OutBlocks, const RCollisionMesh& CollisionMesh)
+{
+	CookTriangleBlocks(OutBlocks, CollisionMesh.Indices, [&CollisionMesh](uint Index) { return CollisionMesh.Vertices[Index]; });
+}
+
+void CookTriangleBlocks(vector<RTriangleBlock>& OutBlocks, const RMesh& Mesh)
+{
+	CookTriangleBlocks(OutBlocks, Mesh.Indices, [&Mesh](uint Index) { return Mesh.Vertices[Index].Position; });
+}
+
+// Picks the closest lane out of a hit mask. Hits are rare compared to misses, so this stays scalar.
+static void ResolveLanes(RTriangleBlockHit& Best, uint Mask, const float* Distances, uint FirstTriangle)
+{
+	while (Mask)
+	{
+		uint Lane = 0;
+		while (!(Mask & (1u << Lane))) Lane++;
+		Mask &= ~(1u << Lane);
+
+		if (Distances[Lane] < Best.Distance)
+		{
+			Best.Hit = true;
+			Best.Distance = Distances[Lane];
+			Best.TriangleIndex = FirstTriangle + Lane;
+		}
+	}
+}
+
+// ---------------------------
+// > SCALAR KERNEL
+// ---------------------------
+static RTriangleBlockHit TestRayAgainstTriangleBlocksScalar(const RRay& Ray, const RTriangleBlock* Blocks, uint BlockCount, bool AcceptFront, bool AcceptBack)
+{
+	RTriangleBlockHit Best;
+	const vec3 O = Ray.Origin;
+	const vec3 D = Ray.Direction;
+
+	for (uint B = 0; B < BlockCount; B++)
+	{
+		const auto& Block = Blocks[B];
+		float Distances[TriangleBlockWidth];
+		uint Mask = 0;
+
+		for (uint L = 0; L < TriangleBlockWidth; L++)
+		{
+			const float AOx = O.x - Block.Ax[L], AOy = O.y - Block.Ay[L], AOz = O.z - Block.Az[L];
+			const float DAOx = AOy * D.z - D.y * AOz;
+			const float DAOy = AOz * D.x - D.z * AOx;
+			const float DAOz = AOx * D.y - D.x * AOy;
+
+			const float Det = -(D.x * Block.Nx[L] + D.y * Block.Ny[L] + D.z * Block.Nz[L]);
+			const float InvDet = 1.0f / Det;
+			const float U = (Block.E2x[L] * DAOx + Block.E2y[L] * DAOy + Block.E2z[L] * DAOz) * InvDet;
+			const float V = -(Block.E1x[L] * DAOx + Block.E1y[L] * DAOy + Block.E1z[L] * DAOz) * InvDet;
+			const float T = (AOx * Block.Nx[L] + AOy * Block.Ny[L] + AOz * Block.Nz[L]) * InvDet;
+
+			const bool Facing = (AcceptFront && Det >= TriangleBlockDetEpsilon) || (AcceptBack && Det <= -TriangleBlockDetEpsilon);
+			if (Facing && T >= 0.f && U >= 0.f && V >= 0.f && U + V <= 1.f)
+			{
+				Distances[L] = T;
+				Mask |= 1u << L;
+			}
+		}
+
+		ResolveLanes(Best, Mask, Distances, B * TriangleBlockWidth);
+	}
+
+	return Best;
+}
+
+// ---------------------------
+// > SSE KERNEL
+// ---------------------------
+// SSE2 is baseline on x64, so this one is always available. A block is processed as two halves of 4 lanes.
+static RTriangleBlockHit TestRayAgainstTriangleBlocksSse(const RRay& Ray, const RTriangleBlock* Blocks, uint BlockCount, bool AcceptFront, bool AcceptBack)
+{
+	RTriangleBlockHit Best;
+
+	const __m128 Ox = _mm_set1_ps(Ray.Origin.x), Oy = _mm_set1_ps(Ray.Origin.y), Oz = _mm_set1_ps(Ray.Origin.z);
+	const __m128 Dx = _mm_set1_ps(Ray.Direction.x), Dy = _mm_set1_ps(Ray.Direction.y), Dz = _mm_set1_ps(Ray.Direction.z);
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 One = _mm_set1_ps(1.f);
+	const __m128 Eps = _mm_set1_ps(TriangleBlockDetEpsilon);
+	const __m128 NegEps = _mm_set1_ps(-TriangleBlockDetEpsilon);
+	const __m128 FrontMask = AcceptFront ? _mm_cmpeq_ps(Zero, Zero) : Zero;
+	const __m128 BackMask = AcceptBack ? _mm_cmpeq_ps(Zero, Zero) : Zero;
+
+	for (uint B = 0; B < BlockCount; B++)
+	{
+		const auto& Block = Blocks[B];
+		for (uint Half = 0; Half < TriangleBlockWidth; Half += 4)
+		{
+			const __m128 AOx = _mm_sub_ps(Ox, _mm_loadu_ps(Block.Ax + Half));
+			const __m128 AOy = _mm_sub_ps(Oy, _mm_loadu_ps(Block.Ay + Half));
+			const __m128 AOz = _mm_sub_ps(Oz, _mm_loadu_ps(Block.Az + Half));
+
+			const __m128 DAOx = _mm_sub_ps(_mm_mul_ps(AOy, Dz), _mm_mul_ps(Dy, AOz));
+			const __m128 DAOy = _mm_sub_ps(_mm_mul_ps(AOz, Dx), _mm_mul_ps(Dz, AOx));
+			const __m128 DAOz = _mm_sub_ps(_mm_mul_ps(AOx, Dy), _mm_mul_ps(Dx, AOy));
+
+			const __m128 Nx = _mm_loadu_ps(Block.Nx + Half), Ny = _mm_loadu_ps(Block.Ny + Half), Nz = _mm_loadu_ps(Block.Nz + Half);
+			const __m128 Det = _mm_sub_ps(Zero, _mm_add_ps(_mm_add_ps(_mm_mul_ps(Dx, Nx), _mm_mul_ps(Dy, Ny)), _mm_mul_ps(Dz, Nz)));
+			const __m128 InvDet = _mm_div_ps(One, Det);
+
+			const __m128 U = _mm_mul_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_loadu_ps(Block.E2x + Half), DAOx),
+				_mm_mul_ps(_mm_loadu_ps(Block.E2y + Half), DAOy)),
+				_mm_mul_ps(_mm_loadu_ps(Block.E2z + Half), DAOz)), InvDet);
+			const __m128 V = _mm_sub_ps(Zero, _mm_mul_ps(_mm_add_ps(_mm_add_ps(
+				_mm_mul_ps(_mm_loadu_ps(Block.E1x + Half), DAOx),
+				_mm_mul_ps(_mm_loadu_ps(Block.E1y + Half), DAOy)),
+				_mm_mul_ps(_mm_loadu_ps(Block.E1z + Half), DAOz)), InvDet));
+			const __m128 T = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(AOx, Nx), _mm_mul_ps(AOy, Ny)), _mm_mul_ps(AOz, Nz)), InvDet);
+
+			__m128 Hit = _mm_or_ps(_mm_and_ps(_mm_cmpge_ps(Det, Eps), FrontMask), _mm_and_ps(_mm_cmple_ps(Det, NegEps), BackMask));
+			Hit = _mm_and_ps(Hit, _mm_cmpge_ps(T, Zero));
+			Hit = _mm_and_ps(Hit, _mm_cmpge_ps(U, Zero));
+			Hit = _mm_and_ps(Hit, _mm_cmpge_ps(V, Zero));
+			Hit = _mm_and_ps(Hit, _mm_cmple_ps(_mm_add_ps(U, V), One));
+
+			const uint Mask = static_cast<uint>(_mm_movemask_ps(Hit));
+			if (Mask)
+			{
+				alignas(16) float Distances[4];
+				_mm_store_ps(Distances, T);
+				ResolveLanes(Best, Mask, Distances, B * TriangleBlockWidth + Half);
+			}
+		}
+	}
+
+	return Best;
+}
+
+// ---------------------------
+// > AVX2 KERNEL
+// ---------------------------
+TARGET_AVX2
+static RTriangleBlockHit TestRayAgainstTriangleBlocksAvx2(const RRay& Ray, const RTriangleBlock* Blocks, uint BlockCount, bool AcceptFront, bool AcceptBack)
+{
+	RTriangleBlockHit Best;
+
+	const __m256 Ox = _mm256_set1_ps(Ray.Origin.x), Oy = _mm256_set1_ps(Ray.Origin.y), Oz = _mm256_set1_ps(Ray.Origin.z);
+	const __m256 Dx = _mm256_set1_ps(Ray.Direction.x), Dy = _mm256_set1_ps(Ray.Direction.y), Dz = _mm256_set1_ps(Ray.Direction.z);
+	const __m256 Zero = _mm256_setzero_ps();
+	const __m256 One = _mm256_set1_ps(1.f);
+	const __m256 Eps = _mm256_set1_ps(TriangleBlockDetEpsilon);
+	const __m256 NegEps = _mm256_set1_ps(-TriangleBlockDetEpsilon);
+	const __m256 FrontMask = AcceptFront ? _mm256_cmp_ps(Zero, Zero, _CMP_EQ_OQ) : Zero;
+	const __m256 BackMask = AcceptBack ? _mm256_cmp_ps(Zero, Zero, _CMP_EQ_OQ) : Zero;
+
+	for (uint B = 0; B < BlockCount; B++)
+	{
+		const auto& Block = Blocks[B];
+
+		const __m256 AOx = _mm256_sub_ps(Ox, _mm256_load_ps(Block.Ax));
+		const __m256 AOy = _mm256_sub_ps(Oy, _mm256_load_ps(Block.Ay));
+		const __m256 AOz = _mm256_sub_ps(Oz, _mm256_load_ps(Block.Az));
+
+		const __m256 DAOx = _mm256_sub_ps(_mm256_mul_ps(AOy, Dz), _mm256_mul_ps(Dy, AOz));
+		const __m256 DAOy = _mm256_sub_ps(_mm256_mul_ps(AOz, Dx), _mm256_mul_ps(Dz, AOx));
+		const __m256 DAOz = _mm256_sub_ps(_mm256_mul_ps(AOx, Dy), _mm256_mul_ps(Dx, AOy));
+
+		const __m256 Nx = _mm256_load_ps(Block.Nx), Ny = _mm256_load_ps(Block.Ny), Nz = _mm256_load_ps(Block.Nz);
+		const __m256 Det = _mm256_sub_ps(Zero, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(Dx, Nx), _mm256_mul_ps(Dy, Ny)), _mm256_mul_ps(Dz, Nz)));
+		const __m256 InvDet = _mm256_div_ps(One, Det);
+
+		const __m256 U = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(_mm256_load_ps(Block.E2x), DAOx),
+			_mm256_mul_ps(_mm256_load_ps(Block.E2y), DAOy)),
+			_mm256_mul_ps(_mm256_load_ps(Block.E2z), DAOz)), InvDet);
+		const __m256 V = _mm256_sub_ps(Zero, _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(
+			_mm256_mul_ps(_mm256_load_ps(Block.E1x), DAOx),
+			_mm256_mul_ps(_mm256_load_ps(Block.E1y), DAOy)),
+			_mm256_mul_ps(_mm256_load_ps(Block.E1z), DAOz)), InvDet));
+		const __m256 T = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(AOx, Nx), _mm256_mul_ps(AOy, Ny)), _mm256_mul_ps(AOz, Nz)), InvDet);
+
+		__m256 Hit = _mm256_or_ps(_mm256_and_ps(_mm256_cmp_ps(Det, Eps, _CMP_GE_OQ), FrontMask), _mm256_and_ps(_mm256_cmp_ps(Det, NegEps, _CMP_LE_OQ), BackMask));
+		Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(T, Zero, _CMP_GE_OQ));
+		Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(U, Zero, _CMP_GE_OQ));
+		Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(V, Zero, _CMP_GE_OQ));
+		Hit = _mm256_and_ps(Hit, _mm256_cmp_ps(_mm256_add_ps(U, V), One, _CMP_LE_OQ));
+
+		const uint Mask = static_cast<uint>(_mm256_movemask_ps(Hit));
+		if (Mask)
+		{
+			alignas(32) float Distances[8];
+			_mm256_store_ps(Distances, T);
+			ResolveLanes(Best, Mask, Distances, B * TriangleBlockWidth);
+		}
+	}
+
+	return Best;
+}
+
+// ---------------------------
+// > DISPATCH
+// ---------------------------
+static bool CpuSupportsAvx2()
+{
+#ifdef _MSC_VER
+	int Info[4];
+	__cpuid(Info, 0);
+	if (Info[0] < 7)
+		return false;
+
+	__cpuid(Info, 1);
+	const bool OsSavesYmm = (Info[2] & (1 << 27)) && (Info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+	if (!OsSavesYmm)
+		return false;
+
+	__cpuidex(Info, 7, 0);
+	return (Info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+using RTriangleBlockKernelFn = RTriangleBlockHit(*)(const RRay&, const RTriangleBlock*, uint, bool, bool);
+
+static RTriangleBlockKernelFn GetKernelFunction(NRaycastKernel Kernel)
+{
+	switch (Kernel)
+	{
+		case RaycastKernel_Avx2: return &TestRayAgainstTriangleBlocksAvx2;
+		case RaycastKernel_Sse:  return &TestRayAgainstTriangleBlocksSse;
+		default:                 return &TestRayAgainstTriangleBlocksScalar;
+	}
+}
+
+static NRaycastKernel& ActiveKernel()
+{
+	static NRaycastKernel Kernel = IsRaycastKernelSupported(RaycastKernel_Avx2) ? RaycastKernel_Avx2 : RaycastKernel_Sse;
+	return Kernel;
+}
+
+static RTriangleBlockKernelFn& ActiveKernelFunction()
+{
+	static RTriangleBlockKernelFn Function = GetKernelFunction(ActiveKernel());
+	return Function;
+}
+
+bool IsRaycastKernelSupported(NRaycastKernel Kernel)
+{
+	static const bool Avx2 = CpuSupportsAvx2();
+	switch (Kernel)
+	{
+		case RaycastKernel_Scalar: return true;
+		case RaycastKernel_Sse:    return true;
+		case RaycastKernel_Avx2:   return Avx2;
+		default:                   return false;
+	}
+}
+
+NRaycastKernel GetRaycastKernel()
+{
+	return ActiveKernel();
+}
+
+bool SetRaycastKernel(NRaycastKernel Kernel)
+{
+	if (!IsRaycastKernelSupported(Kernel))
+		return false;
+
+	ActiveKernel() = Kernel;
+	ActiveKernelFunction() = GetKernelFunction(Kernel);
+	return true;
+}
+
+const char* GetRaycastKernelName(NRaycastKernel Kernel)
+{
+	switch (Kernel)
+	{
+		case RaycastKernel_Scalar: return "scalar";
+		case RaycastKernel_Sse:    return "sse";
+		case RaycastKernel_Avx2:   return "avx2";
+		default:                   return "unknown";
+	}
+}
+
+RTriangleBlockHit TestRayAgainstTriangleBlocks(const RRay& Ray, const vector<RTriangleBlock>& Blocks, bool TestBothSides, bool FlipWinding)
+{
+	if (Blocks.empty())
+		return {};
+
+	const bool AcceptFront = TestBothSides || !FlipWinding;
+	const bool AcceptBack = TestBothSides || FlipWinding;
+	return ActiveKernelFunction()(Ray, Blocks.data(), static_cast<uint>(Blocks.size()), AcceptFront, AcceptBack);
+}
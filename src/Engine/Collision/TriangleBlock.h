@@ -0,0 +1,59 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+struct RRay;
+struct RMesh;
+struct RCollisionMesh;
+
+/* ==========================================
+ *	Triangle Blocks
+ * ========================================== */
+// Triangles cooked into SoA blocks of 8 for the ray kernels. Each block stores the first
+// vertex, both edges and the (unnormalized) face normal per lane, so a ray test is only loads
+// and arithmetic: no index chasing and no vertex copies. Unused lanes in the last block are
+// zeroed, which makes their determinant zero and they never report a hit.
+//
+// The math is the same Möller–Trumbore variant used by TestRayAgainstTriangle, except that
+// front and back faces are resolved in a single pass from the sign of the determinant.
+
+constexpr uint TriangleBlockWidth = 8;
+
+struct alignas(32) RTriangleBlock
+{
+	float Ax[TriangleBlockWidth], Ay[TriangleBlockWidth], Az[TriangleBlockWidth];
+	float E1x[TriangleBlockWidth], E1y[TriangleBlockWidth], E1z[TriangleBlockWidth];
+	float E2x[TriangleBlockWidth], E2y[TriangleBlockWidth], E2z[TriangleBlockWidth];
+	float Nx[TriangleBlockWidth], Ny[TriangleBlockWidth], Nz[TriangleBlockWidth];
+};
+
+struct RTriangleBlockHit
+{
+	bool Hit = false;
+	float Distance = MaxFloat;
+	uint TriangleIndex = 0;		// index into the source mesh triangles (Indices / 3)
+};
+
+enum NRaycastKernel
+{
+	RaycastKernel_Scalar = 0,
+	RaycastKernel_Sse    = 1,
+	RaycastKernel_Avx2   = 2,
+	RaycastKernel_Count
+};
+
+inline uint GetTriangleBlockCount(uint TriangleCount) { return (TriangleCount + TriangleBlockWidth - 1) / TriangleBlockWidth; }
+
+void CookTriangleBlocks(vector<RTriangleBlock>& OutBlocks, const RCollisionMesh& CollisionMesh);
+void CookTriangleBlocks(vector<RTriangleBlock>& OutBlocks, const RMesh& Mesh);
+
+// Closest hit among all triangles. Ties resolve to the lowest triangle index, same as looping TestRayAgainstTriangle.
+// FlipWinding swaps which side counts as the front, for blocks cooked in a space that a mirroring transform maps to world.
+RTriangleBlockHit TestRayAgainstTriangleBlocks(const RRay& Ray, const vector<RTriangleBlock>& Blocks, bool TestBothSides, bool FlipWinding = false);
+
+// Kernel is picked on first use from what the CPU supports (AVX2 > SSE > scalar).
+// Setting it is meant for benchmarks and tests; unsupported kernels are ignored.
+NRaycastKernel GetRaycastKernel();
+bool SetRaycastKernel(NRaycastKernel Kernel);
+bool IsRaycastKernelSupported(NRaycastKernel Kernel);
+const char* GetRaycastKernelName(NRaycastKernel Kernel);
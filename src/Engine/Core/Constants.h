@@ -16,5 +16,6 @@ inline constexpr float MinFloat = -FLT_MAX;
 inline constexpr float Epsilon = FLT_EPSILON;        //1.19209290e-7F
 inline constexpr double EpsilonDouble = DBL_EPSILON; //2.2204460492503131e-16
 inline constexpr double MaxDouble = DBL_MAX;
+inline constexpr unsigned int MaxUint = 0xFFFFFFFF;
 // inline constexpr double MinDouble = DBL_MIN; // 2.225073858507201e-308
 inline constexpr double MinDouble = -DBL_MAX;
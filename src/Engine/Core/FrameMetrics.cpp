@@ -0,0 +1,62 @@
+#include "FrameMetrics.h"
+
+#include <cstdio>
+
+void RFrameMetrics::Set(const string& Name, double Value)
+{
+	for (RFrameMetric& Metric : Current)
+	{
+		if (Metric.Name == Name)
+		{
+			Metric.Value = Value;
+			return;
+		}
+	}
+	Current.push_back({Name, Value});
+}
+
+void RFrameMetrics::EndFrame()
+{
+	if (Stream)
+	{
+		fprintf(Stream, "{\"frame\": %llu", static_cast<unsigned long long>(FrameIndex));
+		for (const RFrameMetric& Metric : Current)
+			fprintf(Stream, ", \"%s\": %g", Metric.Name.c_str(), Metric.Value);
+		fprintf(Stream, "}\n");
+	}
+
+	// names only ever get appended and stay in place, so past the first frames nothing allocates
+	const size_t Known = LastFrame.size();
+	LastFrame.resize(Current.size());
+	for (size_t i = 0; i < Current.size(); i++)
+	{
+		if (i >= Known)
+			LastFrame[i].Name = Current[i].Name;
+		LastFrame[i].Value = Current[i].Value;
+		Current[i].Value = 0;
+	}
+	FrameIndex++;
+}
+
+bool RFrameMetrics::OpenStream(const string& Path)
+{
+	CloseStream();
+	Stream = fopen(Path.c_str(), "w");
+	if (!Stream)
+	{
+		Log("Error: Couldn't open '%s' to stream frame metrics to.", Path.c_str())
+		return false;
+	}
+
+	Log("Streaming frame metrics to '%s'.", Path.c_str())
+	return true;
+}
+
+void RFrameMetrics::CloseStream()
+{
+	if (!Stream)
+		return;
+
+	fclose(Stream);
+	Stream = nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+/* ==========================================
+ *	Frame Metrics
+ * ========================================== */
+// One record of named values per frame. Systems Set their numbers while the frame runs (render
+// statistics, pass timings...) and EndFrame keeps the record as the last frame's, then starts the
+// next one with every value back at zero.
+//
+// While a stream is open, every record is also appended to it as one JSON object per line, so a
+// session can be graphed offline. The console's "metrics <file>" and "metrics off" open and close it.
+//
+// Names are looked up linearly, keep them few and set them from the main thread only.
+
+struct RFrameMetric
+{
+	string Name;
+	double Value = 0;
+};
+
+struct RFrameMetrics
+{
+	static RFrameMetrics* Get()
+	{
+		static RFrameMetrics Instance{};
+		return &Instance;
+	}
+
+	~RFrameMetrics() { CloseStream(); }
+
+	void Set(const string& Name, double Value);
+	void EndFrame();
+
+	bool OpenStream(const string& Path);
+	void CloseStream();
+	bool IsStreaming() const { return Stream != nullptr; }
+
+	const vector<RFrameMetric>& GetLastFrame() const { return LastFrame; }
+	uint64 GetFrameIndex() const { return FrameIndex; }
+
+private:
+	vector<RFrameMetric> Current;
+	vector<RFrameMetric> LastFrame;
+	uint64 FrameIndex = 0;
+	FILE* Stream = nullptr;
+};
@@ -42,6 +42,7 @@ struct ESpotLight;
 // T
 struct RTriangle;
 struct RTexture;
+struct RTextureHandle;
 
 // W
 struct RWorld;
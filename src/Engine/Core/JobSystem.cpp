@@ -0,0 +1,136 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <memory>
+
+struct RParallelForContext
+{
+	RJobRangeFunc Job;
+	uint Count = 0;
+	uint BatchSize = 1;
+	uint BatchCount = 0;
+	std::atomic<uint> NextBatch = 0;
+	std::atomic<uint> FinishedBatches = 0;
+};
+
+// Claims batches until there are none left. Returns once this thread can't find more work,
+// which doesn't mean the others finished theirs.
+static void RunBatches(RParallelForContext& Context)
+{
+	while (true)
+	{
+		const uint Batch = Context.NextBatch.fetch_add(1, std::memory_order_relaxed);
+		if (Batch >= Context.BatchCount)
+			return;
+
+		const uint Begin = Batch * Context.BatchSize;
+		const uint End = std::min(Begin + Context.BatchSize, Context.Count);
+		{
+			PROFILE_ZONE("Job");
+			Context.Job(Begin, End);
+		}
+		Context.FinishedBatches.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void RJobSystem::Initialize(uint WorkerCount)
+{
+	if (Initialized)
+		return;
+
+	if (WorkerCount == 0)
+	{
+		const uint HardwareThreads = std::thread::hardware_concurrency();
+		WorkerCount = HardwareThreads > 1 ? HardwareThreads - 1 : 0;
+	}
+
+	Quit = false;
+	Workers.reserve(WorkerCount);
+	for (uint i = 0; i < WorkerCount; i++)
+		Workers.emplace_back([this]() { WorkerLoop(); });
+
+	Initialized = true;
+	Log("Job system started with %u worker threads.", WorkerCount);
+}
+
+void RJobSystem::Shutdown()
+{
+	if (!Initialized)
+		return;
+
+	{
+		std::lock_guard Lock(QueueMutex);
+		Quit = true;
+	}
+	QueueSignal.notify_all();
+
+	for (auto& Worker : Workers)
+		Worker.join();
+
+	Workers.clear();
+	Queue.clear();
+	Initialized = false;
+}
+
+void RJobSystem::WorkerLoop()
+{
+	RProfiler::SetThreadName("Worker");
+
+	while (true)
+	{
+		std::function<void()> Task;
+		{
+			std::unique_lock Lock(QueueMutex);
+			QueueSignal.wait(Lock, [this]() { return Quit || !Queue.empty(); });
+			if (Quit && Queue.empty())
+				return;
+
+			Task = std::move(Queue.front());
+			Queue.pop_front();
+		}
+		Task();
+	}
+}
+
+void RJobSystem::ParallelFor(uint Count, uint BatchSize, const RJobRangeFunc& Job)
+{
+	if (Count == 0)
+		return;
+
+	if (!Initialized)
+		Initialize();
+
+	BatchSize = std::max(BatchSize, 1u);
+	const uint BatchCount = (Count + BatchSize - 1) / BatchSize;
+
+	// Not worth waking anybody up
+	if (BatchCount == 1 || Workers.empty())
+	{
+		Job(0, Count);
+		return;
+	}
+
+	// Shared, so a worker that only gets to its ticket after we returned still has valid memory to look at
+	auto Context = std::make_shared<RParallelForContext>();
+	Context->Job = Job;
+	Context->Count = Count;
+	Context->BatchSize = BatchSize;
+	Context->BatchCount = BatchCount;
+
+	const uint Helpers = std::min(GetWorkerCount(), BatchCount - 1);
+	{
+		std::lock_guard Lock(QueueMutex);
+		for (uint i = 0; i < Helpers; i++)
+			Queue.push_back([Context]() { RunBatches(*Context); });
+	}
+	if (Helpers == 1)
+		QueueSignal.notify_one();
+	else
+		QueueSignal.notify_all();
+
+	RunBatches(*Context);
+
+	while (Context->FinishedBatches.load(std::memory_order_acquire) < BatchCount)
+		std::this_thread::yield();
+}
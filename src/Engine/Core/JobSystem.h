@@ -0,0 +1,51 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/* ==========================================
+ *	Job System
+ * ========================================== */
+// Deliberately small: a fixed pool of worker threads pulling closures off a single queue.
+// ParallelFor cuts a range into batches that workers (and the calling thread) claim through an
+// atomic counter, and only returns once every batch ran. The calling thread always helps, so
+// with zero workers everything simply runs inline.
+//
+// Jobs must not touch GL or anything owned by the main thread without synchronizing themselves.
+
+using RJobRangeFunc = std::function<void(uint Begin, uint End)>;
+
+struct RJobSystem
+{
+	static RJobSystem* Get()
+	{
+		static RJobSystem Instance{};
+		return &Instance;
+	}
+
+	~RJobSystem() { Shutdown(); }
+
+	// WorkerCount = 0 picks hardware threads - 1, leaving the main thread its own core
+	void Initialize(uint WorkerCount = 0);
+	void Shutdown();
+
+	// Calls Job(Begin, End) over [0, Count) in chunks of at most BatchSize. Blocks until done.
+	void ParallelFor(uint Count, uint BatchSize, const RJobRangeFunc& Job);
+
+	uint GetWorkerCount() const { return static_cast<uint>(Workers.size()); }
+
+private:
+	void WorkerLoop();
+
+	vector<std::thread> Workers;
+	std::deque<std::function<void()>> Queue;
+	std::mutex QueueMutex;
+	std::condition_variable QueueSignal;
+	bool Initialized = false;
+	bool Quit = false;
+};
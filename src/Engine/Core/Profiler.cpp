@@ -0,0 +1,292 @@
+#include "Profiler.h"
+#include "glad/glad.h"
+
+#include <cstdio>
+
+static thread_local RProfilerThread* ThisThread = nullptr;
+static thread_local const char* ThisThreadName = nullptr;
+
+void RProfiler::SetThreadName(const char* Name)
+{
+	ThisThreadName = Name;
+	if (ThisThread)
+		ThisThread->Name = Name;
+}
+
+RProfilerThread* RProfiler::GetThread()
+{
+	if (ThisThread)
+		return ThisThread;
+
+	std::lock_guard Lock(ThreadsMutex);
+	auto& Thread = Threads.emplace_back(std::make_unique<RProfilerThread>());
+	Thread->Name = ThisThreadName ? ThisThreadName : "Thread";
+	Thread->Id = static_cast<uint>(Threads.size());
+	Thread->Events = std::make_unique<RProfileEvent[]>(MaxEventsPerThread);
+	ThisThread = Thread.get();
+	return ThisThread;
+}
+
+void RProfiler::Record(const char* Name, uint64 Start, uint64 End)
+{
+	// zones that were already open when the capture started are left out
+	if (!IsCapturing() || Start < GetCaptureStart())
+		return;
+
+	RProfilerThread* Thread = GetThread();
+	const uint Index = Thread->Count.load(std::memory_order_relaxed);
+	if (Index == MaxEventsPerThread)
+	{
+		Thread->Dropped++;
+		return;
+	}
+
+	Thread->Events[Index] = {Name, Start, End};
+	Thread->Count.store(Index + 1, std::memory_order_release);
+}
+
+/* ==========================================
+ *	Capture
+ * ========================================== */
+
+bool RProfiler::Capture(uint Frames, const string& Path)
+{
+	if (IsCapturing() || PendingFrames > 0)
+	{
+		Log("Error: A profiler capture is already running.")
+		return false;
+	}
+	if (Frames == 0)
+		return false;
+
+	PendingFrames = Frames;
+	PendingPath = Path;
+	return true;
+}
+
+void RProfiler::EndFrame()
+{
+	if (IsCapturing())
+	{
+		FrameEnds.push_back(Now());
+
+		// the next frame reuses the queries of GpuFrameLatency frames back, read them first
+		if (HasGpuTimers())
+		{
+			GpuFrame++;
+			ResolveGpuFrame(GpuFrame % GpuFrameLatency);
+		}
+
+		if (--FramesLeft == 0)
+			StopCapture();
+	}
+	else if (PendingFrames > 0)
+	{
+		StartCapture();
+	}
+}
+
+void RProfiler::StartCapture()
+{
+	{
+		std::lock_guard Lock(ThreadsMutex);
+		for (auto& Thread : Threads)
+		{
+			Thread->Count.store(0, std::memory_order_relaxed);
+			Thread->Dropped = 0;
+		}
+	}
+	FrameEnds.clear();
+	GpuEvents.clear();
+	for (uint& Count : GpuZoneCounts)
+		Count = 0;
+
+	if (HasGpuTimers())
+	{
+		GLint64 GpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &GpuNow);
+		GpuClockOffset = static_cast<int64>(Now()) - GpuNow;
+	}
+
+	if (!ThisThreadName)
+		SetThreadName("Main");
+	MainThreadId = GetThread()->Id;
+
+	FramesLeft = PendingFrames;
+	CapturePath = PendingPath;
+	PendingFrames = 0;
+	CaptureStart.store(Now(), std::memory_order_relaxed);
+	Capturing.store(true, std::memory_order_relaxed);
+}
+
+void RProfiler::StopCapture()
+{
+	Capturing.store(false, std::memory_order_relaxed);
+
+	// whatever the GPU still owes us, oldest frame first
+	if (HasGpuTimers())
+	{
+		for (uint Frame = 1; Frame <= GpuFrameLatency; Frame++)
+			ResolveGpuFrame((GpuFrame + Frame) % GpuFrameLatency);
+	}
+
+	if (WriteTrace(CapturePath))
+	{
+		Log("Profiler: %u frames, %u zones, %u GPU zones written to '%s'.", static_cast<uint>(FrameEnds.size()), GetEventCount(),
+			GetGpuEventCount(), CapturePath.c_str())
+	}
+	if (const uint Dropped = GetDroppedCount())
+		Log("Warning: Profiler dropped %u zones, more than %u on a thread.", Dropped, MaxEventsPerThread)
+}
+
+uint RProfiler::GetThreadCount() const
+{
+	std::lock_guard Lock(ThreadsMutex);
+	return static_cast<uint>(Threads.size());
+}
+
+uint RProfiler::GetEventCount() const
+{
+	std::lock_guard Lock(ThreadsMutex);
+	uint Count = 0;
+	for (const auto& Thread : Threads)
+		Count += Thread->Count.load(std::memory_order_acquire);
+	return Count;
+}
+
+uint RProfiler::GetDroppedCount() const
+{
+	std::lock_guard Lock(ThreadsMutex);
+	uint Dropped = 0;
+	for (const auto& Thread : Threads)
+		Dropped += Thread->Dropped;
+	return Dropped;
+}
+
+/* ==========================================
+ *	GPU timers
+ * ========================================== */
+
+void RProfiler::InitGpuTimers()
+{
+	if (HasGpuTimers())
+		return;
+
+	GpuQueries.resize(GpuFrameLatency * MaxGpuZonesPerFrame * 2);
+	glGenQueries(static_cast<GLsizei>(GpuQueries.size()), GpuQueries.data());
+}
+
+void RProfiler::ShutdownGpuTimers()
+{
+	if (!HasGpuTimers())
+		return;
+
+	glDeleteQueries(static_cast<GLsizei>(GpuQueries.size()), GpuQueries.data());
+	GpuQueries.clear();
+}
+
+int RProfiler::BeginGpuZone(const char* Name)
+{
+	if (!IsCapturing() || !HasGpuTimers())
+		return -1;
+
+	const uint Slot = GpuFrame % GpuFrameLatency;
+	const uint Zone = GpuZoneCounts[Slot];
+	if (Zone == MaxGpuZonesPerFrame)
+		return -1;
+
+	glQueryCounter(GpuQueries[(Slot * MaxGpuZonesPerFrame + Zone) * 2], GL_TIMESTAMP);
+	GpuZones[Slot][Zone] = {Name, false};
+	GpuZoneCounts[Slot]++;
+	return static_cast<int>(Zone);
+}
+
+void RProfiler::EndGpuZone(int Zone)
+{
+	if (Zone < 0)
+		return;
+
+	const uint Slot = GpuFrame % GpuFrameLatency;
+	glQueryCounter(GpuQueries[(Slot * MaxGpuZonesPerFrame + Zone) * 2 + 1], GL_TIMESTAMP);
+	GpuZones[Slot][Zone].Ended = true;
+}
+
+void RProfiler::ResolveGpuFrame(uint Slot)
+{
+	for (uint Zone = 0; Zone < GpuZoneCounts[Slot]; Zone++)
+	{
+		if (!GpuZones[Slot][Zone].Ended)
+			continue;
+
+		const uint Query = (Slot * MaxGpuZonesPerFrame + Zone) * 2;
+		GLuint64 Begin = 0;
+		GLuint64 End = 0;
+		glGetQueryObjectui64v(GpuQueries[Query], GL_QUERY_RESULT, &Begin);
+		glGetQueryObjectui64v(GpuQueries[Query + 1], GL_QUERY_RESULT, &End);
+		GpuEvents.push_back({GpuZones[Slot][Zone].Name, Begin + GpuClockOffset, End + GpuClockOffset});
+	}
+	GpuZoneCounts[Slot] = 0;
+}
+
+/* ==========================================
+ *	Chrome trace
+ * ========================================== */
+// {"traceEvents": [...]} with one complete ("X") event per zone, timestamps in microseconds from the
+// start of the capture. The GPU track is tid 0, threads are numbered from 1 in the order they first
+// recorded something.
+
+bool RProfiler::WriteTrace(const string& Path) const
+{
+	FILE* File = fopen(Path.c_str(), "w");
+	if (!File)
+	{
+		Log("Error: Couldn't open '%s' to write the profiler capture to.", Path.c_str())
+		return false;
+	}
+
+	const int64 Origin = static_cast<int64>(GetCaptureStart());
+	auto WriteEvent = [File, Origin](const char* Name, uint Tid, uint64 Start, uint64 End)
+	{
+		fprintf(File, ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}", Name, Tid,
+			(static_cast<int64>(Start) - Origin) / 1000.0, (static_cast<int64>(End) - static_cast<int64>(Start)) / 1000.0);
+	};
+
+	fprintf(File, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+	fprintf(File, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"args\": {\"name\": \"Ravenous\"}}");
+
+	{
+		std::lock_guard Lock(ThreadsMutex);
+		for (const auto& Thread : Threads)
+		{
+			const uint Count = Thread->Count.load(std::memory_order_acquire);
+			if (Count == 0 && Thread->Id != MainThreadId)
+				continue;
+
+			fprintf(File, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s %u\"}}",
+				Thread->Id, Thread->Name, Thread->Id);
+			for (uint Index = 0; Index < Count; Index++)
+			{
+				const RProfileEvent& Event = Thread->Events[Index];
+				WriteEvent(Event.Name, Thread->Id, Event.Start, Event.End);
+			}
+		}
+	}
+
+	uint64 FrameStart = static_cast<uint64>(Origin);
+	for (const uint64 FrameEnd : FrameEnds)
+	{
+		WriteEvent("Frame", MainThreadId, FrameStart, FrameEnd);
+		FrameStart = FrameEnd;
+	}
+
+	if (!GpuEvents.empty())
+	{
+		fprintf(File, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"GPU\"}}");
+		for (const RProfileEvent& Event : GpuEvents)
+			WriteEvent(Event.Name, 0, Event.Start, Event.End);
+	}
+
+	fprintf(File, "\n]}\n");
+	fclose(File);
+	return true;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+/* ==========================================
+ *	Profiler
+ * ========================================== */
+// Scoped zones over the frame, captured for a number of frames and written as a Chrome trace (JSON
+// trace event format), which chrome://tracing and ui.perfetto.dev both open. Put PROFILE_ZONE("Name")
+// at the top of a scope; the name has to be a string literal, only its pointer is kept.
+//
+// Outside of a capture a zone costs a relaxed atomic load. During one, each thread appends finished
+// zones with nanosecond timestamps to a buffer of its own, created the first time the thread records
+// something. Only the owning thread writes to a buffer, so recording takes no lock.
+//
+// Captures start and stop in EndFrame, at the frame boundary. By then every ParallelFor has returned,
+// so no worker writes to its buffer while the main thread reads them. Each captured frame shows up as
+// a "Frame" zone on the main thread.
+//
+// Once InitGpuTimers was called with a GL context current, PROFILE_GPU_ZONE also puts a pair of
+// GL_TIMESTAMP queries around its scope. They're read back GpuFrameLatency frames later, so the
+// pipeline doesn't stall, and land on a "GPU" track shifted onto the CPU clock. Render passes opened
+// with RRenderPassScope get both kinds of zone. GPU zones are main thread only.
+
+#define PROFILE_CONCAT_INNER(A, B) A##B
+#define PROFILE_CONCAT(A, B) PROFILE_CONCAT_INNER(A, B)
+#define PROFILE_ZONE(Name) RProfileZone PROFILE_CONCAT(ProfileZone, __LINE__)(Name)
+#define PROFILE_GPU_ZONE(Name) RGpuProfileZone PROFILE_CONCAT(GpuProfileZone, __LINE__)(Name)
+
+struct RProfileEvent
+{
+	const char* Name = nullptr;
+	uint64 Start = 0;
+	uint64 End = 0;
+};
+
+struct RProfilerThread
+{
+	const char* Name = nullptr;
+	uint Id = 0;
+	std::unique_ptr<RProfileEvent[]> Events;
+	std::atomic<uint> Count = 0;
+	uint Dropped = 0;
+};
+
+struct RProfiler
+{
+	static RProfiler* Get()
+	{
+		static RProfiler Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint MaxEventsPerThread = 1 << 16;
+	static constexpr uint MaxGpuZonesPerFrame = 32;
+	static constexpr uint GpuFrameLatency = 4;
+
+	// steady clock, in nanoseconds
+	static uint64 Now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// Records the next Frames frames and writes them to Path once done. Main thread only.
+	bool Capture(uint Frames, const string& Path);
+	void EndFrame();
+	bool IsCapturing() const { return Capturing.load(std::memory_order_relaxed); }
+
+	// Name for the calling thread in traces, a string literal. Doesn't allocate anything.
+	static void SetThreadName(const char* Name);
+
+	// GL context required, main thread only
+	void InitGpuTimers();
+	void ShutdownGpuTimers();
+	bool HasGpuTimers() const { return !GpuQueries.empty(); }
+
+	// for RProfileZone and RGpuProfileZone
+	void Record(const char* Name, uint64 Start, uint64 End);
+	uint64 GetCaptureStart() const { return CaptureStart.load(std::memory_order_relaxed); }
+	int BeginGpuZone(const char* Name);
+	void EndGpuZone(int Zone);
+
+	// last capture, valid until the next one starts
+	bool WriteTrace(const string& Path) const;
+	uint GetThreadCount() const;
+	uint GetEventCount() const;
+	uint GetDroppedCount() const;
+	uint GetGpuEventCount() const { return static_cast<uint>(GpuEvents.size()); }
+
+private:
+	struct RGpuZone
+	{
+		const char* Name = nullptr;
+		bool Ended = false;
+	};
+
+	RProfilerThread* GetThread();
+	void StartCapture();
+	void StopCapture();
+	// reads back the queries of a frame slot, blocking if they aren't ready yet
+	void ResolveGpuFrame(uint Slot);
+
+	std::atomic<bool> Capturing = false;
+	std::atomic<uint64> CaptureStart = 0;
+	uint PendingFrames = 0;
+	uint FramesLeft = 0;
+	string PendingPath;
+	string CapturePath;
+	vector<uint64> FrameEnds;
+	uint MainThreadId = 0;
+
+	mutable std::mutex ThreadsMutex;
+	vector<std::unique_ptr<RProfilerThread>> Threads;
+
+	// GpuFrameLatency slots of MaxGpuZonesPerFrame zones, two queries each
+	vector<uint> GpuQueries;
+	RGpuZone GpuZones[GpuFrameLatency][MaxGpuZonesPerFrame];
+	uint GpuZoneCounts[GpuFrameLatency]{};
+	uint GpuFrame = 0;
+	int64 GpuClockOffset = 0;
+	vector<RProfileEvent> GpuEvents;
+};
+
+struct RProfileZone
+{
+	explicit RProfileZone(const char* InName)
+	{
+		if (RProfiler::Get()->IsCapturing())
+		{
+			Name = InName;
+			Start = RProfiler::Now();
+		}
+	}
+
+	~RProfileZone()
+	{
+		if (Name)
+			RProfiler::Get()->Record(Name, Start, RProfiler::Now());
+	}
+
+	RProfileZone(const RProfileZone&) = delete;
+	RProfileZone& operator=(const RProfileZone&) = delete;
+
+private:
+	const char* Name = nullptr;
+	uint64 Start = 0;
+};
+
+struct RGpuProfileZone
+{
+	explicit RGpuProfileZone(const char* Name) : Zone(RProfiler::Get()->BeginGpuZone(Name)) { }
+	~RGpuProfileZone() { RProfiler::Get()->EndGpuZone(Zone); }
+
+	RGpuProfileZone(const RGpuProfileZone&) = delete;
+	RGpuProfileZone& operator=(const RGpuProfileZone&) = delete;
+
+private:
+	int Zone;
+};
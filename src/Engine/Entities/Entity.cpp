@@ -1,5 +1,6 @@
 #include "engine/entities/Entity.h"
 #include "engine/geometry/mesh.h"
+#include "engine/collision/ColliderCache.h"
 
 /* ==================================================================
  * Update:
@@ -15,12 +16,13 @@ void EEntity::Update()
 
 void EEntity::UpdateCollider()
 {
-	if (Collider.Vertices.empty()) {
-		Collider = *CollisionMesh;
-	}
-	for (int i = 0; i < CollisionMesh->Vertices.size(); i++) {
-		Collider.Vertices[i] = vec3(MatModel * vec4(CollisionMesh->Vertices[i], 1.0));
-	}
+	// World space vertices are only computed when someone asks for them (see GetCollider)
+	ColliderVersion++;
+}
+
+RCollisionMesh* EEntity::GetCollider()
+{
+	return RColliderCache::Get()->GetWorldCollider(this);
 }
 
 void EEntity::UpdateModelMatrix()
@@ -35,8 +37,10 @@ void EEntity::UpdateModelMatrix()
 
 void EEntity::UpdateBoundingBox()
 {
-	// uses the collider to compute an AABB 
-	BoundingBox = Collider.ComputeBoundingBox();
+	// transforms the local space bounds instead of every collider vertex
+	if (CollisionMesh) {
+		BoundingBox = CollisionMesh->GetBounds().Transform(MatModel);
+	}
 }
 
 void EEntity::UpdateTrigger()
@@ -45,10 +49,10 @@ void EEntity::UpdateTrigger()
 	glm::mat4 Model = translate(Mat4Identity, Centroid);
 
 	// to avoid elipsoids
-	TriggerScale.z = TriggerScale.x;
-	Model = glm::scale(Model, TriggerScale);
+	Cold->TriggerScale.z = Cold->TriggerScale.x;
+	Model = glm::scale(Model, Cold->TriggerScale);
 
-	TriggerMatModel = Model;
+	Cold->TriggerMatModel = Model;
 }
 
 void EEntity::RotateY(float Angle)
@@ -74,8 +78,9 @@ RCollisionMesh EEntity::GetTriggerCollider()
 	RCollisionMesh TriggerCollider;
 
 	// multiplies model matrix to collision mesh
+	const RMesh* Trigger = Cold->Trigger;
 	for (int i = 0; i < Trigger->Vertices.size(); i++)
-		TriggerCollider.Vertices.push_back(vec3(vec4(Trigger->Vertices[i].Position, 1) * TriggerMatModel));
+		TriggerCollider.Vertices.push_back(vec3(vec4(Trigger->Vertices[i].Position, 1) * Cold->TriggerMatModel));
 
 	for (int I = 0; I < Trigger->Indices.size(); I++)
 		TriggerCollider.Indices.push_back(Trigger->Indices[I]);
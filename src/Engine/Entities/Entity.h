@@ -6,6 +6,8 @@
 #include "Engine/Entities/Traits/EntityTraits.h"
 #include "engine/geometry/mesh.h"
 
+#include <memory>
+
 constexpr static uint MaxEntityWorldChunks = 20;
 const static string DefaultEntityShader = "model";
 const static string EntityShaderMarking = "color";
@@ -19,13 +21,21 @@ enum NEntityFlags
 	EntityFlags_RenderWireframe = 1 << 3
 };
 
-struct VisitorState
+// Data only the editor, world partitioning and triggers look at. Lives in its own allocation so
+// walking entities for updates / rendering doesn't pull it through the cache.
+struct REntityColdData
 {
-	bool Visiting = false;
-	vec3 ChunkPosition = vec3(0.f);
-	RWorldChunk* ChunkPtr = nullptr;
+	// World Data
+	// Array<WorldCell*, MaxEntityWorldCells> world_cells{};
+	vector<RWorldChunk*> WorldChunks{};
+	int WorldChunksCount = 0;
 
-	void Reset() { new(this) VisitorState; }
+	// Event Trigger Data
+	// TODO: Will only be necessary on I_Interactable
+	RMesh* Trigger = nullptr;
+	vec3 TriggerScale = vec3(1.5f, 1.f, 0.f);
+	vec3 TriggerPos = vec3(0.0f);
+	mat4 TriggerMatModel{};
 };
 
 /*  =====================================================================
@@ -39,10 +49,13 @@ struct BaseEntityType(EEntity)
 	friend RWorldChunk;
 
 public:
+	// -----------------------------------------------------------------------
+	// Hot data: what transform updates, collision and rendering read every
+	// frame. Keep it compact and up front.
+	// -----------------------------------------------------------------------
 	// Basic data needed for lower level systems to recognize an Entity type.
 	REntityTypeID TypeID = 0;
 	Field(RUUID, ID) = 0;
-	string Name = "NoName";
 
 	//	Entity flags
 	Flags Flags = 0;
@@ -53,39 +66,35 @@ public:
 	Field(vec3, Scale) = vec3(1.0f);
 	vec3 Velocity = vec3(0.0f);
 	//glm::quat quaternion{};
+	mat4 MatModel = Mat4Identity;
+	RBoundingBox BoundingBox{};							// world AABB, from the collision mesh bounds and the model matrix. Used for fast first pass collision tests
 
 	// Render Data
 	Field(RMesh*, Mesh) = nullptr;
 	Field(RShader*, Shader) = nullptr;
-	Field(RTexture, TextureDiffuse){};
-	Field(RTexture, TextureSpecular){};
-	Field(RTexture, TextureNormal){};
-	mat4 MatModel = Mat4Identity;
+	Field(RTextureHandle, TextureDiffuse){};
+	Field(RTextureHandle, TextureSpecular){};
+	Field(RTextureHandle, TextureNormal){};
+	Field(bool, Occluder) = false;						// always considered as an occluder by ROcclusionCulling, whatever its size on screen. Rasterizes the collision mesh, which has to fit inside the render mesh
 	
-	//@TODO: Get rid of collider (and include)
-	Field(RCollisionMesh*, CollisionMesh) = nullptr;	// static collision mesh vertex data
-	RCollisionMesh Collider{};							// dynamic collision mesh, obtained by multiplying static collision mesh with model matrix
-	RBoundingBox BoundingBox{};							// computed using the collider mesh, used for fast first pass collision tests
+	Field(RCollisionMesh*, CollisionMesh) = nullptr;	// shared, local space collision mesh
+	uint ColliderVersion = 1;							// bumped whenever MatModel changes, invalidates the cached world space collider
+	uint ColliderCacheSlot = MaxUint;					// slot in RColliderCache, see GetCollider()
+	uint8 Lod = 0;										// mesh LOD the scene pass drew last, see RLodSelector
 
 	// @TODO temp
 	bool Slidable = false;						// collider settings
 
-	// World Data
-	// Array<WorldCell*, MaxEntityWorldCells> world_cells{};
-	vector<RWorldChunk*> WorldChunks{};
-	int WorldChunksCount = 0;
-	VisitorState VisitorState;
-
-	// Event Trigger Data
-	// TODO: Will only be necessary on I_Interactable
-	RMesh* Trigger = nullptr;
-	vec3 TriggerScale = vec3(1.5f, 1.f, 0.f);
-	vec3 TriggerPos = vec3(0.0f);
-	mat4 TriggerMatModel{};
+	// -----------------------------------------------------------------------
+	// Cold data
+	// -----------------------------------------------------------------------
+	string Name = "NoName";
+	std::unique_ptr<REntityColdData> Cold = std::make_unique<REntityColdData>();
 	
 	// Methods
 	void Update();
 	void UpdateCollider();
+	RCollisionMesh* GetCollider();
 	void UpdateModelMatrix();
 	void UpdateBoundingBox();
 	void UpdateTrigger();
@@ -0,0 +1,223 @@
+#include "TransformBatch.h"
+
+#include <cmath>
+#include <cstddef>
+#include <emmintrin.h>
+
+uint RTransformBatch::Add(vec3 Position, vec3 Rotation, vec3 Scale, const RBoundingBox* LocalBounds)
+{
+	const uint Index = Size();
+
+	PositionX.push_back(Position.x);
+	PositionY.push_back(Position.y);
+	PositionZ.push_back(Position.z);
+	RotationX.push_back(Rotation.x);
+	RotationY.push_back(Rotation.y);
+	RotationZ.push_back(Rotation.z);
+	ScaleX.push_back(Scale.x);
+	ScaleY.push_back(Scale.y);
+	ScaleZ.push_back(Scale.z);
+
+	vec3 Center(0.f), Extent(0.f);
+	if (LocalBounds)
+	{
+		Center = vec3((LocalBounds->MinX + LocalBounds->MaxX) * 0.5f, (LocalBounds->MinY + LocalBounds->MaxY) * 0.5f, (LocalBounds->MinZ + LocalBounds->MaxZ) * 0.5f);
+		Extent = vec3((LocalBounds->MaxX - LocalBounds->MinX) * 0.5f, (LocalBounds->MaxY - LocalBounds->MinY) * 0.5f, (LocalBounds->MaxZ - LocalBounds->MinZ) * 0.5f);
+	}
+	CenterX.push_back(Center.x);
+	CenterY.push_back(Center.y);
+	CenterZ.push_back(Center.z);
+	ExtentX.push_back(Extent.x);
+	ExtentY.push_back(Extent.y);
+	ExtentZ.push_back(Extent.z);
+
+	return Index;
+}
+
+void RTransformBatch::Reserve(uint Count)
+{
+	for (auto* Array : {&PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &ScaleX, &ScaleY, &ScaleZ,
+		&CenterX, &CenterY, &CenterZ, &ExtentX, &ExtentY, &ExtentZ})
+	{
+		Array->reserve(Count);
+	}
+}
+
+void RTransformBatch::Clear()
+{
+	for (auto* Array : {&PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &ScaleX, &ScaleY, &ScaleZ,
+		&CenterX, &CenterY, &CenterZ, &ExtentX, &ExtentY, &ExtentZ})
+	{
+		Array->clear();
+	}
+}
+
+constexpr float DegreesToRadians = PI / 180.f;
+
+static_assert(sizeof(RBoundingBox) == 6 * sizeof(float) && offsetof(RBoundingBox, MaxZ) == 3 * sizeof(float) && offsetof(RBoundingBox, MinY) == 4 * sizeof(float),
+	"The SSE path stores RBoundingBox as MinX, MaxX, MinZ, MaxZ | MinY, MaxY");
+
+// ---------------------------
+// > SCALAR
+// ---------------------------
+// Used for the tail that doesn't fill a whole register. Same math as the SSE path, lane by lane.
+static void ComputeTransformScalar(const RTransformBatch& Batch, uint I, mat4* OutMatrix, RBoundingBox* OutBox)
+{
+	const float Sa = std::sin(Batch.RotationX[I] * DegreesToRadians), Ca = std::cos(Batch.RotationX[I] * DegreesToRadians);
+	const float Sb = std::sin(Batch.RotationY[I] * DegreesToRadians), Cb = std::cos(Batch.RotationY[I] * DegreesToRadians);
+	const float Sc = std::sin(Batch.RotationZ[I] * DegreesToRadians), Cc = std::cos(Batch.RotationZ[I] * DegreesToRadians);
+
+	// Rx * Ry * Rz, columns scaled
+	const float Sx = Batch.ScaleX[I], Sy = Batch.ScaleY[I], Sz = Batch.ScaleZ[I];
+	mat4& M = *OutMatrix;
+	M[0] = vec4(Cb * Cc, Sa * Sb * Cc + Ca * Sc, -Ca * Sb * Cc + Sa * Sc, 0.f) * Sx;
+	M[1] = vec4(-Cb * Sc, -Sa * Sb * Sc + Ca * Cc, Ca * Sb * Sc + Sa * Cc, 0.f) * Sy;
+	M[2] = vec4(Sb, -Sa * Cb, Ca * Cb, 0.f) * Sz;
+	M[3] = vec4(Batch.PositionX[I], Batch.PositionY[I], Batch.PositionZ[I], 1.f);
+
+	const vec3 Center = vec3(M * vec4(Batch.CenterX[I], Batch.CenterY[I], Batch.CenterZ[I], 1.f));
+	vec3 Extent;
+	for (int Row = 0; Row < 3; Row++)
+		Extent[Row] = abs(M[0][Row]) * Batch.ExtentX[I] + abs(M[1][Row]) * Batch.ExtentY[I] + abs(M[2][Row]) * Batch.ExtentZ[I];
+
+	OutBox->MinX = Center.x - Extent.x;
+	OutBox->MaxX = Center.x + Extent.x;
+	OutBox->MinY = Center.y - Extent.y;
+	OutBox->MaxY = Center.y + Extent.y;
+	OutBox->MinZ = Center.z - Extent.z;
+	OutBox->MaxZ = Center.z + Extent.z;
+}
+
+// ---------------------------
+// > SSE
+// ---------------------------
+// Cephes style sin/cos: reduce by multiples of Pi/2 (in three parts so we don't lose precision),
+// evaluate both minimax polynomials on [-Pi/4, Pi/4] and pick / negate by quadrant. ~1 ulp on
+// the angles entities actually use, and no branches.
+static inline void SinCos4(__m128 X, __m128& OutSin, __m128& OutCos)
+{
+	const __m128i Quadrant = _mm_cvtps_epi32(_mm_mul_ps(X, _mm_set1_ps(2.f / PI)));
+	const __m128 Q = _mm_cvtepi32_ps(Quadrant);
+
+	__m128 R = _mm_sub_ps(X, _mm_mul_ps(Q, _mm_set1_ps(1.5703125f)));
+	R = _mm_sub_ps(R, _mm_mul_ps(Q, _mm_set1_ps(4.837512969970703125e-4f)));
+	R = _mm_sub_ps(R, _mm_mul_ps(Q, _mm_set1_ps(7.54978995489188216e-8f)));
+	const __m128 R2 = _mm_mul_ps(R, R);
+
+	__m128 S = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), R2), _mm_set1_ps(8.3321608736e-3f));
+	S = _mm_add_ps(_mm_mul_ps(S, R2), _mm_set1_ps(-1.6666654611e-1f));
+	S = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(S, R2), R), R);
+
+	__m128 C = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), R2), _mm_set1_ps(-1.388731625493765e-3f));
+	C = _mm_add_ps(_mm_mul_ps(C, R2), _mm_set1_ps(4.166664568298827e-2f));
+	C = _mm_mul_ps(_mm_mul_ps(C, R2), R2);
+	C = _mm_add_ps(_mm_sub_ps(C, _mm_mul_ps(R2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.f));
+
+	// odd quadrants swap sin and cos, sin is negated in quadrants 2 and 3, cos in 1 and 2
+	const __m128 Swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(Quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+	const __m128 SinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(Quadrant, _mm_set1_epi32(2)), 30));
+	const __m128 CosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(Quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+	OutSin = _mm_xor_ps(_mm_or_ps(_mm_and_ps(Swap, C), _mm_andnot_ps(Swap, S)), SinSign);
+	OutCos = _mm_xor_ps(_mm_or_ps(_mm_and_ps(Swap, S), _mm_andnot_ps(Swap, C)), CosSign);
+}
+
+static inline __m128 Abs4(__m128 X)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.f), X);
+}
+
+static void ComputeTransform4(const RTransformBatch& Batch, uint I, mat4* OutMatrices, RBoundingBox* OutBoxes)
+{
+	const __m128 ToRadians = _mm_set1_ps(DegreesToRadians);
+	__m128 Sa, Ca, Sb, Cb, Sc, Cc;
+	SinCos4(_mm_mul_ps(_mm_loadu_ps(&Batch.RotationX[I]), ToRadians), Sa, Ca);
+	SinCos4(_mm_mul_ps(_mm_loadu_ps(&Batch.RotationY[I]), ToRadians), Sb, Cb);
+	SinCos4(_mm_mul_ps(_mm_loadu_ps(&Batch.RotationZ[I]), ToRadians), Sc, Cc);
+
+	const __m128 Sx = _mm_loadu_ps(&Batch.ScaleX[I]);
+	const __m128 Sy = _mm_loadu_ps(&Batch.ScaleY[I]);
+	const __m128 Sz = _mm_loadu_ps(&Batch.ScaleZ[I]);
+
+	// M<Row><Col> of Rx * Ry * Rz * S, one entity per lane
+	const __m128 SaSb = _mm_mul_ps(Sa, Sb);
+	const __m128 CaSb = _mm_mul_ps(Ca, Sb);
+
+	const __m128 M00 = _mm_mul_ps(_mm_mul_ps(Cb, Cc), Sx);
+	const __m128 M10 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(SaSb, Cc), _mm_mul_ps(Ca, Sc)), Sx);
+	const __m128 M20 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(Sa, Sc), _mm_mul_ps(CaSb, Cc)), Sx);
+
+	const __m128 M01 = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(Cb, Sc)), Sy);
+	const __m128 M11 = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(Ca, Cc), _mm_mul_ps(SaSb, Sc)), Sy);
+	const __m128 M21 = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(CaSb, Sc), _mm_mul_ps(Sa, Cc)), Sy);
+
+	const __m128 M02 = _mm_mul_ps(Sb, Sz);
+	const __m128 M12 = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(Sa, Cb)), Sz);
+	const __m128 M22 = _mm_mul_ps(_mm_mul_ps(Ca, Cb), Sz);
+
+	const __m128 Px = _mm_loadu_ps(&Batch.PositionX[I]);
+	const __m128 Py = _mm_loadu_ps(&Batch.PositionY[I]);
+	const __m128 Pz = _mm_loadu_ps(&Batch.PositionZ[I]);
+
+	// SoA -> one column per entity
+	__m128 Col0[4] = {M00, M10, M20, _mm_setzero_ps()};
+	__m128 Col1[4] = {M01, M11, M21, _mm_setzero_ps()};
+	__m128 Col2[4] = {M02, M12, M22, _mm_setzero_ps()};
+	__m128 Col3[4] = {Px, Py, Pz, _mm_set1_ps(1.f)};
+	_MM_TRANSPOSE4_PS(Col0[0], Col0[1], Col0[2], Col0[3]);
+	_MM_TRANSPOSE4_PS(Col1[0], Col1[1], Col1[2], Col1[3]);
+	_MM_TRANSPOSE4_PS(Col2[0], Col2[1], Col2[2], Col2[3]);
+	_MM_TRANSPOSE4_PS(Col3[0], Col3[1], Col3[2], Col3[3]);
+
+	for (int Lane = 0; Lane < 4; Lane++)
+	{
+		float* Out = glm::value_ptr(OutMatrices[I + Lane]);
+		_mm_storeu_ps(Out + 0, Col0[Lane]);
+		_mm_storeu_ps(Out + 4, Col1[Lane]);
+		_mm_storeu_ps(Out + 8, Col2[Lane]);
+		_mm_storeu_ps(Out + 12, Col3[Lane]);
+	}
+
+	// Arvo: transformed center, extent through |M|
+	const __m128 Cx = _mm_loadu_ps(&Batch.CenterX[I]);
+	const __m128 Cy = _mm_loadu_ps(&Batch.CenterY[I]);
+	const __m128 Cz = _mm_loadu_ps(&Batch.CenterZ[I]);
+	const __m128 Ex = _mm_loadu_ps(&Batch.ExtentX[I]);
+	const __m128 Ey = _mm_loadu_ps(&Batch.ExtentY[I]);
+	const __m128 Ez = _mm_loadu_ps(&Batch.ExtentZ[I]);
+
+	auto Dot3 = [](__m128 A0, __m128 A1, __m128 A2, __m128 B0, __m128 B1, __m128 B2)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(A0, B0), _mm_mul_ps(A1, B1)), _mm_mul_ps(A2, B2));
+	};
+
+	const __m128 WorldCx = _mm_add_ps(Dot3(M00, M01, M02, Cx, Cy, Cz), Px);
+	const __m128 WorldCy = _mm_add_ps(Dot3(M10, M11, M12, Cx, Cy, Cz), Py);
+	const __m128 WorldCz = _mm_add_ps(Dot3(M20, M21, M22, Cx, Cy, Cz), Pz);
+	const __m128 WorldEx = Dot3(Abs4(M00), Abs4(M01), Abs4(M02), Ex, Ey, Ez);
+	const __m128 WorldEy = Dot3(Abs4(M10), Abs4(M11), Abs4(M12), Ex, Ey, Ez);
+	const __m128 WorldEz = Dot3(Abs4(M20), Abs4(M21), Abs4(M22), Ex, Ey, Ez);
+
+	// RBoundingBox is MinX, MaxX, MinZ, MaxZ, MinY, MaxY, so each box is one 4 wide store + one 2 wide store
+	__m128 XZ[4] = {_mm_sub_ps(WorldCx, WorldEx), _mm_add_ps(WorldCx, WorldEx), _mm_sub_ps(WorldCz, WorldEz), _mm_add_ps(WorldCz, WorldEz)};
+	__m128 Y[4] = {_mm_sub_ps(WorldCy, WorldEy), _mm_add_ps(WorldCy, WorldEy), _mm_setzero_ps(), _mm_setzero_ps()};
+	_MM_TRANSPOSE4_PS(XZ[0], XZ[1], XZ[2], XZ[3]);
+	_MM_TRANSPOSE4_PS(Y[0], Y[1], Y[2], Y[3]);
+
+	for (int Lane = 0; Lane < 4; Lane++)
+	{
+		RBoundingBox& Box = OutBoxes[I + Lane];
+		_mm_storeu_ps(&Box.MinX, XZ[Lane]);
+		_mm_storel_pi(reinterpret_cast<__m64*>(&Box.MinY), Y[Lane]);
+	}
+}
+
+void ComputeTransformBatch(const RTransformBatch& Batch, uint Begin, uint End, mat4* OutMatrices, RBoundingBox* OutBoxes)
+{
+	uint I = Begin;
+	for (; I + 4 <= End; I += 4)
+		ComputeTransform4(Batch, I, OutMatrices, OutBoxes);
+
+	for (; I < End; I++)
+		ComputeTransformScalar(Batch, I, &OutMatrices[I], &OutBoxes[I]);
+}
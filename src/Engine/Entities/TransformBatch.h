@@ -0,0 +1,33 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/collision/primitives/BoundingBox.h"
+
+/* ==========================================
+ *	Transform Batch
+ * ========================================== */
+// SoA input for computing many model matrices + world AABBs at once. Produces the same matrix as
+// EEntity::UpdateModelMatrix (translate * rotX * rotY * rotZ * scale, Euler angles in degrees), but
+// with the rotation product written out by hand and 4 entities per SSE register, sin/cos included.
+// The world AABB is the local bounds transformed with Arvo's method, like RBoundingBox::Transform.
+//
+// ComputeTransformBatch only reads the batch and writes to disjoint output ranges, so ranges of the
+// same batch can be handed to different jobs (see RJobSystem::ParallelFor).
+
+struct RTransformBatch
+{
+	vector<float> PositionX, PositionY, PositionZ;
+	vector<float> RotationX, RotationY, RotationZ;
+	vector<float> ScaleX, ScaleY, ScaleZ;
+
+	// local space bounds as center + half extent, zero for things without a collision mesh
+	vector<float> CenterX, CenterY, CenterZ;
+	vector<float> ExtentX, ExtentY, ExtentZ;
+
+	uint Add(vec3 Position, vec3 Rotation, vec3 Scale, const RBoundingBox* LocalBounds);
+	void Reserve(uint Count);
+	void Clear();
+	uint Size() const { return static_cast<uint>(PositionX.size()); }
+};
+
+void ComputeTransformBatch(const RTransformBatch& Batch, uint Begin, uint End, mat4* OutMatrices, RBoundingBox* OutBoxes);
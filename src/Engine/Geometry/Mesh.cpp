@@ -7,8 +7,11 @@
 #include <glm/gtx/normal.hpp>
 #include "engine/geometry/triangle.h"
 #include "engine/geometry/vertex.h"
+#include <algorithm>
 #include <iostream>
 #include "engine/geometry/mesh.h"
+#include "engine/render/RenderStats.h"
+#include "engine/geometry/MeshCooker.h"
 #include <engine/collision/CollisionMesh.h>
 
 /*
@@ -20,7 +23,14 @@
 
 map<std::string, RMesh*> GeometryCatalogue;
 map<std::string, RCollisionMesh*> CollisionGeometryCatalogue;
-map<std::string, RTexture> TextureCatalogue;
+map<std::string, RTextureHandle> TextureCatalogue;
+vector<RTexture> TextureRegistry{RTexture{}};
+
+RTextureHandle RegisterTexture(const RTexture& Texture)
+{
+	TextureRegistry.push_back(Texture);
+	return RTextureHandle{static_cast<uint>(TextureRegistry.size() - 1)};
+}
 
 void RMesh::SetupGLData()
 {
@@ -43,32 +53,104 @@ void RMesh::SetupGLData()
 	// load data into vertex buffers
 	glBindVertexArray(NewGlData.VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, NewGlData.VBO);
-	glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(RVertex), &(Vertices[0]), GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, NewGlData.EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, Indices.size() * sizeof(uint), &(Indices[0]), GL_STATIC_DRAW);
 
-	// set the vertex attribute pointers
-	// vertex positions
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), static_cast<void*>(nullptr));
-	// vertex normals
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Normal));
-	// vertex texture coords
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, TexCoords));
-	// vertex tangent
-	glEnableVertexAttribArray(3);
-	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Tangent));
-	// vertex bitangent
-	glEnableVertexAttribArray(4);
-	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Bitangent));
+	// LODs go in the same index buffer, after the full mesh
+	vector<uint> IndicesWithLods;
+	const vector<uint>* IndexData = &Indices;
+	if (!Lods.Indices.empty())
+	{
+		IndicesWithLods.reserve(Indices.size() + Lods.Indices.size());
+		IndicesWithLods.insert(IndicesWithLods.end(), Indices.begin(), Indices.end());
+		IndicesWithLods.insert(IndicesWithLods.end(), Lods.Indices.begin(), Lods.Indices.end());
+		IndexData = &IndicesWithLods;
+	}
+
+	if (ShortIndices)
+	{
+		const vector<uint16> ShortIndexData(IndexData->begin(), IndexData->end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, ShortIndexData.size() * sizeof(uint16), ShortIndexData.data(), GL_STATIC_DRAW);
+		RRenderStats::Get()->CountUpload(ShortIndexData.size() * sizeof(uint16));
+	}
+	else
+	{
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, IndexData->size() * sizeof(uint), IndexData->data(), GL_STATIC_DRAW);
+		RRenderStats::Get()->CountUpload(IndexData->size() * sizeof(uint));
+	}
+
+	if (VertexFormat == NVertexFormat::Packed)
+	{
+		vector<RPackedVertex> PackedVertices;
+		PackedVertices.reserve(Vertices.size());
+		for (const RVertex& Vertex : Vertices)
+			PackedVertices.push_back(PackVertex(Vertex));
+		glBufferData(GL_ARRAY_BUFFER, PackedVertices.size() * sizeof(RPackedVertex), PackedVertices.data(), GL_STATIC_DRAW);
+		RRenderStats::Get()->CountUpload(PackedVertices.size() * sizeof(RPackedVertex));
+
+		// same attribute locations as the float layout, GL expands them back to vec3/vec2
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RPackedVertex), static_cast<void*>(nullptr));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(RPackedVertex), (void*)offsetof(RPackedVertex, Normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(RPackedVertex), (void*)offsetof(RPackedVertex, TexCoords));
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(RPackedVertex), (void*)offsetof(RPackedVertex, Tangent));
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(RPackedVertex), (void*)offsetof(RPackedVertex, Bitangent));
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, Vertices.size() * sizeof(RVertex), &(Vertices[0]), GL_STATIC_DRAW);
+		RRenderStats::Get()->CountUpload(Vertices.size() * sizeof(RVertex));
+
+		// set the vertex attribute pointers
+		// vertex positions
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), static_cast<void*>(nullptr));
+		// vertex normals
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Normal));
+		// vertex texture coords
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, TexCoords));
+		// vertex tangent
+		glEnableVertexAttribArray(3);
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Tangent));
+		// vertex bitangent
+		glEnableVertexAttribArray(4);
+		glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), (void*)offsetof(RVertex, Bitangent));
+	}
 
 	glBindVertexArray(0);
 
 	GLData = NewGlData;
 }
 
+void RMesh::ReleaseGLData()
+{
+	if (GLData.VAO == 0)
+		return;
+
+	glDeleteVertexArrays(1, &GLData.VAO);
+	glDeleteBuffers(1, &GLData.VBO);
+	glDeleteBuffers(1, &GLData.EBO);
+	GLData = {};
+}
+
+uint RMesh::GetGLIndexType() const
+{
+	return ShortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+RMeshLod RMesh::GetLod(uint Lod) const
+{
+	if (Lod == 0 || Lods.Levels.empty())
+		return RMeshLod{0, static_cast<uint>(Indices.size()), 0.f};
+
+	return Lods.Levels[std::min<uint>(Lod, Lods.Levels.size()) - 1];
+}
+
 // This will only create the buffer and set the attribute pointers
 void RMesh::SetupGLBuffers()
 {
@@ -84,10 +166,12 @@ void RMesh::SendDataToGLBuffer()
 	glBindBuffer(GL_ARRAY_BUFFER, this->GLData.VBO);
 	glBufferData(GL_ARRAY_BUFFER, this->Vertices.size() * sizeof(RVertex), &(this->Vertices[0]), GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->GLData.EBO);
+	RRenderStats::Get()->CountUpload(this->Vertices.size() * sizeof(RVertex));
 
 	if (this->Indices.size() > 0)
 	{
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->Indices.size() * sizeof(unsigned int), &(this->Indices[0]), GL_STATIC_DRAW);
+		RRenderStats::Get()->CountUpload(this->Indices.size() * sizeof(unsigned int));
 	}
 	// @TODO: Do we need to do this every time?
 	// set the vertex attribute pointers
@@ -133,6 +217,16 @@ RBoundingBox RMesh::ComputeBoundingBox()
 	return Box;
 }
 
+const vector<RTriangleBlock>& RMesh::GetTriangleBlocks()
+{
+	if (TriangleBlocksDirty)
+	{
+		CookTriangleBlocks(TriangleBlocks, *this);
+		TriangleBlocksDirty = false;
+	}
+	return TriangleBlocks;
+}
+
 void RMesh::ComputeTangentsAndBitangents()
 {
 	// @TODO: This may lead to bugs, we currentyl assume here that faces = 2 triangles each, and while that may hold true with the current loader, that may not remain the case forever.
@@ -181,6 +275,7 @@ RGLData SetupGlDataForLines(const RVertex* Vertices, uint Size)
 	glBindVertexArray(GlData.VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, GlData.VBO);
 	glBufferData(GL_ARRAY_BUFFER, Size * sizeof(RVertex), Vertices, GL_STATIC_DRAW);
+	RRenderStats::Get()->CountUpload(Size * sizeof(RVertex));
 
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RVertex), static_cast<void*>(nullptr));
@@ -2,6 +2,7 @@
 
 #include "engine/core/core.h"
 #include "vertex.h"
+#include "engine/collision/TriangleBlock.h"
 
 struct RGLData
 {
@@ -10,6 +11,23 @@ struct RGLData
 	uint EBO = 0;
 };
 
+// A range of the mesh's index buffer. LOD 0 is RMesh::Indices, coarser ones come after it.
+struct RMeshLod
+{
+	uint IndexOffset = 0;
+	uint IndexCount = 0;
+	float Error = 0;					// model units the LOD strays from the full mesh
+};
+
+// Simplified index buffers over the mesh's own vertices, generated when the mesh is cooked (see MeshCooker.h)
+struct RMeshLods
+{
+	vector<RMeshLod> Levels;			// LOD 1 on
+	vector<uint> Indices;				// LOD 1 on, concatenated, right after RMesh::Indices in the index buffer
+	vec3 Center = vec3(0.f);			// model space bounding sphere, LOD selection measures distance from it
+	float Radius = 0;
+};
+
 // Note: There's an @optimization opportunity by using glDrawElements instead of glDrawArray but that would require restructuring the RMesh data structure, most likely.
 
 struct RMesh
@@ -20,28 +38,65 @@ struct RMesh
 	uint RenderMethod = 0x0004;
 	RGLData GLData;
 	string Name;
+	// GPU side only, Vertices and Indices stay full precision. Cooked meshes pack both (see MeshCooker.h).
+	NVertexFormat VertexFormat = NVertexFormat::Float;
+	bool ShortIndices = false;
+	RMeshLods Lods;
 	// FILETIME last_written;
 
+	// Model space SoA triangles for raycasts, rebuilt lazily. Whoever edits Vertices or Indices in place calls MarkDirty.
+	vector<RTriangleBlock> TriangleBlocks;
+	bool TriangleBlocksDirty = true;
+
 	void SetupGLData();
+	void ReleaseGLData();
+	// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT, what glDrawElements needs for this mesh's index buffer
+	uint GetGLIndexType() const;
+	uint GetIndexSize() const { return ShortIndices ? sizeof(uint16) : sizeof(uint); }
+	uint GetLodCount() const { return 1 + Lods.Levels.size(); }
+	// clamped to the coarsest LOD
+	RMeshLod GetLod(uint Lod) const;
 	void SetupGLBuffers();
 	void SendDataToGLBuffer();
 	void ComputeTangentsAndBitangents();
 	RBoundingBox ComputeBoundingBox();
+	const vector<RTriangleBlock>& GetTriangleBlocks();
+	void MarkDirty() { TriangleBlocksDirty = true; }
 };
 
 struct RTexture
 {
-	unsigned int ID;
+	unsigned int ID = 0;
 	string Type;
 	string Path;
 	string Name;
 };
 
-extern map<string, RTexture> TextureCatalogue;
+// Index into TextureRegistry. Entities keep these instead of RTexture copies (three strings each),
+// index 0 is the null texture.
+struct RTextureHandle
+{
+	uint Index = 0;
+
+	const RTexture& Get() const;
+	uint GetGLID() const { return Get().ID; }
+	bool IsNull() const { return Index == 0; }
+	bool operator==(const RTextureHandle& Other) const { return Index == Other.Index; }
+};
+
+extern vector<RTexture> TextureRegistry;
+
+inline const RTexture& RTextureHandle::Get() const
+{
+	return TextureRegistry[Index];
+}
+
+extern map<string, RTextureHandle> TextureCatalogue;
 extern map<string, RMesh*> GeometryCatalogue;
 extern map<string, RCollisionMesh*> CollisionGeometryCatalogue;
 
 
+RTextureHandle RegisterTexture(const RTexture& Texture);
 RGLData SetupGlDataForLines(const RVertex* Vertices, uint Size);
 vector<RVertex> ConstructCylinder(float Radius, float HalfLenght, int Slices);
 RTriangle GetTriangleForColliderIndexedMesh(const RMesh* Mesh, int TriangleIndex);
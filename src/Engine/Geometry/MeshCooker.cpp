@@ -0,0 +1,498 @@
+#include "MeshCooker.h"
+#include "MeshSimplifier.h"
+#include "engine/geometry/mesh.h"
+#include "engine/io/loaders.h"
+#include "engine/utils/utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <glm/gtc/packing.hpp>
+
+namespace
+{
+	// Forsyth's tuning, the cache here only drives the scores and is bigger than the one ACMR is measured with
+	constexpr uint ScoringCacheSize = 32;
+	constexpr float CacheDecayPower = 1.5f;
+	constexpr float LastTriangleScore = 0.75f;
+	constexpr float ValenceBoostScale = 2.f;
+	constexpr float ValenceBoostPower = 0.5f;
+
+	float GetVertexScore(int CachePosition, uint RemainingTriangles)
+	{
+		if (RemainingTriangles == 0)
+			return -1.f;
+
+		float Score = 0;
+		if (CachePosition >= 0)
+		{
+			// the last triangle's vertices get a fixed score so the next triangle doesn't just pick one of them
+			if (CachePosition < 3)
+				Score = LastTriangleScore;
+			else
+				Score = std::pow(1.f - (CachePosition - 3) / static_cast<float>(ScoringCacheSize - 3), CacheDecayPower);
+		}
+
+		// vertices with few triangles left get a boost, finishing them off frees them from the cache
+		return Score + ValenceBoostScale * std::pow(static_cast<float>(RemainingTriangles), -ValenceBoostPower);
+	}
+
+	uint PackDirection(vec3 Direction)
+	{
+		const float Length = glm::length(Direction);
+		const vec3 Unit = Length > 0.f ? Direction / Length : vec3(0.f);
+		return glm::packSnorm3x10_1x2(vec4(Unit, 0.f));
+	}
+
+	vec3 UnpackDirection(uint Packed)
+	{
+		return vec3(glm::unpackSnorm3x10_1x2(Packed));
+	}
+
+	bool CanPackTexCoords(const vector<RVertex>& Vertices)
+	{
+		for (const RVertex& Vertex : Vertices)
+		{
+			if (glm::abs(Vertex.TexCoords.x) > MaxPackedTexCoord || glm::abs(Vertex.TexCoords.y) > MaxPackedTexCoord)
+				return false;
+		}
+		return true;
+	}
+}
+
+RMeshCookStats CookMesh(RMesh& Mesh)
+{
+	RMeshCookStats Stats;
+	Stats.SourceVertices = Mesh.Vertices.size();
+
+	if (Mesh.RenderMethod == static_cast<uint>(RenderMethodEnum::Triangles) && !Mesh.Indices.empty())
+	{
+		Stats.AcmrBefore = ComputeACMR(Mesh.Indices, Mesh.Vertices.size());
+
+		WeldVertices(Mesh);
+		OptimizeVertexCache(Mesh.Indices, Mesh.Vertices.size());
+		Stats.OverdrawOrder = OptimizeOverdraw(Mesh.Indices, Mesh.Vertices, OverdrawThreshold);
+		Mesh.MarkDirty();
+		GenerateLods(Mesh);
+		OptimizeVertexFetch(Mesh);
+
+		Mesh.VertexFormat = CanPackTexCoords(Mesh.Vertices) ? NVertexFormat::Packed : NVertexFormat::Float;
+		Mesh.ShortIndices = Mesh.Vertices.size() <= 0x10000;
+
+		// the CPU copy gets the same rounding the GPU sees, so a freshly cooked mesh matches an imported one
+		if (Mesh.VertexFormat == NVertexFormat::Packed)
+		{
+			for (RVertex& Vertex : Mesh.Vertices)
+				Vertex = UnpackVertex(PackVertex(Vertex));
+		}
+
+		Stats.AcmrAfter = ComputeACMR(Mesh.Indices, Mesh.Vertices.size());
+	}
+
+	Stats.Vertices = Mesh.Vertices.size();
+	Stats.Triangles = Mesh.Indices.size() / 3;
+	Stats.BytesPerVertex = GetVertexSize(Mesh.VertexFormat);
+	Stats.ShortIndices = Mesh.ShortIndices;
+	Stats.LodCount = Mesh.GetLodCount();
+	for (uint Lod = 0; Lod < Stats.LodCount; Lod++)
+	{
+		Stats.LodTriangles[Lod] = Mesh.GetLod(Lod).IndexCount / 3;
+		Stats.LodErrors[Lod] = Mesh.GetLod(Lod).Error;
+	}
+	return Stats;
+}
+
+void WeldVertices(RMesh& Mesh)
+{
+	const vector<RVertex>& Vertices = Mesh.Vertices;
+
+	// bit exact, the loader copies the same OBJ values into every corner that shares them
+	auto Hash = [&Vertices](uint Index)
+	{
+		uint Words[sizeof(RVertex) / sizeof(uint)];
+		memcpy(Words, &Vertices[Index], sizeof(RVertex));
+
+		uint64 Result = 0;
+		for (uint Word : Words)
+			Result = HashCombine(Result, Word);
+		return static_cast<size_t>(Result);
+	};
+	auto Equal = [&Vertices](uint A, uint B) { return memcmp(&Vertices[A], &Vertices[B], sizeof(RVertex)) == 0; };
+
+	std::unordered_map<uint, uint, decltype(Hash), decltype(Equal)> Unique(Vertices.size(), Hash, Equal);
+	vector<uint> Remap(Vertices.size());
+	vector<RVertex> Welded;
+	Welded.reserve(Vertices.size());
+
+	for (uint i = 0; i < Vertices.size(); i++)
+	{
+		const auto [It, Inserted] = Unique.try_emplace(i, static_cast<uint>(Welded.size()));
+		if (Inserted)
+			Welded.push_back(Vertices[i]);
+		Remap[i] = It->second;
+	}
+
+	for (uint& Index : Mesh.Indices)
+		Index = Remap[Index];
+
+	Mesh.Vertices = std::move(Welded);
+	Mesh.MarkDirty();
+}
+
+void OptimizeVertexCache(vector<uint>& Indices, uint VertexCount)
+{
+	const uint TriangleCount = Indices.size() / 3;
+	if (TriangleCount == 0)
+		return;
+
+	// triangles using each vertex. The first Remaining[v] entries of a vertex's range are the triangles
+	// not emitted yet, emitted ones get swapped past the end.
+	vector<uint> Offsets(VertexCount + 1, 0);
+	for (uint Index : Indices)
+		Offsets[Index + 1]++;
+	for (uint v = 0; v < VertexCount; v++)
+		Offsets[v + 1] += Offsets[v];
+
+	vector<uint> Adjacency(Indices.size());
+	vector<uint> Remaining(VertexCount, 0);
+	for (uint t = 0; t < TriangleCount; t++)
+	{
+		for (uint k = 0; k < 3; k++)
+		{
+			const uint Vertex = Indices[t * 3 + k];
+			Adjacency[Offsets[Vertex] + Remaining[Vertex]++] = t;
+		}
+	}
+
+	vector<int> CachePosition(VertexCount, -1);
+	vector<float> VertexScore(VertexCount);
+	for (uint v = 0; v < VertexCount; v++)
+		VertexScore[v] = GetVertexScore(-1, Remaining[v]);
+
+	vector<float> TriangleScore(TriangleCount);
+	vector<bool> Emitted(TriangleCount, false);
+	for (uint t = 0; t < TriangleCount; t++)
+		TriangleScore[t] = VertexScore[Indices[t * 3]] + VertexScore[Indices[t * 3 + 1]] + VertexScore[Indices[t * 3 + 2]];
+
+	vector<uint> Cache;
+	vector<uint> NewCache;
+	Cache.reserve(ScoringCacheSize + 3);
+	NewCache.reserve(ScoringCacheSize + 3);
+
+	vector<uint> Output;
+	Output.reserve(Indices.size());
+
+	uint Cursor = 0;
+	int Best = -1;
+	for (uint Count = 0; Count < TriangleCount; Count++)
+	{
+		// nothing in the cache has triangles left, start over from the next triangle in the input order
+		if (Best < 0)
+		{
+			while (Emitted[Cursor])
+				Cursor++;
+			Best = Cursor;
+		}
+
+		const uint* Triangle = &Indices[Best * 3];
+		Output.insert(Output.end(), Triangle, Triangle + 3);
+		Emitted[Best] = true;
+
+		NewCache.clear();
+		for (uint k = 0; k < 3; k++)
+		{
+			const uint Vertex = Triangle[k];
+			NewCache.push_back(Vertex);
+
+			uint* Begin = &Adjacency[Offsets[Vertex]];
+			uint* Last = Begin + --Remaining[Vertex];
+			std::swap(*std::find(Begin, Last + 1, static_cast<uint>(Best)), *Last);
+		}
+		for (uint Vertex : Cache)
+		{
+			if (Vertex != Triangle[0] && Vertex != Triangle[1] && Vertex != Triangle[2])
+				NewCache.push_back(Vertex);
+		}
+
+		// rescore everything that moved in the cache, evicted vertices included, and pass the change on to their triangles
+		for (uint i = 0; i < NewCache.size(); i++)
+		{
+			const uint Vertex = NewCache[i];
+			CachePosition[Vertex] = i < ScoringCacheSize ? i : -1;
+
+			const float Score = GetVertexScore(CachePosition[Vertex], Remaining[Vertex]);
+			const float Delta = Score - VertexScore[Vertex];
+			VertexScore[Vertex] = Score;
+
+			for (uint j = 0; j < Remaining[Vertex]; j++)
+				TriangleScore[Adjacency[Offsets[Vertex] + j]] += Delta;
+		}
+
+		if (NewCache.size() > ScoringCacheSize)
+			NewCache.resize(ScoringCacheSize);
+		std::swap(Cache, NewCache);
+
+		// the next triangle is the best one touching the cache
+		Best = -1;
+		float BestScore = -MaxFloat;
+		for (uint Vertex : Cache)
+		{
+			for (uint j = 0; j < Remaining[Vertex]; j++)
+			{
+				const uint Candidate = Adjacency[Offsets[Vertex] + j];
+				if (TriangleScore[Candidate] > BestScore)
+				{
+					BestScore = TriangleScore[Candidate];
+					Best = Candidate;
+				}
+			}
+		}
+	}
+
+	Indices = std::move(Output);
+}
+
+bool OptimizeOverdraw(vector<uint>& Indices, const vector<RVertex>& Vertices, float Threshold)
+{
+	const uint TriangleCount = Indices.size() / 3;
+	if (TriangleCount < 2)
+		return false;
+
+	vector<uint> Timestamp(Vertices.size(), 0);
+	uint Time = MeshCookCacheSize + 1;
+	auto CountMisses = [&](uint Triangle)
+	{
+		uint Misses = 0;
+		for (uint k = 0; k < 3; k++)
+		{
+			uint& Stamp = Timestamp[Indices[Triangle * 3 + k]];
+			if (Time - Stamp > MeshCookCacheSize)
+			{
+				Stamp = Time++;
+				Misses++;
+			}
+		}
+		return Misses;
+	};
+	auto FlushCache = [&] { Time += MeshCookCacheSize + 1; };
+
+	// Hard boundaries are triangles that miss the cache on all three vertices, the cache order starts
+	// over there anyway.
+	vector<uint> HardStarts;
+	for (uint t = 0; t < TriangleCount; t++)
+	{
+		if (CountMisses(t) == 3)
+			HardStarts.push_back(t);
+	}
+	HardStarts.push_back(TriangleCount);
+
+	// Within those a cluster ends as soon as its ACMR, starting from a cold cache, gets within Threshold
+	// of the whole hard cluster's. Clusters are then free to move, each one costs about what it did in place.
+	vector<uint> ClusterStarts;
+	for (uint h = 0; h + 1 < HardStarts.size(); h++)
+	{
+		const uint Start = HardStarts[h];
+		const uint End = HardStarts[h + 1];
+
+		FlushCache();
+		uint HardMisses = 0;
+		for (uint t = Start; t < End; t++)
+			HardMisses += CountMisses(t);
+		const float TargetAcmr = Threshold * HardMisses / (End - Start);
+
+		FlushCache();
+		ClusterStarts.push_back(Start);
+		uint Misses = 0;
+		uint Triangles = 0;
+		for (uint t = Start; t + 1 < End; t++)
+		{
+			Misses += CountMisses(t);
+			Triangles++;
+			if (Misses <= TargetAcmr * Triangles)
+			{
+				ClusterStarts.push_back(t + 1);
+				FlushCache();
+				Misses = 0;
+				Triangles = 0;
+			}
+		}
+	}
+
+	const uint ClusterCount = ClusterStarts.size();
+	if (ClusterCount < 2)
+		return false;
+	ClusterStarts.push_back(TriangleCount);
+
+	// area weighted centroid and normal of each cluster
+	vector<vec3> ClusterCentroids(ClusterCount, vec3(0.f));
+	vector<vec3> ClusterNormals(ClusterCount, vec3(0.f));
+	vec3 MeshCentroid(0.f);
+	float MeshArea = 0;
+	for (uint c = 0; c < ClusterCount; c++)
+	{
+		float ClusterArea = 0;
+		for (uint t = ClusterStarts[c]; t < ClusterStarts[c + 1]; t++)
+		{
+			const vec3& A = Vertices[Indices[t * 3]].Position;
+			const vec3& B = Vertices[Indices[t * 3 + 1]].Position;
+			const vec3& C = Vertices[Indices[t * 3 + 2]].Position;
+			const vec3 Normal = glm::cross(B - A, C - A);
+			const float Area = glm::length(Normal);
+
+			ClusterCentroids[c] += (A + B + C) * (Area / 3.f);
+			ClusterNormals[c] += Normal;
+			ClusterArea += Area;
+		}
+
+		MeshCentroid += ClusterCentroids[c];
+		MeshArea += ClusterArea;
+		if (ClusterArea > 0.f)
+			ClusterCentroids[c] /= ClusterArea;
+	}
+	if (MeshArea > 0.f)
+		MeshCentroid /= MeshArea;
+
+	// clusters sitting further out along their own normal are more likely to cover the others, draw those first
+	vector<float> ClusterKeys(ClusterCount, 0.f);
+	for (uint c = 0; c < ClusterCount; c++)
+	{
+		const float Length = glm::length(ClusterNormals[c]);
+		if (Length > 0.f)
+			ClusterKeys[c] = glm::dot(ClusterCentroids[c] - MeshCentroid, ClusterNormals[c] / Length);
+	}
+
+	vector<uint> Order(ClusterCount);
+	std::iota(Order.begin(), Order.end(), 0);
+	std::stable_sort(Order.begin(), Order.end(), [&](uint A, uint B) { return ClusterKeys[A] > ClusterKeys[B]; });
+
+	vector<uint> Reordered;
+	Reordered.reserve(Indices.size());
+	for (uint c : Order)
+		Reordered.insert(Reordered.end(), Indices.begin() + ClusterStarts[c] * 3, Indices.begin() + ClusterStarts[c + 1] * 3);
+
+	if (ComputeACMR(Reordered, Vertices.size()) > ComputeACMR(Indices, Vertices.size()) * Threshold)
+		return false;
+
+	Indices = std::move(Reordered);
+	return true;
+}
+
+void GenerateLods(RMesh& Mesh)
+{
+	Mesh.Lods = {};
+
+	vec3 Min(MaxFloat), Max(-MaxFloat);
+	for (const RVertex& Vertex : Mesh.Vertices)
+	{
+		Min = glm::min(Min, Vertex.Position);
+		Max = glm::max(Max, Vertex.Position);
+	}
+	Mesh.Lods.Center = (Min + Max) * 0.5f;
+	Mesh.Lods.Radius = glm::length(Max - Min) * 0.5f;
+
+	const uint TriangleCount = Mesh.Indices.size() / 3;
+	uint PreviousCount = TriangleCount;
+	float PreviousError = 0;
+	for (uint Lod = 1; Lod < MaxMeshLods; Lod++)
+	{
+		const uint Target = TriangleCount >> Lod;
+		if (Target < MinLodTriangles)
+			break;
+
+		float Error;
+		vector<uint> LodIndices = SimplifyMesh(Mesh.Vertices, Mesh.Indices, Target * 3, Error);
+		if (LodIndices.size() / 3 > PreviousCount * MaxLodTriangleRatio)
+			break;
+
+		OptimizeVertexCache(LodIndices, Mesh.Vertices.size());
+
+		// coarser LODs never claim to be closer to the full mesh than finer ones, selection relies on that
+		RMeshLod Level;
+		Level.IndexOffset = Mesh.Indices.size() + Mesh.Lods.Indices.size();
+		Level.IndexCount = LodIndices.size();
+		Level.Error = std::max(Error, PreviousError);
+		Mesh.Lods.Levels.push_back(Level);
+		Mesh.Lods.Indices.insert(Mesh.Lods.Indices.end(), LodIndices.begin(), LodIndices.end());
+
+		PreviousCount = LodIndices.size() / 3;
+		PreviousError = Level.Error;
+	}
+}
+
+void OptimizeVertexFetch(RMesh& Mesh)
+{
+	constexpr uint Unused = ~0u;
+	vector<uint> Remap(Mesh.Vertices.size(), Unused);
+	vector<RVertex> Reordered;
+	Reordered.reserve(Mesh.Vertices.size());
+
+	auto RemapIndices = [&](vector<uint>& Indices)
+	{
+		for (uint& Index : Indices)
+		{
+			if (Remap[Index] == Unused)
+			{
+				Remap[Index] = Reordered.size();
+				Reordered.push_back(Mesh.Vertices[Index]);
+			}
+			Index = Remap[Index];
+		}
+	};
+
+	// LOD vertices are a subset of the full mesh's, they only get renumbered
+	RemapIndices(Mesh.Indices);
+	RemapIndices(Mesh.Lods.Indices);
+
+	Mesh.Vertices = std::move(Reordered);
+	Mesh.MarkDirty();
+}
+
+float ComputeACMR(const vector<uint>& Indices, uint VertexCount, uint CacheSize)
+{
+	const uint TriangleCount = Indices.size() / 3;
+	if (TriangleCount == 0)
+		return 0;
+
+	// a vertex is in the FIFO while fewer than CacheSize vertices went in after it
+	vector<uint> Timestamp(VertexCount, 0);
+	uint Time = CacheSize + 1;
+	uint Misses = 0;
+	for (uint Index : Indices)
+	{
+		if (Time - Timestamp[Index] > CacheSize)
+		{
+			Timestamp[Index] = Time++;
+			Misses++;
+		}
+	}
+
+	return static_cast<float>(Misses) / TriangleCount;
+}
+
+RPackedVertex PackVertex(const RVertex& Vertex)
+{
+	RPackedVertex Packed;
+	Packed.Position = Vertex.Position;
+	Packed.Normal = PackDirection(Vertex.Normal);
+	Packed.TexCoords = glm::packHalf2x16(Vertex.TexCoords);
+	Packed.Tangent = PackDirection(Vertex.Tangent);
+	Packed.Bitangent = PackDirection(Vertex.Bitangent);
+	return Packed;
+}
+
+RVertex UnpackVertex(const RPackedVertex& Vertex)
+{
+	return RVertex{
+		Vertex.Position,
+		UnpackDirection(Vertex.Normal),
+		glm::unpackHalf2x16(Vertex.TexCoords),
+		UnpackDirection(Vertex.Tangent),
+		UnpackDirection(Vertex.Bitangent)
+	};
+}
+
+uint GetVertexSize(NVertexFormat Format)
+{
+	return Format == NVertexFormat::Packed ? sizeof(RPackedVertex) : sizeof(RVertex);
+}
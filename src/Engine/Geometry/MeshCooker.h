@@ -0,0 +1,72 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "vertex.h"
+
+/* ==========================================
+ *	Mesh Cooker
+ * ========================================== */
+// Runs when an OBJ is exported to .rmesh. The loader emits one vertex per face corner in file order,
+// so the cook first welds identical vertices, then reorders the triangles for the post transform
+// vertex cache (Forsyth's linear speed optimizer). The overdraw pass (after Sander et al) then cuts
+// that order in clusters wherever starting over with a cold cache costs little, and sorts them so the
+// outward facing parts of the mesh draw first and hide the rest. Finally vertices are renumbered in
+// the order the index buffer first touches them.
+//
+// Between the overdraw pass and the renumbering, GenerateLods simplifies the mesh (MeshSimplifier.h)
+// down to half, a quarter and an eighth of its triangles, each LOD cache optimized on its own.
+//
+// The GPU copy of a cooked mesh is RPackedVertex (see Vertex.h), 28 bytes instead of 56. Meshes whose
+// UVs tile too far for half floats keep the float layout. Indices go to 16 bit when they fit.
+// CPU side meshes keep RVertex and 32 bit indices, raycasts and the static batches read those.
+//
+// GL free, SetupGLData does the upload.
+
+// LOD 0 included
+constexpr uint MaxMeshLods = 4;
+
+struct RMeshCookStats
+{
+	uint SourceVertices = 0;
+	uint Vertices = 0;
+	uint Triangles = 0;
+	uint BytesPerVertex = 0;
+	bool ShortIndices = false;
+	bool OverdrawOrder = false;		// false when the overdraw pass was rejected
+	uint LodCount = 1;
+	uint LodTriangles[MaxMeshLods] = {};
+	float LodErrors[MaxMeshLods] = {};
+	float AcmrBefore = 0;
+	float AcmrAfter = 0;
+};
+
+// FIFO cache size ACMR is measured with, about what current GPUs hold per batch
+constexpr uint MeshCookCacheSize = 16;
+// the overdraw order is dropped when it raises ACMR by more than this factor over the cache order
+constexpr float OverdrawThreshold = 1.05f;
+// meshes this small aren't worth simplifying
+constexpr uint MinLodTriangles = 64;
+// a LOD that can't get under this fraction of the previous one's triangles isn't kept, nor any after it
+constexpr float MaxLodTriangleRatio = 0.8f;
+// past this a half float UV steps by more than a texel of a 1k texture, such meshes keep float vertices
+constexpr float MaxPackedTexCoord = 2.f;
+
+// Welds, reorders and picks the packed vertex format. Only indexed triangle meshes are touched.
+RMeshCookStats CookMesh(RMesh& Mesh);
+
+// Merges bit identical vertices and remaps the indices
+void WeldVertices(RMesh& Mesh);
+void OptimizeVertexCache(vector<uint>& Indices, uint VertexCount);
+// Reorders cache optimized triangles cluster by cluster. Returns false if the order was left as it was.
+bool OptimizeOverdraw(vector<uint>& Indices, const vector<RVertex>& Vertices, float Threshold);
+// Fills Mesh.Lods from Mesh.Indices, every LOD simplified from the full mesh so errors don't add up
+void GenerateLods(RMesh& Mesh);
+// Renumbers vertices by first use, LODs included, drops the unreferenced ones
+void OptimizeVertexFetch(RMesh& Mesh);
+
+// average cache misses per triangle for a FIFO cache, 0.5 is about the best a regular grid can do and 3 the worst
+float ComputeACMR(const vector<uint>& Indices, uint VertexCount, uint CacheSize = MeshCookCacheSize);
+
+RPackedVertex PackVertex(const RVertex& Vertex);
+RVertex UnpackVertex(const RPackedVertex& Vertex);
+uint GetVertexSize(NVertexFormat Format);
@@ -0,0 +1,269 @@
+#include "MeshSimplifier.h"
+#include "engine/utils/utils.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace
+{
+	// symmetric 4x4 plane quadric, summed area weighted. Doubles since big flat areas cancel out a lot.
+	struct RQuadric
+	{
+		double A2 = 0, AB = 0, AC = 0, AD = 0;
+		double B2 = 0, BC = 0, BD = 0;
+		double C2 = 0, CD = 0;
+		double D2 = 0;
+		double Weight = 0;
+
+		static RQuadric FromPlane(glm::dvec3 Normal, double Distance, double Weight)
+		{
+			RQuadric Q;
+			Q.A2 = Normal.x * Normal.x * Weight;
+			Q.AB = Normal.x * Normal.y * Weight;
+			Q.AC = Normal.x * Normal.z * Weight;
+			Q.AD = Normal.x * Distance * Weight;
+			Q.B2 = Normal.y * Normal.y * Weight;
+			Q.BC = Normal.y * Normal.z * Weight;
+			Q.BD = Normal.y * Distance * Weight;
+			Q.C2 = Normal.z * Normal.z * Weight;
+			Q.CD = Normal.z * Distance * Weight;
+			Q.D2 = Distance * Distance * Weight;
+			Q.Weight = Weight;
+			return Q;
+		}
+
+		void operator+=(const RQuadric& Other)
+		{
+			A2 += Other.A2; AB += Other.AB; AC += Other.AC; AD += Other.AD;
+			B2 += Other.B2; BC += Other.BC; BD += Other.BD;
+			C2 += Other.C2; CD += Other.CD;
+			D2 += Other.D2;
+			Weight += Other.Weight;
+		}
+
+		// weighted mean of the squared distances to the planes
+		double Evaluate(vec3 Point) const
+		{
+			const double X = Point.x, Y = Point.y, Z = Point.z;
+			const double Sum = A2 * X * X + B2 * Y * Y + C2 * Z * Z
+				+ 2 * (AB * X * Y + AC * X * Z + BC * Y * Z)
+				+ 2 * (AD * X + BD * Y + CD * Z) + D2;
+			return Weight > 0 ? std::max(Sum, 0.0) / Weight : 0;
+		}
+	};
+
+	struct RCollapse
+	{
+		uint Source;
+		uint Target;
+		float Cost;
+	};
+
+	uint64 GetEdgeKey(uint A, uint B)
+	{
+		return A < B ? static_cast<uint64>(A) << 32 | B : static_cast<uint64>(B) << 32 | A;
+	}
+
+	vec3 GetTriangleNormal(vec3 A, vec3 B, vec3 C)
+	{
+		return glm::cross(B - A, C - A);
+	}
+}
+
+vector<uint> SimplifyMesh(const vector<RVertex>& Vertices, const vector<uint>& Indices, uint TargetIndexCount, float& OutError)
+{
+	OutError = 0;
+	const uint VertexCount = Vertices.size();
+
+	// vertices sharing a position, bit exact, point to the first of them
+	vector<uint> Canonical(VertexCount);
+	{
+		auto Hash = [&Vertices](uint Index)
+		{
+			uint Words[3];
+			memcpy(Words, &Vertices[Index].Position, sizeof(vec3));
+			return static_cast<size_t>(HashCombine(HashCombine(Words[0], Words[1]), Words[2]));
+		};
+		auto Equal = [&Vertices](uint A, uint B) { return memcmp(&Vertices[A].Position, &Vertices[B].Position, sizeof(vec3)) == 0; };
+
+		std::unordered_map<uint, uint, decltype(Hash), decltype(Equal)> Positions(VertexCount, Hash, Equal);
+		for (uint v = 0; v < VertexCount; v++)
+			Canonical[v] = Positions.try_emplace(v, v).first->second;
+	}
+
+	// seams: a position shared by vertices that differ in anything else
+	vector<bool> Locked(VertexCount, false);
+	for (uint v = 0; v < VertexCount; v++)
+	{
+		if (Canonical[v] != v)
+			Locked[v] = Locked[Canonical[v]] = true;
+	}
+
+	// borders: edges, by position, that don't have exactly two triangles
+	{
+		std::unordered_map<uint64, uint> EdgeTriangles;
+		for (uint i = 0; i < Indices.size(); i += 3)
+		{
+			for (uint k = 0; k < 3; k++)
+				EdgeTriangles[GetEdgeKey(Canonical[Indices[i + k]], Canonical[Indices[i + (k + 1) % 3]])]++;
+		}
+		for (const auto& [Key, Count] : EdgeTriangles)
+		{
+			if (Count != 2)
+				Locked[Key >> 32] = Locked[Key & 0xFFFFFFFF] = true;
+		}
+	}
+	for (uint v = 0; v < VertexCount; v++)
+		Locked[v] = Locked[Canonical[v]];
+
+	// quadrics live on the canonical vertex of each position
+	vector<RQuadric> Quadrics(VertexCount);
+	for (uint i = 0; i < Indices.size(); i += 3)
+	{
+		const vec3& A = Vertices[Indices[i]].Position;
+		const vec3 Normal = GetTriangleNormal(A, Vertices[Indices[i + 1]].Position, Vertices[Indices[i + 2]].Position);
+		const double Length = glm::length(glm::dvec3(Normal));
+		if (Length == 0)
+			continue;
+
+		const glm::dvec3 Unit = glm::dvec3(Normal) / Length;
+		const RQuadric Plane = RQuadric::FromPlane(Unit, -glm::dot(Unit, glm::dvec3(A)), Length * 0.5);
+		for (uint k = 0; k < 3; k++)
+			Quadrics[Canonical[Indices[i + k]]] += Plane;
+	}
+
+	vector<uint> Result = Indices;
+	vector<uint> Remap(VertexCount);
+	vector<bool> Touched(VertexCount);
+	vector<uint> TriangleOffsets(VertexCount + 1);
+	vector<uint> VertexTriangles;
+	vector<RCollapse> Collapses;
+	vector<uint64> Edges;
+
+	while (Result.size() > TargetIndexCount)
+	{
+		const uint TriangleCount = Result.size() / 3;
+
+		// triangles around each vertex
+		std::fill(TriangleOffsets.begin(), TriangleOffsets.end(), 0);
+		for (uint Index : Result)
+			TriangleOffsets[Index + 1]++;
+		for (uint v = 0; v < VertexCount; v++)
+			TriangleOffsets[v + 1] += TriangleOffsets[v];
+		VertexTriangles.resize(Result.size());
+		{
+			vector<uint> Fill(TriangleOffsets.begin(), TriangleOffsets.end() - 1);
+			for (uint t = 0; t < TriangleCount; t++)
+			{
+				for (uint k = 0; k < 3; k++)
+					VertexTriangles[Fill[Result[t * 3 + k]]++] = t;
+			}
+		}
+
+		Edges.clear();
+		for (uint t = 0; t < TriangleCount; t++)
+		{
+			for (uint k = 0; k < 3; k++)
+				Edges.push_back(GetEdgeKey(Result[t * 3 + k], Result[t * 3 + (k + 1) % 3]));
+		}
+		std::sort(Edges.begin(), Edges.end());
+		Edges.erase(std::unique(Edges.begin(), Edges.end()), Edges.end());
+
+		// the cheaper direction of every edge that can collapse
+		Collapses.clear();
+		for (uint64 Edge : Edges)
+		{
+			const uint A = Edge >> 32;
+			const uint B = Edge & 0xFFFFFFFF;
+
+			auto GetCost = [&](uint Source, uint Target)
+			{
+				RQuadric Merged = Quadrics[Canonical[Source]];
+				Merged += Quadrics[Canonical[Target]];
+				return static_cast<float>(Merged.Evaluate(Vertices[Target].Position));
+			};
+
+			const float CostAB = Locked[A] ? MaxFloat : GetCost(A, B);
+			const float CostBA = Locked[B] ? MaxFloat : GetCost(B, A);
+			if (CostAB == MaxFloat && CostBA == MaxFloat)
+				continue;
+
+			Collapses.push_back(CostAB <= CostBA ? RCollapse{A, B, CostAB} : RCollapse{B, A, CostBA});
+		}
+		std::sort(Collapses.begin(), Collapses.end(), [](const RCollapse& X, const RCollapse& Y) { return X.Cost < Y.Cost; });
+
+		for (uint v = 0; v < VertexCount; v++)
+			Remap[v] = v;
+		std::fill(Touched.begin(), Touched.end(), false);
+
+		const uint TrianglesToRemove = (Result.size() - TargetIndexCount + 2) / 3;
+		uint Removed = 0;
+		for (const RCollapse& Collapse : Collapses)
+		{
+			if (Removed >= TrianglesToRemove)
+				break;
+			if (Touched[Collapse.Source] || Touched[Collapse.Target])
+				continue;
+
+			// triangles that keep their area must keep facing the same way once Source sits at Target
+			const vec3& NewPosition = Vertices[Collapse.Target].Position;
+			uint Degenerate = 0;
+			bool Flips = false;
+			for (uint j = TriangleOffsets[Collapse.Source]; j < TriangleOffsets[Collapse.Source + 1] && !Flips; j++)
+			{
+				const uint* Triangle = &Result[VertexTriangles[j] * 3];
+				if (Triangle[0] == Collapse.Target || Triangle[1] == Collapse.Target || Triangle[2] == Collapse.Target)
+				{
+					Degenerate++;
+					continue;
+				}
+
+				vec3 Corners[3];
+				for (uint k = 0; k < 3; k++)
+					Corners[k] = Triangle[k] == Collapse.Source ? NewPosition : Vertices[Triangle[k]].Position;
+
+				const vec3 Before = GetTriangleNormal(Vertices[Triangle[0]].Position, Vertices[Triangle[1]].Position, Vertices[Triangle[2]].Position);
+				const vec3 After = GetTriangleNormal(Corners[0], Corners[1], Corners[2]);
+				Flips = glm::dot(Before, After) <= 0.f;
+			}
+			if (Flips)
+				continue;
+
+			Remap[Collapse.Source] = Collapse.Target;
+			Quadrics[Canonical[Collapse.Target]] += Quadrics[Canonical[Collapse.Source]];
+			OutError = std::max(OutError, Collapse.Cost);
+			Removed += Degenerate;
+
+			// the whole ring moves with it as far as the flip tests of this pass go
+			for (uint j = TriangleOffsets[Collapse.Source]; j < TriangleOffsets[Collapse.Source + 1]; j++)
+			{
+				const uint* Triangle = &Result[VertexTriangles[j] * 3];
+				Touched[Triangle[0]] = Touched[Triangle[1]] = Touched[Triangle[2]] = true;
+			}
+		}
+
+		if (Removed == 0)
+			break;
+
+		// drop the triangles that lost an edge
+		uint Kept = 0;
+		for (uint t = 0; t < TriangleCount; t++)
+		{
+			const uint A = Remap[Result[t * 3]];
+			const uint B = Remap[Result[t * 3 + 1]];
+			const uint C = Remap[Result[t * 3 + 2]];
+			if (A == B || B == C || C == A)
+				continue;
+
+			Result[Kept * 3] = A;
+			Result[Kept * 3 + 1] = B;
+			Result[Kept * 3 + 2] = C;
+			Kept++;
+		}
+		Result.resize(Kept * 3);
+	}
+
+	OutError = std::sqrt(OutError);
+	return Result;
+}
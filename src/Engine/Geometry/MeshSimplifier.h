@@ -0,0 +1,20 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "vertex.h"
+
+/* ==========================================
+ *	Mesh Simplifier
+ * ========================================== */
+// Quadric error metric edge collapse (Garland & Heckbert). Every vertex collapses onto one of its
+// neighbours, so a simplified mesh is just another index buffer over the same vertices and LODs
+// can share the vertex buffer of the full mesh.
+//
+// Vertices on open borders and on attribute seams (one position, several normals or UVs) never
+// move, that keeps the silhouette of open meshes and stops UVs from smearing across a seam.
+// Collapses that would flip a triangle are rejected. Collapses run in passes, cheapest first, and a
+// vertex touched in a pass waits for the next one so the flip tests always see current positions.
+
+// Collapses edges until the index count is at or below TargetIndexCount, or nothing can collapse
+// anymore. OutError gets the largest distance, in model units, the result strays from the source.
+vector<uint> SimplifyMesh(const vector<RVertex>& Vertices, const vector<uint>& Indices, uint TargetIndexCount, float& OutError);
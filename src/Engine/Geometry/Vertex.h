@@ -39,3 +39,24 @@ struct RVertex
 		return *this;
 	};
 };
+
+// How a mesh's vertex buffer is laid out on the GPU, see RMesh::SetupGLData
+enum class NVertexFormat : uint8
+{
+	Float,		// RVertex
+	Packed,		// RPackedVertex
+};
+
+// GPU layout of cooked meshes (see MeshCooker.h). Directions are normalized and go to snorm 10:10:10:2,
+// UVs to half floats, both plain vertex attribute formats in GL 3.3 so the shaders keep reading vec3/vec2.
+struct RPackedVertex
+{
+	vec3 Position;
+	uint Normal;			// GL_INT_2_10_10_10_REV, normalized
+	uint TexCoords;			// 2 x GL_HALF_FLOAT
+	uint Tangent;
+	uint Bitangent;
+};
+
+static_assert(sizeof(RVertex) == 56);
+static_assert(sizeof(RPackedVertex) == 28);
@@ -5,10 +5,13 @@
 #include <glfw3.h>
 #include <imgui.h>
 #include "engine/camera/camera.h"
+#include "engine/core/Profiler.h"
 
 
 RInputFlags StartInputPhase()
 {
+	PROFILE_ZONE("Input");
+
 	auto* GII = GlobalInputInfo::Get();
 	GII->MouseCoords.LastX = GII->MouseCoords.X;
 	GII->MouseCoords.LastY = GII->MouseCoords.Y;
@@ -5,6 +5,7 @@
 #include <iomanip>
 #include <glad/glad.h>
 #include <fstream>
+#include <algorithm>
 #include <glm/gtx/quaternion.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -12,6 +13,7 @@
 
 #include "Engine/Geometry/Vertex.h"
 #include "Engine/Geometry/Mesh.h"
+#include "Engine/Geometry/MeshCooker.h"
 #include "Engine/Collision/CollisionMesh.h"
 #include "Engine/Serialization/Parsing/Parser.h"
 #include "Engine/Rvn.h"
@@ -32,35 +34,24 @@ void LoadModels()
 			
 			auto ModelName = ModelFilename.substr(0, ModelFilename.length() - 4);
 
-			if (DoesFileExist(Paths::MeshExports + ModelName + ".rmesh")) {
-				ImportMeshBinary(ModelName);
-			}
-			else {
+			// stale or missing exports are cooked again from the OBJ
+			const bool Imported = DoesFileExist(Paths::MeshExports + ModelName + ".rmesh") && ImportMeshBinary(ModelName);
+			if (!Imported) {
 				auto* Mesh = LoadWavefrontObjAsMesh(ModelName);
+				const RMeshCookStats Stats = CookMesh(*Mesh);
+				Mesh->ReleaseGLData();
+				Mesh->SetupGLData();
+
+				Log("Cooked mesh '%s': %u -> %u vertices, %u bytes/vertex, %u bit indices, ACMR %.2f -> %.2f%s", ModelName.c_str(),
+					Stats.SourceVertices, Stats.Vertices, Stats.BytesPerVertex, Stats.ShortIndices ? 16u : 32u, Stats.AcmrBefore,
+					Stats.AcmrAfter, Stats.OverdrawOrder ? ", overdraw order" : "")
+				for (uint Lod = 1; Lod < Stats.LodCount; Lod++)
+					Log("  LOD %u: %u triangles, error %.4f", Lod, Stats.LodTriangles[Lod], Stats.LodErrors[Lod])
 				ExportMeshBinary(Mesh);
 			}
 		}
 	}
 	
-	//TEXT
-	{
-		RGLData TextGlData;
-		glGenVertexArrays(1, &TextGlData.VAO);
-		glGenBuffers(1, &TextGlData.VBO);
-		glBindVertexArray(TextGlData.VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, TextGlData.VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, static_cast<void*>(nullptr));
-		glEnableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-
-		auto* TextMesh = new RMesh();
-		TextMesh->Name = "text";
-		TextMesh->GLData = TextGlData;
-		GeometryCatalogue.insert({TextMesh->Name, TextMesh});
-	}
-
 	// SLOPE
 	// with Z coming at the screen, X to the right, slope starts at x=0 high and goes low on x=1
 	std::vector<RVertex> slope_vertex_vec = {
@@ -137,7 +128,7 @@ void LoadTexturesFromAssetsFolder()
 				TextureType = "texture_normal";
 			}
 
-			TextureCatalogue.insert({TextureName, RTexture{TextureID, TextureType, TextureFilename, TextureName}});
+			TextureCatalogue.insert({TextureName, RegisterTexture(RTexture{TextureID, TextureType, TextureFilename, TextureName})});
 		}
 	}
 }
@@ -591,11 +582,6 @@ void LoadShaders()
 		if (Error) FatalError("Error in shader programs file definition. Couldn't parse line %i.", P.LineCount)
 		if (MissingComma) FatalError("Error in shader programs file definition. There is a missing comma in line %i.", P.LineCount)
 	}
-
-	// setup for text shader
-	auto TextShader = ShaderCatalogue.find("text")->second;
-	TextShader->Use();
-	TextShader->SetMatrix4("projection", glm::ortho(0.0f, GlobalDisplayState::ViewportWidth, 0.0f, GlobalDisplayState::ViewportHeight));
 }
 
 void ExportWavefrontCollisionMesh(RCollisionMesh* CollisionMesh)
@@ -626,111 +612,240 @@ void ExportWavefrontCollisionMesh(RCollisionMesh* CollisionMesh)
 	Writer.close();
 }
 
+// .rmesh layout: the header, VertexCount vertices in VertexFormat's layout, then IndexCount indices of
+// IndexSize bytes. With LODs follow their LodIndexCount indices, the LodCount RMeshLod ranges and the
+// bounding sphere. Files from before the header start with the vertex count instead of the magic,
+// those (and older versions) are cooked again from the OBJ.
+constexpr uint MeshFileMagic = 'R' | 'M' << 8 | 'S' << 16 | 'H' << 24;
+constexpr uint MeshFileVersion = 3;
+
+struct RMeshFileHeader
+{
+	uint Magic = MeshFileMagic;
+	uint Version = MeshFileVersion;
+	uint VertexCount = 0;
+	uint IndexCount = 0;
+	uint LodIndexCount = 0;
+	uint FacesCount = 0;
+	NVertexFormat VertexFormat = NVertexFormat::Float;
+	uint8 IndexSize = sizeof(uint);
+	uint16 LodCount = 0;				// past LOD 0
+};
+
+static_assert(sizeof(RMeshFileHeader) == 28);
+static_assert(sizeof(RMeshLod) == 12);
+
+static bool WriteIndices(FILE* File, const vector<uint>& Indices, bool ShortIndices)
+{
+	if (!ShortIndices)
+		return fwrite(Indices.data(), sizeof(uint), Indices.size(), File) == Indices.size();
+
+	const vector<uint16> Narrowed(Indices.begin(), Indices.end());
+	return fwrite(Narrowed.data(), sizeof(uint16), Narrowed.size(), File) == Narrowed.size();
+}
+
+static bool ReadIndices(FILE* File, vector<uint>& Indices, bool ShortIndices)
+{
+	if (!ShortIndices)
+		return fread(Indices.data(), sizeof(uint), Indices.size(), File) == Indices.size();
+
+	vector<uint16> Narrowed(Indices.size());
+	const bool Read = fread(Narrowed.data(), sizeof(uint16), Narrowed.size(), File) == Narrowed.size();
+	std::copy(Narrowed.begin(), Narrowed.end(), Indices.begin());
+	return Read;
+}
+
 void ExportMeshBinary(RMesh* Mesh)
 {
 	const string ExportFilepath = Paths::MeshExports + Mesh->Name + ".rmesh";
 
-	const uint VerticesCount = Mesh->Vertices.size();
-	const uint IndicesCount = Mesh->Indices.size();
-	const uint FacesCount = Mesh->FacesCount;
+	RMeshFileHeader Header;
+	Header.VertexCount = Mesh->Vertices.size();
+	Header.IndexCount = Mesh->Indices.size();
+	Header.FacesCount = Mesh->FacesCount;
+	Header.VertexFormat = Mesh->VertexFormat;
+	Header.IndexSize = Mesh->GetIndexSize();
+	Header.LodIndexCount = Mesh->Lods.Indices.size();
+	Header.LodCount = Mesh->Lods.Levels.size();
 
 	FILE* File;
 	int ErrnoOpen = fopen_s(&File, ExportFilepath.c_str(), "wb");
 	if (!File  || ErrnoOpen != 0) {
 		Log("Couldn't open binary mesh data for '%s'. Error code: %i", Mesh->Name.c_str(), ErrnoOpen)
+		return;
 	}
 
 	Log("Exporting binary mesh data (%s)", Mesh->Name.c_str())
 	
 	// Write file format header
 	{
-		constexpr uint HeaderSize = 12;
-		char HeaderBuffer[HeaderSize];
-		auto* p = (uint*) &HeaderBuffer;
-		*p = VerticesCount; p++;
-		*p = IndicesCount; p++;
-		*p = FacesCount; p++;
-
-		uint64 BytesWritten = fwrite(&HeaderBuffer, 1, HeaderSize, File);
-		if (BytesWritten != HeaderSize) {
+		uint64 ItemsWritten = fwrite(&Header, sizeof(RMeshFileHeader), 1, File);
+		if (ItemsWritten != 1) {
 			Log("Wrote different number of bytes to disk while exporting mesh binary data (Header).") DEBUG_BREAK
 		}
 	}
 
 	// Write Vertices
 	{
-		uint ItemsWritten = fwrite(Mesh->Vertices.data(), sizeof(RVertex), VerticesCount, File);
-		if (ItemsWritten != VerticesCount) {
+		uint64 ItemsWritten;
+		if (Header.VertexFormat == NVertexFormat::Packed)
+		{
+			vector<RPackedVertex> PackedVertices;
+			PackedVertices.reserve(Header.VertexCount);
+			for (const RVertex& Vertex : Mesh->Vertices)
+				PackedVertices.push_back(PackVertex(Vertex));
+			ItemsWritten = fwrite(PackedVertices.data(), sizeof(RPackedVertex), Header.VertexCount, File);
+		}
+		else
+		{
+			ItemsWritten = fwrite(Mesh->Vertices.data(), sizeof(RVertex), Header.VertexCount, File);
+		}
+
+		if (ItemsWritten != Header.VertexCount) {
 			Log("Wrote different number of items to disk while exporting mesh binary data (Vertices).") DEBUG_BREAK
 		}
 	}
 
 	// Write Indices
 	{
-		uint64 ItemsWritten = fwrite(Mesh->Indices.data(), sizeof(uint), IndicesCount, File);
-		if (ItemsWritten != IndicesCount) {
+		if (!WriteIndices(File, Mesh->Indices, Mesh->ShortIndices)) {
 			Log("Wrote different number of items to disk while exporting mesh binary data (Indices).") DEBUG_BREAK
 		}
 	}
 
+	// Write LODs
+	if (Header.LodCount > 0)
+	{
+		const auto& Lods = Mesh->Lods;
+		bool Written = WriteIndices(File, Lods.Indices, Mesh->ShortIndices);
+		Written &= fwrite(Lods.Levels.data(), sizeof(RMeshLod), Header.LodCount, File) == Header.LodCount;
+		Written &= fwrite(&Lods.Center, sizeof(vec3), 1, File) == 1;
+		Written &= fwrite(&Lods.Radius, sizeof(float), 1, File) == 1;
+		if (!Written) {
+			Log("Wrote different number of items to disk while exporting mesh binary data (LODs).") DEBUG_BREAK
+		}
+	}
+
 	int ErrnoClose = fclose(File);
-	if (ErrnoOpen != 0) {
+	if (ErrnoClose != 0) {
 		Log("Error closing filestream while exporting binary mesh data for mesh '%s'. Error code: %i", Mesh->Name.c_str(), ErrnoClose) DEBUG_BREAK
 	}
 }
 
-void ImportMeshBinary(const string& ModelName)
+bool ReadMeshBinary(const string& Filepath, RMesh& OutMesh)
 {
-	const string Filename = ModelName + ".rmesh";
-	const string ImportFilepath = Paths::MeshExports + Filename;
-	
 	FILE* File;
-	int ErrnoOpen = fopen_s(&File, ImportFilepath.c_str(), "rb");
+	int ErrnoOpen = fopen_s(&File, Filepath.c_str(), "rb");
 	if (!File  || ErrnoOpen != 0) {
-		Log("Couldn't open binary mesh data for '%s'. Error code: %i", Filename.c_str(), ErrnoOpen)
+		Log("Couldn't open binary mesh data '%s'. Error code: %i", Filepath.c_str(), ErrnoOpen)
+		return false;
 	}
 
-	auto* Mesh = new RMesh;
-	uint VertexCount = 0;
-	uint IndicesCount = 0;
-	// Reserve space for vertexes
+	// Read and check the header
+	RMeshFileHeader Header;
 	{
-		if (uint ItemsRead = fread(&VertexCount, sizeof(uint), 1, File); ItemsRead != 1) {
-			Log("Error: Read different number of items to disk while importing mesh binary data (Vertices).") DEBUG_BREAK
+		const bool HeaderRead = fread(&Header, sizeof(RMeshFileHeader), 1, File) == 1;
+		if (!HeaderRead || Header.Magic != MeshFileMagic || Header.Version != MeshFileVersion) {
+			Log("ImportMeshBinary: '%s' is from an older version, cooking it again.", Filepath.c_str())
+			fclose(File);
+			return false;
+		}
+
+		const bool ValidIndexSize = Header.IndexSize == sizeof(uint16) || Header.IndexSize == sizeof(uint);
+		const bool ValidFormat = Header.VertexFormat == NVertexFormat::Float || Header.VertexFormat == NVertexFormat::Packed;
+		if (Header.VertexCount == 0 || Header.IndexCount == 0 || !ValidIndexSize || !ValidFormat) {
+			Log("ImportMeshBinary: Invalid header reading mesh '%s' binary data.", Filepath.c_str())
+			fclose(File);
+			return false;
 		}
-		if (VertexCount <= 0) { Log("ImportMeshBinary: Invalid VertexCount Reading mesh '%s' binary data.", Filename.c_str()); delete Mesh; return; }
-		Mesh->Vertices.resize(VertexCount);
 	}
-	// Reserve space for indices
+
+	// the counts have to add up to the file's size before anything is allocated for them
 	{
-		if (uint ItemsRead = fread(&IndicesCount, sizeof(uint), 1, File); ItemsRead != 1) {
-			Log("Error: Read different number of items to disk while importing mesh binary data (Indices).") DEBUG_BREAK
+		const uint64 VertexSize = Header.VertexFormat == NVertexFormat::Packed ? sizeof(RPackedVertex) : sizeof(RVertex);
+		uint64 ExpectedSize = sizeof(RMeshFileHeader) + VertexSize * Header.VertexCount + uint64(Header.IndexSize) * Header.IndexCount;
+		if (Header.LodCount > 0)
+			ExpectedSize += uint64(Header.IndexSize) * Header.LodIndexCount + sizeof(RMeshLod) * Header.LodCount + sizeof(vec3) + sizeof(float);
+
+		bool Sized = fseek(File, 0, SEEK_END) == 0;
+		const long FileSize = ftell(File);
+		Sized &= FileSize >= 0 && static_cast<uint64>(FileSize) == ExpectedSize;
+		Sized &= fseek(File, sizeof(RMeshFileHeader), SEEK_SET) == 0;
+		if (!Sized) {
+			Log("ImportMeshBinary: '%s' doesn't match the size its header claims, cooking it again.", Filepath.c_str())
+			fclose(File);
+			return false;
 		}
-		if (VertexCount <= 0) { Log("ImportMeshBinary: Invalid VertexCount Reading mesh '%s' binary data.", Filename.c_str()); delete Mesh; return; }
-		Mesh->Indices.resize(IndicesCount);
 	}
-	// Read faces count
+
+	OutMesh.FacesCount = Header.FacesCount;
+	OutMesh.VertexFormat = Header.VertexFormat;
+	OutMesh.ShortIndices = Header.IndexSize == sizeof(uint16);
+	OutMesh.Vertices.resize(Header.VertexCount);
+	OutMesh.Indices.resize(Header.IndexCount);
+
+	bool ReadAll = true;
+	// Read vertices data, packed vertices are expanded again for the CPU side
+	if (Header.VertexFormat == NVertexFormat::Packed)
 	{
-		uint FacesCount = 0;
-		if (uint ItemsRead = fread(&FacesCount, sizeof(uint), 1, File); ItemsRead != 1) {
-			Log("Error: Read different number of items to disk while importing mesh binary data (Indices).") DEBUG_BREAK
-		}
-		Mesh->FacesCount = FacesCount;
+		vector<RPackedVertex> PackedVertices(Header.VertexCount);
+		ReadAll &= fread(PackedVertices.data(), sizeof(RPackedVertex), Header.VertexCount, File) == Header.VertexCount;
+		for (uint i = 0; i < Header.VertexCount; i++)
+			OutMesh.Vertices[i] = UnpackVertex(PackedVertices[i]);
 	}
-	// Read vertices data
+	else
 	{
-		if (uint ItemsRead = fread(Mesh->Vertices.data(), sizeof(RVertex), VertexCount, File); ItemsRead != VertexCount) {
-			Log("Error: Read different number of items to disk while importing mesh binary data (Vertices).") DEBUG_BREAK
-		}
+		ReadAll &= fread(OutMesh.Vertices.data(), sizeof(RVertex), Header.VertexCount, File) == Header.VertexCount;
 	}
+
 	// Read indices data
+	ReadAll &= ReadIndices(File, OutMesh.Indices, OutMesh.ShortIndices);
+
+	// Read LODs
+	if (Header.LodCount > 0)
 	{
-		if (uint ItemsRead = fread(Mesh->Indices.data(), sizeof(uint), IndicesCount, File); ItemsRead != IndicesCount) {
-			Log("Error: Read different number of items to disk while importing mesh binary data (Vertices).") DEBUG_BREAK
-		}
+		auto& Lods = OutMesh.Lods;
+		Lods.Indices.resize(Header.LodIndexCount);
+		Lods.Levels.resize(Header.LodCount);
+		ReadAll &= ReadIndices(File, Lods.Indices, OutMesh.ShortIndices);
+		ReadAll &= fread(Lods.Levels.data(), sizeof(RMeshLod), Header.LodCount, File) == Header.LodCount;
+		ReadAll &= fread(&Lods.Center, sizeof(vec3), 1, File) == 1;
+		ReadAll &= fread(&Lods.Radius, sizeof(float), 1, File) == 1;
+		for (const RMeshLod& Level : Lods.Levels)
+			ReadAll &= uint64(Level.IndexOffset) + Level.IndexCount <= uint64(Header.IndexCount) + Header.LodIndexCount;
 	}
 
+	fclose(File);
+
+	if (!ReadAll) {
+		Log("Error: Read different number of items from disk while importing mesh binary data ('%s').", Filepath.c_str())
+		return false;
+	}
+
+	// every index goes to GL and to the ACMR estimate as is
+	auto InRange = [&Header](uint Index) { return Index < Header.VertexCount; };
+	if (!std::all_of(OutMesh.Indices.begin(), OutMesh.Indices.end(), InRange) ||
+		!std::all_of(OutMesh.Lods.Indices.begin(), OutMesh.Lods.Indices.end(), InRange)) {
+		Log("ImportMeshBinary: '%s' has indices past its %u vertices, cooking it again.", Filepath.c_str(), Header.VertexCount)
+		return false;
+	}
+
+	return true;
+}
+
+bool ImportMeshBinary(const string& ModelName)
+{
+	auto* Mesh = new RMesh;
+	if (!ReadMeshBinary(Paths::MeshExports + ModelName + ".rmesh", *Mesh)) {
+		delete Mesh;
+		return false;
+	}
+
+	Log("Mesh '%s': %u vertices, %u bytes/vertex, %u bit indices, ACMR %.2f, %u LODs", ModelName.c_str(), static_cast<uint>(Mesh->Vertices.size()),
+		GetVertexSize(Mesh->VertexFormat), Mesh->GetIndexSize() * 8u, ComputeACMR(Mesh->Indices, Mesh->Vertices.size()), Mesh->GetLodCount())
+
 	Mesh->Name = ModelName;
 	Mesh->SetupGLData();
 	GeometryCatalogue.insert({ModelName, Mesh});
-}
\ No newline at end of file
+	return true;
+}
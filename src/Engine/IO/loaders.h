@@ -21,5 +21,8 @@ void LoadModels();
 
 void ExportWavefrontCollisionMesh(RCollisionMesh* CollisionMesh);
 void ExportMeshBinary(RMesh* Mesh);
-void ImportMeshBinary(const string& Filename);
+// false when the file is missing, unreadable, corrupt or from an older format version
+bool ImportMeshBinary(const string& Filename);
+// ImportMeshBinary's file parsing, without GL or the catalogue. OutMesh is only valid when it returns true.
+bool ReadMeshBinary(const string& Filepath, RMesh& OutMesh);
 bool DoesFileExist(const string& Filepath);
\ No newline at end of file
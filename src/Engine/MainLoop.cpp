@@ -16,9 +16,19 @@
 #include "game/input/PlayerInput.h"
 #include "editor/EditorInput.h"
 #include "engine/camera/camera.h"
+#include "engine/core/FrameMetrics.h"
+#include "engine/core/Profiler.h"
+#include "engine/render/Culling.h"
+#include "engine/render/LodSelector.h"
+#include "engine/render/RenderStats.h"
+#include "engine/render/ShadowCache.h"
+#include "engine/render/StaticBatches.h"
 #include "engine/render/ImRender.h"
 #include "engine/render/renderer.h"
+#include "engine/render/RingBuffer.h"
+#include "engine/render/text/TextRenderer.h"
 #include "engine/world/World.h"
+#include "engine/collision/ColliderCache.h"
 
 void StartFrame();
 
@@ -63,31 +73,35 @@ void RavenousMainLoop()
 		// ---------------
 		auto* Camera = CamManager->GetCurrentCamera();
 
-		if (REditorState::IsInConsoleMode()) {
-			HandleConsoleInput(InputFlags, Player, World, Camera);
-		}
-		else
 		{
-			if (REditorState::IsInEditorMode())
+			PROFILE_ZONE("Input Handling");
+			if (REditorState::IsInConsoleMode()) {
+				HandleConsoleInput(InputFlags, Player, World, Camera);
+			}
+			else
 			{
-				Editor::HandleInputFlagsForEditorMode(InputFlags, World);
+				if (REditorState::IsInEditorMode())
+				{
+					Editor::HandleInputFlagsForEditorMode(InputFlags, World);
 				
-				if (!ImGui::GetIO().WantCaptureKeyboard) {
+					if (!ImGui::GetIO().WantCaptureKeyboard) {
+						InHandleMovementInput(InputFlags, Player, World);
+						Editor::HandleInputFlagsForCommonInput(InputFlags, Player);
+					}
+				}
+				else if (REditorState::IsInGameMode()) {
 					InHandleMovementInput(InputFlags, Player, World);
 					Editor::HandleInputFlagsForCommonInput(InputFlags, Player);
 				}
 			}
-			else if (REditorState::IsInGameMode()) {
-				InHandleMovementInput(InputFlags, Player, World);
-				Editor::HandleInputFlagsForCommonInput(InputFlags, Player);
-			}
+			ResetInputFlags(InputFlags);
 		}
-		ResetInputFlags(InputFlags);
 
 		// -------------
 		//	UPDATE PHASE
 		// -------------
 		{
+			PROFILE_ZONE("Update");
 			World->UpdateTraits();
 			
 			if (ES->CurrentMode == REditorState::NProgramMode::Game) {
@@ -107,12 +121,21 @@ void RavenousMainLoop()
 		//	RENDER PHASE
 		// -------------
 		{
+			PROFILE_ZONE("Render");
 			auto& Frame = RavenousEngine::GetFrame();
 
+			bool DrawDearImgui = false;
+
 			glClearColor(0.196f, 0.298f, 0.3607f, 1.0f);
 			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			RRenderStats::Get()->BeginFrame();
+			RDynamicBuffers::Get()->BeginFrame();
+			RCulling::Get()->BeginFrame();
+			RShadowCache::Get()->BeginFrame();
+			RStaticBatches::Get()->BeginFrame();
+			RLodSelector::Get()->BeginFrame(Camera, GlobalDisplayState::ViewportHeight);
 			RenderDepthMap();
-			RenderDepthCubemap();
+			RenderShadowAtlas(World, Camera);
 			RenderScene(World, Camera);
 			//render_depth_map_debug();
 			switch (ES->CurrentMode)
@@ -124,8 +147,12 @@ void RavenousMainLoop()
 				}
 				case REditorState::NProgramMode::Editor:
 				{
-					Editor::Update(Player, World, Camera);
+					{
+						PROFILE_ZONE("Editor Update");
+						Editor::Update(Player, World, Camera);
+					}
 					Editor::Render(Player, World, Camera);
+					DrawDearImgui = true;
 					break;
 				}
 				case REditorState::NProgramMode::Game:
@@ -137,6 +164,11 @@ void RavenousMainLoop()
 			RImDraw::Render(Camera);
 			RImDraw::Update(Frame.Duration);
 			Rvn::EditorMsgManager->Render();
+			RTextRenderer::Get()->Flush();
+			if (DrawDearImgui) {
+				Editor::RenderDearImgui();
+			}
+			RRenderStats::Get()->EndFrame();
 		}
 
 		// -------------
@@ -144,10 +176,18 @@ void RavenousMainLoop()
 		// -------------
 		Rvn::EditorMsgManager->Update();
 		World->DeleteEntitiesMarkedForDeletion();
-		glfwSwapBuffers(GlobalDisplayState::Get()->GetWindow());
+		RColliderCache::Get()->EndFrame();
+		RDynamicBuffers::Get()->EndFrame();
+		RFrameMetrics::Get()->Set("frame.ms", RavenousEngine::GetFrame().RealDuration * 1000.0);
+		RFrameMetrics::Get()->EndFrame();
+		{
+			PROFILE_ZONE("Swap");
+			glfwSwapBuffers(GlobalDisplayState::Get()->GetWindow());
+		}
 		if (ES->CurrentMode == REditorState::NProgramMode::Editor) {
 			Editor::EndDearImguiFrame();
 		}
+		RProfiler::Get()->EndFrame();
 	}
 
 	glfwTerminate();
@@ -0,0 +1,138 @@
+#include "CommandList.h"
+#include "glad/glad.h"
+#include "RenderQueue.h"
+#include "RenderStats.h"
+
+void RRenderBackend::Execute(const RCommandList& List)
+{
+	Count(List);
+	if (Type == NRenderBackend::GL)
+		ExecuteGL(List);
+	else
+		Recording.insert(Recording.end(), List.GetCommands().begin(), List.GetCommands().end());
+}
+
+void RRenderBackend::ResetStats()
+{
+	Stats = {};
+	Recording.clear();
+}
+
+void RRenderBackend::Count(const RCommandList& List)
+{
+	auto* RenderStats = RRenderStats::Get();
+	Stats.Lists++;
+	Stats.Commands += List.GetCommands().size();
+	for (const RRenderCommand& Command : List.GetCommands())
+	{
+		Stats.CommandsByType[static_cast<uint>(Command.Type)]++;
+		switch (Command.Type)
+		{
+			case NRenderCommand::UseProgram:      Stats.ProgramBinds++; RenderStats->CountProgramBind(); break;
+			case NRenderCommand::SetInt:
+			case NRenderCommand::SetMatrix4:      Stats.UniformSets++; RenderStats->CountUniformSet(); break;
+			case NRenderCommand::BindTexture:     Stats.TextureBinds++; RenderStats->CountTextureBind(); break;
+			case NRenderCommand::BindVertexArray: Stats.VertexArrayBinds++; break;
+			case NRenderCommand::SetPolygonMode:  Stats.PolygonModeChanges++; break;
+			case NRenderCommand::DrawArrays:
+			{
+				Stats.DrawCalls++;
+				RenderStats->CountDraw(Command.A, Command.C);
+				break;
+			}
+			case NRenderCommand::DrawElements:
+			{
+				Stats.DrawCalls++;
+				if (Command.E > 1)
+					Stats.Instances += Command.E;
+				RenderStats->CountDraw(Command.A, Command.B, Command.E);
+				break;
+			}
+			default: break;
+		}
+	}
+}
+
+// Leaves texture unit 0 active, like the code that used to make these calls itself
+void RRenderBackend::ExecuteGL(const RCommandList& List)
+{
+	uint ActiveUnit = MaxUint;
+	for (const RRenderCommand& Command : List.GetCommands())
+	{
+		switch (Command.Type)
+		{
+			case NRenderCommand::UseProgram:
+				glUseProgram(Command.A);
+				break;
+
+			case NRenderCommand::SetInt:
+				glUniform1i(static_cast<int>(Command.A), static_cast<int>(Command.B));
+				break;
+
+			case NRenderCommand::SetMatrix4:
+				glUniformMatrix4fv(static_cast<int>(Command.A), 1, GL_FALSE, &(*Command.Matrix)[0][0]);
+				break;
+
+			case NRenderCommand::BindTexture:
+			{
+				if (ActiveUnit != Command.A)
+				{
+					glActiveTexture(GL_TEXTURE0 + Command.A);
+					ActiveUnit = Command.A;
+				}
+				glBindTexture(Command.B, Command.C);
+				break;
+			}
+
+			case NRenderCommand::BindVertexArray:
+				glBindVertexArray(Command.A);
+				break;
+
+			case NRenderCommand::SetPolygonMode:
+				glPolygonMode(GL_FRONT_AND_BACK, Command.A ? GL_LINE : GL_FILL);
+				break;
+
+			case NRenderCommand::DrawArrays:
+				glDrawArrays(Command.A, Command.B, Command.C);
+				break;
+
+			case NRenderCommand::DrawElements:
+			{
+				const void* Offset = reinterpret_cast<void*>(static_cast<size_t>(Command.D));
+				if (Command.E > 1)
+					glDrawElementsInstanced(Command.A, Command.B, Command.C, Offset, Command.E);
+				else
+					glDrawElements(Command.A, Command.B, Command.C, Offset);
+				break;
+			}
+
+			case NRenderCommand::SetInstanceMatrices:
+			{
+				// no base instance in GL 3.3, so the attributes point straight at the first matrix
+				glBindBuffer(GL_ARRAY_BUFFER, Command.A);
+				for (uint Column = 0; Column < 4; Column++)
+				{
+					const uint Attribute = RInstanceMatrixAttribute + Column;
+					const size_t Offset = Command.B + Column * sizeof(vec4);
+					glEnableVertexAttribArray(Attribute);
+					glVertexAttribPointer(Attribute, 4, GL_FLOAT, GL_FALSE, sizeof(mat4), reinterpret_cast<void*>(Offset));
+					glVertexAttribDivisor(Attribute, 1);
+				}
+				break;
+			}
+
+			case NRenderCommand::ClearInstanceMatrices:
+			{
+				for (uint Column = 0; Column < 4; Column++)
+					glDisableVertexAttribArray(RInstanceMatrixAttribute + Column);
+				break;
+			}
+
+			default:
+				break;
+		}
+	}
+
+	if (ActiveUnit != 0)
+		glActiveTexture(GL_TEXTURE0);
+}
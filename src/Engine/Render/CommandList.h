@@ -0,0 +1,119 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+/* ==========================================
+ *	Command List
+ * ========================================== */
+// Instead of calling GL as it goes, the render queue records what it wants done (programs,
+// uniforms, textures, vertex arrays, draws) into a command list, and a backend then executes it.
+// Recording doesn't touch GL, so everything up to and including the state tracking of a pass can
+// run headless.
+//
+// The GL backend turns each command into the calls it replaces. The Null backend doesn't draw
+// anything: it appends the commands to a recording and counts them, which is what benchmarks and
+// tests look at. Both keep the same counters, so the numbers match between a headless run and the
+// game.
+//
+// Commands are fixed size, the meaning of the arguments depends on the type (see NRenderCommand).
+// Matrices aren't copied, a SetMatrix4 keeps a pointer that has to stay valid until the list was
+// executed.
+
+enum class NRenderCommand : uint8
+{
+	UseProgram,				// A program
+	SetInt,					// A location, B value
+	SetMatrix4,				// A location, Matrix
+	BindTexture,			// A unit, B target (GL_TEXTURE_2D...), C texture
+	BindVertexArray,		// A vertex array
+	SetPolygonMode,			// A 1 for lines, 0 for fill
+	DrawArrays,				// A mode, B first vertex, C vertex count
+	DrawElements,			// A mode, B index count, C index type, D byte offset into the index buffer, E instances
+	SetInstanceMatrices,	// A buffer, B byte offset of the first matrix
+	ClearInstanceMatrices,
+	Count
+};
+
+struct RRenderCommand
+{
+	NRenderCommand Type;
+	uint A = 0;
+	uint B = 0;
+	uint C = 0;
+	uint D = 0;
+	uint E = 0;
+	const mat4* Matrix = nullptr;
+};
+
+struct RCommandList
+{
+	void Clear() { Commands.clear(); }
+	bool IsEmpty() const { return Commands.empty(); }
+	const vector<RRenderCommand>& GetCommands() const { return Commands; }
+	void Append(const RCommandList& Other) { Commands.insert(Commands.end(), Other.Commands.begin(), Other.Commands.end()); }
+
+	void UseProgram(uint Program) { Commands.push_back({NRenderCommand::UseProgram, Program}); }
+	void SetInt(int Location, int Value) { Commands.push_back({NRenderCommand::SetInt, static_cast<uint>(Location), static_cast<uint>(Value)}); }
+	void SetMatrix4(int Location, const mat4* Matrix) { Commands.push_back({NRenderCommand::SetMatrix4, static_cast<uint>(Location), 0, 0, 0, 0, Matrix}); }
+	void BindTexture(uint Unit, uint Target, uint Texture) { Commands.push_back({NRenderCommand::BindTexture, Unit, Target, Texture}); }
+	void BindVertexArray(uint VertexArray) { Commands.push_back({NRenderCommand::BindVertexArray, VertexArray}); }
+	void SetPolygonMode(bool Wireframe) { Commands.push_back({NRenderCommand::SetPolygonMode, Wireframe ? 1u : 0u}); }
+	void DrawArrays(uint Mode, uint First, uint Count) { Commands.push_back({NRenderCommand::DrawArrays, Mode, First, Count}); }
+	void DrawElements(uint Mode, uint IndexCount, uint IndexType, uint ByteOffset, uint Instances = 1)
+	{
+		Commands.push_back({NRenderCommand::DrawElements, Mode, IndexCount, IndexType, ByteOffset, Instances});
+	}
+	// Points the instance matrix attributes (RInstanceMatrixAttribute) of the bound vertex array at Buffer
+	void SetInstanceMatrices(uint Buffer, uint ByteOffset) { Commands.push_back({NRenderCommand::SetInstanceMatrices, Buffer, ByteOffset}); }
+	void ClearInstanceMatrices() { Commands.push_back({NRenderCommand::ClearInstanceMatrices}); }
+
+private:
+	vector<RRenderCommand> Commands;
+};
+
+enum class NRenderBackend : uint8
+{
+	GL,
+	Null
+};
+
+struct RRenderBackendStats
+{
+	// since ResetStats
+	uint Lists = 0;
+	uint Commands = 0;
+	uint DrawCalls = 0;
+	uint Instances = 0;				// drawn by instanced draws
+	uint ProgramBinds = 0;
+	uint UniformSets = 0;
+	uint TextureBinds = 0;
+	uint VertexArrayBinds = 0;
+	uint PolygonModeChanges = 0;
+	uint CommandsByType[static_cast<uint>(NRenderCommand::Count)]{};
+};
+
+struct RRenderBackend
+{
+	static RRenderBackend* Get()
+	{
+		static RRenderBackend Instance{};
+		return &Instance;
+	}
+
+	// Null for headless runs, set before anything is rendered
+	NRenderBackend Type = NRenderBackend::GL;
+
+	void Execute(const RCommandList& List);
+
+	// what the Null backend was given since ResetStats, in order
+	const vector<RRenderCommand>& GetRecording() const { return Recording; }
+	const RRenderBackendStats& GetStats() const { return Stats; }
+	void ResetStats();
+
+private:
+	void ExecuteGL(const RCommandList& List);
+	void Count(const RCommandList& List);
+
+	vector<RRenderCommand> Recording;
+	RRenderBackendStats Stats;
+};
@@ -0,0 +1,199 @@
+#include "Culling.h"
+#include "engine/core/JobSystem.h"
+#include "engine/core/Profiler.h"
+#include "engine/entities/Entity.h"
+#include "engine/world/World.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+// big enough to pass every plane test, small enough that |n| * Extent never turns into inf * 0
+constexpr float AlwaysVisibleExtent = 1e30f;
+
+RFrustum RFrustum::FromMatrix(const mat4& ViewProjection)
+{
+	// Gribb & Hartmann, with GL's -w <= z <= w clip space. glm is column major, so row i is M[*][i].
+	auto Row = [&ViewProjection](int I)
+	{
+		return vec4(ViewProjection[0][I], ViewProjection[1][I], ViewProjection[2][I], ViewProjection[3][I]);
+	};
+
+	RFrustum Frustum;
+	Frustum.Planes[0] = Row(3) + Row(0);
+	Frustum.Planes[1] = Row(3) - Row(0);
+	Frustum.Planes[2] = Row(3) + Row(1);
+	Frustum.Planes[3] = Row(3) - Row(1);
+	Frustum.Planes[4] = Row(3) + Row(2);
+	Frustum.Planes[5] = Row(3) - Row(2);
+
+	for (auto& Plane : Frustum.Planes)
+		Plane /= glm::length(vec3(Plane));
+
+	return Frustum;
+}
+
+bool RFrustum::TestBox(vec3 Center, vec3 Extent) const
+{
+	for (const auto& Plane : Planes)
+	{
+		const vec3 Normal = vec3(Plane);
+		if (dot(Normal, Center) + Plane.w + dot(abs(Normal), Extent) < 0)
+			return false;
+	}
+	return true;
+}
+
+void RCullingInput::Add(EEntity* Entity, const RBoundingBox& Box)
+{
+	vec3 Center(0.f), Extent(AlwaysVisibleExtent);
+	if (Box.MinX <= Box.MaxX)
+	{
+		Center = vec3(Box.MinX + Box.MaxX, Box.MinY + Box.MaxY, Box.MinZ + Box.MaxZ) * 0.5f;
+		Extent = vec3(Box.MaxX - Box.MinX, Box.MaxY - Box.MinY, Box.MaxZ - Box.MinZ) * 0.5f;
+	}
+
+	Entities.push_back(Entity);
+	CenterX.push_back(Center.x);
+	CenterY.push_back(Center.y);
+	CenterZ.push_back(Center.z);
+	ExtentX.push_back(Extent.x);
+	ExtentY.push_back(Extent.y);
+	ExtentZ.push_back(Extent.z);
+}
+
+void RCullingInput::Clear()
+{
+	Entities.clear();
+	CenterX.clear();
+	CenterY.clear();
+	CenterZ.clear();
+	ExtentX.clear();
+	ExtentY.clear();
+	ExtentZ.clear();
+}
+
+void CullBoxes(const RCullingInput& Input, const RFrustum* Frusta, uint FrustumCount, uint Begin, uint End, uint8* OutVisible)
+{
+	uint i = Begin;
+
+	// splat every plane once, with its absolute normal for the extent term
+	struct RPlane4
+	{
+		__m128 Nx, Ny, Nz, W, AbsNx, AbsNy, AbsNz;
+	};
+	constexpr uint MaxFrusta = 6;
+	RPlane4 Planes[MaxFrusta][6];
+	FrustumCount = std::min(FrustumCount, MaxFrusta);
+	for (uint f = 0; f < FrustumCount; f++)
+	{
+		for (uint p = 0; p < 6; p++)
+		{
+			const vec4& Plane = Frusta[f].Planes[p];
+			Planes[f][p] = {
+				_mm_set1_ps(Plane.x), _mm_set1_ps(Plane.y), _mm_set1_ps(Plane.z), _mm_set1_ps(Plane.w),
+				_mm_set1_ps(abs(Plane.x)), _mm_set1_ps(abs(Plane.y)), _mm_set1_ps(abs(Plane.z))
+			};
+		}
+	}
+
+	const __m128 Zero = _mm_setzero_ps();
+	for (; i + 4 <= End; i += 4)
+	{
+		const __m128 Cx = _mm_loadu_ps(&Input.CenterX[i]);
+		const __m128 Cy = _mm_loadu_ps(&Input.CenterY[i]);
+		const __m128 Cz = _mm_loadu_ps(&Input.CenterZ[i]);
+		const __m128 Ex = _mm_loadu_ps(&Input.ExtentX[i]);
+		const __m128 Ey = _mm_loadu_ps(&Input.ExtentY[i]);
+		const __m128 Ez = _mm_loadu_ps(&Input.ExtentZ[i]);
+
+		int VisibleMask = 0;
+		for (uint f = 0; f < FrustumCount && VisibleMask != 0xF; f++)
+		{
+			__m128 Inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+			for (const RPlane4& P : Planes[f])
+			{
+				// signed distance of the box corner furthest along the plane normal
+				__m128 Distance = _mm_add_ps(_mm_mul_ps(P.Nx, Cx), P.W);
+				Distance = _mm_add_ps(Distance, _mm_mul_ps(P.Ny, Cy));
+				Distance = _mm_add_ps(Distance, _mm_mul_ps(P.Nz, Cz));
+				Distance = _mm_add_ps(Distance, _mm_mul_ps(P.AbsNx, Ex));
+				Distance = _mm_add_ps(Distance, _mm_mul_ps(P.AbsNy, Ey));
+				Distance = _mm_add_ps(Distance, _mm_mul_ps(P.AbsNz, Ez));
+				Inside = _mm_and_ps(Inside, _mm_cmpge_ps(Distance, Zero));
+			}
+			VisibleMask |= _mm_movemask_ps(Inside);
+		}
+
+		OutVisible[i + 0] = (VisibleMask >> 0) & 1;
+		OutVisible[i + 1] = (VisibleMask >> 1) & 1;
+		OutVisible[i + 2] = (VisibleMask >> 2) & 1;
+		OutVisible[i + 3] = (VisibleMask >> 3) & 1;
+	}
+
+	for (; i < End; i++)
+	{
+		const vec3 Center(Input.CenterX[i], Input.CenterY[i], Input.CenterZ[i]);
+		const vec3 Extent(Input.ExtentX[i], Input.ExtentY[i], Input.ExtentZ[i]);
+
+		OutVisible[i] = 0;
+		for (uint f = 0; f < FrustumCount; f++)
+		{
+			if (Frusta[f].TestBox(Center, Extent))
+			{
+				OutVisible[i] = 1;
+				break;
+			}
+		}
+	}
+}
+
+void RCulling::BeginFrame()
+{
+	Input.Clear();
+	for (auto& PassStats : Stats)
+		PassStats = {};
+
+	REntityIterator It;
+	while (auto* Entity = It())
+	{
+		if (Entity->Flags & EntityFlags_InvisibleEntity)
+			continue;
+
+		// only entities with a collision mesh keep their world AABB up to date
+		Input.Add(Entity, Entity->CollisionMesh ? Entity->BoundingBox : RBoundingBox{});
+	}
+
+	VisibleFlags.resize(Input.Size());
+}
+
+const vector<EEntity*>& RCulling::Cull(NCullPass Pass, const RFrustum* Frusta, uint FrustumCount)
+{
+	PROFILE_ZONE("Frustum Culling");
+
+	const uint PassIndex = static_cast<uint>(Pass);
+	const uint Count = Input.Size();
+
+	if (Count >= ParallelThreshold)
+	{
+		RJobSystem::Get()->ParallelFor(Count, JobBatchSize, [this, Frusta, FrustumCount](uint Begin, uint End)
+		{
+			CullBoxes(Input, Frusta, FrustumCount, Begin, End, VisibleFlags.data());
+		});
+	}
+	else
+	{
+		CullBoxes(Input, Frusta, FrustumCount, 0, Count, VisibleFlags.data());
+	}
+
+	auto& PassVisible = Visible[PassIndex];
+	PassVisible.clear();
+	for (uint i = 0; i < Count; i++)
+	{
+		if (VisibleFlags[i])
+			PassVisible.push_back(Input.Entities[i]);
+	}
+
+	Stats[PassIndex].Tested += Count;
+	Stats[PassIndex].Visible += PassVisible.size();
+	return PassVisible;
+}
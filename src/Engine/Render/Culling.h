@@ -0,0 +1,85 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/collision/primitives/BoundingBox.h"
+
+/* ==========================================
+ *	Frustum Culling
+ * ========================================== */
+// Every frame the world AABBs of renderable entities are gathered once into SoA arrays, then each
+// pass tests them against its own frusta: the camera for the scene, the light space matrix for the
+// directional shadow map and the six face matrices for the point light cubemap (where a box is kept
+// if any face sees it). Boxes go 4 at a time through SSE plane tests, and big worlds are split over
+// the job system.
+//
+// Entities without a collision mesh have no world AABB, they are never culled.
+
+// Planes point inwards and are normalized: left, right, bottom, top, near, far
+struct RFrustum
+{
+	vec4 Planes[6];
+
+	static RFrustum FromMatrix(const mat4& ViewProjection);
+	bool TestBox(vec3 Center, vec3 Extent) const;
+};
+
+struct RCullingInput
+{
+	vector<EEntity*> Entities;
+	vector<float> CenterX, CenterY, CenterZ;
+	vector<float> ExtentX, ExtentY, ExtentZ;
+
+	void Add(EEntity* Entity, const RBoundingBox& Box);
+	void Clear();
+	uint Size() const { return static_cast<uint>(Entities.size()); }
+};
+
+// OutVisible[i] = 1 when box i intersects at least one of the frusta, for i in [Begin, End). Up to 6 frusta.
+void CullBoxes(const RCullingInput& Input, const RFrustum* Frusta, uint FrustumCount, uint Begin, uint End, uint8* OutVisible);
+
+enum class NCullPass : uint8
+{
+	Camera,
+	DirectionalShadow,
+	PointShadow,
+	Count
+};
+
+struct RCullingStats
+{
+	uint Tested = 0;
+	uint Visible = 0;
+
+	uint GetCulled() const { return Tested - Visible; }
+};
+
+struct RCulling
+{
+	static RCulling* Get()
+	{
+		static RCulling Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint JobBatchSize = 2048;
+	// below this a single thread finishes before the workers would have woken up
+	static constexpr uint ParallelThreshold = 8192;
+
+	// Gathers the AABBs of everything that isn't flagged invisible. Call once a frame, before the passes.
+	void BeginFrame();
+
+	// Returns the entities of this frame visible from any of the frusta. Valid until the pass is culled again.
+	const vector<EEntity*>& Cull(NCullPass Pass, const RFrustum* Frusta, uint FrustumCount);
+	const vector<EEntity*>& Cull(NCullPass Pass, const RFrustum& Frustum) { return Cull(Pass, &Frustum, 1); }
+
+	// Passes culled more than once a frame (one per atlas face) add up
+	const RCullingStats& GetStats(NCullPass Pass) const { return Stats[static_cast<uint>(Pass)]; }
+	// this frame's boxes, for systems that test them against something other than a frustum
+	const RCullingInput& GetInput() const { return Input; }
+
+private:
+	RCullingInput Input;
+	vector<uint8> VisibleFlags;
+	vector<EEntity*> Visible[static_cast<uint>(NCullPass::Count)];
+	RCullingStats Stats[static_cast<uint>(NCullPass::Count)];
+};
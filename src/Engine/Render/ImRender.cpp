@@ -1,5 +1,7 @@
 #include "ImRender.h"
 #include "Shader.h"
+#include "RenderStats.h"
+#include "RingBuffer.h"
 #include "engine/camera/camera.h"
 #include "engine/geometry/mesh.h"
 #include "engine/geometry/triangle.h"
@@ -7,17 +9,15 @@
 #include <glad/glad.h>
 #include "engine/geometry/vertex.h"
 
+#include <algorithm>
+#include <glm/gtc/packing.hpp>
+
 // ==============================
 //	Init        
 // ==============================
 void RImDraw::Init()
 {
-	List = new RImDrawElement[ImBufferSize];
-	for (int I = 0; I < ImBufferSize; I++)
-	{
-		EmptySlot(I);
-		List[I].Mesh.SetupGLBuffers();
-	}
+	glGenVertexArrays(1, &StreamVAO);
 }
 
 // ==============================
@@ -25,7 +25,7 @@ void RImDraw::Init()
 // ==============================
 void RImDraw::Update(float FrameDuration)
 {
-	for (int I = 0; I < ImBufferSize; I++)
+	for (int I = 0; I < List.size(); I++)
 	{
 		auto& Obj = List[I];
 		if (Obj.Empty)
@@ -42,39 +42,108 @@ void RImDraw::Update(float FrameDuration)
 // ==============================
 void RImDraw::Render(RCamera* Camera)
 {
-	RShader* ImPointShader = ShaderCatalogue.find("immediate_point")->second;
+	RRenderPassScope Pass(NStatsPass::ImDraw);
 	RShader* ImMeshShader = ShaderCatalogue.find("im_mesh")->second;
-	RShader* Shader = ImPointShader;
-	for (int I = 0; I < ImBufferSize; I++)
+	for (int I = 0; I < List.size(); I++)
 	{
 		auto& Obj = List[I];
-		if (Obj.Empty)
+		if (Obj.Empty || Obj.Kind != NImDrawKind::Mesh)
 			continue;
 
 		// vec3 Color = IsEqual(Obj.RRenderOptions.Color.x, -1) ? vec3(0.9, 0.2, 0.0) : Obj.RRenderOptions.Color;
 
-		if (Obj.IsMesh)
-		{
-			Shader = ImMeshShader;
-			Shader->Use();
-			if (!Obj.IsMultplByMatmodel) {
-				auto MatModel = GetMatModel(Obj.Position, Obj.Rotation, Obj.Scale);
-				Shader->SetMatrix4("model", MatModel);
-			}
-			else {
-				Shader->SetMatrix4("model", Mat4Identity);
-			}
+		RShader* Shader = ImMeshShader;
+		Shader->Use();
+		if (!Obj.IsMultplByMatmodel) {
+			auto MatModel = GetMatModel(Obj.Position, Obj.Rotation, Obj.Scale);
+			Shader->SetMatrix4(UniformIds::Model, MatModel);
 		}
 		else {
-			Shader->Use();
+			Shader->SetMatrix4(UniformIds::Model, Mat4Identity);
 		}
 
-		Shader->SetMatrix4("view", Camera->MatView);
-		Shader->SetMatrix4("projection", Camera->MatProjection);
+		Shader->SetMatrix4(UniformIds::View, Camera->MatView);
+		Shader->SetMatrix4(UniformIds::Projection, Camera->MatProjection);
 		Shader->SetFloat("opacity", Obj.RRenderOptions.Opacity);
 		Shader->SetFloat3("Color", Obj.RRenderOptions.Color);
 
-		RenderMesh(&(List[I].Mesh), Obj.RRenderOptions);
+		RenderMesh(Obj.SourceMesh ? Obj.SourceMesh : &Obj.Mesh, Obj.RRenderOptions);
+	}
+
+	// all lines and points, one upload
+	BuildStream(StreamVertices, StreamBatches);
+	if (StreamVertices.empty())
+		return;
+
+	const RRingAllocation Allocation = RDynamicBuffers::Get()->Vertices.Upload(StreamVertices.data(), StreamVertices.size() * sizeof(RImVertex), sizeof(RImVertex));
+	if (!Allocation.IsValid())
+		return;
+
+	glBindVertexArray(StreamVAO);
+	// the ring only changes buffer when it grows
+	if (StreamGeneration != Allocation.Generation)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, Allocation.Buffer);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(RImVertex), reinterpret_cast<void*>(offsetof(RImVertex, Position)));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RImVertex), reinterpret_cast<void*>(offsetof(RImVertex, Color)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(RImVertex), reinterpret_cast<void*>(offsetof(RImVertex, PointSize)));
+		glEnableVertexAttribArray(2);
+		StreamGeneration = Allocation.Generation;
+	}
+	const uint FirstVertex = Allocation.Offset / sizeof(RImVertex);
+
+	RShader* Shader = ShaderCatalogue.find("im_primitive")->second;
+	Shader->Use();
+	Shader->SetMatrix4(UniformIds::View, Camera->MatView);
+	Shader->SetMatrix4(UniformIds::Projection, Camera->MatProjection);
+
+	// always on top vertices sit on the near plane, equal depth lets them draw over each other
+	glDepthFunc(GL_LEQUAL);
+	for (const RImBatch& Batch : StreamBatches)
+	{
+		if (Batch.Mode == GL_LINES)
+			glLineWidth(Batch.LineWidth);
+		glDrawArrays(Batch.Mode, FirstVertex + Batch.FirstVertex, Batch.VertexCount);
+		RRenderStats::Get()->CountDraw(Batch.Mode, Batch.VertexCount);
+	}
+	glLineWidth(1.0);
+	glDepthFunc(GL_LESS);
+	glBindVertexArray(0);
+}
+
+void RImDraw::BuildStream(vector<RImVertex>& OutVertices, vector<RImBatch>& OutBatches)
+{
+	OutVertices.clear();
+	OutBatches.clear();
+
+	auto Append = [&OutVertices, &OutBatches](const RImDrawElement& Obj, uint Mode, float PointSize)
+	{
+		if (OutBatches.empty() || OutBatches.back().Mode != Mode || (Mode == GL_LINES && OutBatches.back().LineWidth != Obj.Size))
+			OutBatches.push_back(RImBatch{Mode, Mode == GL_LINES ? Obj.Size : 1.f, static_cast<uint>(OutVertices.size()), 0});
+
+		const uint Color = glm::packUnorm4x8(Obj.Color);
+		for (const vec3& Point : Obj.Points)
+			OutVertices.push_back(RImVertex{Point, Color, PointSize, Obj.AlwaysOnTop ? 1.f : 0.f});
+		OutBatches.back().VertexCount += Obj.Points.size();
+	};
+
+	// lines grouped by width, that's the one thing that can't change within a draw
+	vector<uint> Lines;
+	for (uint I = 0; I < List.size(); I++)
+	{
+		if (!List[I].Empty && List[I].Kind == NImDrawKind::Lines)
+			Lines.push_back(I);
+	}
+	std::stable_sort(Lines.begin(), Lines.end(), [](uint A, uint B) { return List[A].Size < List[B].Size; });
+	for (uint I : Lines)
+		Append(List[I], GL_LINES, 1.f);
+
+	for (const RImDrawElement& Obj : List)
+	{
+		if (!Obj.Empty && Obj.Kind == NImDrawKind::Points)
+			Append(Obj, GL_POINTS, Obj.Size * PointSizeInPixels);
 	}
 }
 
@@ -88,22 +157,21 @@ void RImDraw::AddEntity(uint Hash, EEntity* Entity, int Duration, RRenderOptions
 // ==============================
 void RImDraw::AddMeshWithTransform(uint _hash, RMesh* Mesh, vec3 Position, vec3 Rotation, vec3 Scale, int Duration, RRenderOptions Opts)
 {
+	if (!Enabled) return;
+
 	int Index = FindDrawElement(_hash);
 	if (Index != -1) {
 		UpdateMeshDuration(Index, Duration);
 		return;
 	}
 
-	Index = GetNewSlotIndex();
-	if (Index == -1) return;
+	Index = GetNewSlotIndex(_hash, NImDrawKind::Mesh);
 
 	auto& Obj = List[Index];
-	Obj.Hash = _hash;
 	Obj.Duration = Duration;
 	Obj.Position = Position;
 	Obj.Rotation = Rotation;
 	Obj.Scale = Scale;
-	Obj.Empty = false;
 
 	SetMesh(Index, Mesh, Opts);
 }
@@ -121,25 +189,22 @@ void RImDraw::AddMeshAtPosition(uint Hash, RMesh* Mesh, vec3 Position, int Durat
 // ==============================
 void RImDraw::AddCollisionMesh(uint _hash, RCollisionMesh* CollisionMesh, int Duration, RRenderOptions Opts)
 {
+	if (!Enabled) return;
+
 	int Index = FindDrawElement(_hash);
 	if (Index != -1) {
 		UpdateMeshDuration(Index, Duration);
 		return;
 	}
 
-	Index = GetNewSlotIndex();
-	if (Index == -1) return;
+	Index = GetNewSlotIndex(_hash, NImDrawKind::Mesh);
 	
 	auto& Obj = List[Index];
-	Obj.Hash = _hash;
 	Obj.Duration = Duration;
 	Obj.IsMultplByMatmodel = true;
 	Obj.RRenderOptions = Opts;
-	Obj.IsMesh = true;
-	Obj.Empty = false;
 
 	// Copy data from collision mesh into imdraw mesh inside slot
-	Obj.Mesh = RMesh{};
 	for (auto& Vec : CollisionMesh->Vertices) {
 		RVertex Vertex;
 		Vertex.Position = Vec;
@@ -147,26 +212,23 @@ void RImDraw::AddCollisionMesh(uint _hash, RCollisionMesh* CollisionMesh, int Du
 	}
 	Obj.Mesh.Indices = CollisionMesh->Indices;
 
-	Obj.Mesh.SetupGLData();
 	Obj.Mesh.SendDataToGLBuffer();
 }
 
 void RImDraw::AddBoundingBox(uint _hash, RBoundingBox& BoundingBox, int Duration, RRenderOptions Opts)
 {
+	if (!Enabled) return;
+
 	int Index = FindDrawElement(_hash);
 	if (Index != -1) {
 		UpdateMeshDuration(Index, Duration);
 		return;
 	}
 
-	Index = GetNewSlotIndex();
-	if (Index == -1) return;
+	Index = GetNewSlotIndex(_hash, NImDrawKind::Mesh);
 
 	auto& Obj = List[Index];
-	Obj.Hash = _hash;
 	Obj.Duration = Duration;
-	Obj.Empty = false;
-	Obj.IsMesh = true;
 	Obj.IsMultplByMatmodel = true;
 	Obj.RRenderOptions = Opts;
 	Obj.Mesh.RenderMethod = GL_TRIANGLES;
@@ -186,14 +248,8 @@ void RImDraw::AddBoundingBox(uint _hash, RBoundingBox& BoundingBox, int Duration
 // ==============================
 void RImDraw::AddLine(uint _hash, vec3 PointA, vec3 PointB, int Duration, vec3 Color, float LineWidth, bool AlwaysOnTop)
 {
-	RRenderOptions Opts;
-	Opts.LineWidth = LineWidth;
-	Opts.AlwaysOnTop = AlwaysOnTop;
-	Opts.Color = Color;
-	Opts.DontCullFace = true;
-
-	vector<RVertex> Vertices {RVertex{PointA}, RVertex{PointB}};
-	AddOrUpdateDrawElement(_hash, Vertices, Duration, Opts, GL_LINES);
+	const vec3 Points[2] = {PointA, PointB};
+	AddPrimitive(_hash, NImDrawKind::Lines, Points, 2, Duration, vec4(Color, 1.f), LineWidth, AlwaysOnTop);
 }
 
 // ==============================
@@ -201,6 +257,10 @@ void RImDraw::AddLine(uint _hash, vec3 PointA, vec3 PointB, int Duration, vec3 C
 // ==============================
 void RImDraw::AddLineLoop(uint _hash, vector<RVertex>& Vertices, int Duration, vec3 Color, RRenderOptions Opts)
 {
+	// the options' color wins when it's set
+	if (Opts.Color.x < 0.f)
+		Opts.Color = Color;
+
 	AddOrUpdateDrawElement(_hash, Vertices, Duration, Opts, GL_LINE_LOOP);
 }
 
@@ -209,13 +269,7 @@ void RImDraw::AddLineLoop(uint _hash, vector<RVertex>& Vertices, int Duration, v
 // ==============================
 void RImDraw::AddPoint(uint _hash, vec3 Point, int Duration, vec3 Color, float PointSize, bool AlwaysOnTop)
 {
-	RRenderOptions Opts;
-	Opts.PointSize = PointSize;
-	Opts.AlwaysOnTop = AlwaysOnTop;
-	Opts.Color = Color;
-
-	vector<RVertex> Vertices {RVertex{Point}};
-	AddOrUpdateDrawElement(_hash, Vertices, Duration, Opts, GL_POINTS);
+	AddPrimitive(_hash, NImDrawKind::Points, &Point, 1, Duration, vec4(Color, 1.f), PointSize, AlwaysOnTop);
 }
 
 // ==============================
@@ -243,19 +297,113 @@ void RImDraw::AddVertexList(uint _hash, vector<RVertex>& VertexVec, int Duration
 	AddOrUpdateDrawElement(_hash, VertexVec, Duration, Opts, DrawMethod);
 }
 
+// ===========================
+//	Slot Table
+// ===========================
+
+void RImSlotTable::Add(uint Hash, int Element)
+{
+	if ((Count + 1) * 2 > Slots.size())
+		Grow();
+
+	const uint Mask = static_cast<uint>(Slots.size()) - 1;
+	uint Index = Hash & Mask;
+	while (Slots[Index].Hash != 0 && Slots[Index].Hash != Hash)
+		Index = (Index + 1) & Mask;
+
+	if (Slots[Index].Hash == 0)
+		Count++;
+	Slots[Index] = RSlot{Hash, Element};
+}
+
+void RImSlotTable::Remove(uint Hash)
+{
+	if (Slots.empty())
+		return;
+
+	const uint Mask = static_cast<uint>(Slots.size()) - 1;
+	uint Hole = Hash & Mask;
+	while (Slots[Hole].Hash != Hash)
+	{
+		if (Slots[Hole].Hash == 0)
+			return;
+		Hole = (Hole + 1) & Mask;
+	}
+
+	// no tombstones: entries after the hole that probed past it move back into it
+	for (uint Next = (Hole + 1) & Mask; Slots[Next].Hash != 0; Next = (Next + 1) & Mask)
+	{
+		const uint Home = Slots[Next].Hash & Mask;
+		if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+		{
+			Slots[Hole] = Slots[Next];
+			Hole = Next;
+		}
+	}
+
+	Slots[Hole] = RSlot{};
+	Count--;
+}
+
+void RImSlotTable::Grow()
+{
+	vector<RSlot> Old = std::move(Slots);
+	Slots.assign(Old.empty() ? 64 : Old.size() * 2, RSlot{});
+	Count = 0;
+	for (const RSlot& Slot : Old)
+	{
+		if (Slot.Hash != 0)
+			Add(Slot.Hash, Slot.Element);
+	}
+}
+
 // ===========================
 //	Private Methods
 // ===========================
 
+void RImDraw::AddPrimitive(uint Hash, NImDrawKind Kind, const vec3* Points, uint PointCount, int Duration, vec4 Color, float Size, bool AlwaysOnTop)
+{
+	if (!Enabled) return;
+
+	// no GL data to keep alive, so a call with the same hash just takes the new values
+	int Index = FindDrawElement(Hash);
+	if (Index == -1 || List[Index].Kind != Kind) {
+		if (Index != -1)
+			EmptySlot(Index);
+		Index = GetNewSlotIndex(Hash, Kind);
+	}
+
+	auto& Obj = List[Index];
+	Obj.Duration = Duration;
+	Obj.Points.assign(Points, Points + PointCount);
+	Obj.Color = Color;
+	Obj.Size = Size;
+	Obj.AlwaysOnTop = AlwaysOnTop;
+}
+
 void RImDraw::EmptySlot(int Index)
 {
 	auto& Obj = List[Index];
+	if (!Obj.Empty) {
+		Slots.Remove(Obj.Hash);
+		FreeElements.push_back(Index);
+	}
+
+	// keeps the vectors' capacity for the next element using the slot
 	Obj.Mesh.Indices.clear();
 	Obj.Mesh.Vertices.clear();
+	Obj.Mesh.MarkDirty();
+	Obj.Mesh.GLData = Obj.SlotGLData;
+	Obj.Mesh.RenderMethod = GL_TRIANGLES;
+	Obj.Mesh.VertexFormat = NVertexFormat::Float;
+	Obj.Mesh.ShortIndices = false;
+	Obj.SourceMesh = nullptr;
+	Obj.Points.clear();
+	Obj.RRenderOptions = RRenderOptions{};
 	Obj.Empty = true;
 	Obj.Hash = 0;
 	Obj.Duration = 0;
-	Obj.IsMesh = false;
+	Obj.Kind = NImDrawKind::Mesh;
 	Obj.Scale = vec3(0);
 	Obj.Position = vec3(0);
 	Obj.Rotation = vec3(0);
@@ -264,51 +412,53 @@ void RImDraw::EmptySlot(int Index)
 
 int RImDraw::FindDrawElement(uint Hash)
 {
-	for (int i = 0; i < ImBufferSize; i++) {
-		if (List[i].Hash == Hash) {
-			return i;
-		}
-	}
-
-	return -1;
+	return Slots.Find(Hash);
 }
 
-int RImDraw::GetNewSlotIndex()
+int RImDraw::GetNewSlotIndex(uint Hash, NImDrawKind Kind)
 {
-	int FirstEmptyIndex = -1;
-	for (int i = 0; i < ImBufferSize; i++)
-	{
-		if (List[i].Empty) {
-			FirstEmptyIndex = i;
-			break;
-		}
+	int Index;
+	if (!FreeElements.empty()) {
+		Index = FreeElements.back();
+		FreeElements.pop_back();
+	}
+	else {
+		Index = List.size();
+		List.emplace_back();
+		List.back().Empty = true;
+		EmptySlot(Index);
 	}
 
-	if (FirstEmptyIndex == -1) {
-		Log("ImDraw buffer is full.");
+	auto& Obj = List[Index];
+	// meshes built from vertices need buffers of their own, made the first time the slot holds one
+	if (Kind == NImDrawKind::Mesh && Obj.SlotGLData.VAO == 0) {
+		Obj.Mesh.SetupGLBuffers();
+		Obj.SlotGLData = Obj.Mesh.GLData;
 	}
-	
-	return FirstEmptyIndex;
+
+	Obj.Hash = Hash;
+	Obj.Kind = Kind;
+	Obj.Empty = false;
+	Slots.Add(Hash, Index);
+	return Index;
 }
 
 void RImDraw::SetMeshFromVertices(int Index, vector<RVertex>& Vertices, GLenum DrawMethod, RRenderOptions Opts)
 {
 	auto& Obj = List[Index];
 	Obj.Mesh.Vertices = Vertices;
+	Obj.Mesh.MarkDirty();
 	Obj.Mesh.RenderMethod = DrawMethod;
 	Obj.RRenderOptions = Opts;
-	Obj.Empty = false;
 	Obj.Mesh.SendDataToGLBuffer();
 }
 
 void RImDraw::SetMesh(int Index, RMesh* Mesh, RRenderOptions Opts)
 {
+	// draws straight from the mesh's buffers, uploading into them again could change their vertex format
 	auto& Obj = List[Index];
-	Obj.Mesh = *Mesh;
+	Obj.SourceMesh = Mesh;
 	Obj.RRenderOptions = Opts;
-	Obj.IsMesh = true;
-	Obj.Empty = false;
-	Obj.Mesh.SendDataToGLBuffer();
 }
 
 void RImDraw::UpdateMeshTransform(int Index, vec3 Position, vec3 Rotation, vec3 Scale, vec3 Color, int Duration)
@@ -345,19 +495,36 @@ mat4 RImDraw::GetMatModel(vec3 Position, vec3 Rotation, vec3 Scale)
 
 void RImDraw::AddOrUpdateDrawElement(uint _hash, vector<RVertex>& Vertices, int Duration, RRenderOptions Opts, uint DrawMethod)
 {
+	if (!Enabled) return;
+
+	// lines and points go to the stream, loops as separate segments
+	if (DrawMethod == GL_LINES || DrawMethod == GL_LINE_LOOP || DrawMethod == GL_POINTS)
+	{
+		vector<vec3> Points;
+		for (uint i = 0; i < Vertices.size(); i++)
+		{
+			Points.push_back(Vertices[i].Position);
+			if (DrawMethod == GL_LINE_LOOP)
+				Points.push_back(Vertices[(i + 1) % Vertices.size()].Position);
+		}
+
+		const vec3 Color = Opts.Color.x < 0.f ? DefaultColor : Opts.Color;
+		const bool IsPoints = DrawMethod == GL_POINTS;
+		AddPrimitive(_hash, IsPoints ? NImDrawKind::Points : NImDrawKind::Lines, Points.data(), Points.size(), Duration,
+			vec4(Color, Opts.Opacity), IsPoints ? Opts.PointSize : Opts.LineWidth, Opts.AlwaysOnTop);
+		return;
+	}
+
 	int Index = FindDrawElement(_hash);
 	if (Index != -1) {
 		UpdateMeshDuration(Index, Duration);
 		return;
 	}
 
-	Index = GetNewSlotIndex();
-	if (Index == -1) return;
+	Index = GetNewSlotIndex(_hash, NImDrawKind::Mesh);
 
 	auto& Obj = List[Index];
-	Obj.Hash = _hash;
 	Obj.Duration = Duration;
-	Obj.Empty = false;
 
 	SetMeshFromVertices(Index, Vertices, DrawMethod, Opts);
-}
\ No newline at end of file
+}
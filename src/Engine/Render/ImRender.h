@@ -1,55 +1,175 @@
 #pragma once
 
-/* --------------------------- 
-   > Instructions         
+/* ---------------------------
+   > Instructions
 /* --------------------------- */
-/* 
+/*
    This module allows for adding geometric primitives to a buffer and render them each frame from anywhere in the code, mostly
    for debugging purposes. To use, simply add ImDraw::<function>(IMHASH, <args>) to your code. The IMHASH macro will expand to
    a hash calculation based on file and line of the function call. This way we can 'keep alive' the obj in the buffer if it is
    being requested to be updated, instead of clearing it and reseting it.
 
-   use IMCUSTOMHASH when you need to run ImDraw in a loop. In that case, __FILE__ and __LINE__ doesn't cut it,
+   use IM_ITERHASH(i) when you need to run ImDraw in a loop. In that case, __FILE__ and __LINE__ doesn't cut it,
    as in every iteration the item being added would be replaced because it would have the same hash always.
-   Put a prefix + i from the loop in it and you should be fine.
+   IMCUSTOMHASH(string) hashes any name you give it, at runtime.
 */
 
+/* ==========================================
+ *	Immediate Draw
+ * ========================================== */
+// IMHASH is worked out at compile time, IM_ITERHASH only mixes the loop index into it. Elements are
+// found through an open addressed table keyed by that hash and there is no fixed limit on how many
+// can be alive.
+//
+// Lines and points don't own any GL data. Every frame all of them go into the vertex ring (RingBuffer.h),
+// color, size and always on top per vertex, and draw with one call for the points and one per line
+// width in use. Meshes (AddMesh*, AddCollisionMesh, AddBoundingBox, AddVertexList with triangles)
+// draw one by one as before. AddMesh* only keeps a pointer to the mesh and draws from its buffers,
+// so the mesh has to outlive the element (catalogue meshes do), the others upload into buffers of
+// the slot's own.
+
 #include "engine/core/core.h"
 #include "renderer.h"
 #include "Engine/Geometry/Quad.h"
 #include "engine/geometry/mesh.h"
 #include "engine/utils/colors.h"
 
-#define IMCUSTOMHASH(x) ImHasher(x)
-#define IM_ITERHASH(x) ImHasher(std::string(__FILE__) + "-" + std::to_string(__LINE__) + "-" + std::to_string(x))
-#define IMHASH ImHasher(string(__FILE__) + "-" + to_string(__LINE__))
+#include <string_view>
+#include <type_traits>
+
+constexpr uint ImHashCombine(uint Hash, uint Value)
+{
+	for (uint Byte = 0; Byte < 4; Byte++)
+	{
+		Hash ^= (Value >> Byte * 8) & 0xFF;
+		Hash *= 16777619u;
+	}
+	// 0 marks empty slots
+	return Hash == 0 ? 1 : Hash;
+}
+
+// FNV-1a
+constexpr uint ImHashName(std::string_view Name)
+{
+	uint Hash = 2166136261u;
+	for (char C : Name)
+	{
+		Hash ^= static_cast<uint8>(C);
+		Hash *= 16777619u;
+	}
+	return Hash == 0 ? 1 : Hash;
+}
+
+constexpr uint ImHashCallSite(std::string_view File, uint Line)
+{
+	return ImHashCombine(ImHashName(File), Line);
+}
+
+#define IMCUSTOMHASH(x) ImHashName(x)
+#define IM_ITERHASH(x) ImHashCombine(IMHASH, static_cast<uint>(x))
+#define IMHASH (std::integral_constant<uint, ImHashCallSite(__FILE__, __LINE__)>::value)
 
 struct RRenderOptions;
-constexpr inline std::hash<std::string> ImHasher;
+
+enum class NImDrawKind : uint8
+{
+	Mesh,
+	Lines,		// pairs of points
+	Points
+};
 
 struct RImDrawElement
 {
 	uint Hash;
 	bool Empty;
+	NImDrawKind Kind;
+	int Duration;
+
+	// meshes, drawn from the slot's own buffers unless they come from elsewhere (AddMesh*)
 	RMesh Mesh;
+	const RMesh* SourceMesh;
+	RGLData SlotGLData;
 	RRenderOptions RRenderOptions;
-	int Duration;
-	bool IsMesh;
 	vec3 Position;
 	vec3 Rotation;
 	vec3 Scale;
 	bool IsMultplByMatmodel;
+
+	// lines and points
+	vector<vec3> Points;
+	vec4 Color;
+	float Size;			// line width or point size
+	bool AlwaysOnTop;
+};
+
+struct RImVertex
+{
+	vec3 Position;
+	uint Color;			// RGBA8
+	float PointSize;	// in pixels
+	float AlwaysOnTop;
+};
+
+// a run of the stream drawn with one call
+struct RImBatch
+{
+	uint Mode;			// GL_LINES or GL_POINTS
+	float LineWidth;
+	uint FirstVertex;
+	uint VertexCount;
+};
+
+// Hash to element index, linear probing over a power of two table
+struct RImSlotTable
+{
+	int Find(uint Hash) const
+	{
+		if (Slots.empty())
+			return -1;
+
+		const uint Mask = static_cast<uint>(Slots.size()) - 1;
+		for (uint Index = Hash & Mask;; Index = (Index + 1) & Mask)
+		{
+			const auto& Slot = Slots[Index];
+			if (Slot.Hash == Hash)
+				return Slot.Element;
+			if (Slot.Hash == 0)
+				return -1;
+		}
+	}
+
+	void Add(uint Hash, int Element);
+	void Remove(uint Hash);
+	uint Size() const { return Count; }
+
+private:
+	struct RSlot
+	{
+		uint Hash = 0;
+		int Element = -1;
+	};
+
+	void Grow();
+
+	vector<RSlot> Slots;
+	uint Count = 0;
 };
 
 struct RImDraw
 {
-	static constexpr int ImBufferSize = 200;
-	inline static RImDrawElement* List;
+	inline static vector<RImDrawElement> List;
+
+	// When disabled, Add* calls are no-ops. Used by headless runs (benchmarks) that have no GL context.
+	inline static bool Enabled = true;
 
 	static void Init();
 	static void Update(float FrameDuration);
 	static void Render(RCamera* Camera);
 
+	// Lays out all lines and points, lines grouped by width. GL free, for tests.
+	static void BuildStream(vector<RImVertex>& OutVertices, vector<RImBatch>& OutBatches);
+	static uint GetElementCount() { return Slots.Size(); }
+
 	// Entity
 	static void AddEntity(uint Hash, EEntity* Entity, int Duration = DefaultDuration, RRenderOptions Opts = {});
 
@@ -58,7 +178,7 @@ struct RImDraw
 	static void AddMeshAtPosition(uint Hash, RMesh* Mesh, vec3 Position, int Duration = DefaultDuration, RRenderOptions Opts = {.Wireframe =  true});
 	static void AddCollisionMesh(uint _hash, RCollisionMesh* CollisionMesh, int Duration = DefaultDuration, RRenderOptions Opts = {.Wireframe =  true, .AlwaysOnTop = true, .DontCullFace = true});
 	static void AddBoundingBox(uint _hash, RBoundingBox& BoundingBox, int Duration = DefaultDuration, RRenderOptions Opts = {.Wireframe = true, .AlwaysOnTop = true, .DontCullFace = true});
-	
+
 	// Lines
 	static void AddLine(uint Hash, vec3 PointA, vec3 PointB, int Duration = DefaultDuration, vec3 Color = vec3(0.f), float LineWidth = 2.f, bool AlwaysOnTop = true);
 	static void AddLineLoop(uint _hash, vector<RVertex>& Vertices, int Duration = DefaultDuration, vec3 Color = vec3{0.f}, RRenderOptions Opts = {});
@@ -68,13 +188,27 @@ struct RImDraw
 
 	// Quads
 	static void AddQuad(uint _hash, RQuad Quad, int Duration = DefaultDuration, vec3 Color = COLOR_BLACK, RRenderOptions Opts = RRenderOptions{});
-	
+
 	// Low level vertices
 	static void AddVertexList(uint _hash, vector<RVertex>& VertexVec, int Duration = DefaultDuration, RRenderOptions Opts = {}, GLenum DrawMethod = 4);
-	
+
 private:
 	static inline int DefaultDuration = 40;
-	
+	// the point shader used to draw every point at 10 px whatever was asked, and call sites ask for 2
+	static constexpr float PointSizeInPixels = 5.f;
+	// lines and points from RRenderOptions that don't set a color
+	inline static const vec3 DefaultColor = vec3(0.9f, 0.2f, 0.0f);
+
+	inline static RImSlotTable Slots;
+	inline static vector<int> FreeElements;
+
+	// line and point stream
+	inline static uint StreamVAO = 0;
+	inline static uint StreamGeneration = 0;	// of the ring buffer StreamVAO's attributes point into
+	inline static vector<RImVertex> StreamVertices;
+	inline static vector<RImBatch> StreamBatches;
+
+	static void AddPrimitive(uint Hash, NImDrawKind Kind, const vec3* Points, uint PointCount, int Duration, vec4 Color, float Size, bool AlwaysOnTop);
 	static void AddOrUpdateDrawElement(uint _hash, vector<RVertex>& Vertices, int Duration, RRenderOptions Opts, uint DrawMethod);
 	static void SetMeshFromVertices(int Index, vector<RVertex>& Vertices, GLenum DrawMethod, RRenderOptions Opts);
 	static void SetMesh(int Index, RMesh* Mesh, RRenderOptions Opts);
@@ -83,6 +217,6 @@ private:
 	static void UpdateMeshColor(int Index, vec3 Color);
 	static mat4 GetMatModel(vec3 Position, vec3 Rotation, vec3 Scale);
 	static void EmptySlot(int Index);
-	static int GetNewSlotIndex();
+	static int GetNewSlotIndex(uint Hash, NImDrawKind Kind);
 	static int FindDrawElement(uint Hash);
 };
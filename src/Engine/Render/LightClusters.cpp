@@ -0,0 +1,326 @@
+#include "LightClusters.h"
+#include "glad/glad.h"
+#include "LightsBuffer.h"
+#include "RenderStats.h"
+#include "Shader.h"
+#include "engine/camera/camera.h"
+#include "engine/core/JobSystem.h"
+#include "engine/entities/lights.h"
+#include "engine/world/World.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <xmmintrin.h>
+
+// the sphere tests read 4 clusters from the row start, the last row of the last slice may read past the end
+constexpr uint BoundsPadding = 3;
+
+void RLightClusters::SetProjection(const mat4& Projection, float InNear, float InFar)
+{
+	if (Projection == BoundsProjection && InNear == Near && InFar == Far)
+		return;
+
+	BoundsProjection = Projection;
+	Near = InNear;
+	Far = InFar;
+
+	// slice = log(depth) * SliceScale - SliceBias, so slice 0 starts at Near and slice DimZ at Far
+	const float LogRatio = std::log(Far / Near);
+	SliceScale = DimZ / LogRatio;
+	SliceBias = DimZ * std::log(Near) / LogRatio;
+
+	for (auto* Bounds : {&BoundsMinX, &BoundsMinY, &BoundsMinZ, &BoundsMaxX, &BoundsMaxY, &BoundsMaxZ})
+		Bounds->assign(ClusterCount + BoundsPadding, 0.f);
+
+	// x_view = x_ndc * depth / P00, the tile corners are spread the furthest at the far end of the slice
+	const float InvP00 = 1.f / Projection[0][0];
+	const float InvP11 = 1.f / Projection[1][1];
+	for (uint Z = 0; Z < DimZ; Z++)
+	{
+		const float SliceNear = Near * std::pow(Far / Near, static_cast<float>(Z) / DimZ);
+		const float SliceFar = Near * std::pow(Far / Near, static_cast<float>(Z + 1) / DimZ);
+		for (uint Y = 0; Y < DimY; Y++)
+		{
+			const float NdcMinY = -1.f + 2.f * Y / DimY;
+			const float NdcMaxY = -1.f + 2.f * (Y + 1) / DimY;
+			for (uint X = 0; X < DimX; X++)
+			{
+				const float NdcMinX = -1.f + 2.f * X / DimX;
+				const float NdcMaxX = -1.f + 2.f * (X + 1) / DimX;
+
+				const uint Cluster = GetClusterIndex(X, Y, Z);
+				BoundsMinX[Cluster] = std::min(NdcMinX * SliceNear, NdcMinX * SliceFar) * InvP00;
+				BoundsMaxX[Cluster] = std::max(NdcMaxX * SliceNear, NdcMaxX * SliceFar) * InvP00;
+				BoundsMinY[Cluster] = std::min(NdcMinY * SliceNear, NdcMinY * SliceFar) * InvP11;
+				BoundsMaxY[Cluster] = std::max(NdcMaxY * SliceNear, NdcMaxY * SliceFar) * InvP11;
+				// view space looks down -z
+				BoundsMinZ[Cluster] = -SliceFar;
+				BoundsMaxZ[Cluster] = -SliceNear;
+			}
+		}
+	}
+}
+
+uint RLightClusters::GetSlice(float Depth) const
+{
+	const int Slice = static_cast<int>(std::floor(std::log(std::max(Depth, Near)) * SliceScale - SliceBias));
+	return static_cast<uint>(std::clamp(Slice, 0, static_cast<int>(DimZ) - 1));
+}
+
+RLightClusters::RClusterRange RLightClusters::GetClusterRange(const RLightSphere& Sphere) const
+{
+	constexpr RClusterRange Empty{0, 0, 0, 0, 1, 0};
+
+	const float Depth = -Sphere.Center.z;
+	if (Sphere.Radius <= 0 || Depth + Sphere.Radius < Near || Depth - Sphere.Radius > Far)
+		return Empty;
+
+	const float NearDepth = std::max(Depth - Sphere.Radius, Near);
+	const float FarDepth = std::min(Depth + Sphere.Radius, Far);
+
+	// Screen extent of the sphere's box between NearDepth and FarDepth. Conservative, the box holds the
+	// sphere and each edge projects furthest out at whichever end of the depth range it leans to.
+	auto ProjectMin = [&](float V, float Scale) { return Scale * V / (V < 0 ? NearDepth : FarDepth); };
+	auto ProjectMax = [&](float V, float Scale) { return Scale * V / (V > 0 ? NearDepth : FarDepth); };
+
+	const float P00 = BoundsProjection[0][0];
+	const float P11 = BoundsProjection[1][1];
+	const float NdcMinX = ProjectMin(Sphere.Center.x - Sphere.Radius, P00);
+	const float NdcMaxX = ProjectMax(Sphere.Center.x + Sphere.Radius, P00);
+	const float NdcMinY = ProjectMin(Sphere.Center.y - Sphere.Radius, P11);
+	const float NdcMaxY = ProjectMax(Sphere.Center.y + Sphere.Radius, P11);
+	if (NdcMaxX < -1.f || NdcMinX > 1.f || NdcMaxY < -1.f || NdcMinY > 1.f)
+		return Empty;
+
+	auto ToTile = [](float Ndc, uint Dim)
+	{
+		const int Tile = static_cast<int>(std::floor((Ndc * 0.5f + 0.5f) * Dim));
+		return static_cast<uint>(std::clamp(Tile, 0, static_cast<int>(Dim) - 1));
+	};
+
+	RClusterRange Range;
+	Range.MinX = ToTile(NdcMinX, DimX);
+	Range.MaxX = ToTile(NdcMaxX, DimX);
+	Range.MinY = ToTile(NdcMinY, DimY);
+	Range.MaxY = ToTile(NdcMaxY, DimY);
+	Range.MinZ = GetSlice(NearDepth);
+	Range.MaxZ = GetSlice(FarDepth);
+	return Range;
+}
+
+void RLightClusters::BinSlices(const vector<RLightSphere>& Lights, const vector<RClusterRange>& Ranges, uint Capacity,
+	uint16* OutLights, uint* OutCounts, uint BeginSlice, uint EndSlice)
+{
+	const __m128 Zero = _mm_setzero_ps();
+
+	for (uint LightIndex = 0; LightIndex < Lights.size(); LightIndex++)
+	{
+		const RClusterRange& Range = Ranges[LightIndex];
+		const uint FirstSlice = std::max(Range.MinZ, BeginSlice);
+		const uint EndRangeSlice = std::min(Range.MaxZ + 1, EndSlice);
+		if (FirstSlice >= EndRangeSlice)
+			continue;
+
+		const RLightSphere& Sphere = Lights[LightIndex];
+		const __m128 CenterX = _mm_set1_ps(Sphere.Center.x);
+		const __m128 CenterY = _mm_set1_ps(Sphere.Center.y);
+		const __m128 CenterZ = _mm_set1_ps(Sphere.Center.z);
+		const __m128 RadiusSquared = _mm_set1_ps(Sphere.Radius * Sphere.Radius);
+
+		for (uint Z = FirstSlice; Z < EndRangeSlice; Z++)
+		{
+			for (uint Y = Range.MinY; Y <= Range.MaxY; Y++)
+			{
+				const uint Row = GetClusterIndex(0, Y, Z);
+				for (uint X = Range.MinX; X <= Range.MaxX; X += 4)
+				{
+					// squared distance from the sphere center to each box, 0 inside
+					const uint First = Row + X;
+					const __m128 DX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&BoundsMinX[First]), CenterX),
+						_mm_sub_ps(CenterX, _mm_loadu_ps(&BoundsMaxX[First]))), Zero);
+					const __m128 DY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&BoundsMinY[First]), CenterY),
+						_mm_sub_ps(CenterY, _mm_loadu_ps(&BoundsMaxY[First]))), Zero);
+					const __m128 DZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&BoundsMinZ[First]), CenterZ),
+						_mm_sub_ps(CenterZ, _mm_loadu_ps(&BoundsMaxZ[First]))), Zero);
+					const __m128 Distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(DX, DX), _mm_mul_ps(DY, DY)), _mm_mul_ps(DZ, DZ));
+
+					uint Mask = _mm_movemask_ps(_mm_cmple_ps(Distance, RadiusSquared));
+					// lanes past MaxX belong to other tiles (or the next row)
+					const uint Lanes = Range.MaxX - X + 1;
+					if (Lanes < 4)
+						Mask &= (1u << Lanes) - 1;
+
+					for (; Mask; Mask &= Mask - 1)
+					{
+						const uint Cluster = First + std::countr_zero(Mask);
+						uint& Count = OutCounts[Cluster];
+						if (Count < Capacity)
+							OutLights[Cluster * Capacity + Count] = static_cast<uint16>(LightIndex);
+						Count++;
+					}
+				}
+			}
+		}
+	}
+}
+
+void RLightClusters::Bin(const vector<RLightSphere>& PointLights, const vector<RLightSphere>& SpotLights)
+{
+	Stats = {};
+	Stats.PointLights = PointLights.size();
+	Stats.SpotLights = SpotLights.size();
+
+	assert(!BoundsMinX.empty() && "SetProjection has to be called before binning");
+	// indices go out as 16 bit
+	assert(PointLights.size() <= 0xFFFF && SpotLights.size() <= 0xFFFF);
+
+	PointRanges.resize(PointLights.size());
+	for (uint i = 0; i < PointLights.size(); i++)
+		PointRanges[i] = GetClusterRange(PointLights[i]);
+	SpotRanges.resize(SpotLights.size());
+	for (uint i = 0; i < SpotLights.size(); i++)
+		SpotRanges[i] = GetClusterRange(SpotLights[i]);
+
+	PointSlots.resize(ClusterCount * MaxPointLightsPerCluster);
+	SpotSlots.resize(ClusterCount * MaxSpotLightsPerCluster);
+	PointCounts.assign(ClusterCount, 0);
+	SpotCounts.assign(ClusterCount, 0);
+
+	// each batch owns whole slices, nothing is shared between jobs
+	auto BinRange = [&](uint BeginSlice, uint EndSlice)
+	{
+		BinSlices(PointLights, PointRanges, MaxPointLightsPerCluster, PointSlots.data(), PointCounts.data(), BeginSlice, EndSlice);
+		BinSlices(SpotLights, SpotRanges, MaxSpotLightsPerCluster, SpotSlots.data(), SpotCounts.data(), BeginSlice, EndSlice);
+	};
+
+	if (PointLights.size() + SpotLights.size() >= ParallelThreshold)
+		RJobSystem::Get()->ParallelFor(DimZ, 1, BinRange);
+	else
+		BinRange(0, DimZ);
+
+	Grid.resize(ClusterCount * 2);
+	Indices.clear();
+	for (uint Cluster = 0; Cluster < ClusterCount; Cluster++)
+	{
+		const uint PointCount = std::min(PointCounts[Cluster], MaxPointLightsPerCluster);
+		const uint SpotCount = std::min(SpotCounts[Cluster], MaxSpotLightsPerCluster);
+
+		Grid[Cluster * 2] = Indices.size();
+		Grid[Cluster * 2 + 1] = PointCount | SpotCount << 16;
+
+		const uint16* Points = &PointSlots[Cluster * MaxPointLightsPerCluster];
+		Indices.insert(Indices.end(), Points, Points + PointCount);
+		const uint16* Spots = &SpotSlots[Cluster * MaxSpotLightsPerCluster];
+		Indices.insert(Indices.end(), Spots, Spots + SpotCount);
+
+		const uint Total = PointCounts[Cluster] + SpotCounts[Cluster];
+		Stats.Assignments += Total;
+		Stats.Dropped += Total - PointCount - SpotCount;
+		Stats.MaxLightsInCluster = std::max(Stats.MaxLightsInCluster, Total);
+		if (Total > 0)
+			Stats.OccupiedClusters++;
+	}
+}
+
+RLightSphere RLightClusters::GetPointLightBounds(const EPointLight& Light, const mat4& View)
+{
+	RLightSphere Sphere;
+	Sphere.Center = vec3(View * vec4(Light.Position, 1.f));
+	Sphere.Radius = GetLightAttenuationRange(Light.IntensityConstant, Light.IntensityLinear, Light.IntensityQuadratic,
+		Light.Diffuse, LightCutoff, MaxLightRange);
+	return Sphere;
+}
+
+RLightSphere RLightClusters::GetSpotLightBounds(const ESpotLight& Light, const mat4& View)
+{
+	const float Range = GetLightAttenuationRange(Light.IntensityConstant, Light.IntensityLinear, Light.IntensityQuadratic,
+		Light.Diffuse, LightCutoff, MaxLightRange);
+
+	// The lit part is the cone of half angle acos(Outercone) cut off by the range sphere around the apex.
+	// For narrow cones the sphere through the apex and the rim of that cap is tighter than the range
+	// sphere: its center sits at Range / (2 cos) down the axis. Past 60 degrees it isn't anymore.
+	const float Cos = std::clamp(Light.Outercone, 0.f, 1.f);
+	const vec3 Direction = glm::length(Light.Direction) > 0 ? glm::normalize(Light.Direction) : vec3(0, -1, 0);
+
+	vec3 Center = Light.Position;
+	float Radius = Range;
+	if (Cos > 0.5f)
+	{
+		Radius = Range / (2.f * Cos);
+		Center = Light.Position + Direction * Radius;
+	}
+
+	return RLightSphere{vec3(View * vec4(Center, 1.f)), Radius};
+}
+
+void RLightClusters::Update(RWorld* World, RCamera* Camera)
+{
+	SetProjection(Camera->MatProjection, Camera->NearPlane, Camera->FarPlane);
+
+	PointSpheres.clear();
+	for (uint i = 0; i < std::min<uint>(World->PointLights.size(), RMaxPointLights); i++)
+		PointSpheres.push_back(GetPointLightBounds(*World->PointLights[i], Camera->MatView));
+
+	SpotSpheres.clear();
+	for (uint i = 0; i < std::min<uint>(World->SpotLights.size(), RMaxSpotLights); i++)
+		SpotSpheres.push_back(GetSpotLightBounds(*World->SpotLights[i], Camera->MatView));
+
+	Bin(PointSpheres, SpotSpheres);
+	Upload();
+}
+
+void RLightClusters::Upload()
+{
+	if (GridBuffer == 0)
+	{
+		glGenBuffers(1, &GridBuffer);
+		glGenBuffers(1, &IndicesBuffer);
+		glGenTextures(1, &GridTexture);
+		glGenTextures(1, &IndicesTexture);
+
+		// texture buffers follow their buffer's data store, so attaching once is enough
+		glBindBuffer(GL_TEXTURE_BUFFER, GridBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, Grid.size() * sizeof(uint), nullptr, GL_STREAM_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, GridTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, GridBuffer);
+
+		glBindBuffer(GL_TEXTURE_BUFFER, IndicesBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(uint16), nullptr, GL_STREAM_DRAW);
+		glBindTexture(GL_TEXTURE_BUFFER, IndicesTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, IndicesBuffer);
+
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	// orphan and refill, the driver hands out fresh storage instead of waiting on last frame's draws
+	glBindBuffer(GL_TEXTURE_BUFFER, GridBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, Grid.size() * sizeof(uint), Grid.data(), GL_STREAM_DRAW);
+
+	// an empty data store isn't a valid texture buffer, keep at least one index around
+	static const uint16 NoIndex = 0;
+	glBindBuffer(GL_TEXTURE_BUFFER, IndicesBuffer);
+	if (Indices.empty())
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(uint16), &NoIndex, GL_STREAM_DRAW);
+	else
+		glBufferData(GL_TEXTURE_BUFFER, Indices.size() * sizeof(uint16), Indices.data(), GL_STREAM_DRAW);
+
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	RRenderStats::Get()->CountUpload(Grid.size() * sizeof(uint) + std::max<size_t>(Indices.size(), 1) * sizeof(uint16));
+}
+
+void RLightClusters::SetShaderVariables(RShader* Shader, float ViewportWidth, float ViewportHeight) const
+{
+	Shader->SetFloat4("cluster_params", DimX / ViewportWidth, DimY / ViewportHeight, SliceScale, SliceBias);
+	Shader->SetFloat2("cluster_planes", Near, Far);
+}
+
+void RLightClusters::BindTextures(uint GridUnit, uint IndicesUnit) const
+{
+	glActiveTexture(GL_TEXTURE0 + GridUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, GridTexture);
+	glActiveTexture(GL_TEXTURE0 + IndicesUnit);
+	glBindTexture(GL_TEXTURE_BUFFER, IndicesTexture);
+	RRenderStats::Get()->CountTextureBind();
+	RRenderStats::Get()->CountTextureBind();
+}
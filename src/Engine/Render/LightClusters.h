@@ -0,0 +1,126 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+/* ==========================================
+ *	Clustered Light Assignment
+ * ========================================== */
+// The view frustum is cut in DimX x DimY screen tiles and DimZ depth slices, exponentially spaced
+// between the camera near and far planes. Every frame each point light's range sphere, and the
+// bounding sphere of each spot light's cone, is binned into the clusters it touches. The lit shaders
+// find their cluster from gl_FragCoord and only visit the lights listed for it. Directional lights
+// reach everything and are still looped over directly.
+//
+// GL 3.3 has no storage buffers, so the result goes up as two buffer textures: the grid, one RG32UI
+// texel per cluster (offset into the index list, point count | spot count << 16), and the light
+// index list, R16UI, each cluster's point lights followed by its spot lights.
+//
+// Binning is split over the job system by depth slice. Every job walks the lights in the same order
+// and only writes its own slices, so the output doesn't depend on thread count or timing, and
+// within a cluster lights are always sorted by index. Clusters are tested 4 at a time with SSE.
+// Lights past the per cluster capacity are dropped (and counted in the stats).
+
+struct RLightSphere
+{
+	vec3 Center;				// view space
+	float Radius;
+};
+
+struct RLightClusterStats
+{
+	uint PointLights = 0;
+	uint SpotLights = 0;
+	uint Assignments = 0;		// light / cluster pairs
+	uint OccupiedClusters = 0;
+	uint MaxLightsInCluster = 0;
+	uint Dropped = 0;			// assignments past the cluster capacity
+};
+
+struct RLightClusters
+{
+	static RLightClusters* Get()
+	{
+		static RLightClusters Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint DimX = 16;
+	static constexpr uint DimY = 9;
+	static constexpr uint DimZ = 24;
+	static constexpr uint ClusterCount = DimX * DimY * DimZ;
+	static constexpr uint MaxPointLightsPerCluster = 64;
+	static constexpr uint MaxSpotLightsPerCluster = 32;
+	// binning goes wide from this many lights on, below it the jobs cost more than they save
+	static constexpr uint ParallelThreshold = 64;
+	// a light stops counting for a cluster once its attenuation drops below this, invisible in 8 bit color
+	static constexpr float LightCutoff = 1.f / 256.f;
+	static constexpr float MaxLightRange = 200.f;
+
+	// Rebuilds the cluster bounds when the projection changed. Projection must be a symmetric perspective.
+	void SetProjection(const mat4& Projection, float Near, float Far);
+
+	// Bins view space spheres into the clusters. GL free, this is what the tests and benchmarks call.
+	void Bin(const vector<RLightSphere>& PointLights, const vector<RLightSphere>& SpotLights);
+
+	// Binning for the scene: bounds the world's lights in view space, bins them and uploads the result
+	void Update(RWorld* World, RCamera* Camera);
+
+	// Per frame uniforms the lit shaders need to find their cluster
+	void SetShaderVariables(RShader* Shader, float ViewportWidth, float ViewportHeight) const;
+	// Binds the grid and index buffer textures. Leaves IndicesUnit as the active unit.
+	void BindTextures(uint GridUnit, uint IndicesUnit) const;
+	// buffer textures, bind them to GL_TEXTURE_BUFFER
+	uint GetGridTexture() const { return GridTexture; }
+	uint GetIndicesTexture() const { return IndicesTexture; }
+
+	static uint GetClusterIndex(uint X, uint Y, uint Z) { return (Z * DimY + Y) * DimX + X; }
+	uint GetSlice(float Depth) const;
+
+	// 2 uints per cluster: offset into GetIndices, point count | spot count << 16
+	const vector<uint>& GetGrid() const { return Grid; }
+	const vector<uint16>& GetIndices() const { return Indices; }
+	const RLightClusterStats& GetStats() const { return Stats; }
+
+	static RLightSphere GetPointLightBounds(const EPointLight& Light, const mat4& View);
+	static RLightSphere GetSpotLightBounds(const ESpotLight& Light, const mat4& View);
+
+private:
+	// screen tiles and slices a sphere may touch, inclusive. Empty when MinZ > MaxZ.
+	struct RClusterRange
+	{
+		uint MinX, MaxX, MinY, MaxY, MinZ, MaxZ;
+	};
+
+	RClusterRange GetClusterRange(const RLightSphere& Sphere) const;
+	void BinSlices(const vector<RLightSphere>& Lights, const vector<RClusterRange>& Ranges, uint Capacity,
+		uint16* OutLights, uint* OutCounts, uint BeginSlice, uint EndSlice);
+
+	void Upload();
+
+	// view space cluster bounds, SoA so the sphere tests can load 4 neighbours along x at once
+	vector<float> BoundsMinX, BoundsMinY, BoundsMinZ;
+	vector<float> BoundsMaxX, BoundsMaxY, BoundsMaxZ;
+	mat4 BoundsProjection{0.f};
+	float Near = 0;
+	float Far = 0;
+	float SliceScale = 0;
+	float SliceBias = 0;
+
+	vector<RLightSphere> PointSpheres;
+	vector<RLightSphere> SpotSpheres;
+	vector<RClusterRange> PointRanges;
+	vector<RClusterRange> SpotRanges;
+	vector<uint16> PointSlots;			// MaxPointLightsPerCluster per cluster
+	vector<uint16> SpotSlots;			// MaxSpotLightsPerCluster per cluster
+	vector<uint> PointCounts;			// unclamped, so overflows can be counted
+	vector<uint> SpotCounts;
+
+	vector<uint> Grid;
+	vector<uint16> Indices;
+	RLightClusterStats Stats;
+
+	uint GridBuffer = 0;
+	uint GridTexture = 0;
+	uint IndicesBuffer = 0;
+	uint IndicesTexture = 0;
+};
@@ -0,0 +1,134 @@
+#include "LightsBuffer.h"
+#include "glad/glad.h"
+#include "RenderStats.h"
+#include "Shader.h"
+#include "engine/entities/lights.h"
+#include "engine/world/World.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+float GetLightAttenuationRange(float Constant, float Linear, float Quadratic, vec3 Diffuse, float Cutoff, float MaxRange)
+{
+	const float Brightness = std::max(std::max(Diffuse.x, Diffuse.y), Diffuse.z);
+	const float C = Constant - Brightness / Cutoff;
+
+	float Range = MaxRange;
+	if (C >= 0)
+		Range = 0;
+	else if (Quadratic > 0)
+		Range = (-Linear + std::sqrt(Linear * Linear - 4 * Quadratic * C)) / (2 * Quadratic);
+	else if (Linear > 0)
+		Range = -C / Linear;
+
+	return std::min(Range, MaxRange);
+}
+
+void RLightsBuffer::CreateBlock(RLightBlock& Block, uint Binding, uint Size)
+{
+	glGenBuffers(1, &Block.UBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, Block.UBO);
+	glBufferData(GL_UNIFORM_BUFFER, Size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, Binding, Block.UBO);
+
+	// a zero count is all the shaders look at before the first upload
+	const int Count = 0;
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(int), &Count);
+	Block.UploadedCount = 0;
+}
+
+template<typename TGpuLight, typename TLight, typename TPackFunc>
+uint RLightsBuffer::UploadBlock(RLightBlock& Block, const vector<TLight*>& Lights, uint MaxLights, RLightDirtyRange& Dirty, TPackFunc Pack)
+{
+	const uint Count = std::min(static_cast<uint>(Lights.size()), MaxLights);
+	uint UploadSize = 0;
+
+	if (!Dirty.IsDirty() && Count == Block.UploadedCount)
+		return 0;
+
+	glBindBuffer(GL_UNIFORM_BUFFER, Block.UBO);
+
+	// lights appended without being marked still need to go up
+	if (Count > Block.UploadedCount)
+		Dirty.MarkFrom(Block.UploadedCount);
+
+	const uint Begin = Dirty.Begin;
+	const uint End = std::min(Dirty.End, Count);
+	if (Begin < End)
+	{
+		Staging.resize((End - Begin) * sizeof(TGpuLight));
+		auto* GpuLights = reinterpret_cast<TGpuLight*>(Staging.data());
+		for (uint Index = Begin; Index < End; Index++)
+		{
+			TGpuLight& GpuLight = GpuLights[Index - Begin];
+			std::memset(&GpuLight, 0, sizeof(TGpuLight));
+			Pack(*Lights[Index], GpuLight);
+		}
+
+		glBufferSubData(GL_UNIFORM_BUFFER, RLightBlockHeaderSize + Begin * sizeof(TGpuLight), Staging.size(), Staging.data());
+		UploadSize += Staging.size();
+	}
+
+	if (Count != Block.UploadedCount)
+	{
+		const int GpuCount = static_cast<int>(Count);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(int), &GpuCount);
+		Block.UploadedCount = Count;
+		UploadSize += sizeof(int);
+	}
+
+	Dirty.Reset();
+	RRenderStats::Get()->CountUpload(UploadSize);
+	return UploadSize;
+}
+
+void RLightsBuffer::Update(RWorld* World)
+{
+	if (!Initialized)
+	{
+		CreateBlock(PointBlock, UniformBlockBindings::PointLights, RLightBlockHeaderSize + RMaxPointLights * sizeof(RGpuPointLight));
+		CreateBlock(SpotBlock, UniformBlockBindings::SpotLights, RLightBlockHeaderSize + RMaxSpotLights * sizeof(RGpuSpotLight));
+		CreateBlock(DirectionalBlock, UniformBlockBindings::DirectionalLights,
+			RLightBlockHeaderSize + RMaxDirectionalLights * sizeof(RGpuDirectionalLight));
+		World->MarkLightsDirty();
+		Initialized = true;
+	}
+
+	LastUploadSize = 0;
+
+	LastUploadSize += UploadBlock<RGpuPointLight>(PointBlock, World->PointLights, RMaxPointLights, World->PointLightsDirty,
+		[](const EPointLight& Light, RGpuPointLight& GpuLight)
+		{
+			GpuLight.Position = Light.Position;
+			GpuLight.Diffuse = Light.Diffuse;
+			GpuLight.Specular = Light.Specular;
+			GpuLight.Constant = Light.IntensityConstant;
+			GpuLight.Linear = Light.IntensityLinear;
+			GpuLight.Quadratic = Light.IntensityQuadratic;
+		});
+
+	LastUploadSize += UploadBlock<RGpuSpotLight>(SpotBlock, World->SpotLights, RMaxSpotLights, World->SpotLightsDirty,
+		[](const ESpotLight& Light, RGpuSpotLight& GpuLight)
+		{
+			GpuLight.Position = Light.Position;
+			GpuLight.Direction = Light.Direction;
+			GpuLight.Diffuse = Light.Diffuse;
+			GpuLight.Specular = Light.Specular;
+			GpuLight.Innercone = Light.Innercone;
+			GpuLight.Outercone = Light.Outercone;
+			GpuLight.Constant = Light.IntensityConstant;
+			GpuLight.Linear = Light.IntensityLinear;
+			GpuLight.Quadratic = Light.IntensityQuadratic;
+		});
+
+	LastUploadSize += UploadBlock<RGpuDirectionalLight>(DirectionalBlock, World->DirectionalLights, RMaxDirectionalLights,
+		World->DirectionalLightsDirty, [](const EDirectionalLight& Light, RGpuDirectionalLight& GpuLight)
+		{
+			GpuLight.Direction = Light.Direction;
+			GpuLight.Diffuse = Light.Diffuse;
+			GpuLight.Specular = Light.Specular;
+		});
+
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+struct RLightDirtyRange;
+
+/* ==========================================
+ *	Lights Buffer
+ * ========================================== */
+// Scene lights live in three std140 uniform buffers, one per light type, bound to fixed binding
+// points that every lit program's light blocks get attached to when linked (see
+// RShader::ReflectUniforms). Each buffer holds the light count in its first 16 bytes followed by
+// the light array, matching the blocks in fragment_multiple_lights.shd.
+//
+// Update only re-uploads the dirty range of each buffer, so a frame where no light changed costs
+// nothing. The limits are picked so every block stays below the 16KB GL guarantees for
+// GL_MAX_UNIFORM_BLOCK_SIZE.
+
+// must match the MAX_*_LIGHT_SOURCES defines in the lit shaders, lights past these are ignored
+constexpr uint RMaxPointLights = 256;
+constexpr uint RMaxSpotLights = 128;
+constexpr uint RMaxDirectionalLights = 32;
+
+// Distance at which Constant + Linear * d + Quadratic * d^2 grows past the brightest channel of Diffuse
+// over Cutoff, i.e. where the light's contribution drops below Cutoff. 0 when it never reaches Cutoff,
+// MaxRange when it doesn't fall off.
+float GetLightAttenuationRange(float Constant, float Linear, float Quadratic, vec3 Diffuse, float Cutoff, float MaxRange);
+
+// std140 mirrors of the GLSL structs: every float sits in the padding after a vec3
+struct RGpuPointLight
+{
+	vec3 Position;
+	float Constant;
+	vec3 Diffuse;
+	float Linear;
+	vec3 Specular;
+	float Quadratic;
+};
+
+struct RGpuSpotLight
+{
+	vec3 Position;
+	float Innercone;
+	vec3 Direction;
+	float Outercone;
+	vec3 Diffuse;
+	float Constant;
+	vec3 Specular;
+	float Linear;
+	float Quadratic;
+	float Padding[3];
+};
+
+struct RGpuDirectionalLight
+{
+	vec3 Direction;
+	float Padding0;
+	vec3 Diffuse;
+	float Padding1;
+	vec3 Specular;
+	float Padding2;
+};
+
+static_assert(sizeof(RGpuPointLight) == 48);
+static_assert(sizeof(RGpuSpotLight) == 80);
+static_assert(sizeof(RGpuDirectionalLight) == 48);
+
+// the count is an int padded to a vec4, arrays of structs start at the next 16 byte boundary
+constexpr uint RLightBlockHeaderSize = 16;
+
+static_assert(RLightBlockHeaderSize + RMaxPointLights * sizeof(RGpuPointLight) <= 16384);
+static_assert(RLightBlockHeaderSize + RMaxSpotLights * sizeof(RGpuSpotLight) <= 16384);
+static_assert(RLightBlockHeaderSize + RMaxDirectionalLights * sizeof(RGpuDirectionalLight) <= 16384);
+
+struct RLightsBuffer
+{
+	static RLightsBuffer* Get()
+	{
+		static RLightsBuffer Instance{};
+		return &Instance;
+	}
+
+	// Creates the buffers on first use, then uploads whatever the world marked dirty
+	void Update(RWorld* World);
+
+	// bytes sent to the GPU by the last Update
+	uint GetLastUploadSize() const { return LastUploadSize; }
+
+private:
+	struct RLightBlock
+	{
+		uint UBO = 0;
+		uint UploadedCount = 0;
+	};
+
+	template<typename TGpuLight, typename TLight, typename TPackFunc>
+	uint UploadBlock(RLightBlock& Block, const vector<TLight*>& Lights, uint MaxLights, RLightDirtyRange& Dirty, TPackFunc Pack);
+
+	void CreateBlock(RLightBlock& Block, uint Binding, uint Size);
+
+	RLightBlock PointBlock;
+	RLightBlock SpotBlock;
+	RLightBlock DirectionalBlock;
+	vector<uint8> Staging;
+	uint LastUploadSize = 0;
+	bool Initialized = false;
+};
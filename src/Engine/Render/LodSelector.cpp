@@ -0,0 +1,77 @@
+#include "LodSelector.h"
+#include "RenderQueue.h"
+#include "engine/camera/camera.h"
+#include "engine/entities/Entity.h"
+#include "engine/geometry/mesh.h"
+
+#include <algorithm>
+
+void RLodSelector::BeginFrame(const RCamera* Camera, float ViewportHeight)
+{
+	CameraPosition = Camera->Position;
+	PixelsPerUnitAtOne = ViewportHeight * 0.5f / std::tan(glm::radians(Camera->FovY) * 0.5f);
+	Stats = {};
+}
+
+float RLodSelector::GetPixelsPerUnit(const EEntity* Entity) const
+{
+	const RMeshLods& Lods = Entity->Mesh->Lods;
+	const mat4& Model = Entity->MatModel;
+	const float Scale = std::max({glm::length(vec3(Model[0])), glm::length(vec3(Model[1])), glm::length(vec3(Model[2]))});
+
+	// from the surface of the bounding sphere, the camera being inside it means full detail
+	const vec3 Center = vec3(Model * vec4(Lods.Center, 1.f));
+	const float Distance = glm::length(Center - CameraPosition) - Lods.Radius * Scale;
+	if (Distance <= 0.f)
+		return MaxFloat;
+
+	return PixelsPerUnitAtOne * Scale / Distance;
+}
+
+uint RLodSelector::SelectLod(const RMesh* Mesh, float PixelsPerUnit, uint CurrentLod, float PixelError, float Hysteresis)
+{
+	// errors only grow with the LOD, so the first one that fits from the coarse end is the coarsest
+	for (uint Lod = Mesh->GetLodCount() - 1; Lod > 0; Lod--)
+	{
+		const float Threshold = Lod > CurrentLod ? PixelError * (1.f - Hysteresis) : PixelError;
+		if (Mesh->GetLod(Lod).Error * PixelsPerUnit <= Threshold)
+			return Lod;
+	}
+	return 0;
+}
+
+uint RLodSelector::Select(const EEntity* Entity) const
+{
+	if (!Enabled || !Entity->Mesh || Entity->Mesh->GetLodCount() == 1)
+		return 0;
+
+	return SelectLod(Entity->Mesh, GetPixelsPerUnit(Entity), Entity->Lod, PixelError, Hysteresis);
+}
+
+uint RLodSelector::SelectSceneLod(EEntity* Entity)
+{
+	Entity->Lod = Select(Entity);
+	return Entity->Lod;
+}
+
+uint RLodSelector::SelectShadowLod(const EEntity* Entity) const
+{
+	if (!Enabled || !Entity->Mesh)
+		return 0;
+
+	return std::min(Select(Entity) + ShadowLodBias, Entity->Mesh->GetLodCount() - 1);
+}
+
+void RLodSelector::CountSubmitted(NSubmitMode Mode, const RRenderQueueStats& QueueStats)
+{
+	if (Mode == NSubmitMode::Lit)
+	{
+		Stats.SceneTriangles += QueueStats.Triangles;
+		Stats.SceneFullTriangles += QueueStats.FullDetailTriangles;
+	}
+	else
+	{
+		Stats.ShadowTriangles += QueueStats.Triangles;
+		Stats.ShadowFullTriangles += QueueStats.FullDetailTriangles;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+struct RRenderQueueStats;
+enum class NSubmitMode : uint8;
+
+/* ==========================================
+ *	LOD Selection
+ * ========================================== */
+// Picks which of a mesh's LODs (see RMeshLods) to draw. Each LOD knows how far, in model units, it
+// strays from the full mesh. Scaled by the entity and projected at its distance from the camera that
+// becomes an error in pixels, and the coarsest LOD under PixelError wins.
+//
+// To keep meshes from flickering between two LODs at the switch distance, going coarser needs the
+// error to be Hysteresis under PixelError, going finer happens once the current LOD goes over it. The
+// scene pass keeps the LOD it drew on the entity for that.
+//
+// Shadow passes start from the scene's choice and go ShadowLodBias levels coarser, shadow maps are
+// lower resolution than the screen anyway. The shadow caches hash the shadow LOD of their casters, so
+// cached maps are redrawn when the camera moves a caster to another LOD. Static batches always draw
+// the full meshes.
+
+struct RLodStats
+{
+	// triangles submitted this frame, and what they would have been at LOD 0
+	uint SceneTriangles = 0;
+	uint SceneFullTriangles = 0;
+	uint ShadowTriangles = 0;
+	uint ShadowFullTriangles = 0;
+};
+
+struct RLodSelector
+{
+	static RLodSelector* Get()
+	{
+		static RLodSelector Instance{};
+		return &Instance;
+	}
+
+	// when off everything draws LOD 0
+	bool Enabled = true;
+	float PixelError = 1.f;
+	// fraction of PixelError
+	float Hysteresis = 0.25f;
+	uint ShadowLodBias = 1;
+
+	// Takes the camera for this frame's selections and clears the stats. Call before the shadow passes.
+	void BeginFrame(const RCamera* Camera, float ViewportHeight);
+
+	// LOD for the scene pass, remembered on the entity for the hysteresis
+	uint SelectSceneLod(EEntity* Entity);
+	uint SelectShadowLod(const EEntity* Entity) const;
+
+	// Adds a submitted queue's triangle counts to the frame stats
+	void CountSubmitted(NSubmitMode Mode, const RRenderQueueStats& QueueStats);
+	const RLodStats& GetStats() const { return Stats; }
+
+	// Coarsest LOD whose error, times PixelsPerUnit, stays under the threshold for it. GL free, for tests and benchmarks.
+	static uint SelectLod(const RMesh* Mesh, float PixelsPerUnit, uint CurrentLod, float PixelError, float Hysteresis);
+
+private:
+	// pixels one world unit covers at the entity's distance, scaled into the entity's model units
+	float GetPixelsPerUnit(const EEntity* Entity) const;
+	uint Select(const EEntity* Entity) const;
+
+	vec3 CameraPosition = vec3(0.f);
+	float PixelsPerUnitAtOne = 0;	// at a distance of one unit
+	RLodStats Stats;
+};
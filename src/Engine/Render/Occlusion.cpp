@@ -0,0 +1,363 @@
+#include "Occlusion.h"
+#include "engine/collision/CollisionMesh.h"
+#include "engine/core/JobSystem.h"
+#include "engine/core/Profiler.h"
+#include "engine/entities/Entity.h"
+#include "engine/geometry/mesh.h"
+#include "engine/io/loaders.h"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+// triangles smaller than this, in pixels squared, can't cover a pixel center worth writing
+constexpr float MinTriangleArea = 1e-6f;
+
+void ROcclusionCulling::Begin(const mat4& InViewProjection)
+{
+	ViewProjection = InViewProjection;
+	Stats = {};
+
+	if (Levels.empty())
+	{
+		uint LevelWidth = Width, LevelHeight = Height;
+		while (true)
+		{
+			RDepthLevel& Level = Levels.emplace_back();
+			Level.Width = LevelWidth;
+			Level.Height = LevelHeight;
+			Level.Depth.resize(LevelWidth * LevelHeight);
+
+			if (LevelWidth == 1 && LevelHeight == 1)
+				break;
+			LevelWidth = std::max(LevelWidth / 2, 1u);
+			LevelHeight = std::max(LevelHeight / 2, 1u);
+		}
+	}
+
+	std::fill(Levels[0].Depth.begin(), Levels[0].Depth.end(), 1.f);
+}
+
+void ROcclusionCulling::RasterizeOccluder(const RCollisionMesh& Mesh, const mat4& MatModel)
+{
+	const mat4 Transform = ViewProjection * MatModel;
+	ClipVertices.resize(Mesh.Vertices.size());
+	for (size_t i = 0; i < Mesh.Vertices.size(); i++)
+		ClipVertices[i] = Transform * vec4(Mesh.Vertices[i], 1.f);
+
+	RasterizeClipTriangles(Mesh.Indices);
+}
+
+void ROcclusionCulling::RasterizeOccluder(const RMesh& Mesh, const mat4& MatModel)
+{
+	const mat4 Transform = ViewProjection * MatModel;
+	ClipVertices.resize(Mesh.Vertices.size());
+	for (size_t i = 0; i < Mesh.Vertices.size(); i++)
+		ClipVertices[i] = Transform * vec4(Mesh.Vertices[i].Position, 1.f);
+
+	RasterizeClipTriangles(Mesh.Indices);
+}
+
+void ROcclusionCulling::RasterizeClipTriangles(const vector<uint>& Indices)
+{
+	Stats.Occluders++;
+	for (size_t i = 0; i + 2 < Indices.size(); i += 3)
+	{
+		const vec4 Triangle[3] = {ClipVertices[Indices[i]], ClipVertices[Indices[i + 1]], ClipVertices[Indices[i + 2]]};
+		Stats.OccluderTriangles++;
+
+		// all three outside the same side plane, or beyond the far plane
+		auto AllOutside = [&Triangle](auto&& Outside)
+		{
+			return Outside(Triangle[0]) && Outside(Triangle[1]) && Outside(Triangle[2]);
+		};
+		if (AllOutside([](const vec4& V) { return V.x > V.w; }) || AllOutside([](const vec4& V) { return V.x < -V.w; }) ||
+			AllOutside([](const vec4& V) { return V.y > V.w; }) || AllOutside([](const vec4& V) { return V.y < -V.w; }) ||
+			AllOutside([](const vec4& V) { return V.z > V.w; }))
+			continue;
+
+		// clip against the near plane, z >= -w, which leaves a triangle or a quad
+		vec4 Polygon[4];
+		uint PolygonSize = 0;
+		for (uint Edge = 0; Edge < 3; Edge++)
+		{
+			const vec4& From = Triangle[Edge];
+			const vec4& To = Triangle[(Edge + 1) % 3];
+			const float FromDistance = From.z + From.w;
+			const float ToDistance = To.z + To.w;
+
+			if (FromDistance >= 0)
+				Polygon[PolygonSize++] = From;
+			if ((FromDistance >= 0) != (ToDistance >= 0))
+				Polygon[PolygonSize++] = From + (To - From) * (FromDistance / (FromDistance - ToDistance));
+		}
+
+		for (uint Vertex = 2; Vertex < PolygonSize; Vertex++)
+			RasterizeTriangle(Polygon[0], Polygon[Vertex - 1], Polygon[Vertex]);
+	}
+}
+
+void ROcclusionCulling::RasterizeTriangle(const vec4& ClipA, const vec4& ClipB, const vec4& ClipC)
+{
+	auto ToScreen = [](const vec4& Clip)
+	{
+		const float InvW = 1.f / Clip.w;
+		return vec3(
+			(Clip.x * InvW * 0.5f + 0.5f) * Width,
+			(Clip.y * InvW * 0.5f + 0.5f) * Height,
+			Clip.z * InvW * 0.5f + 0.5f
+		);
+	};
+
+	vec3 A = ToScreen(ClipA), B = ToScreen(ClipB), C = ToScreen(ClipC);
+	float Area = (B.x - A.x) * (C.y - A.y) - (B.y - A.y) * (C.x - A.x);
+	if (abs(Area) < MinTriangleArea)
+		return;
+
+	// both windings are rasterized, turn everything counter-clockwise
+	if (Area < 0)
+	{
+		std::swap(B, C);
+		Area = -Area;
+	}
+
+	// pixels whose centers fall in the triangle's bounds
+	const int MinX = std::max(static_cast<int>(ceil(std::min({A.x, B.x, C.x}) - 0.5f)), 0) & ~3;
+	const int MaxX = std::min(static_cast<int>(floor(std::max({A.x, B.x, C.x}) - 0.5f)), static_cast<int>(Width) - 1);
+	const int MinY = std::max(static_cast<int>(ceil(std::min({A.y, B.y, C.y}) - 0.5f)), 0);
+	const int MaxY = std::min(static_cast<int>(floor(std::max({A.y, B.y, C.y}) - 0.5f)), static_cast<int>(Height) - 1);
+	if (MinX > MaxX || MinY > MaxY)
+		return;
+
+	// edge functions E = a x + b y + c, positive inside
+	struct REdge
+	{
+		float A, B, C;
+	};
+	auto MakeEdge = [](const vec3& From, const vec3& To)
+	{
+		const float EdgeA = From.y - To.y;
+		const float EdgeB = To.x - From.x;
+		return REdge{EdgeA, EdgeB, -(EdgeA * From.x + EdgeB * From.y)};
+	};
+	const REdge Edges[3] = {MakeEdge(A, B), MakeEdge(B, C), MakeEdge(C, A)};
+
+	// depth is affine in screen space. Each pixel gets the furthest value of the plane over its area,
+	// never beyond the furthest vertex.
+	const float DzDx = ((B.z - A.z) * (C.y - A.y) - (B.y - A.y) * (C.z - A.z)) / Area;
+	const float DzDy = ((B.x - A.x) * (C.z - A.z) - (B.z - A.z) * (C.x - A.x)) / Area;
+	const float DepthOffset = A.z - DzDx * A.x - DzDy * A.y + 0.5f * (abs(DzDx) + abs(DzDy));
+	const __m128 MaxDepth = _mm_set1_ps(std::max({A.z, B.z, C.z}));
+
+	const __m128 Zero = _mm_setzero_ps();
+	const __m128 LaneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 EdgeA0 = _mm_set1_ps(Edges[0].A), EdgeA1 = _mm_set1_ps(Edges[1].A), EdgeA2 = _mm_set1_ps(Edges[2].A);
+	const __m128 DepthDx = _mm_set1_ps(DzDx);
+
+	float* Depth = Levels[0].Depth.data();
+	for (int y = MinY; y <= MaxY; y++)
+	{
+		const float CenterY = y + 0.5f;
+		const __m128 Row0 = _mm_set1_ps(Edges[0].B * CenterY + Edges[0].C);
+		const __m128 Row1 = _mm_set1_ps(Edges[1].B * CenterY + Edges[1].C);
+		const __m128 Row2 = _mm_set1_ps(Edges[2].B * CenterY + Edges[2].C);
+		const __m128 RowDepth = _mm_set1_ps(DzDy * CenterY + DepthOffset);
+
+		float* Row = Depth + y * Width;
+		for (int x = MinX; x <= MaxX; x += 4)
+		{
+			const __m128 CenterX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), LaneOffsets);
+			const __m128 E0 = _mm_add_ps(_mm_mul_ps(EdgeA0, CenterX), Row0);
+			const __m128 E1 = _mm_add_ps(_mm_mul_ps(EdgeA1, CenterX), Row1);
+			const __m128 E2 = _mm_add_ps(_mm_mul_ps(EdgeA2, CenterX), Row2);
+			const __m128 Inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(E0, Zero), _mm_cmpge_ps(E1, Zero)), _mm_cmpge_ps(E2, Zero));
+			if (_mm_movemask_ps(Inside) == 0)
+				continue;
+
+			const __m128 TriangleDepth = _mm_min_ps(_mm_add_ps(_mm_mul_ps(DepthDx, CenterX), RowDepth), MaxDepth);
+			const __m128 Current = _mm_loadu_ps(Row + x);
+			const __m128 Nearest = _mm_min_ps(Current, TriangleDepth);
+			_mm_storeu_ps(Row + x, _mm_or_ps(_mm_and_ps(Inside, Nearest), _mm_andnot_ps(Inside, Current)));
+		}
+	}
+}
+
+void ROcclusionCulling::BuildPyramid()
+{
+	for (size_t i = 1; i < Levels.size(); i++)
+	{
+		const RDepthLevel& Source = Levels[i - 1];
+		RDepthLevel& Level = Levels[i];
+
+		for (uint y = 0; y < Level.Height; y++)
+		{
+			const uint Y0 = std::min(y * 2, Source.Height - 1);
+			const uint Y1 = std::min(y * 2 + 1, Source.Height - 1);
+			for (uint x = 0; x < Level.Width; x++)
+			{
+				const uint X0 = std::min(x * 2, Source.Width - 1);
+				const uint X1 = std::min(x * 2 + 1, Source.Width - 1);
+				Level.Depth[y * Level.Width + x] = std::max(
+					std::max(Source.Depth[Y0 * Source.Width + X0], Source.Depth[Y0 * Source.Width + X1]),
+					std::max(Source.Depth[Y1 * Source.Width + X0], Source.Depth[Y1 * Source.Width + X1])
+				);
+			}
+		}
+	}
+}
+
+bool ROcclusionCulling::ProjectBox(const RBoundingBox& Box, vec4& OutRect, float& OutMinDepth) const
+{
+	OutRect = vec4(MaxFloat, MaxFloat, MinFloat, MinFloat);
+	OutMinDepth = MaxFloat;
+
+	for (uint Corner = 0; Corner < 8; Corner++)
+	{
+		const vec4 Position(Corner & 1 ? Box.MaxX : Box.MinX, Corner & 2 ? Box.MaxY : Box.MinY, Corner & 4 ? Box.MaxZ : Box.MinZ, 1.f);
+		const vec4 Clip = ViewProjection * Position;
+		if (Clip.z < -Clip.w || Clip.w <= 0)
+			return false;
+
+		const float InvW = 1.f / Clip.w;
+		const float X = (Clip.x * InvW * 0.5f + 0.5f) * Width;
+		const float Y = (Clip.y * InvW * 0.5f + 0.5f) * Height;
+		OutRect = vec4(std::min(OutRect.x, X), std::min(OutRect.y, Y), std::max(OutRect.z, X), std::max(OutRect.w, Y));
+		OutMinDepth = std::min(OutMinDepth, Clip.z * InvW * 0.5f + 0.5f);
+	}
+	return true;
+}
+
+bool ROcclusionCulling::TestBox(const RBoundingBox& Box) const
+{
+	if (Box.MinX > Box.MaxX || Levels.empty())
+		return true;
+
+	vec4 Rect;
+	float MinDepth;
+	if (!ProjectBox(Box, Rect, MinDepth))
+		return true;
+
+	// off screen or past the far plane is for the frustum to decide
+	if (Rect.z < 0 || Rect.w < 0 || Rect.x >= Width || Rect.y >= Height || MinDepth > 1.f)
+		return true;
+
+	Rect = glm::clamp(Rect, vec4(0.f), vec4(Width, Height, Width, Height));
+
+	// the level where the rect spans about 2 texels, so at most 3x3 of them get read
+	uint LevelIndex = 0;
+	float Span = std::max(Rect.z - Rect.x, Rect.w - Rect.y);
+	while (Span > 2.f && LevelIndex + 1 < Levels.size())
+	{
+		Span *= 0.5f;
+		LevelIndex++;
+	}
+
+	const RDepthLevel& Level = Levels[LevelIndex];
+	const float ScaleX = static_cast<float>(Level.Width) / Width;
+	const float ScaleY = static_cast<float>(Level.Height) / Height;
+	const uint X0 = std::min(static_cast<uint>(Rect.x * ScaleX), Level.Width - 1);
+	const uint X1 = std::min(static_cast<uint>(Rect.z * ScaleX), Level.Width - 1);
+	const uint Y0 = std::min(static_cast<uint>(Rect.y * ScaleY), Level.Height - 1);
+	const uint Y1 = std::min(static_cast<uint>(Rect.w * ScaleY), Level.Height - 1);
+
+	float OccluderDepth = 0.f;
+	for (uint y = Y0; y <= Y1; y++)
+		for (uint x = X0; x <= X1; x++)
+			OccluderDepth = std::max(OccluderDepth, Level.Depth[y * Level.Width + x]);
+
+	return MinDepth <= OccluderDepth;
+}
+
+// a hidden or wireframe entity doesn't hide what's behind it on screen
+constexpr Flags NonOccluderFlags = EntityFlags_InvisibleEntity | EntityFlags_HiddenEntity | EntityFlags_RenderWireframe;
+
+// what an entity that isn't flagged gets rasterized with, the triangles that are drawn
+static bool CanRasterizeRenderMesh(const RMesh* Mesh)
+{
+	return Mesh && Mesh->RenderMethod == static_cast<uint>(RenderMethodEnum::Triangles) && !Mesh->Indices.empty() &&
+		Mesh->Indices.size() / 3 <= ROcclusionCulling::MaxOccluderTriangles;
+}
+
+const vector<EEntity*>& ROcclusionCulling::Cull(const vector<EEntity*>& Visible, const mat4& InViewProjection)
+{
+	PROFILE_ZONE("Occlusion");
+
+	if (!Enabled)
+	{
+		Stats = {};
+		return Visible;
+	}
+
+	Begin(InViewProjection);
+	const uint Count = static_cast<uint>(Visible.size());
+
+	// flagged occluders go first, then the biggest on screen
+	Candidates.clear();
+	for (uint i = 0; i < Count; i++)
+	{
+		const EEntity* Entity = Visible[i];
+		if (Entity->Flags & NonOccluderFlags)
+			continue;
+		if (Entity->Occluder ? !Entity->CollisionMesh : !CanRasterizeRenderMesh(Entity->Mesh))
+			continue;
+
+		vec4 Rect;
+		float MinDepth;
+		float ScreenArea = 1.f;
+		if (ProjectBox(Entity->BoundingBox, Rect, MinDepth))
+		{
+			Rect = glm::clamp(Rect, vec4(0.f), vec4(Width, Height, Width, Height));
+			ScreenArea = (Rect.z - Rect.x) * (Rect.w - Rect.y) / (Width * Height);
+		}
+
+		if (Entity->Occluder)
+			Candidates.push_back({ScreenArea + 2.f, i});
+		else if (ScreenArea >= MinOccluderScreenArea)
+			Candidates.push_back({ScreenArea, i});
+	}
+
+	const uint OccluderCount = std::min(static_cast<uint>(Candidates.size()), MaxOccluders);
+	std::partial_sort(Candidates.begin(), Candidates.begin() + OccluderCount, Candidates.end(), [](const auto& Left, const auto& Right)
+	{
+		return Left.first > Right.first;
+	});
+
+	for (uint i = 0; i < OccluderCount; i++)
+	{
+		const EEntity* Occluder = Visible[Candidates[i].second];
+		if (Occluder->Occluder)
+			RasterizeOccluder(*Occluder->CollisionMesh, Occluder->MatModel);
+		else
+			RasterizeOccluder(*Occluder->Mesh, Occluder->MatModel);
+	}
+	BuildPyramid();
+
+	VisibleFlags.resize(Count);
+	auto TestRange = [this, &Visible](uint Begin, uint End)
+	{
+		for (uint i = Begin; i < End; i++)
+		{
+			const EEntity* Entity = Visible[i];
+			VisibleFlags[i] = !Entity->CollisionMesh || TestBox(Entity->BoundingBox);
+		}
+	};
+
+	if (Count >= ParallelThreshold)
+		RJobSystem::Get()->ParallelFor(Count, JobBatchSize, TestRange);
+	else
+		TestRange(0, Count);
+
+	for (uint i = 0; i < OccluderCount; i++)
+		VisibleFlags[Candidates[i].second] = 1;
+
+	Result.clear();
+	for (uint i = 0; i < Count; i++)
+	{
+		if (VisibleFlags[i])
+			Result.push_back(Visible[i]);
+		else
+			Stats.Occluded++;
+	}
+
+	Stats.Tested = Count - OccluderCount;
+	return Result;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/collision/primitives/BoundingBox.h"
+
+struct RCollisionMesh;
+struct RMesh;
+
+/* ==========================================
+ *	Occlusion Culling
+ * ========================================== */
+// Software occlusion culling for the camera pass, all on the CPU. After frustum culling, a few big
+// occluders (entities flagged as Occluder in the editor, then whatever covers the most screen) are
+// rasterized into a small depth buffer. A max depth pyramid is built from it, and every other visible
+// entity has its world AABB tested against the pyramid level where its screen rect spans a couple of
+// texels: if the nearest point of the box is behind the furthest occluder depth under the whole rect,
+// it isn't drawn.
+//
+// Depth is NDC z remapped to [0, 1], 1 is far and is what the buffer is cleared to. Triangles are
+// rasterized 4 pixels at a time with SSE, both windings, clipped against the near plane. A pixel is
+// covered when its center is, and stores the furthest depth the triangle's plane reaches inside the
+// pixel, so a box only gets culled behind depths that hold over whole texels.
+//
+// Flagged occluders rasterize their collision mesh, flagging one says it fits inside what's drawn.
+// The others rasterize their render mesh at LOD 0: most collision meshes are the bounding box, and a
+// box in place of a table or an arch would hide what shows through it. Render meshes over
+// MaxOccluderTriangles aren't picked.
+//
+// Boxes crossing the near plane, and entities without a collision mesh, are always visible. So are
+// the occluders themselves. Hidden and wireframe entities are never picked as occluders, they don't
+// cover anything on screen.
+
+struct ROcclusionStats
+{
+	uint Tested = 0;
+	uint Occluded = 0;
+	uint Occluders = 0;
+	uint OccluderTriangles = 0;
+
+	float GetOccludedPercent() const { return Tested ? 100.f * Occluded / Tested : 0.f; }
+};
+
+struct ROcclusionCulling
+{
+	static ROcclusionCulling* Get()
+	{
+		static ROcclusionCulling Instance{};
+		return &Instance;
+	}
+
+	// depth buffer resolution, Width a multiple of 4
+	static constexpr uint Width = 256;
+	static constexpr uint Height = 128;
+
+	static constexpr uint MaxOccluders = 32;
+	// render meshes above this are too expensive to rasterize every frame
+	static constexpr uint MaxOccluderTriangles = 256;
+	// fraction of the screen the AABB rect has to cover for an entity to be picked without the flag
+	static constexpr float MinOccluderScreenArea = 0.02f;
+
+	static constexpr uint JobBatchSize = 512;
+	static constexpr uint ParallelThreshold = 2048;
+
+	bool Enabled = true;
+
+	// Picks the occluders among the frustum visible entities, rasterizes them and returns the entities
+	// that aren't hidden behind them. Returns Visible as is when disabled. Valid until the next call.
+	const vector<EEntity*>& Cull(const vector<EEntity*>& Visible, const mat4& ViewProjection);
+
+	// The steps Cull goes through, for tests and tools: clear, rasterize occluders, build the pyramid, test.
+	void Begin(const mat4& ViewProjection);
+	void RasterizeOccluder(const RCollisionMesh& Mesh, const mat4& MatModel);
+	void RasterizeOccluder(const RMesh& Mesh, const mat4& MatModel);
+	void BuildPyramid();
+	// false when the box is certainly hidden
+	bool TestBox(const RBoundingBox& Box) const;
+
+	uint GetLevelCount() const { return static_cast<uint>(Levels.size()); }
+	uint GetLevelWidth(uint Level) const { return Levels[Level].Width; }
+	uint GetLevelHeight(uint Level) const { return Levels[Level].Height; }
+	float GetDepth(uint Level, uint X, uint Y) const { return Levels[Level].Depth[Y * Levels[Level].Width + X]; }
+
+	const ROcclusionStats& GetStats() const { return Stats; }
+
+private:
+	struct RDepthLevel
+	{
+		uint Width = 0;
+		uint Height = 0;
+		vector<float> Depth;
+	};
+
+	// the triangles of Indices over ClipVertices
+	void RasterizeClipTriangles(const vector<uint>& Indices);
+	// clip space triangle, after near plane clipping
+	void RasterizeTriangle(const vec4& A, const vec4& B, const vec4& C);
+	// screen rect in pixels and the nearest depth of a box, false if the box crosses the near plane
+	bool ProjectBox(const RBoundingBox& Box, vec4& OutRect, float& OutMinDepth) const;
+
+	mat4 ViewProjection{};
+	vector<RDepthLevel> Levels;		// 0 is the rasterized buffer, each next one the max of 2x2 texels
+
+	vector<vec4> ClipVertices;
+	vector<std::pair<float, uint>> Candidates;		// occluder score, index in Visible
+	vector<uint8> VisibleFlags;
+	vector<EEntity*> Result;
+	ROcclusionStats Stats;
+};
@@ -0,0 +1,403 @@
+#include "RenderQueue.h"
+#include "glad/glad.h"
+#include "CommandList.h"
+#include "LightClusters.h"
+#include "Renderer.h"
+#include "Shader.h"
+#include "ShadowAtlas.h"
+#include "engine/core/JobSystem.h"
+#include "engine/entities/Entity.h"
+
+#include <algorithm>
+
+constexpr uint UnboundGLID = MaxUint;
+
+// the texture units every entity shader samples from, see RenderEntity
+constexpr uint DiffuseUnit = 0;
+constexpr uint SpecularUnit = 1;
+constexpr uint ShadowMapUnit = 2;
+constexpr uint ShadowAtlasUnit = 3;
+constexpr uint ClusterGridUnit = 4;
+constexpr uint ClusterIndicesUnit = 5;
+
+RRenderQueueStats& RRenderQueueStats::operator+=(const RRenderQueueStats& Other)
+{
+	Items += Other.Items;
+	DrawCalls += Other.DrawCalls;
+	InstancedDrawCalls += Other.InstancedDrawCalls;
+	InstancedItems += Other.InstancedItems;
+	ProgramBinds += Other.ProgramBinds;
+	TextureBinds += Other.TextureBinds;
+	VaoBinds += Other.VaoBinds;
+	UniformLookups += Other.UniformLookups;
+	PolygonModeChanges += Other.PolygonModeChanges;
+	Triangles += Other.Triangles;
+	FullDetailTriangles += Other.FullDetailTriangles;
+	NaiveProgramBinds += Other.NaiveProgramBinds;
+	NaiveTextureBinds += Other.NaiveTextureBinds;
+	NaiveVaoBinds += Other.NaiveVaoBinds;
+	NaiveUniformLookups += Other.NaiveUniformLookups;
+	NaivePolygonModeChanges += Other.NaivePolygonModeChanges;
+	return *this;
+}
+
+uint64 RRenderQueue::MakeSortKey(const RDrawItem& Item)
+{
+	uint64 Key = 0;
+	Key |= (static_cast<uint64>(Item.Pass) & 0xF) << 60;
+	Key |= (static_cast<uint64>(Item.Shader->GLProgramID) & 0xFFF) << 48;
+	Key |= (static_cast<uint64>(Item.Diffuse.Index) & 0xFFF) << 36;
+	Key |= (static_cast<uint64>(Item.Specular.Index) & 0xFFF) << 24;
+	Key |= (static_cast<uint64>(Item.Mesh->GLData.VAO) & 0xFFFF) << 8;
+	Key |= static_cast<uint64>(Item.Lod);
+	return Key;
+}
+
+void RRenderQueue::Clear()
+{
+	Items.clear();
+}
+
+void RRenderQueue::Add(const RDrawItem& Item)
+{
+	Items.push_back(Item);
+	Items.back().SortKey = MakeSortKey(Item);
+}
+
+RDrawItem RRenderQueue::MakeEntityItem(const EEntity* Entity, uint Lod)
+{
+	RDrawItem Item;
+	Item.MatModel = &Entity->MatModel;
+	Item.Mesh = Entity->Mesh;
+	Item.Shader = Entity->Shader;
+	Item.Diffuse = Entity->TextureDiffuse;
+	Item.Specular = Entity->TextureSpecular;
+	Item.Pass = Entity->Flags & EntityFlags_RenderWireframe || Entity->Flags & EntityFlags_HiddenEntity ?
+		NRenderPass::Wireframe : NRenderPass::Opaque;
+	Item.Lod = Lod;
+	return Item;
+}
+
+RDrawItem RRenderQueue::MakeEntityItem(const EEntity* Entity, RShader* Shader, uint Lod)
+{
+	RDrawItem Item;
+	Item.MatModel = &Entity->MatModel;
+	Item.Mesh = Entity->Mesh;
+	Item.Shader = Shader;
+	Item.Lod = Lod;
+	return Item;
+}
+
+void RRenderQueue::AddParallel(uint Count, const RDrawItemFunc& Fill)
+{
+	if (Count < ParallelThreshold)
+	{
+		RDrawItem Item;
+		for (uint Index = 0; Index < Count; Index++)
+		{
+			if (Fill(Index, Item))
+				Add(Item);
+		}
+		return;
+	}
+
+	// one buffer per batch rather than per thread, so merging them in batch order keeps the source order
+	const uint BatchCount = (Count + JobBatchSize - 1) / JobBatchSize;
+	if (BatchItems.size() < BatchCount)
+		BatchItems.resize(BatchCount);
+	// with no workers the whole range comes in one call and lands in the first batch
+	for (uint BatchIndex = 0; BatchIndex < BatchCount; BatchIndex++)
+		BatchItems[BatchIndex].clear();
+
+	RJobSystem::Get()->ParallelFor(Count, JobBatchSize, [this, &Fill](uint Begin, uint End)
+	{
+		auto& Batch = BatchItems[Begin / JobBatchSize];
+		RDrawItem Item;
+		for (uint Index = Begin; Index < End; Index++)
+		{
+			if (!Fill(Index, Item))
+				continue;
+
+			Item.SortKey = MakeSortKey(Item);
+			Batch.push_back(Item);
+		}
+	});
+
+	for (uint BatchIndex = 0; BatchIndex < BatchCount; BatchIndex++)
+		Items.insert(Items.end(), BatchItems[BatchIndex].begin(), BatchItems[BatchIndex].end());
+}
+
+void RRenderQueue::Sort()
+{
+	std::sort(Items.begin(), Items.end(), [](const RDrawItem& A, const RDrawItem& B) { return A.SortKey < B.SortKey; });
+}
+
+static bool CanShareDraw(const RDrawItem& A, const RDrawItem& B)
+{
+	return A.Pass == B.Pass && A.Shader == B.Shader && A.Mesh == B.Mesh && A.Lod == B.Lod && A.Diffuse == B.Diffuse && A.Specular == B.Specular;
+}
+
+void RRenderQueue::BuildRuns()
+{
+	Runs.clear();
+	InstanceMatrices.clear();
+
+	for (uint First = 0; First < Items.size();)
+	{
+		uint End = First + 1;
+		while (End < Items.size() && CanShareDraw(Items[First], Items[End]))
+			End++;
+
+		RDrawRun Run;
+		Run.First = First;
+		Run.Count = End - First;
+
+		const RDrawItem& Item = Items[First];
+		const bool Instanced = Run.Count >= MinInstancedRun && Item.Shader->Instanced != nullptr &&
+			Item.Mesh->RenderMethod == GL_TRIANGLES;
+		if (Instanced)
+		{
+			Run.FirstInstance = InstanceMatrices.size();
+			for (uint Index = First; Index < End; Index++)
+				InstanceMatrices.push_back(*Items[Index].MatModel);
+		}
+
+		Runs.push_back(Run);
+		First = End;
+	}
+}
+
+void RRenderQueue::UploadInstances()
+{
+	if (InstanceMatrices.empty())
+		return;
+
+	// the shadow queue and the main queue both upload each frame, each into its own slice of the ring
+	InstanceUpload = RDynamicBuffers::Get()->Vertices.Upload(InstanceMatrices.data(), InstanceMatrices.size() * sizeof(mat4), sizeof(mat4));
+
+	// nowhere to point the matrix attributes at, fall back to drawing those runs item by item
+	if (!InstanceUpload.IsValid())
+	{
+		for (RDrawRun& Run : Runs)
+			Run.FirstInstance = MaxUint;
+	}
+}
+
+// DrawMeshGeometry, recorded
+static void RecordMeshGeometry(RCommandList& Commands, const RMesh* Mesh, uint Lod)
+{
+	switch (Mesh->RenderMethod)
+	{
+		case GL_TRIANGLE_STRIP:
+		case GL_LINE_LOOP:
+		case GL_POINTS:
+		case GL_LINES:
+			Commands.DrawArrays(Mesh->RenderMethod, 0, Mesh->Vertices.size());
+			break;
+		case GL_TRIANGLES:
+		{
+			const RMeshLod MeshLod = Mesh->GetLod(Lod);
+			Commands.DrawElements(GL_TRIANGLES, MeshLod.IndexCount, Mesh->GetGLIndexType(), MeshLod.IndexOffset * Mesh->GetIndexSize());
+			break;
+		}
+		default:
+			Log("WARNING: no drawing method set for mesh '%s', it won't be rendered!", Mesh->Name.c_str());
+	}
+}
+
+void RRenderQueue::Submit(NSubmitMode Mode)
+{
+	Record(Mode);
+	RRenderBackend::Get()->Execute(Commands);
+}
+
+void RRenderQueue::Record(NSubmitMode Mode)
+{
+	Stats = {};
+	Stats.Items = Items.size();
+	Commands.Clear();
+	if (Items.empty())
+		return;
+
+	const bool Lit = Mode == NSubmitMode::Lit;
+
+	BuildRuns();
+	UploadInstances();
+
+	// shadow maps and light clusters are the same for everybody, bind them once
+	if (Lit)
+	{
+		auto* LightClusters = RLightClusters::Get();
+		Commands.BindTexture(ClusterGridUnit, GL_TEXTURE_BUFFER, LightClusters->GetGridTexture());
+		Commands.BindTexture(ClusterIndicesUnit, GL_TEXTURE_BUFFER, LightClusters->GetIndicesTexture());
+		Commands.BindTexture(ShadowMapUnit, GL_TEXTURE_2D, RDepthMap);
+		Commands.BindTexture(ShadowAtlasUnit, GL_TEXTURE_2D, RShadowAtlas::Get()->GetTexture());
+		Stats.TextureBinds += 4;
+	}
+
+	if (Items.size() < ParallelThreshold)
+	{
+		RecordRuns(0, Runs.size(), Lit, Commands, Stats);
+	}
+	else
+	{
+		// chunks of whole runs, about JobBatchSize items each
+		uint ChunkCount = 0;
+		for (uint Run = 0; Run < Runs.size();)
+		{
+			if (Chunks.size() <= ChunkCount)
+				Chunks.emplace_back();
+
+			auto& Chunk = Chunks[ChunkCount++];
+			Chunk.FirstRun = Run;
+			for (uint ChunkItems = 0; Run < Runs.size() && ChunkItems < JobBatchSize; Run++)
+				ChunkItems += Runs[Run].Count;
+			Chunk.EndRun = Run;
+		}
+
+		RJobSystem::Get()->ParallelFor(ChunkCount, 1, [this, Lit](uint Begin, uint End)
+		{
+			for (uint ChunkIndex = Begin; ChunkIndex < End; ChunkIndex++)
+			{
+				auto& Chunk = Chunks[ChunkIndex];
+				Chunk.Commands.Clear();
+				Chunk.Stats = {};
+				RecordRuns(Chunk.FirstRun, Chunk.EndRun, Lit, Chunk.Commands, Chunk.Stats);
+			}
+		});
+
+		for (uint ChunkIndex = 0; ChunkIndex < ChunkCount; ChunkIndex++)
+		{
+			Commands.Append(Chunks[ChunkIndex].Commands);
+			Stats += Chunks[ChunkIndex].Stats;
+		}
+	}
+
+	if (!Lit)
+		Stats.NaiveProgramBinds++;
+
+	// set everything back to defaults
+	Commands.BindVertexArray(0);
+	Stats.VaoBinds++;
+}
+
+void RRenderQueue::RecordRuns(uint FirstRun, uint EndRun, bool Lit, RCommandList& OutCommands, RRenderQueueStats& OutStats) const
+{
+	uint CurrentProgram = UnboundGLID;
+	uint CurrentVAO = UnboundGLID;
+	uint CurrentTextures[2] = {UnboundGLID, UnboundGLID};
+	int ModelLocation = -1;
+	bool Wireframe = false;
+
+	auto BindTexture = [&](uint Unit, uint GLID)
+	{
+		if (CurrentTextures[Unit] == GLID)
+			return;
+
+		OutCommands.BindTexture(Unit, GL_TEXTURE_2D, GLID);
+		CurrentTextures[Unit] = GLID;
+		OutStats.TextureBinds++;
+	};
+
+	for (uint RunIndex = FirstRun; RunIndex < EndRun; RunIndex++)
+	{
+		const RDrawRun& Run = Runs[RunIndex];
+		const RDrawItem& Item = Items[Run.First];
+		const bool Instanced = Run.FirstInstance != MaxUint;
+		RShader* Shader = Instanced ? Item.Shader->Instanced : Item.Shader;
+
+		if (Shader->GLProgramID != CurrentProgram)
+		{
+			OutCommands.UseProgram(Shader->GLProgramID);
+			CurrentProgram = Shader->GLProgramID;
+			OutStats.ProgramBinds++;
+
+			// sampler uniforms are program state, so they only need setting when we switch to it
+			if (Lit)
+			{
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::TextureDiffuse), DiffuseUnit);
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::TextureSpecular), SpecularUnit);
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::ShadowMap), ShadowMapUnit);
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::ShadowAtlas), ShadowAtlasUnit);
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::ClusterGrid), ClusterGridUnit);
+				OutCommands.SetInt(Shader->GetUniformLocation(UniformIds::ClusterLightIndices), ClusterIndicesUnit);
+				OutStats.UniformLookups += 6;
+			}
+			ModelLocation = Shader->GetUniformLocation(UniformIds::Model);
+			OutStats.UniformLookups++;
+		}
+
+		if (Lit)
+		{
+			BindTexture(DiffuseUnit, Item.Diffuse.GetGLID());
+			BindTexture(SpecularUnit, Item.Specular.GetGLID());
+
+			const bool RunWireframe = Item.Pass == NRenderPass::Wireframe;
+			if (RunWireframe != Wireframe)
+			{
+				OutCommands.SetPolygonMode(RunWireframe);
+				Wireframe = RunWireframe;
+				OutStats.PolygonModeChanges++;
+			}
+		}
+
+		if (Item.Mesh->GLData.VAO != CurrentVAO)
+		{
+			OutCommands.BindVertexArray(Item.Mesh->GLData.VAO);
+			CurrentVAO = Item.Mesh->GLData.VAO;
+			OutStats.VaoBinds++;
+		}
+
+		if (Instanced)
+		{
+			OutCommands.SetInstanceMatrices(InstanceUpload.Buffer, InstanceUpload.Offset + Run.FirstInstance * sizeof(mat4));
+
+			const RMeshLod Lod = Item.Mesh->GetLod(Item.Lod);
+			OutCommands.DrawElements(GL_TRIANGLES, Lod.IndexCount, Item.Mesh->GetGLIndexType(), Lod.IndexOffset * Item.Mesh->GetIndexSize(), Run.Count);
+
+			// leave the VAO as RenderMesh expects it
+			OutCommands.ClearInstanceMatrices();
+
+			OutStats.DrawCalls++;
+			OutStats.InstancedDrawCalls++;
+			OutStats.InstancedItems += Run.Count;
+		}
+		else
+		{
+			for (uint Index = Run.First; Index < Run.First + Run.Count; Index++)
+			{
+				OutCommands.SetMatrix4(ModelLocation, Items[Index].MatModel);
+				RecordMeshGeometry(OutCommands, Items[Index].Mesh, Items[Index].Lod);
+				OutStats.DrawCalls++;
+			}
+		}
+
+		if (Item.Mesh->RenderMethod == GL_TRIANGLES)
+		{
+			OutStats.Triangles += Item.Mesh->GetLod(Item.Lod).IndexCount / 3 * Run.Count;
+			OutStats.FullDetailTriangles += Item.Mesh->Indices.size() / 3 * Run.Count;
+		}
+
+		// RenderEntity: Use + 4 textures + model and 6 sampler lookups + VAO bind/unbind + polygon mode set/reset.
+		// Depth passes used to bind their program once and then go through RenderMesh per entity.
+		OutStats.NaiveVaoBinds += 2 * Run.Count;
+		if (Lit)
+		{
+			OutStats.NaiveProgramBinds += Run.Count;
+			OutStats.NaiveUniformLookups += 7 * Run.Count;
+			OutStats.NaiveTextureBinds += 4 * Run.Count;
+			if (Item.Pass == NRenderPass::Wireframe)
+				OutStats.NaivePolygonModeChanges += 2 * Run.Count;
+		}
+		else
+		{
+			OutStats.NaiveUniformLookups += Run.Count;
+		}
+	}
+
+	if (Wireframe)
+	{
+		OutCommands.SetPolygonMode(false);
+		OutStats.PolygonModeChanges++;
+	}
+}
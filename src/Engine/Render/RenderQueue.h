@@ -0,0 +1,183 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/geometry/mesh.h"
+#include "CommandList.h"
+#include "RingBuffer.h"
+
+#include <functional>
+
+struct RShader;
+
+/* ==========================================
+ *	Render Queue
+ * ========================================== */
+// Collects the draws of a pass instead of issuing them right away, sorts them by a 64 bit key and
+// then submits them in that order while keeping track of what is currently bound. Only state that
+// differs from the previous draw gets touched, so a run of entities sharing shader, textures and
+// mesh costs one model matrix upload + one draw call each.
+//
+// Sort key layout, most significant first:
+//   [63..60] pass       opaque before wireframe, so polygon mode flips at most once
+//   [59..48] shader     GL program id
+//   [47..36] diffuse    texture handle index
+//   [35..24] specular   texture handle index
+//   [23..8]  mesh       VAO
+//   [7..0]   lod        mesh LOD, see RLodSelector
+//
+// Submit doesn't call GL itself, it records the pass into a command list that RRenderBackend
+// executes (see CommandList.h), so a headless run goes through the same code with the Null backend.
+//
+// Past ParallelThreshold the CPU side of a pass runs on the job system. AddParallel fills the items
+// of a range of sources (visible entities, shadow casters) per job, each job into its own buffer,
+// and Record cuts the sorted runs in chunks that are recorded into a command list per job. Both
+// are merged back in order on the calling thread, so the result is the same with any number of
+// workers, give or take the binds repeated at the start of each chunk.
+//
+// Fields are truncated to their bit width. That only affects grouping quality, never correctness,
+// since Submit compares the real values before skipping a bind.
+//
+// After sorting, consecutive items sharing pass, shader, textures and mesh form a run. Runs of at
+// least MinInstancedRun items whose shader has an instanced variant (see RShader::Instanced) are
+// drawn with a single glDrawElementsInstanced, their model matrices streamed through the vertex
+// ring (see RingBuffer.h), so draw calls scale with the number of unique materials instead of entities.
+
+// matches "layout (location = 5) in mat4 aModel" in the instanced vertex shaders, takes 4 slots
+constexpr uint RInstanceMatrixAttribute = 5;
+
+enum class NRenderPass : uint8
+{
+	Opaque = 0,
+	Wireframe = 1,
+};
+
+struct RDrawItem
+{
+	uint64 SortKey = 0;
+	const mat4* MatModel = nullptr;
+	const RMesh* Mesh = nullptr;
+	RShader* Shader = nullptr;
+	RTextureHandle Diffuse;
+	RTextureHandle Specular;
+	NRenderPass Pass = NRenderPass::Opaque;
+	uint8 Lod = 0;
+};
+
+enum class NSubmitMode : uint8
+{
+	// entity shaders: textures, shadow maps, wireframe
+	Lit,
+	// shadow passes: just the matrices, the caller set up the shader
+	DepthOnly,
+};
+
+// "Naive" is what drawing every item through RenderEntity would have cost
+struct RRenderQueueStats
+{
+	uint Items = 0;
+	uint DrawCalls = 0;
+	uint InstancedDrawCalls = 0;
+	uint InstancedItems = 0;
+
+	uint ProgramBinds = 0;
+	uint TextureBinds = 0;
+	uint VaoBinds = 0;
+	uint UniformLookups = 0;
+	uint PolygonModeChanges = 0;
+
+	// triangles drawn, and what they would have been with every mesh at LOD 0
+	uint Triangles = 0;
+	uint FullDetailTriangles = 0;
+
+	uint NaiveProgramBinds = 0;
+	uint NaiveTextureBinds = 0;
+	uint NaiveVaoBinds = 0;
+	uint NaiveUniformLookups = 0;
+	uint NaivePolygonModeChanges = 0;
+
+	uint GetStateChanges() const { return ProgramBinds + TextureBinds + VaoBinds + UniformLookups + PolygonModeChanges; }
+	uint GetNaiveStateChanges() const
+	{
+		return NaiveProgramBinds + NaiveTextureBinds + NaiveVaoBinds + NaiveUniformLookups + NaivePolygonModeChanges;
+	}
+	// signed, an estimate that's off for some pass shouldn't wrap around to billions
+	int64 GetEliminatedStateChanges() const { return static_cast<int64>(GetNaiveStateChanges()) - GetStateChanges(); }
+
+	RRenderQueueStats& operator+=(const RRenderQueueStats& Other);
+};
+
+// Fills the item for source Index, false if that source draws nothing. Runs on worker threads.
+using RDrawItemFunc = std::function<bool(uint Index, RDrawItem& OutItem)>;
+
+struct RRenderQueue
+{
+	static RRenderQueue* Get()
+	{
+		static RRenderQueue Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint MinInstancedRun = 2;
+	// below this many items (sources for AddParallel) a pass is built and recorded on the calling thread
+	static constexpr uint ParallelThreshold = 1024;
+	// sources per AddParallel job, and about how many items each recording job takes
+	static constexpr uint JobBatchSize = 256;
+
+	static uint64 MakeSortKey(const RDrawItem& Item);
+	static RDrawItem MakeEntityItem(const EEntity* Entity, uint Lod = 0);
+	// draws the entity's mesh with Shader instead of its own material, for depth passes
+	static RDrawItem MakeEntityItem(const EEntity* Entity, RShader* Shader, uint Lod = 0);
+
+	void Clear();
+	void Add(const RDrawItem& Item);
+	void AddEntity(EEntity* Entity, uint Lod = 0) { Add(MakeEntityItem(Entity, Lod)); }
+	void AddEntity(EEntity* Entity, RShader* Shader, uint Lod = 0) { Add(MakeEntityItem(Entity, Shader, Lod)); }
+	// Calls Fill for every source in [0, Count) on the job system and adds the items in source order
+	void AddParallel(uint Count, const RDrawItemFunc& Fill);
+	void Sort();
+
+	// In Lit mode binds the shadow maps once, then draws every item. Leaves GL in the same defaults RenderEntity does.
+	// Records the pass and hands it to RRenderBackend.
+	void Submit(NSubmitMode Mode = NSubmitMode::Lit);
+	// Only records the commands Submit would execute. Uploads the instance matrices, see RDynamicBuffers.
+	// Big passes are cut in chunks of runs recorded on worker threads, then appended in order.
+	void Record(NSubmitMode Mode = NSubmitMode::Lit);
+	const RCommandList& GetCommands() const { return Commands; }
+
+	const vector<RDrawItem>& GetItems() const { return Items; }
+	const RRenderQueueStats& GetStats() const { return Stats; }
+
+private:
+	struct RDrawRun
+	{
+		uint First = 0;
+		uint Count = 0;
+		// index of the first matrix in InstanceMatrices, MaxUint if the run is drawn item by item
+		uint FirstInstance = MaxUint;
+	};
+
+	// a range of runs recorded by one job
+	struct RRecordChunk
+	{
+		uint FirstRun = 0;
+		uint EndRun = 0;
+		RCommandList Commands;
+		RRenderQueueStats Stats;
+	};
+
+	void BuildRuns();
+	void UploadInstances();
+	// Starts with nothing bound and polygon mode on fill, and puts fill back before returning
+	void RecordRuns(uint FirstRun, uint EndRun, bool Lit, RCommandList& OutCommands, RRenderQueueStats& OutStats) const;
+
+	vector<RDrawItem> Items;
+	vector<RDrawRun> Runs;
+	vector<mat4> InstanceMatrices;
+	RRingAllocation InstanceUpload;
+	RCommandList Commands;
+	RRenderQueueStats Stats;
+
+	// per job scratch, kept between frames for their capacity
+	vector<vector<RDrawItem>> BatchItems;
+	vector<RRecordChunk> Chunks;
+};
@@ -0,0 +1,143 @@
+#include "RenderStats.h"
+#include "glad/glad.h"
+#include "engine/core/FrameMetrics.h"
+
+#include <algorithm>
+
+constexpr uint RenderPassCount = static_cast<uint>(NStatsPass::Count);
+
+const char* GetStatsPassName(NStatsPass Pass)
+{
+	switch (Pass)
+	{
+		case NStatsPass::DirectionalShadow: return "shadow_dir";
+		case NStatsPass::PointShadow:       return "shadow_cube";
+		case NStatsPass::Main:              return "main";
+		case NStatsPass::ImDraw:            return "imdraw";
+		case NStatsPass::Text:              return "text";
+		case NStatsPass::Editor:            return "editor";
+		case NStatsPass::Other:             return "other";
+		default:                             return "unknown";
+	}
+}
+
+RRenderPassStats& RRenderPassStats::operator+=(const RRenderPassStats& Other)
+{
+	DrawCalls += Other.DrawCalls;
+	ProgramBinds += Other.ProgramBinds;
+	TextureBinds += Other.TextureBinds;
+	UniformSets += Other.UniformSets;
+	UploadBytes += Other.UploadBytes;
+	Triangles += Other.Triangles;
+	CpuMs += Other.CpuMs;
+	return *this;
+}
+
+void RRenderStats::BeginFrame()
+{
+	for (auto& Pass : Current)
+		Pass = {};
+	Depth = 0;
+}
+
+void RRenderStats::EndFrame()
+{
+	// a pass left open is cut at the frame boundary
+	if (Depth > 0)
+	{
+		Log("Warning: render pass '%s' still open at the end of the frame.", GetStatsPassName(Stack[Depth - 1].Pass))
+		StopActiveClock(RClock::now());
+		Depth = 0;
+	}
+
+	for (uint i = 0; i < RenderPassCount; i++)
+		LastFrame[i] = Current[i];
+
+	PublishMetrics();
+}
+
+void RRenderStats::BeginPass(NStatsPass Pass)
+{
+	const auto Now = RClock::now();
+	if (Depth == MaxPassDepth)
+	{
+		Log("Error: render passes nested deeper than %u.", MaxPassDepth)
+		return;
+	}
+
+	StopActiveClock(Now);
+	Stack[Depth++] = {Pass, Now};
+}
+
+void RRenderStats::EndPass()
+{
+	if (Depth == 0)
+		return;
+
+	const auto Now = RClock::now();
+	StopActiveClock(Now);
+	Depth--;
+
+	// the outer pass picks up from here
+	if (Depth > 0)
+		Stack[Depth - 1].Start = Now;
+}
+
+void RRenderStats::StopActiveClock(RClock::time_point Now)
+{
+	if (Depth == 0)
+		return;
+
+	RActivePass& Pass = Stack[Depth - 1];
+	Current[static_cast<uint>(Pass.Pass)].CpuMs += std::chrono::duration<double, std::milli>(Now - Pass.Start).count();
+	Pass.Start = Now;
+}
+
+void RRenderStats::CountDraw(uint Mode, uint Vertices, uint Instances)
+{
+	RRenderPassStats& Pass = Active();
+	Pass.DrawCalls++;
+
+	uint64 Triangles = 0;
+	switch (Mode)
+	{
+		case GL_TRIANGLES:      Triangles = Vertices / 3; break;
+		case GL_TRIANGLE_STRIP:
+		case GL_TRIANGLE_FAN:   Triangles = Vertices >= 3 ? Vertices - 2 : 0; break;
+		default: break;
+	}
+	Pass.Triangles += Triangles * std::max(Instances, 1u);
+}
+
+RRenderPassStats RRenderStats::GetTotal() const
+{
+	RRenderPassStats Total;
+	for (const auto& Pass : LastFrame)
+		Total += Pass;
+	return Total;
+}
+
+void RRenderStats::PublishMetrics()
+{
+	constexpr const char* CounterNames[] = {"draws", "programs", "textures", "uniforms", "upload_bytes", "triangles", "cpu_ms"};
+	constexpr uint CounterCount = sizeof(CounterNames) / sizeof(CounterNames[0]);
+
+	if (MetricNames.empty())
+	{
+		for (uint Pass = 0; Pass < RenderPassCount; Pass++)
+			for (const char* Counter : CounterNames)
+				MetricNames.push_back(string("render.") + GetStatsPassName(static_cast<NStatsPass>(Pass)) + "." + Counter);
+	}
+
+	auto* Metrics = RFrameMetrics::Get();
+	for (uint Pass = 0; Pass < RenderPassCount; Pass++)
+	{
+		const RRenderPassStats& Stats = LastFrame[Pass];
+		const double Values[CounterCount] = {
+			static_cast<double>(Stats.DrawCalls), static_cast<double>(Stats.ProgramBinds), static_cast<double>(Stats.TextureBinds),
+			static_cast<double>(Stats.UniformSets), static_cast<double>(Stats.UploadBytes), static_cast<double>(Stats.Triangles), Stats.CpuMs
+		};
+		for (uint Counter = 0; Counter < CounterCount; Counter++)
+			Metrics->Set(MetricNames[Pass * CounterCount + Counter], Values[Counter]);
+	}
+}
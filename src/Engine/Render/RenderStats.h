@@ -0,0 +1,114 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/core/Profiler.h"
+
+#include <chrono>
+
+/* ==========================================
+ *	Render Stats
+ * ========================================== */
+// What the renderer costs per frame, by pass: draw calls, program binds, texture binds, uniform
+// sets, bytes uploaded to buffers, triangles and CPU time. The places that talk to GL count
+// themselves here (RShader, RRenderBackend for everything going through the render queue, the
+// ring buffers, the direct draws of meshes, ImDraw and text), into whatever pass is active.
+//
+// Passes are scoped with RRenderPassScope. They can be entered more than once a frame and add up,
+// and they nest: the time spent in an inner pass isn't counted again in the outer one. Anything
+// counted outside of a pass goes to Other.
+//
+// EndFrame publishes the frame, which is what GetPass returns until the next EndFrame, and sets
+// its numbers in RFrameMetrics as "render.<pass>.<counter>". Main thread only.
+
+enum class NStatsPass : uint8
+{
+	DirectionalShadow,
+	PointShadow,
+	Main,
+	ImDraw,
+	Text,
+	Editor,
+	Other,
+	Count
+};
+
+const char* GetStatsPassName(NStatsPass Pass);
+
+struct RRenderPassStats
+{
+	uint DrawCalls = 0;
+	uint ProgramBinds = 0;
+	uint TextureBinds = 0;
+	uint UniformSets = 0;
+	uint64 UploadBytes = 0;
+	uint64 Triangles = 0;
+	double CpuMs = 0;
+
+	RRenderPassStats& operator+=(const RRenderPassStats& Other);
+};
+
+struct RRenderStats
+{
+	static RRenderStats* Get()
+	{
+		static RRenderStats Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint MaxPassDepth = 8;
+
+	void BeginFrame();
+	void EndFrame();
+
+	void BeginPass(NStatsPass Pass);
+	void EndPass();
+
+	// Mode is the GL primitive, only triangle lists, strips and fans add triangles
+	void CountDraw(uint Mode, uint Vertices, uint Instances = 1);
+	void CountProgramBind() { Active().ProgramBinds++; }
+	void CountTextureBind() { Active().TextureBinds++; }
+	void CountUniformSet() { Active().UniformSets++; }
+	void CountUpload(uint64 Bytes) { Active().UploadBytes += Bytes; }
+
+	// last published frame
+	const RRenderPassStats& GetPass(NStatsPass Pass) const { return LastFrame[static_cast<uint>(Pass)]; }
+	RRenderPassStats GetTotal() const;
+
+private:
+	using RClock = std::chrono::steady_clock;
+
+	struct RActivePass
+	{
+		NStatsPass Pass;
+		RClock::time_point Start;
+	};
+
+	RRenderPassStats& Active() { return Current[static_cast<uint>(Depth ? Stack[Depth - 1].Pass : NStatsPass::Other)]; }
+	// adds the time since the active pass (re)started to it
+	void StopActiveClock(RClock::time_point Now);
+	void PublishMetrics();
+
+	RRenderPassStats Current[static_cast<uint>(NStatsPass::Count)];
+	RRenderPassStats LastFrame[static_cast<uint>(NStatsPass::Count)];
+	RActivePass Stack[MaxPassDepth];
+	uint Depth = 0;
+
+	vector<string> MetricNames;
+};
+
+// also a CPU and a GPU profiler zone named after the pass
+struct RRenderPassScope
+{
+	explicit RRenderPassScope(NStatsPass Pass) : Zone(GetStatsPassName(Pass)), GpuZone(GetStatsPassName(Pass))
+	{
+		RRenderStats::Get()->BeginPass(Pass);
+	}
+	~RRenderPassScope() { RRenderStats::Get()->EndPass(); }
+
+	RRenderPassScope(const RRenderPassScope&) = delete;
+	RRenderPassScope& operator=(const RRenderPassScope&) = delete;
+
+private:
+	RProfileZone Zone;
+	RGpuProfileZone GpuZone;
+};
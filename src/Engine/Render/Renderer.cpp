@@ -1,7 +1,17 @@
 #include "engine/render/renderer.h"
 #include "glad/glad.h"
 #include "..\..\Game\Entities\Player.h"
+#include "Culling.h"
+#include "LightClusters.h"
+#include "LightsBuffer.h"
+#include "LodSelector.h"
+#include "Occlusion.h"
+#include "RenderQueue.h"
+#include "RenderStats.h"
 #include "Shader.h"
+#include "ShadowAtlas.h"
+#include "ShadowCache.h"
+#include "StaticBatches.h"
 #include "engine/camera/camera.h"
 #include "engine/entities/lights.h"
 #include "engine/entities/Entity.h"
@@ -9,6 +19,31 @@
 #include "engine/world/World.h"
 #include "text/TextRenderer.h"
 
+void DrawMeshGeometry(const RMesh* Mesh, uint Lod)
+{
+	switch (Mesh->RenderMethod)
+	{
+		case GL_TRIANGLE_STRIP:
+		case GL_LINE_LOOP:
+		case GL_POINTS:
+		case GL_LINES:
+			glDrawArrays(Mesh->RenderMethod, 0, Mesh->Vertices.size());
+			RRenderStats::Get()->CountDraw(Mesh->RenderMethod, Mesh->Vertices.size());
+			break;
+		case GL_TRIANGLES:
+		{
+			const RMeshLod MeshLod = Mesh->GetLod(Lod);
+			const size_t IndexOffset = MeshLod.IndexOffset * Mesh->GetIndexSize();
+			glDrawElements(GL_TRIANGLES, MeshLod.IndexCount, Mesh->GetGLIndexType(), reinterpret_cast<void*>(IndexOffset));
+			RRenderStats::Get()->CountDraw(GL_TRIANGLES, MeshLod.IndexCount);
+		//glDrawArrays(GL_TRIANGLES, 0, mesh->vertices.size());
+			break;
+		}
+		default:
+			Log("WARNING: no drawing method set for mesh '%s', it won't be rendered!", Mesh->Name.c_str());
+	}
+}
+
 void RenderMesh(const RMesh* Mesh, RRenderOptions Opts)
 {
 	glBindVertexArray(Mesh->GLData.VAO);
@@ -25,28 +60,7 @@ void RenderMesh(const RMesh* Mesh, RRenderOptions Opts)
 	if (Opts.DontCullFace)
 		glDisable(GL_CULL_FACE);
 
-	// draw
-	switch (Mesh->RenderMethod)
-	{
-		case GL_TRIANGLE_STRIP:
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, Mesh->Vertices.size());
-			break;
-		case GL_LINE_LOOP:
-			glDrawArrays(GL_LINE_LOOP, 0, Mesh->Vertices.size());
-			break;
-		case GL_POINTS:
-			glDrawArrays(GL_POINTS, 0, Mesh->Vertices.size());
-			break;
-		case GL_LINES:
-			glDrawArrays(GL_LINES, 0, Mesh->Vertices.size());
-			break;
-		case GL_TRIANGLES:
-			glDrawElements(GL_TRIANGLES, Mesh->Indices.size(), GL_UNSIGNED_INT, nullptr);
-		//glDrawArrays(GL_TRIANGLES, 0, mesh->vertices.size());
-			break;
-		default:
-			Log("WARNING: no drawing method set for mesh '%s', it won't be rendered!", Mesh->Name.c_str());
-	}
+	DrawMeshGeometry(Mesh);
 
 	// set to defaults
 	if (Opts.Wireframe)
@@ -70,30 +84,39 @@ void RenderMesh(const RMesh* Mesh, RRenderOptions Opts)
 void RenderEntity(EEntity* Entity)
 {
 	Entity->Shader->Use();
-	Entity->Shader->SetMatrix4("model", Entity->MatModel);
+	Entity->Shader->SetMatrix4(UniformIds::Model, Entity->MatModel);
 
 	// BIND ENTITY TEXTURES
 	{
 		glActiveTexture(GL_TEXTURE0 + 0);
-		glUniform1i(glGetUniformLocation(Entity->Shader->GLProgramID, "texture_diffuse1"), 0);
-		glBindTexture(GL_TEXTURE_2D, Entity->TextureDiffuse.ID);
+		Entity->Shader->SetInt(UniformIds::TextureDiffuse, 0);
+		glBindTexture(GL_TEXTURE_2D, Entity->TextureDiffuse.GetGLID());
 
 		glActiveTexture(GL_TEXTURE0 + 1);
-		glUniform1i(glGetUniformLocation(Entity->Shader->GLProgramID, "texture_specular1"), 1);
-		glBindTexture(GL_TEXTURE_2D, Entity->TextureSpecular.ID);
+		Entity->Shader->SetInt(UniformIds::TextureSpecular, 1);
+		glBindTexture(GL_TEXTURE_2D, Entity->TextureSpecular.GetGLID());
 	}
 	
 	// BIND SHADOW MAP TEXTURES
 	{
 		// shadow map texture
 		glActiveTexture(GL_TEXTURE0 + 2);
-		glUniform1i(glGetUniformLocation(Entity->Shader->GLProgramID, "shadowMap"), 2);
+		Entity->Shader->SetInt(UniformIds::ShadowMap, 2);
 		glBindTexture(GL_TEXTURE_2D, RDepthMap);
 
-		// shadow cubemap texture
+		// point light shadow atlas
 		glActiveTexture(GL_TEXTURE0 + 3);
-		glUniform1i(glGetUniformLocation(Entity->Shader->GLProgramID, "shadowCubemap"), 3);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, RDepthCubemapTexture);
+		Entity->Shader->SetInt(UniformIds::ShadowAtlas, 3);
+		glBindTexture(GL_TEXTURE_2D, RShadowAtlas::Get()->GetTexture());
+	}
+	for (uint Unit = 0; Unit < 4; Unit++)
+		RRenderStats::Get()->CountTextureBind();
+
+	// BIND LIGHT CLUSTERS
+	{
+		Entity->Shader->SetInt(UniformIds::ClusterGrid, 4);
+		Entity->Shader->SetInt(UniformIds::ClusterLightIndices, 5);
+		RLightClusters::Get()->BindTextures(4, 5);
 	}
 
 	// draw mesh
@@ -109,8 +132,8 @@ void RenderEntity(EEntity* Entity)
 void RenderEditorEntity(EEntity* Entity, RWorld* World, RCamera* Camera)
 {
 	Entity->Shader->Use();
-	Entity->Shader->SetMatrix4("view", Camera->MatView);
-	Entity->Shader->SetMatrix4("projection", Camera->MatProjection);
+	Entity->Shader->SetMatrix4(UniformIds::View, Camera->MatView);
+	Entity->Shader->SetMatrix4(UniformIds::Projection, Camera->MatProjection);
 	RenderEntity(Entity);
 }
 
@@ -120,95 +143,63 @@ void RenderEditorEntity(EEntity* Entity, RWorld* World, RCamera* Camera)
 // -------------
 void RenderScene(RWorld* World, RCamera* Camera)
 {
-	EPlayer* Player = EPlayer::Get();
+	RRenderPassScope Pass(NStatsPass::Main);
+
+	// lights go up first, the cluster uniforms below depend on this frame's binning
+	RLightsBuffer::Get()->Update(World);
+	RLightClusters::Get()->Update(World, Camera);
 
 	// set shader settings that are common to the scene
 	// both to "normal" model shader and to tiled model shader
 	static auto Shaders = {ShaderCatalogue.find("model")->second, ShaderCatalogue.find("tiledTextureModel")->second, ShaderCatalogue.find("color")->second};
 	for (auto* Shader : Shaders)
 	{
-		SetShaderLightVariables(World, Shader, Camera);
+		SetShaderSceneVariables(World, Shader, Camera);
+		if (Shader->Instanced)
+			SetShaderSceneVariables(World, Shader->Instanced, Camera);
 	}
 
-	REntityIterator It;
-	while (auto* Entity = It())
-	{
-		if (Entity->Flags & EntityFlags_InvisibleEntity)
-			continue;
-
-		RenderEntity(Entity);
-	}
+	// the player is a regular entity as far as the iterator goes, so it gets queued with the rest
+	auto* Queue = RRenderQueue::Get();
+	Queue->Clear();
 
-	if (!(Player->Flags & EntityFlags_InvisibleEntity))
-		RenderEntity(Player);
+	// baked static geometry goes in as a few merged batches instead of its entities
+	auto* StaticBatches = RStaticBatches::Get();
+	auto* LodSelector = RLodSelector::Get();
+	const auto CameraFrustum = RFrustum::FromMatrix(Camera->MatProjection * Camera->MatView);
+	const auto& Visible = ROcclusionCulling::Get()->Cull(
+		RCulling::Get()->Cull(NCullPass::Camera, CameraFrustum), Camera->MatProjection * Camera->MatView
+	);
+	Queue->AddParallel(Visible.size(), [&Visible, StaticBatches, LodSelector](uint Index, RDrawItem& OutItem)
+	{
+		EEntity* Entity = Visible[Index];
+		if (StaticBatches->IsBatched(Entity))
+			return false;
+
+		OutItem = RRenderQueue::MakeEntityItem(Entity, LodSelector->SelectSceneLod(Entity));
+		return true;
+	});
+	StaticBatches->AddVisible(*Queue, CameraFrustum);
+
+	Queue->Sort();
+	Queue->Submit();
+	LodSelector->CountSubmitted(NSubmitMode::Lit, Queue->GetStats());
 }
 
 
-void SetShaderLightVariables(RWorld* World, RShader* Shader, RCamera* Camera)
+// Per frame uniforms shared by the scene programs. Lights come from the uniform blocks in RLightsBuffer,
+// which of them reach a fragment from RLightClusters.
+void SetShaderSceneVariables(RWorld* World, RShader* Shader, RCamera* Camera)
 {
 	Shader->Use();
-
-	int LightCount;
-	// point lights
-	{
-		LightCount = 0;
-		for (auto& Light : World->PointLights)
-		{
-			auto UniformName = "pointLights[" + std::to_string(LightCount) + "]";
-			Shader->SetFloat3(UniformName + ".position", Light->Position);
-			Shader->SetFloat3(UniformName + ".diffuse", Light->Diffuse);
-			Shader->SetFloat3(UniformName + ".specular", Light->Specular);
-			Shader->SetFloat(UniformName + ".constant", Light->IntensityConstant);
-			Shader->SetFloat(UniformName + ".linear", Light->IntensityLinear);
-			Shader->SetFloat(UniformName + ".quadratic", Light->IntensityQuadratic);
-			LightCount++;
-		}
-		Shader->SetInt("num_point_lights", LightCount);
-	}
-
-	// spot lights
-	{
-		LightCount = 0;
-		for (auto& Light : World->SpotLights)
-		{
-			auto UniformName = "spotLights[" + std::to_string(LightCount) + "]";
-			Shader->SetFloat3(UniformName + ".position", Light->Position);
-			Shader->SetFloat3(UniformName + ".direction", Light->Direction);
-			Shader->SetFloat3(UniformName + ".diffuse", Light->Diffuse);
-			Shader->SetFloat3(UniformName + ".specular", Light->Specular);
-			Shader->SetFloat(UniformName + ".constant", Light->IntensityConstant);
-			Shader->SetFloat(UniformName + ".linear", Light->IntensityLinear);
-			Shader->SetFloat(UniformName + ".quadratic", Light->IntensityQuadratic);
-			Shader->SetFloat(UniformName + ".innercone", Light->Innercone);
-			Shader->SetFloat(UniformName + ".outercone", Light->Outercone);
-			LightCount++;
-		}
-
-		Shader->SetInt("num_spot_lights", LightCount);
-	}
-
-	// directional lights
-	{
-		LightCount = 0;
-		for (auto& Light : World->DirectionalLights)
-		{
-			auto UniformName = "dirLights[" + std::to_string(LightCount) + "]";
-			Shader->SetFloat3(UniformName + ".direction", Light->Direction);
-			Shader->SetFloat3(UniformName + ".diffuse", Light->Diffuse);
-			Shader->SetFloat3(UniformName + ".specular", Light->Specular);
-			LightCount++;
-		}
-		Shader->SetInt("num_directional_lights", LightCount);
-	}
-
-	Shader->SetMatrix4("view", Camera->MatView);
-	Shader->SetMatrix4("projection", Camera->MatProjection);
-	Shader->SetFloat3("viewPos", Camera->Position);
-	Shader->SetFloat("shininess", World->GlobalShininess);
-	Shader->SetFloat3("ambient", World->AmbientLight);
-	Shader->SetFloat("ambient_intensity", World->AmbientIntensity);
-	Shader->SetMatrix4("lightSpaceMatrix", RDirLightSpaceMatrix);
-	Shader->SetFloat("cubemap_far_plane", RCubemapFarPlane);
+	Shader->SetMatrix4(UniformIds::View, Camera->MatView);
+	Shader->SetMatrix4(UniformIds::Projection, Camera->MatProjection);
+	Shader->SetFloat3(UniformIds::ViewPos, Camera->Position);
+	Shader->SetFloat(UniformIds::Shininess, World->GlobalShininess);
+	Shader->SetFloat3(UniformIds::Ambient, World->AmbientLight);
+	Shader->SetFloat(UniformIds::AmbientIntensity, World->AmbientIntensity);
+	Shader->SetMatrix4(UniformIds::LightSpaceMatrix, RDirLightSpaceMatrix);
+	RLightClusters::Get()->SetShaderVariables(Shader, GlobalDisplayState::ViewportWidth, GlobalDisplayState::ViewportHeight);
 }
 
 // -------------------------
@@ -216,8 +207,10 @@ void SetShaderLightVariables(RWorld* World, RShader* Shader, RCamera* Camera)
 // -------------------------
 void RenderGameGui(EPlayer* Player)
 {
+	static const RFontHandle LivesFont = RTextRenderer::Get()->GetFont("consola42");
+
 	auto Color = Player->Lives == 2 ? vec3{0.1, 0.7, 0} : vec3{0.8, 0.1, 0.1};
-	RenderText("consola42", 25, 75, Color, std::to_string(Player->Lives));
+	RenderText(LivesFont, 25, 75, Color, std::to_string(Player->Lives));
 
 	if (Player->GrabbingEntity != nullptr)
 	{
@@ -232,16 +225,12 @@ void RenderGameGui(EPlayer* Player)
 // RENDER FEATURES
 // ----------------
 
-void CreateDepthBuffer()
+static void CreateDepthMapTarget(unsigned int& Fbo, unsigned int& Texture)
 {
-	// create framebuffer objects
-	glGenFramebuffers(1, &RDepthMapFbo);
-	glGenFramebuffers(1, &RDepthCubemapFbo);
-
-	// for directional lights:
 	// create framebuffer depth buffer texture
-	glGenTextures(1, &RDepthMap);
-	glBindTexture(GL_TEXTURE_2D, RDepthMap);
+	glGenFramebuffers(1, &Fbo);
+	glGenTextures(1, &Texture);
+	glBindTexture(GL_TEXTURE_2D, Texture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, RShadowBufferWidth,
 		RShadowBufferHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr
 	);
@@ -251,30 +240,20 @@ void CreateDepthBuffer()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
 	// bind texture to framebuffer
-	glBindFramebuffer(GL_FRAMEBUFFER, RDepthMapFbo);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, RDepthMap, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, Fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, Texture, 0);
 	glDrawBuffer(GL_NONE);
 	glReadBuffer(GL_NONE);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-	// for point lights:
-	glGenTextures(1, &RDepthCubemapTexture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, RDepthCubemapTexture);
-	for (unsigned int I = 0; I < 6; I++)
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + I, 0, GL_DEPTH_COMPONENT,
-			RShadowBufferWidth, RShadowBufferHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr
-		);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-	glBindFramebuffer(GL_FRAMEBUFFER, RDepthCubemapFbo);
-	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, RDepthCubemapTexture, 0);
-	glDrawBuffer(GL_NONE);
-	glReadBuffer(GL_NONE);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+void CreateDepthBuffer()
+{
+	// for directional lights:
+	CreateDepthMapTarget(RDepthMapFbo, RDepthMap);
+	CreateDepthMapTarget(RStaticDepthMapFbo, RStaticDepthMap);
+
+	// point lights go in RShadowAtlas, created on first use
 }
 
 void CreateLightSpaceTransformMatrices()
@@ -294,25 +273,67 @@ void CreateLightSpaceTransformMatrices()
 // -----------------
 // RENDER DEPTH MAP
 // -----------------
+// shared by both shadow passes, they run one after the other
+static RRenderQueue ShadowQueue;
+
+static void DrawShadowCasters(const vector<EEntity*>& Casters, RShader* DepthShader)
+{
+	auto* LodSelector = RLodSelector::Get();
+	ShadowQueue.Clear();
+	ShadowQueue.AddParallel(Casters.size(), [&Casters, DepthShader, LodSelector](uint Index, RDrawItem& OutItem)
+	{
+		OutItem = RRenderQueue::MakeEntityItem(Casters[Index], DepthShader, LodSelector->SelectShadowLod(Casters[Index]));
+		return true;
+	});
+
+	ShadowQueue.Sort();
+	ShadowQueue.Submit(NSubmitMode::DepthOnly);
+	LodSelector->CountSubmitted(NSubmitMode::DepthOnly, ShadowQueue.GetStats());
+}
+
+static void CopyDepth(unsigned int SourceFbo, unsigned int TargetFbo)
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, SourceFbo);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, TargetFbo);
+	glBlitFramebuffer(0, 0, RShadowBufferWidth, RShadowBufferHeight, 0, 0, RShadowBufferWidth, RShadowBufferHeight,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST
+	);
+}
+
 void RenderDepthMap()
 {
+	RRenderPassScope Pass(NStatsPass::DirectionalShadow);
+	auto DepthShader = ShaderCatalogue.find("depth")->second;
+	for (auto* Shader : {DepthShader, DepthShader->Instanced})
+	{
+		if (!Shader)
+			continue;
+
+		Shader->Use();
+		Shader->SetMatrix4(UniformIds::LightSpaceMatrix, RDirLightSpaceMatrix);
+	}
+
+	const auto LightFrustum = RFrustum::FromMatrix(RDirLightSpaceMatrix);
+	auto* ShadowCache = RShadowCache::Get();
+	const auto Update = ShadowCache->Update(NShadowMap::Directional, RShadowCache::HashLightKey(glm::value_ptr(RDirLightSpaceMatrix), 16),
+		RCulling::Get()->Cull(NCullPass::DirectionalShadow, LightFrustum)
+	);
+
 	// setup
 	glViewport(0, 0, RShadowBufferWidth, RShadowBufferHeight);
-	glBindFramebuffer(GL_FRAMEBUFFER, RDepthMapFbo);
 
-	glClear(GL_DEPTH_BUFFER_BIT);
-	auto DepthShader = ShaderCatalogue.find("depth")->second;
-	DepthShader->Use();
-	DepthShader->SetMatrix4("lightSpaceMatrix", RDirLightSpaceMatrix);
-
-	REntityIterator It;
-	while (auto* Entity = It())
+	if (Update.RedrawStatic)
 	{
-		if (Entity->Flags & EntityFlags_InvisibleEntity)
-			continue;
+		glBindFramebuffer(GL_FRAMEBUFFER, RStaticDepthMapFbo);
+		glClear(GL_DEPTH_BUFFER_BIT);
+		DrawShadowCasters(ShadowCache->GetStaticCasters(NShadowMap::Directional), DepthShader);
+	}
 
-		DepthShader->SetMatrix4("model", Entity->MatModel);
-		RenderMesh(Entity->Mesh, RRenderOptions{});
+	if (Update.Composite)
+	{
+		CopyDepth(RStaticDepthMapFbo, RDepthMapFbo);
+		glBindFramebuffer(GL_FRAMEBUFFER, RDepthMapFbo);
+		DrawShadowCasters(ShadowCache->GetDynamicCasters(NShadowMap::Directional), DepthShader);
 	}
 
 	// de-setup
@@ -320,55 +341,43 @@ void RenderDepthMap()
 	glViewport(0, 0, GlobalDisplayState::ViewportWidth, GlobalDisplayState::ViewportHeight);
 }
 
-void RenderDepthCubemap()
+void RenderShadowAtlas(RWorld* World, RCamera* Camera)
 {
-	auto* World = RWorld::Get();
-	// for now, testing, we are doing this just for the first point light source
-	if (World->PointLights.size() == 0)
+	RRenderPassScope Pass(NStatsPass::PointShadow);
+	auto* Atlas = RShadowAtlas::Get();
+	Atlas->Update(World->PointLights, Camera, GlobalDisplayState::ViewportHeight, RCulling::Get()->GetInput());
+	const unsigned int AtlasFbo = Atlas->PrepareGpu();
+	if (Atlas->GetJobs().empty())
 		return;
 
-	auto Light = World->PointLights[0];
-
-	float AspectRatio = static_cast<float>(RShadowBufferWidth) / static_cast<float>(RShadowBufferHeight);
-	mat4 CubemapProj = glm::perspective(glm::radians(90.0f), AspectRatio, RCubemapNearPlane, RCubemapFarPlane);
-	RPointLightSpaceMatrices[0] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0));
-	RPointLightSpaceMatrices[1] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(-1.0, 0.0, 0.0), vec3(0.0, -1.0, 0.0));
-	RPointLightSpaceMatrices[2] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(0.0, 1.0, 0.0), vec3(0.0, 0.0, 1.0));
-	RPointLightSpaceMatrices[3] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(0.0, -1.0, 0.0), vec3(0.0, 0.0, -1.0));
-	RPointLightSpaceMatrices[4] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(0.0, 0.0, 1.0), vec3(0.0, -1.0, 0.0));
-	RPointLightSpaceMatrices[5] =
-	CubemapProj * lookAt(Light->Position, Light->Position + vec3(0.0, 0.0, -1.0), vec3(0.0, -1.0, 0.0));
-
 	// setup
-	glViewport(0, 0, RShadowBufferWidth, RShadowBufferHeight);
-	glBindFramebuffer(GL_FRAMEBUFFER, RDepthCubemapFbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, AtlasFbo);
+	glEnable(GL_SCISSOR_TEST);
 
-	glClear(GL_DEPTH_BUFFER_BIT);
-	auto DepthShader = ShaderCatalogue.find("depth_cubemap")->second;
-	DepthShader->Use();
-
-	for (unsigned int i = 0; i < 6; ++i)
-		DepthShader->SetMatrix4("shadowMatrices[" + std::to_string(i) + "]", RPointLightSpaceMatrices[i]);
+	auto DepthShader = ShaderCatalogue.find("depth_atlas")->second;
+	for (const auto& Job : Atlas->GetJobs())
+	{
+		// the scissor keeps the clear inside the tile
+		glViewport(Job.X, Job.Y, Job.Size, Job.Size);
+		glScissor(Job.X, Job.Y, Job.Size, Job.Size);
+		glClear(GL_DEPTH_BUFFER_BIT);
 
-	DepthShader->SetFloat("cubemap_far_plane", RCubemapFarPlane);
-	DepthShader->SetFloat3("lightPos", Light->Position);
+		for (auto* Shader : {DepthShader, DepthShader->Instanced})
+		{
+			if (!Shader)
+				continue;
 
-	REntityIterator It;
-	while (auto* Entity = It())
-	{
-		if (Entity->Flags & EntityFlags_InvisibleEntity)
-			continue;
+			Shader->Use();
+			Shader->SetMatrix4(UniformIds::LightSpaceMatrix, Job.LightSpaceMatrix);
+			Shader->SetFloat3(UniformIds::LightPos, Job.LightPosition);
+			Shader->SetFloat(UniformIds::FarPlane, Job.FarPlane);
+		}
 
-		DepthShader->SetMatrix4("model", Entity->MatModel);
-		RenderMesh(Entity->Mesh, RRenderOptions{});
+		DrawShadowCasters(RCulling::Get()->Cull(NCullPass::PointShadow, RFrustum::FromMatrix(Job.LightSpaceMatrix)), DepthShader);
 	}
 
 	// de-setup
+	glDisable(GL_SCISSOR_TEST);
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	glViewport(0, 0, GlobalDisplayState::ViewportWidth, GlobalDisplayState::ViewportHeight);
 }
@@ -9,12 +9,9 @@ inline unsigned int RDepthMap;
 inline mat4 RDirLightSpaceMatrix;
 inline vec3 RDirectionalLightPos = vec3{-2.0f, 4.0f, -1.0f};
 
-// depth cubemap (point light shadow)
-inline unsigned int RDepthCubemapFbo;
-inline mat4 RPointLightSpaceMatrices[6];
-inline unsigned int RDepthCubemapTexture;
-inline float RCubemapNearPlane = 1.0f;
-inline float RCubemapFarPlane = 25.0f;
+// static caster depth of the directional shadow map, see RShadowCache
+inline unsigned int RStaticDepthMapFbo;
+inline unsigned int RStaticDepthMap;
 
 struct RRenderOptions
 {
@@ -36,6 +33,9 @@ inline int PFloor = -1;
 // RENDER MESH
 // --------------
 void RenderMesh(const RMesh* Mesh, RRenderOptions Opts = RRenderOptions{});
+// Just the draw call, expects the mesh VAO and everything else to be bound already
+// Lod only matters for indexed triangle meshes, see RMesh::Lods
+void DrawMeshGeometry(const RMesh* Mesh, uint Lod = 0);
 
 // --------------
 // RENDER ENTITY
@@ -47,7 +47,7 @@ void RenderEditorEntity(EEntity* Entity, RWorld* World, RCamera* Camera);
 // RENDER SCENE
 // -------------
 void RenderScene(RWorld* World, RCamera* Camera);
-void SetShaderLightVariables(RWorld* World, RShader* Shader, RCamera* Camera);
+void SetShaderSceneVariables(RWorld* World, RShader* Shader, RCamera* Camera);
 
 // -------------------------
 // RENDER GAME GUI
@@ -64,5 +64,6 @@ void CreateLightSpaceTransformMatrices();
 // RENDER DEPTH MAP
 // -----------------
 void RenderDepthMap();
-void RenderDepthCubemap();
+// point light shadows, see RShadowAtlas
+void RenderShadowAtlas(RWorld* World, RCamera* Camera);
 void RenderDepthMapDebug();
@@ -0,0 +1,183 @@
+#include "RingBuffer.h"
+#include "glad/glad.h"
+#include "RenderStats.h"
+
+#include <cstring>
+
+// how long each wait on a fence blocks before checking again, in nanoseconds
+constexpr GLuint64 FenceWaitTimeout = 1000000;
+
+void RRingBuffer::Init(NRingBufferBackend InBackend, uint InTarget, uint InFrameSize)
+{
+	Backend = InBackend;
+	Target = InTarget;
+	Create(InFrameSize);
+}
+
+void RRingBuffer::Create(uint NewFrameSize)
+{
+	for (uint Index = 0; Index < FrameCount; Index++)
+	{
+		if (Fences[Index] && Backend == NRingBufferBackend::GL)
+			glDeleteSync(static_cast<GLsync>(Fences[Index]));
+		Fences[Index] = nullptr;
+	}
+
+	FrameSize = NewFrameSize;
+	Region = 0;
+	Head = 0;
+	Generation++;
+
+	if (Backend == NRingBufferBackend::Memory)
+	{
+		// the frame's earlier allocations still point into the old memory
+		if (!Memory.empty())
+			RetiredMemory.push_back(std::move(Memory));
+		Memory.assign(static_cast<size_t>(FrameSize) * FrameCount, 0);
+		return;
+	}
+
+	// Generated before the old one is deleted, so the name can't be handed back right away. Draws
+	// already issued from the old buffer keep it alive until they are done.
+	const uint OldBuffer = Buffer;
+	glGenBuffers(1, &Buffer);
+	glBindBuffer(Target, Buffer);
+	glBufferData(Target, static_cast<GLsizeiptr>(FrameSize) * FrameCount, nullptr, GL_STREAM_DRAW);
+
+	if (OldBuffer != 0)
+		glDeleteBuffers(1, &OldBuffer);
+}
+
+void RRingBuffer::WaitForRegion(uint Index)
+{
+	if (!Fences[Index])
+		return;
+
+	if (Backend == NRingBufferBackend::GL)
+	{
+		auto Fence = static_cast<GLsync>(Fences[Index]);
+		GLenum Result = glClientWaitSync(Fence, 0, 0);
+		if (Result == GL_TIMEOUT_EXPIRED)
+		{
+			Stats.FenceWaits++;
+			do {
+				Result = glClientWaitSync(Fence, GL_SYNC_FLUSH_COMMANDS_BIT, FenceWaitTimeout);
+			} while (Result == GL_TIMEOUT_EXPIRED);
+		}
+
+		if (Result == GL_WAIT_FAILED)
+			Log("Error: Waiting on a ring buffer fence failed.")
+
+		glDeleteSync(Fence);
+	}
+	Fences[Index] = nullptr;
+}
+
+void RRingBuffer::BeginFrame()
+{
+	WaitForRegion(Region);
+	Head = 0;
+	Stats.Bytes = 0;
+	Stats.Allocations = 0;
+}
+
+void RRingBuffer::EndFrame()
+{
+	if (Backend == NRingBufferBackend::GL)
+		Fences[Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	else
+		Fences[Region] = this;
+	RetiredMemory.clear();
+
+	Region = (Region + 1) % FrameCount;
+}
+
+RRingAllocation RRingBuffer::Allocate(uint Size, uint Alignment)
+{
+	if (Size == 0 || Alignment == 0 || FrameSize == 0)
+		return {};
+
+	auto AlignedHead = [this, Alignment]()
+	{
+		const uint Start = Region * FrameSize + Head;
+		return (Start + Alignment - 1) / Alignment * Alignment - Region * FrameSize;
+	};
+
+	uint Aligned = AlignedHead();
+	if (Aligned + Size > FrameSize)
+	{
+		// nothing from earlier frames lives in the new buffer, so no need to wait before writing to it
+		uint NewFrameSize = FrameSize * 2;
+		while (NewFrameSize < Size + Alignment)
+			NewFrameSize *= 2;
+
+		Log("Ring buffer frame size grown from %u to %u bytes.", FrameSize, NewFrameSize)
+		Create(NewFrameSize);
+		Stats.Grows++;
+		Aligned = AlignedHead();
+	}
+
+	RRingAllocation Allocation;
+	Allocation.Buffer = Buffer;
+	Allocation.Generation = Generation;
+	Allocation.Offset = Region * FrameSize + Aligned;
+	Allocation.Size = Size;
+
+	if (Backend == NRingBufferBackend::GL)
+	{
+		// the fence waited on in BeginFrame already guarantees nobody is reading this range
+		glBindBuffer(Target, Buffer);
+		const GLbitfield Access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+		Allocation.Data = static_cast<uint8*>(glMapBufferRange(Target, Allocation.Offset, Size, Access));
+		if (!Allocation.Data) {
+			Log("Error: Couldn't map %u bytes of the ring buffer.", Size)
+			return {};
+		}
+	}
+	else
+	{
+		Allocation.Data = Memory.data() + Allocation.Offset;
+	}
+
+	Head = Aligned + Size;
+	Stats.Bytes += Size;
+	RRenderStats::Get()->CountUpload(Size);
+	Stats.Allocations++;
+	return Allocation;
+}
+
+void RRingBuffer::Commit(const RRingAllocation& Allocation)
+{
+	if (Backend != NRingBufferBackend::GL || !Allocation.IsValid())
+		return;
+
+	glBindBuffer(Target, Allocation.Buffer);
+	if (glUnmapBuffer(Target) == GL_FALSE)
+		Log("Error: Ring buffer contents were lost while mapped, this frame's data is undefined.")
+}
+
+RRingAllocation RRingBuffer::Upload(const void* Data, uint Size, uint Alignment)
+{
+	RRingAllocation Allocation = Allocate(Size, Alignment);
+	if (Allocation.IsValid())
+	{
+		memcpy(Allocation.Data, Data, Size);
+		Commit(Allocation);
+	}
+	return Allocation;
+}
+
+void RDynamicBuffers::Init(NRingBufferBackend Backend)
+{
+	Vertices.Init(Backend, GL_ARRAY_BUFFER, VertexFrameSize);
+}
+
+void RDynamicBuffers::BeginFrame()
+{
+	Vertices.BeginFrame();
+}
+
+void RDynamicBuffers::EndFrame()
+{
+	Vertices.EndFrame();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+/* ==========================================
+ *	Ring Buffer
+ * ========================================== */
+// Data rebuilt every frame (text quads, ImDraw lines and points, instance matrices) used to go into
+// buffers of its own, each orphaned with glBufferData and filled with glBufferSubData every frame.
+// Now it all goes through one GL buffer split in FrameCount regions, one per frame in flight. A frame
+// only writes to its own region, through unsynchronized mapped ranges, so the driver never has to
+// wait on, or copy around, draws still reading the regions of the frames before it.
+//
+// EndFrame puts a fence after the frame's commands and BeginFrame waits on the fence of the region
+// it is about to reuse, which only blocks when the CPU gets FrameCount frames ahead of the GPU.
+//
+// GL 3.3 has no buffer storage, so regions can't stay mapped: each allocation maps its own range
+// and Commit unmaps it. When a frame needs more than a region holds, the ring is recreated twice
+// as big (or big enough) and the frame carries on at the start of the new buffer. Allocations made
+// before that stay valid in GL, the old buffer lives on until the draws using it are done. The new
+// buffer can get the old one's name back on a later grow, so vertex arrays pointing into the ring
+// check the allocation's Generation rather than its Buffer to know when to re-point.
+//
+// The Memory backend keeps the ring in plain memory with fences that are always signaled. Nothing
+// in it touches GL, for tests. Memory replaced by a grow is kept until EndFrame, so the frame's
+// earlier allocations stay readable like they do in GL.
+
+enum class NRingBufferBackend : uint8
+{
+	GL,
+	Memory
+};
+
+struct RRingAllocation
+{
+	uint8* Data = nullptr;	// where to write, null if the allocation failed
+	uint Buffer = 0;		// GL buffer holding the bytes, 0 with the Memory backend
+	uint Offset = 0;		// from the start of Buffer, a multiple of the alignment asked for
+	uint Size = 0;
+	uint Generation = 0;	// of the ring's buffer, changes every time it is recreated
+
+	bool IsValid() const { return Data != nullptr; }
+};
+
+struct RRingBufferStats
+{
+	// last frame
+	uint Bytes = 0;
+	uint Allocations = 0;
+
+	// since startup
+	uint FenceWaits = 0;	// frames that had to wait for the GPU before reusing a region
+	uint Grows = 0;
+};
+
+struct RRingBuffer
+{
+	static constexpr uint FrameCount = 3;
+
+	// Target is the GL binding point used to map the buffer (GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER...)
+	void Init(NRingBufferBackend Backend, uint Target, uint FrameSize);
+
+	// Waits until the GPU is done with the region this frame writes to
+	void BeginFrame();
+	// Fences the frame's commands and moves on to the next region. Call once everything using this frame's data was issued.
+	void EndFrame();
+
+	// Alignment doesn't have to be a power of two: aligning to a vertex stride makes Offset / stride a valid first vertex.
+	// Write Size bytes to Data, then Commit before drawing from it.
+	RRingAllocation Allocate(uint Size, uint Alignment = 4);
+	void Commit(const RRingAllocation& Allocation);
+	// Allocate, copy and Commit
+	RRingAllocation Upload(const void* Data, uint Size, uint Alignment = 4);
+
+	uint GetFrameSize() const { return FrameSize; }
+	uint GetRegion() const { return Region; }
+	uint GetGeneration() const { return Generation; }
+	const RRingBufferStats& GetStats() const { return Stats; }
+
+private:
+	void Create(uint NewFrameSize);
+	void WaitForRegion(uint Index);
+
+	NRingBufferBackend Backend = NRingBufferBackend::Memory;
+	uint Target = 0;
+	uint FrameSize = 0;
+	uint Buffer = 0;
+	uint Generation = 0;
+	vector<uint8> Memory;
+	vector<vector<uint8>> RetiredMemory;	// replaced by grows this frame
+
+	// GLsync of the last frame that wrote to each region
+	void* Fences[FrameCount]{};
+	uint Region = 0;
+	uint Head = 0;			// bytes used in the current region
+
+	RRingBufferStats Stats;
+};
+
+/* ==========================================
+ *	Dynamic Buffers
+ * ========================================== */
+// The rings shared by everything uploading per frame data. MainLoop begins and ends their frames.
+
+struct RDynamicBuffers
+{
+	static RDynamicBuffers* Get()
+	{
+		static RDynamicBuffers Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint VertexFrameSize = 1024 * 1024;
+
+	RRingBuffer Vertices;
+
+	// Memory for headless runs
+	void Init(NRingBufferBackend Backend = NRingBufferBackend::GL);
+	void BeginFrame();
+	void EndFrame();
+};
@@ -1,4 +1,5 @@
 #include "Shader.h"
+#include "RenderStats.h"
 #ifndef GLAD_INCL
 #define GLAD_INCL
 #include <glad/glad.h>
@@ -14,56 +15,128 @@ map<string, RShader*> ShaderCatalogue;
 void RShader::Use()
 {
 	glUseProgram(this->GLProgramID);
+	RRenderStats::Get()->CountProgramBind();
 }
 
-void RShader::SetBool(const string& Name, bool Value) const
+struct RUniformBlockBinding
 {
-	glUniform1i(glGetUniformLocation(this->GLProgramID, Name.c_str()), static_cast<int>(Value));
+	const char* Name;
+	uint Binding;
+};
+
+static constexpr RUniformBlockBinding SharedUniformBlocks[] = {
+	{"DirectionalLightBlock", UniformBlockBindings::DirectionalLights},
+	{"PointLightBlock", UniformBlockBindings::PointLights},
+	{"SpotLightBlock", UniformBlockBindings::SpotLights},
+	{"PointShadowBlock", UniformBlockBindings::PointShadows},
+};
+
+void RShader::ReflectUniforms()
+{
+	Uniforms.Clear();
+
+	// GLSL 330 can't declare block bindings itself, so attach the shared blocks here
+	for (const auto& Block : SharedUniformBlocks)
+	{
+		const uint BlockIndex = glGetUniformBlockIndex(GLProgramID, Block.Name);
+		if (BlockIndex != GL_INVALID_INDEX)
+			glUniformBlockBinding(GLProgramID, BlockIndex, Block.Binding);
+	}
+
+	int UniformCount = 0, MaxNameLength = 0;
+	glGetProgramiv(GLProgramID, GL_ACTIVE_UNIFORMS, &UniformCount);
+	glGetProgramiv(GLProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &MaxNameLength);
+
+	string Buffer(MaxNameLength + 1, '\0');
+	for (int I = 0; I < UniformCount; I++)
+	{
+		int NameLength = 0, ArraySize = 0;
+		GLenum Type;
+		glGetActiveUniform(GLProgramID, I, MaxNameLength + 1, &NameLength, &ArraySize, &Type, Buffer.data());
+		string UniformName(Buffer.data(), NameLength);
+
+		// uniform block members have no location of their own
+		const int Location = glGetUniformLocation(GLProgramID, UniformName.c_str());
+		if (Location == -1)
+			continue;
+
+		// arrays of plain types come back once as "name[0]", register the bare name and every element.
+		// Arrays of structs are already listed member by member ("pointLights[3].diffuse").
+		const bool IsArray = UniformName.size() > 3 && UniformName.compare(UniformName.size() - 3, 3, "[0]") == 0;
+		if (!IsArray)
+		{
+			Uniforms.Add(UniformName, Location);
+			continue;
+		}
+
+		const string BaseName = UniformName.substr(0, UniformName.size() - 3);
+		Uniforms.Add(BaseName, Location);
+		for (int Element = 0; Element < ArraySize; Element++)
+		{
+			const string ElementName = BaseName + "[" + std::to_string(Element) + "]";
+			Uniforms.Add(ElementName, glGetUniformLocation(GLProgramID, ElementName.c_str()));
+		}
+	}
+}
+
+void RShader::SetBool(RUniformId Id, bool Value) const
+{
+	glUniform1i(Uniforms.Find(Id), static_cast<int>(Value));
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetInt(const string& Name, int Value) const
+void RShader::SetInt(RUniformId Id, int Value) const
 {
-	glUniform1i(glGetUniformLocation(this->GLProgramID, Name.c_str()), Value);
+	glUniform1i(Uniforms.Find(Id), Value);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat(const string& Name, float Value) const
+void RShader::SetFloat(RUniformId Id, float Value) const
 {
-	glUniform1f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Value);
+	glUniform1f(Uniforms.Find(Id), Value);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat2(const string& Name, float Value0, float Value1) const
+void RShader::SetFloat2(RUniformId Id, float Value0, float Value1) const
 {
-	glUniform2f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Value0, Value1);
+	glUniform2f(Uniforms.Find(Id), Value0, Value1);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat2(const string& Name, vec2 Vec) const
+void RShader::SetFloat2(RUniformId Id, vec2 Vec) const
 {
-	glUniform2f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Vec.x, Vec.y);
+	glUniform2f(Uniforms.Find(Id), Vec.x, Vec.y);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat3(const string& Name, float Value0, float Value1, float Value2) const
+void RShader::SetFloat3(RUniformId Id, float Value0, float Value1, float Value2) const
 {
-	glUniform3f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Value0, Value1, Value2);
+	glUniform3f(Uniforms.Find(Id), Value0, Value1, Value2);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat3(const string& Name, vec3 Vec) const
+void RShader::SetFloat3(RUniformId Id, vec3 Vec) const
 {
-	glUniform3f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Vec.x, Vec.y, Vec.z);
+	glUniform3f(Uniforms.Find(Id), Vec.x, Vec.y, Vec.z);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat4(const string& Name, float Value0, float Value1, float Value2, float Value3) const
+void RShader::SetFloat4(RUniformId Id, float Value0, float Value1, float Value2, float Value3) const
 {
-	glUniform4f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Value0, Value1, Value2, Value3);
+	glUniform4f(Uniforms.Find(Id), Value0, Value1, Value2, Value3);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetFloat4(const string& Name, glm::vec4 Vec) const
+void RShader::SetFloat4(RUniformId Id, vec4 Vec) const
 {
-	glUniform4f(glGetUniformLocation(this->GLProgramID, Name.c_str()), Vec.x, Vec.y, Vec.z, Vec.w);
+	glUniform4f(Uniforms.Find(Id), Vec.x, Vec.y, Vec.z, Vec.w);
+	RRenderStats::Get()->CountUniformSet();
 }
 
-void RShader::SetMatrix4(const string& Name, glm::mat4 Mat) const
+void RShader::SetMatrix4(RUniformId Id, const mat4& Mat) const
 {
-	glUniformMatrix4fv(glGetUniformLocation(this->GLProgramID, Name.c_str()), 1, GL_FALSE, glm::value_ptr(Mat));
+	glUniformMatrix4fv(Uniforms.Find(Id), 1, GL_FALSE, glm::value_ptr(Mat));
+	RRenderStats::Get()->CountUniformSet();
 }
 
 
@@ -98,7 +171,27 @@ bool CheckShaderCompileErrors(RShader* Shader, string Type, unsigned int Id)
 	return false;
 }
 
+// Puts Defines right after the #version line, which has to stay first
+static string InjectDefines(const string& Code, const string& Defines)
+{
+	if (Defines.empty())
+		return Code;
+
+	const auto VersionPos = Code.find("#version");
+	const auto LineEnd = VersionPos == string::npos ? string::npos : Code.find('\n', VersionPos);
+	if (LineEnd == string::npos)
+		return Defines + Code;
+
+	return Code.substr(0, LineEnd + 1) + Defines + Code.substr(LineEnd + 1);
+}
+
 RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, const string GeometryShaderFilename, const string FragmentShaderFilename)
+{
+	return CreateShaderProgram(Name, VertexShaderFilename, GeometryShaderFilename, FragmentShaderFilename, "");
+}
+
+RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, const string GeometryShaderFilename, const string FragmentShaderFilename,
+	const string Defines)
 {
 	auto Shader = new RShader();
 	Shader->Name = Name;
@@ -122,7 +215,7 @@ RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, con
 		std::stringstream VShaderStream;
 		VShaderStream << VShaderFile.rdbuf();
 		VShaderFile.close();
-		VertexCode = VShaderStream.str();
+		VertexCode = InjectDefines(VShaderStream.str(), Defines);
 
 		if (VShaderFile.fail())
 			Log("ERROR Failed to read Vertex Shader File : %s", VertexShaderFilename.c_str());
@@ -138,7 +231,7 @@ RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, con
 		std::stringstream FShaderStream;
 		FShaderStream << FShaderFile.rdbuf();
 		FShaderFile.close();
-		FragmentCode = FShaderStream.str();
+		FragmentCode = InjectDefines(FShaderStream.str(), Defines);
 
 		if (FShaderFile.fail())
 			Log("ERROR Failed to read Fragment Shader File : %s", FragmentShaderFilename.c_str());
@@ -188,7 +281,7 @@ RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, con
 			
 			GShaderStream << GShaderFile.rdbuf();
 			GShaderFile.close();
-			GeometryCode = GShaderStream.str();
+			GeometryCode = InjectDefines(GShaderStream.str(), Defines);
 
 			if (GShaderFile.fail())
 				Log("ERROR Failed to read Geometry Shader File: %s", GeometryShaderFilename.c_str());
@@ -215,6 +308,7 @@ RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, con
 	// > LINK PROGRAM
 	glLinkProgram(Shader->GLProgramID);
 	Problem = Problem || CheckShaderCompileErrors(Shader, "PROGRAM", Shader->GLProgramID);
+	Shader->ReflectUniforms();
 
 
 	// > DELETE SHADERS
@@ -226,6 +320,16 @@ RShader* CreateShaderProgram(string Name, const string VertexShaderFilename, con
 		glDeleteShader(OptionalShaders[I]);
 
 
+	// > INSTANCED VARIANT
+	// vertex shaders that know how to read the model matrix from an instance attribute get a second
+	// program compiled with INSTANCED defined, used by the render queue for batched draws
+	if (Defines.empty() && VertexCode.find("#ifdef INSTANCED") != string::npos)
+	{
+		Shader->Instanced = CreateShaderProgram(Name + "_instanced", VertexShaderFilename, GeometryShaderFilename,
+			FragmentShaderFilename, "#define INSTANCED\n");
+	}
+
+
 	// > ASSERT AND RETURN
 	//if(Problem)
 	// assert(false);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/core/core.h"
+#include "UniformTable.h"
 
 struct RShader
 {
@@ -10,20 +11,60 @@ struct RShader
 	string GeometryPath;
 	string FragmentPath;
 
+	// filled right after linking, see ReflectUniforms
+	RUniformTable Uniforms;
+
+	// same program compiled with INSTANCED defined, if the vertex shader supports it
+	RShader* Instanced = nullptr;
+
 	void Use();
+	void ReflectUniforms();
+	int GetUniformLocation(RUniformId Id) const { return Uniforms.Find(Id); }
 
-	void SetBool(const string& Name, bool Value) const;
-	void SetInt(const string& Name, int Value) const;
-	void SetFloat(const string& Name, float Value) const;
-	void SetFloat2(const string& Name, float Value0, float Value1) const;
-	void SetFloat2(const string& Name, vec2 Vec) const;
-	void SetFloat3(const string& Name, float Value0, float Value1, float Value2) const;
-	void SetFloat3(const string& Name, vec3 Vec) const;
-	void SetFloat4(const string& Name, float Value0, float Value1, float Value2, float Value3) const;
-	void SetFloat4(const string& Name, vec4 Vec) const;
-	void SetMatrix4(const string& Name, mat4 Mat) const;
+	// Ids convert implicitly from literals (hashed at compile time when used in a constant
+	// expression) and from strings (hashed at runtime, still no GL query)
+	void SetBool(RUniformId Id, bool Value) const;
+	void SetInt(RUniformId Id, int Value) const;
+	void SetFloat(RUniformId Id, float Value) const;
+	void SetFloat2(RUniformId Id, float Value0, float Value1) const;
+	void SetFloat2(RUniformId Id, vec2 Vec) const;
+	void SetFloat3(RUniformId Id, float Value0, float Value1, float Value2) const;
+	void SetFloat3(RUniformId Id, vec3 Vec) const;
+	void SetFloat4(RUniformId Id, float Value0, float Value1, float Value2, float Value3) const;
+	void SetFloat4(RUniformId Id, vec4 Vec) const;
+	void SetMatrix4(RUniformId Id, const mat4& Mat) const;
 };
 
+// ids for uniforms most programs share
+namespace UniformIds
+{
+	constexpr RUniformId Model = "model";
+	constexpr RUniformId View = "view";
+	constexpr RUniformId Projection = "projection";
+	constexpr RUniformId TextureDiffuse = "texture_diffuse1";
+	constexpr RUniformId TextureSpecular = "texture_specular1";
+	constexpr RUniformId ShadowMap = "shadowMap";
+	constexpr RUniformId ShadowAtlas = "shadowAtlas";
+	constexpr RUniformId ClusterGrid = "clusterGrid";
+	constexpr RUniformId ClusterLightIndices = "clusterLightIndices";
+	constexpr RUniformId ViewPos = "viewPos";
+	constexpr RUniformId Shininess = "shininess";
+	constexpr RUniformId Ambient = "ambient";
+	constexpr RUniformId AmbientIntensity = "ambient_intensity";
+	constexpr RUniformId LightSpaceMatrix = "lightSpaceMatrix";
+	constexpr RUniformId LightPos = "lightPos";
+	constexpr RUniformId FarPlane = "far_plane";
+}
+
+// fixed binding points for uniform blocks shared between programs, attached by name in ReflectUniforms
+namespace UniformBlockBindings
+{
+	constexpr uint DirectionalLights = 0;
+	constexpr uint PointLights = 1;
+	constexpr uint SpotLights = 2;
+	constexpr uint PointShadows = 3;
+}
+
 extern map<string, RShader*> ShaderCatalogue;
 
 bool CheckShaderCompileErrors(RShader* Shader, string Type, unsigned int Id);
@@ -35,4 +76,12 @@ RShader* CreateShaderProgram(
 	string FragmentShaderFilename
 );
 
+RShader* CreateShaderProgram(
+	string Name,
+	string VertexShaderFilename,
+	string GeometryShaderFilename,
+	string FragmentShaderFilename,
+	string Defines
+);
+
 RShader* CreateShaderProgram(string Name, string VertexShaderFilename, string FragmentShaderFilename);
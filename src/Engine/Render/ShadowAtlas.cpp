@@ -0,0 +1,399 @@
+#include "ShadowAtlas.h"
+#include "glad/glad.h"
+#include "Culling.h"
+#include "LodSelector.h"
+#include "RenderStats.h"
+#include "Shader.h"
+#include "engine/camera/camera.h"
+#include "engine/entities/lights.h"
+#include "engine/utils/utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+// every other bit of V, packed: the x (or y, with V >> 1) coordinate of a Z-order index
+static uint CompactBits(uint V)
+{
+	V &= 0x55555555;
+	V = (V | (V >> 1)) & 0x33333333;
+	V = (V | (V >> 2)) & 0x0F0F0F0F;
+	V = (V | (V >> 4)) & 0x00FF00FF;
+	V = (V | (V >> 8)) & 0x0000FFFF;
+	return V;
+}
+
+static mat4 GetFaceMatrix(vec3 Position, float Range, uint Face)
+{
+	const mat4 Projection = glm::perspective(glm::radians(90.0f), 1.f, RShadowAtlas::NearPlane, Range);
+	return Projection * glm::lookAt(Position, Position + RShadowFaceDirections[Face], RShadowFaceUps[Face]);
+}
+
+float RShadowAtlas::GetLightRange(const EPointLight& Light)
+{
+	const float Range = GetLightAttenuationRange(Light.IntensityConstant, Light.IntensityLinear, Light.IntensityQuadratic,
+		Light.Diffuse, LightCutoff, MaxRange);
+	return std::clamp(Range, 1.f, MaxRange);
+}
+
+void RShadowAtlas::Configure(uint Size, uint Budget)
+{
+	AtlasSize = std::bit_ceil(std::max(Size, MaxFaceSize));
+	FaceBudget = Budget;
+}
+
+void RShadowAtlas::Update(const vector<EPointLight*>& Lights, const RCamera* Camera, float ViewportHeight, const RCullingInput& Casters)
+{
+	// a new texture has nothing in it
+	if (TextureSize != AtlasSize)
+	{
+		for (auto& ShadowLight : ShadowLights)
+			for (auto& Face : ShadowLight.Faces)
+				Face.Rendered = false;
+	}
+
+	SelectLights(Lights, Camera, ViewportHeight);
+	FitSizes();
+	Pack();
+	MarkDirtyFaces(Casters);
+	ScheduleJobs();
+	BuildGpuBlock();
+}
+
+void RShadowAtlas::SelectLights(const vector<EPointLight*>& Lights, const RCamera* Camera, float ViewportHeight)
+{
+	const RFrustum CameraFrustum = RFrustum::FromMatrix(Camera->MatProjection * Camera->MatView);
+	const float PixelsPerUnit = ViewportHeight * 0.5f / std::tan(glm::radians(Camera->FovY) * 0.5f);
+
+	struct RCandidate
+	{
+		uint LightIndex;
+		float Range;
+		float Importance;
+	};
+	vector<RCandidate> Candidates;
+
+	const uint LightCount = std::min(static_cast<uint>(Lights.size()), RMaxPointLights);
+	for (uint i = 0; i < LightCount; i++)
+	{
+		const EPointLight& Light = *Lights[i];
+		const float Range = GetLightRange(Light);
+
+		// screen height covered by the range sphere, lights whose sphere is off screen light nothing we see
+		float Importance = 0;
+		bool OnScreen = true;
+		for (const auto& Plane : CameraFrustum.Planes)
+			OnScreen = OnScreen && dot(vec3(Plane), Light.Position) + Plane.w >= -Range;
+
+		if (OnScreen)
+		{
+			const float Distance = glm::length(Light.Position - Camera->Position);
+			Importance = Distance <= Range ? ViewportHeight : std::min(ViewportHeight, 2 * Range * PixelsPerUnit / std::sqrt(Distance * Distance - Range * Range));
+		}
+
+		Candidates.push_back({i, Range, Importance});
+	}
+
+	std::stable_sort(Candidates.begin(), Candidates.end(), [](const RCandidate& A, const RCandidate& B) { return A.Importance > B.Importance; });
+	if (Candidates.size() > RMaxPointShadows)
+		Candidates.resize(RMaxPointShadows);
+
+	vector<RShadowLight> Selected;
+	Selected.reserve(Candidates.size());
+	for (const auto& Candidate : Candidates)
+	{
+		EPointLight* Light = Lights[Candidate.LightIndex];
+		auto Found = std::find_if(ShadowLights.begin(), ShadowLights.end(), [Light](const RShadowLight& S) { return S.Light == Light; });
+
+		RShadowLight ShadowLight;
+		if (Found != ShadowLights.end())
+		{
+			ShadowLight = *Found;
+			if (ShadowLight.Position != Light->Position || ShadowLight.Range != Candidate.Range)
+			{
+				for (auto& Face : ShadowLight.Faces)
+					Face.DirtyFrames = std::max(Face.DirtyFrames, 1u);
+			}
+		}
+
+		ShadowLight.Light = Light;
+		ShadowLight.LightIndex = Candidate.LightIndex;
+		ShadowLight.Position = Light->Position;
+		ShadowLight.Range = Candidate.Range;
+		ShadowLight.Importance = Candidate.Importance;
+
+		// grow right away, only shrink once the light is a quarter of its size so it doesn't flip every frame
+		const uint Desired = std::clamp(std::bit_ceil(static_cast<uint>(Candidate.Importance)), MinFaceSize, MaxFaceSize);
+		if (ShadowLight.FaceSize == 0 || Desired > ShadowLight.FaceSize)
+			ShadowLight.FaceSize = Desired;
+		else if (Desired * 4 <= ShadowLight.FaceSize)
+			ShadowLight.FaceSize /= 2;
+
+		Selected.push_back(ShadowLight);
+	}
+
+	ShadowLights = std::move(Selected);
+}
+
+void RShadowAtlas::FitSizes()
+{
+	auto GetArea = [](uint FaceSize) { return static_cast<uint64>(FaceSize) * FaceSize * RShadowCubeFaces; };
+
+	uint64 Area = 0;
+	for (const auto& ShadowLight : ShadowLights)
+		Area += GetArea(ShadowLight.FaceSize);
+
+	// least important lights are at the back: shrink them first, drop them when nothing shrinks anymore
+	const uint64 Capacity = static_cast<uint64>(AtlasSize) * AtlasSize;
+	while (Area > Capacity && !ShadowLights.empty())
+	{
+		auto Shrink = std::find_if(ShadowLights.rbegin(), ShadowLights.rend(), [](const RShadowLight& S) { return S.FaceSize > MinFaceSize; });
+		if (Shrink != ShadowLights.rend())
+		{
+			Area -= GetArea(Shrink->FaceSize) - GetArea(Shrink->FaceSize / 2);
+			Shrink->FaceSize /= 2;
+		}
+		else
+		{
+			Area -= GetArea(ShadowLights.back().FaceSize);
+			ShadowLights.pop_back();
+		}
+	}
+
+	Stats.TexelsUsed = static_cast<uint>(Area);
+}
+
+void RShadowAtlas::Pack()
+{
+	// biggest first so every tile starts on a multiple of its own area along the curve. Ties go by light
+	// address, not importance, so lights turning around the camera don't shuffle the atlas.
+	vector<RShadowLight*> Order;
+	for (auto& ShadowLight : ShadowLights)
+		Order.push_back(&ShadowLight);
+
+	std::sort(Order.begin(), Order.end(), [](const RShadowLight* A, const RShadowLight* B)
+	{
+		if (A->FaceSize != B->FaceSize)
+			return A->FaceSize > B->FaceSize;
+		return std::less<EPointLight*>()(A->Light, B->Light);
+	});
+
+	bool Moved = false;
+	uint64 Cursor = 0;
+	for (auto* ShadowLight : Order)
+	{
+		const uint Size = ShadowLight->FaceSize;
+		for (auto& Face : ShadowLight->Faces)
+		{
+			const uint Index = static_cast<uint>(Cursor / (static_cast<uint64>(Size) * Size));
+			const uint X = CompactBits(Index) * Size;
+			const uint Y = CompactBits(Index >> 1) * Size;
+			Cursor += static_cast<uint64>(Size) * Size;
+
+			if (Face.X != X || Face.Y != Y || Face.Size != Size)
+			{
+				Face.X = X;
+				Face.Y = Y;
+				Face.Size = Size;
+				Face.Rendered = false;
+				Moved = true;
+			}
+		}
+	}
+
+	if (Moved)
+		Stats.Repacks++;
+}
+
+void RShadowAtlas::MarkDirtyFaces(const RCullingInput& Casters)
+{
+	const uint CasterCount = Casters.Size();
+	auto* LodSelector = RLodSelector::Get();
+	for (auto& ShadowLight : ShadowLights)
+	{
+		RFrustum FaceFrusta[RShadowCubeFaces];
+		uint64 Hashes[RShadowCubeFaces];
+		for (uint f = 0; f < RShadowCubeFaces; f++)
+		{
+			FaceFrusta[f] = RFrustum::FromMatrix(GetFaceMatrix(ShadowLight.Position, ShadowLight.Range, f));
+			Hashes[f] = 0;
+		}
+
+		const vec3 Center = ShadowLight.Position;
+		const float RangeSquared = ShadowLight.Range * ShadowLight.Range;
+		for (uint i = 0; i < CasterCount; i++)
+		{
+			// sphere against box, the distance from the light to the closest point of the box
+			const float Dx = std::max(abs(Casters.CenterX[i] - Center.x) - Casters.ExtentX[i], 0.f);
+			const float Dy = std::max(abs(Casters.CenterY[i] - Center.y) - Casters.ExtentY[i], 0.f);
+			const float Dz = std::max(abs(Casters.CenterZ[i] - Center.z) - Casters.ExtentZ[i], 0.f);
+			if (Dx * Dx + Dy * Dy + Dz * Dz > RangeSquared)
+				continue;
+
+			const EEntity* Entity = Casters.Entities[i];
+			const vec3 BoxCenter(Casters.CenterX[i], Casters.CenterY[i], Casters.CenterZ[i]);
+			const vec3 BoxExtent(Casters.ExtentX[i], Casters.ExtentY[i], Casters.ExtentZ[i]);
+			for (uint f = 0; f < RShadowCubeFaces; f++)
+			{
+				if (!FaceFrusta[f].TestBox(BoxCenter, BoxExtent))
+					continue;
+
+				Hashes[f] = HashCombine(Hashes[f], Entity->ID);
+				Hashes[f] = HashCombine(Hashes[f], Entity->ColliderVersion);
+				Hashes[f] = HashCombine(Hashes[f], reinterpret_cast<uint64>(Entity->Mesh));
+				Hashes[f] = HashCombine(Hashes[f], LodSelector->SelectShadowLod(Entity));
+			}
+		}
+
+		for (uint f = 0; f < RShadowCubeFaces; f++)
+		{
+			auto& Face = ShadowLight.Faces[f];
+			if (Face.CastersHash != Hashes[f])
+			{
+				Face.CastersHash = Hashes[f];
+				Face.DirtyFrames = std::max(Face.DirtyFrames, 1u);
+			}
+		}
+	}
+}
+
+void RShadowAtlas::ScheduleJobs()
+{
+	struct RCandidate
+	{
+		RShadowLight* ShadowLight;
+		uint Face;
+		bool NeverRendered;
+		float Priority;
+	};
+	vector<RCandidate> Candidates;
+
+	uint FaceCount = 0;
+	for (auto& ShadowLight : ShadowLights)
+	{
+		for (uint f = 0; f < RShadowCubeFaces; f++)
+		{
+			FaceCount++;
+			const auto& Face = ShadowLight.Faces[f];
+			// nobody sees what an off screen light lights, its faces can wait until it comes back
+			if ((Face.Rendered && Face.DirtyFrames == 0) || ShadowLight.Importance <= 0)
+				continue;
+
+			Candidates.push_back({&ShadowLight, f, !Face.Rendered, ShadowLight.Importance * Face.DirtyFrames});
+		}
+	}
+
+	const uint Count = std::min(static_cast<uint>(Candidates.size()), FaceBudget);
+	std::partial_sort(Candidates.begin(), Candidates.begin() + Count, Candidates.end(), [](const RCandidate& A, const RCandidate& B)
+	{
+		if (A.NeverRendered != B.NeverRendered)
+			return A.NeverRendered;
+		return A.Priority > B.Priority;
+	});
+
+	Jobs.clear();
+	for (uint i = 0; i < Count; i++)
+	{
+		auto& ShadowLight = *Candidates[i].ShadowLight;
+		auto& Face = ShadowLight.Faces[Candidates[i].Face];
+
+		RShadowFaceJob Job;
+		Job.X = Face.X;
+		Job.Y = Face.Y;
+		Job.Size = ShadowLight.FaceSize;
+		Job.LightSpaceMatrix = GetFaceMatrix(ShadowLight.Position, ShadowLight.Range, Candidates[i].Face);
+		Job.LightPosition = ShadowLight.Position;
+		Job.FarPlane = ShadowLight.Range;
+		Jobs.push_back(Job);
+
+		Face.Rendered = true;
+		Face.DirtyFrames = 0;
+	}
+
+	// whatever didn't make it this frame waits, and moves up the queue for it
+	for (uint i = Count; i < Candidates.size(); i++)
+	{
+		auto& Face = Candidates[i].ShadowLight->Faces[Candidates[i].Face];
+		if (Face.Rendered)
+			Face.DirtyFrames++;
+	}
+
+	Stats.ShadowedLights = ShadowLights.size();
+	Stats.FacesRendered = Count;
+	Stats.FacesPending = Candidates.size() - Count;
+	Stats.FacesRenderedTotal += Count;
+	Stats.FaceRendersAvoided += FaceCount - Count;
+}
+
+void RShadowAtlas::BuildGpuBlock()
+{
+	std::fill(std::begin(GpuBlock.Slots), std::end(GpuBlock.Slots), -1);
+	std::memset(GpuBlock.Shadows, 0, sizeof(GpuBlock.Shadows));
+
+	const float TexelSize = 1.f / AtlasSize;
+	for (uint Slot = 0; Slot < ShadowLights.size(); Slot++)
+	{
+		const auto& ShadowLight = ShadowLights[Slot];
+		auto& GpuShadow = GpuBlock.Shadows[Slot];
+		GpuBlock.Slots[ShadowLight.LightIndex] = Slot;
+		GpuShadow.FarPlane = ShadowLight.Range;
+
+		for (uint f = 0; f < RShadowCubeFaces; f++)
+		{
+			const auto& Face = ShadowLight.Faces[f];
+			if (!Face.Rendered)
+				continue;
+
+			GpuShadow.Rects[f] = vec4(Face.X + 0.5f, Face.Y + 0.5f, ShadowLight.FaceSize - 1.f, ShadowLight.FaceSize - 1.f) * TexelSize;
+		}
+	}
+}
+
+uint RShadowAtlas::PrepareGpu()
+{
+	if (UBO == 0)
+	{
+		glGenBuffers(1, &UBO);
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(RGpuPointShadowBlock), nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferBase(GL_UNIFORM_BUFFER, UniformBlockBindings::PointShadows, UBO);
+		UploadedBlockValid = false;
+	}
+
+	if (TextureSize != AtlasSize)
+	{
+		if (Texture == 0)
+		{
+			glGenTextures(1, &Texture);
+			glGenFramebuffers(1, &Fbo);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, Texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, AtlasSize, AtlasSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, Fbo);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, Texture, 0);
+		glDrawBuffer(GL_NONE);
+		glReadBuffer(GL_NONE);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		TextureSize = AtlasSize;
+	}
+
+	// the block barely changes once the lights settle, skip the upload when it didn't
+	if (!UploadedBlockValid || std::memcmp(&GpuBlock, &UploadedBlock, sizeof(GpuBlock)) != 0)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GpuBlock), &GpuBlock);
+		RRenderStats::Get()->CountUpload(sizeof(GpuBlock));
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		UploadedBlock = GpuBlock;
+		UploadedBlockValid = true;
+	}
+
+	return Fbo;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "LightsBuffer.h"
+
+struct RCullingInput;
+
+/* ==========================================
+ *	Point Light Shadow Atlas
+ * ========================================== */
+// Point light shadows live in one big 2D depth texture. Every shadowed light gets six square tiles,
+// one per cube face, rendered separately with a 90 degree perspective and sampled by picking the face
+// from the light to fragment direction (see shadowPointLight in the lit shaders). Depth is stored as
+// distance to the light over the light's range, like the old cubemap did.
+//
+// Face resolution follows how big the light's range sphere is on screen, in powers of two between
+// MinFaceSize and MaxFaceSize. Tiles are packed largest first along a Z-order curve, which leaves no
+// holes as long as sizes are powers of two and the atlas is square. When the total doesn't fit, the
+// least important lights are shrunk first and dropped last.
+//
+// Faces aren't redrawn every frame. A face is dirty when its light moved or changed range, or when
+// anything inside its frustum and the light's range was added, removed, moved or switched shadow LOD.
+// Each frame at most FaceBudget dirty faces get rendered, faces that were never rendered first, then
+// the rest by light importance times how many frames they have been waiting. Until its first render a
+// face reads as unshadowed.
+
+constexpr uint RMaxPointShadows = 64;
+constexpr uint RShadowCubeFaces = 6;
+
+// Face orientation shared with the lit shaders: looking down FaceDirections[i] with FaceUps[i] up,
+// the same as the cubemap convention the old point light shadow used.
+inline const vec3 RShadowFaceDirections[RShadowCubeFaces] = {
+	{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+};
+inline const vec3 RShadowFaceUps[RShadowCubeFaces] = {
+	{0, -1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}, {0, -1, 0}, {0, -1, 0}
+};
+
+// std140 mirror of PointShadowBlock. Rects are in atlas UV space, inset half a texel so filtering never
+// reads a neighbour tile. A zero sized rect means the face has no depth yet.
+struct RGpuPointShadow
+{
+	vec4 Rects[RShadowCubeFaces];
+	float FarPlane;
+	float Padding[3];
+};
+
+struct RGpuPointShadowBlock
+{
+	// shadow slot of each point light, -1 when it has none. ivec4 packed, std140 pads int arrays to 16 bytes.
+	int Slots[RMaxPointLights];
+	RGpuPointShadow Shadows[RMaxPointShadows];
+};
+
+static_assert(sizeof(RGpuPointShadow) == 112);
+static_assert(sizeof(RGpuPointShadowBlock) <= 16384);
+
+// One tile to render this frame
+struct RShadowFaceJob
+{
+	uint X = 0;
+	uint Y = 0;
+	uint Size = 0;
+	mat4 LightSpaceMatrix;
+	vec3 LightPosition;
+	float FarPlane = 0;
+};
+
+struct RShadowAtlasStats
+{
+	uint ShadowedLights = 0;
+	uint FacesRendered = 0;				// this frame
+	uint FacesPending = 0;				// dirty faces left for later frames
+	uint TexelsUsed = 0;
+	uint Repacks = 0;					// since startup
+	uint FacesRenderedTotal = 0;
+	uint FaceRendersAvoided = 0;		// faces that were up to date and not redrawn, since startup
+};
+
+struct RShadowAtlas
+{
+	static RShadowAtlas* Get()
+	{
+		static RShadowAtlas Instance{};
+		return &Instance;
+	}
+
+	static constexpr uint MinFaceSize = 64;
+	static constexpr uint MaxFaceSize = 1024;
+	static constexpr float NearPlane = 0.1f;
+	// lights reach until their attenuation drops below this, that's the depth range of their faces
+	static constexpr float LightCutoff = 1.f / 32.f;
+	static constexpr float MaxRange = 50.f;
+
+	// power of two, from config.txt (shadow_atlas_size)
+	uint AtlasSize = 4096;
+	// faces rendered per frame at most, from config.txt (shadow_atlas_face_budget)
+	uint FaceBudget = 6;
+
+	// Rounds the size up to a power of two no smaller than MaxFaceSize
+	void Configure(uint Size, uint Budget);
+
+	// CPU side of a frame: picks the lights and their resolution, packs the tiles, finds dirty faces and
+	// schedules this frame's jobs. Doesn't touch GL.
+	void Update(const vector<EPointLight*>& Lights, const RCamera* Camera, float ViewportHeight, const RCullingInput& Casters);
+
+	const vector<RShadowFaceJob>& GetJobs() const { return Jobs; }
+	const RGpuPointShadowBlock& GetGpuBlock() const { return GpuBlock; }
+	const RShadowAtlasStats& GetStats() const { return Stats; }
+
+	// Creates the atlas texture and uniform buffer on first use, uploads the block if anything changed.
+	// Returns the atlas framebuffer.
+	uint PrepareGpu();
+	uint GetTexture() const { return Texture; }
+
+	static float GetLightRange(const EPointLight& Light);
+
+private:
+	struct RShadowFace
+	{
+		uint X = 0;
+		uint Y = 0;
+		uint Size = 0;
+		uint64 CastersHash = 0;
+		uint DirtyFrames = 0;
+		bool Rendered = false;
+	};
+
+	struct RShadowLight
+	{
+		EPointLight* Light = nullptr;
+		uint LightIndex = 0;
+		vec3 Position;
+		float Range = 0;
+		float Importance = 0;
+		uint FaceSize = 0;
+		RShadowFace Faces[RShadowCubeFaces];
+	};
+
+	void SelectLights(const vector<EPointLight*>& Lights, const RCamera* Camera, float ViewportHeight);
+	void FitSizes();
+	void Pack();
+	void MarkDirtyFaces(const RCullingInput& Casters);
+	void ScheduleJobs();
+	void BuildGpuBlock();
+
+	vector<RShadowLight> ShadowLights;
+	vector<RShadowFaceJob> Jobs;
+	RGpuPointShadowBlock GpuBlock{};
+	RGpuPointShadowBlock UploadedBlock{};
+	bool UploadedBlockValid = false;
+	RShadowAtlasStats Stats;
+
+	uint Texture = 0;
+	uint Fbo = 0;
+	uint UBO = 0;
+	uint TextureSize = 0;
+};
@@ -0,0 +1,123 @@
+#include "ShadowCache.h"
+#include "LodSelector.h"
+#include "engine/entities/Entity.h"
+#include "engine/utils/utils.h"
+#include "engine/world/World.h"
+
+#include <bit>
+
+uint64 RShadowCache::HashLightKey(const float* Values, uint Count)
+{
+	uint64 Hash = Count;
+	for (uint i = 0; i < Count; i++)
+		Hash = HashCombine(Hash, std::bit_cast<uint>(Values[i]));
+	return Hash;
+}
+
+void RShadowCache::BeginFrame()
+{
+	Frame++;
+
+	REntityIterator It;
+	while (auto* Entity = It())
+	{
+		auto& State = Casters[Entity];
+		if (State.LastSeenFrame == 0 || State.ID != Entity->ID)
+		{
+			// new entity, or a new one reusing a deleted entity's memory: static until it moves
+			State.ID = Entity->ID;
+			State.Version = Entity->ColliderVersion;
+			State.LastMovedFrame = Frame - SettleFrames;
+		}
+		else if (State.Version != Entity->ColliderVersion)
+		{
+			State.Version = Entity->ColliderVersion;
+			State.LastMovedFrame = Frame;
+		}
+		State.LastSeenFrame = Frame;
+	}
+
+	std::erase_if(Casters, [this](const auto& Pair) { return Pair.second.LastSeenFrame != Frame; });
+}
+
+bool RShadowCache::IsDynamic(EEntity* Entity) const
+{
+	const auto Found = Casters.find(Entity);
+	return Found != Casters.end() && Frame - Found->second.LastMovedFrame < SettleFrames;
+}
+
+RShadowCacheUpdate RShadowCache::Update(NShadowMap Map, uint64 LightKey, const vector<EEntity*>& InCasters)
+{
+	auto& Entry = Entries[static_cast<uint>(Map)];
+	Entry.StaticCasters.clear();
+	Entry.DynamicCasters.clear();
+
+	RShadowCacheUpdate Result;
+	if (!Enabled)
+	{
+		Entry.StaticCasters = InCasters;
+		Entry.Valid = false;
+		Entry.LiveHasDynamic = false;
+		Entry.Stats.StaticCasters = Entry.StaticCasters.size();
+		Entry.Stats.DynamicCasters = 0;
+		Entry.Stats.StaticRedraws++;
+		Result.RedrawStatic = true;
+		Result.Composite = true;
+		return Result;
+	}
+
+	// the mesh is in there because swapping it from the editor doesn't bump the version, the LOD because
+	// it follows the camera and the static copy has to be drawn with the one DrawShadowCasters picks
+	auto* LodSelector = RLodSelector::Get();
+	uint64 CastersHash = InCasters.size();
+	for (auto* Entity : InCasters)
+	{
+		if (IsDynamic(Entity))
+		{
+			Entry.DynamicCasters.push_back(Entity);
+			continue;
+		}
+
+		Entry.StaticCasters.push_back(Entity);
+		CastersHash = HashCombine(CastersHash, Entity->ID);
+		CastersHash = HashCombine(CastersHash, Entity->ColliderVersion);
+		CastersHash = HashCombine(CastersHash, reinterpret_cast<uint64>(Entity->Mesh));
+		CastersHash = HashCombine(CastersHash, LodSelector->SelectShadowLod(Entity));
+	}
+
+	if (Entry.Valid && Entry.LightKey != LightKey)
+		Entry.Stats.LightInvalidations++;
+	else if (Entry.Valid && Entry.CastersHash != CastersHash)
+		Entry.Stats.CasterInvalidations++;
+
+	Result.RedrawStatic = !Entry.Valid || Entry.LightKey != LightKey || Entry.CastersHash != CastersHash;
+	Result.Composite = Result.RedrawStatic || Entry.LiveHasDynamic || !Entry.DynamicCasters.empty();
+
+	Entry.Valid = true;
+	Entry.LightKey = LightKey;
+	Entry.CastersHash = CastersHash;
+	Entry.LiveHasDynamic = !Entry.DynamicCasters.empty();
+
+	auto& Stats = Entry.Stats;
+	Stats.StaticCasters = Entry.StaticCasters.size();
+	Stats.DynamicCasters = Entry.DynamicCasters.size();
+	if (Result.RedrawStatic)
+		Stats.StaticRedraws++;
+	else
+		Stats.StaticRedrawsAvoided++;
+	if (!Result.Composite)
+		Stats.UntouchedFrames++;
+
+	return Result;
+}
+
+void RShadowCache::Invalidate(NShadowMap Map)
+{
+	Entries[static_cast<uint>(Map)].Valid = false;
+}
+
+void RShadowCache::InvalidateAll()
+{
+	for (auto& Entry : Entries)
+		Entry.Valid = false;
+}
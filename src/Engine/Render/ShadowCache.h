@@ -0,0 +1,110 @@
+#pragma once
+
+#include "engine/core/core.h"
+
+#include <unordered_map>
+
+/* ==========================================
+ *	Shadow Cache
+ * ========================================== */
+// Most of a level never moves, so its depth doesn't have to be redrawn into the shadow maps every
+// frame. Each shadow map keeps a static copy holding only the static casters in range of its light.
+// Every frame the static copy is blitted into the live map and the dynamic casters are drawn on top
+// of it, and when there are no dynamic casters and nothing changed the live map isn't touched at all.
+//
+// An entity counts as dynamic while its transform keeps changing (ColliderVersion is bumped by every
+// Update), and goes back to static once it has been still for SettleFrames. The static copy of a map
+// is only redrawn when its light moved or the set of static casters in range changed: one was
+// added, deleted, hidden, moved in or out of range, became dynamic / static again, or the camera moved
+// far enough for it to cast from another LOD.
+//
+// This class is only the bookkeeping, the GL side lives in RenderDepthMap. Point lights are cached per
+// face in RShadowAtlas instead.
+
+enum class NShadowMap : uint8
+{
+	Directional,
+	Count
+};
+
+struct RShadowCacheStats
+{
+	// last frame
+	uint StaticCasters = 0;
+	uint DynamicCasters = 0;
+
+	// since startup
+	uint StaticRedraws = 0;
+	uint StaticRedrawsAvoided = 0;
+	uint UntouchedFrames = 0;				// neither redrawn nor composited, the live map was already right
+	uint LightInvalidations = 0;
+	uint CasterInvalidations = 0;
+};
+
+// What a shadow pass has to do this frame
+struct RShadowCacheUpdate
+{
+	// clear the static copy and draw the static casters into it
+	bool RedrawStatic = false;
+	// blit the static copy into the live map and draw the dynamic casters on top
+	bool Composite = false;
+};
+
+struct RShadowCache
+{
+	static RShadowCache* Get()
+	{
+		static RShadowCache Instance{};
+		return &Instance;
+	}
+
+	// frames an entity has to stay still before it is cached again
+	static constexpr uint SettleFrames = 30;
+
+	// when off every caster is drawn every frame, like before caching
+	bool Enabled = true;
+
+	// Classifies every entity as static or dynamic. Call once a frame, before the shadow passes.
+	void BeginFrame();
+
+	// Splits the casters of Map in static / dynamic and works out what has to be redrawn. LightKey
+	// identifies everything about the light that ends up in the depth (see HashLightKey).
+	RShadowCacheUpdate Update(NShadowMap Map, uint64 LightKey, const vector<EEntity*>& Casters);
+
+	const vector<EEntity*>& GetStaticCasters(NShadowMap Map) const { return Entries[static_cast<uint>(Map)].StaticCasters; }
+	const vector<EEntity*>& GetDynamicCasters(NShadowMap Map) const { return Entries[static_cast<uint>(Map)].DynamicCasters; }
+	const RShadowCacheStats& GetStats(NShadowMap Map) const { return Entries[static_cast<uint>(Map)].Stats; }
+
+	bool IsDynamic(EEntity* Entity) const;
+
+	void Invalidate(NShadowMap Map);
+	void InvalidateAll();
+
+	static uint64 HashLightKey(const float* Values, uint Count);
+
+private:
+	struct RCasterState
+	{
+		RUUID ID;
+		uint Version = 0;
+		uint LastMovedFrame = 0;
+		uint LastSeenFrame = 0;
+	};
+
+	struct RCacheEntry
+	{
+		bool Valid = false;
+		// the live map holds dynamic casters from the last composite, it has to be restored
+		bool LiveHasDynamic = false;
+		uint64 LightKey = 0;
+		uint64 CastersHash = 0;
+		vector<EEntity*> StaticCasters;
+		vector<EEntity*> DynamicCasters;
+		RShadowCacheStats Stats;
+	};
+
+	std::unordered_map<EEntity*, RCasterState> Casters;
+	RCacheEntry Entries[static_cast<uint>(NShadowMap::Count)];
+	// starts past SettleFrames so entities seen on the first frame are already static
+	uint Frame = SettleFrames;
+};
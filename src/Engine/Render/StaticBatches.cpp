@@ -0,0 +1,271 @@
+#include "StaticBatches.h"
+#include "glad/glad.h"
+#include "Culling.h"
+#include "RenderQueue.h"
+#include "engine/entities/StaticMesh.h"
+#include "engine/utils/utils.h"
+#include "engine/world/World.h"
+
+#include <algorithm>
+#include <tuple>
+
+// entities hidden from the scene or drawn as wireframe keep their own draw
+constexpr Flags UnbatchedFlags = EntityFlags_InvisibleEntity | EntityFlags_HiddenEntity | EntityFlags_RenderWireframe;
+
+bool RStaticBatches::CanBatch(const EEntity* Entity)
+{
+	return Entity->TypeID == EStaticMesh::GetTypeID() && !(Entity->Flags & UnbatchedFlags) && Entity->Shader && Entity->Mesh
+		&& Entity->Mesh->RenderMethod == GL_TRIANGLES && !Entity->Mesh->Indices.empty();
+}
+
+uint64 RStaticBatches::GetCellKey(vec3 Position)
+{
+	// 21 bits per axis, biased so negative cells stay positive
+	constexpr float Bias = 1 << 20;
+	const vec3 Cell = glm::floor(Position / CellSize);
+	auto Pack = [](float V) { return static_cast<uint64>(std::clamp(V + Bias, 0.f, 2.f * Bias - 1.f)); };
+	return Pack(Cell.x) | Pack(Cell.y) << 21 | Pack(Cell.z) << 42;
+}
+
+uint64 RStaticBatches::HashEntity(const EEntity* Entity)
+{
+	uint64 Hash = HashCombine(Entity->ID, Entity->ColliderVersion);
+	Hash = HashCombine(Hash, reinterpret_cast<uint64>(Entity->Mesh));
+	Hash = HashCombine(Hash, reinterpret_cast<uint64>(Entity->Shader));
+	Hash = HashCombine(Hash, Entity->TextureDiffuse.Index);
+	return HashCombine(Hash, Entity->TextureSpecular.Index);
+}
+
+bool RStaticBatches::Matches(const RBatchedEntity& Baked, const EEntity* Entity)
+{
+	return Baked.ID == Entity->ID && Baked.Version == Entity->ColliderVersion && Baked.Mesh == Entity->Mesh && Baked.Shader == Entity->Shader
+		&& Baked.Diffuse == Entity->TextureDiffuse && Baked.Specular == Entity->TextureSpecular && Baked.Flags == Entity->Flags;
+}
+
+void RStaticBatches::AppendEntity(RBatch& Batch, const EEntity* Entity)
+{
+	// the same transform vertex_model applies, normals included (it doesn't use the inverse transpose either)
+	const mat4& Model = Entity->MatModel;
+	const glm::mat3 Linear = glm::mat3(Model);
+
+	auto& Vertices = Batch.Mesh.Vertices;
+	auto& Indices = Batch.Mesh.Indices;
+	const uint BaseVertex = Vertices.size();
+
+	for (const RVertex& Vertex : Entity->Mesh->Vertices)
+	{
+		RVertex& Out = Vertices.emplace_back(Vertex);
+		Out.Position = vec3(Model * vec4(Vertex.Position, 1.f));
+		Out.Normal = Linear * Vertex.Normal;
+		Out.Tangent = Linear * Vertex.Tangent;
+		Out.Bitangent = Linear * Vertex.Bitangent;
+	}
+
+	for (uint Index : Entity->Mesh->Indices)
+		Indices.push_back(BaseVertex + Index);
+}
+
+void RStaticBatches::BuildCell(RBatchCell& Cell, vector<const EEntity*>& CellEntities)
+{
+	ReleaseCell(Cell);
+
+	// one batch per material, entities keep their relative order so rebuilds give the same buffers
+	auto MaterialKey = [](const EEntity* Entity)
+	{
+		return std::tuple(reinterpret_cast<uintptr_t>(Entity->Shader), Entity->TextureDiffuse.Index, Entity->TextureSpecular.Index);
+	};
+	std::stable_sort(CellEntities.begin(), CellEntities.end(), [&](const EEntity* A, const EEntity* B) { return MaterialKey(A) < MaterialKey(B); });
+
+	for (uint First = 0; First < CellEntities.size();)
+	{
+		uint End = First + 1;
+		while (End < CellEntities.size() && MaterialKey(CellEntities[End]) == MaterialKey(CellEntities[First]))
+			End++;
+
+		RBatch& Batch = Cell.Batches.emplace_back();
+		Batch.Shader = CellEntities[First]->Shader;
+		Batch.Diffuse = CellEntities[First]->TextureDiffuse;
+		Batch.Specular = CellEntities[First]->TextureSpecular;
+		Batch.Mesh.Name = "static_batch";
+
+		for (uint i = First; i < End; i++)
+			AppendEntity(Batch, CellEntities[i]);
+
+		vec3 Min(MaxFloat), Max(-MaxFloat);
+		for (const RVertex& Vertex : Batch.Mesh.Vertices)
+		{
+			Min = glm::min(Min, Vertex.Position);
+			Max = glm::max(Max, Vertex.Position);
+		}
+		Batch.Center = (Min + Max) * 0.5f;
+		Batch.Extent = (Max - Min) * 0.5f;
+		Batch.Mesh.FacesCount = Batch.Mesh.Indices.size() / 3;
+
+		First = End;
+	}
+
+	for (auto& Batch : Cell.Batches)
+		Batch.Mesh.SetupGLData();
+
+	Cell.EntityCount = CellEntities.size();
+	Cell.Valid = true;
+}
+
+void RStaticBatches::ReleaseCell(RBatchCell& Cell)
+{
+	for (auto& Batch : Cell.Batches)
+		Batch.Mesh.ReleaseGLData();
+	Cell.Batches.clear();
+}
+
+void RStaticBatches::Bake()
+{
+	// gather the static entities per cell, in iteration order
+	std::unordered_map<uint64, vector<const EEntity*>> CellEntities;
+	REntityIterator EntityIt;
+	while (auto* Entity = EntityIt())
+	{
+		if (CanBatch(Entity))
+			CellEntities[GetCellKey(Entity->Position)].push_back(Entity);
+	}
+
+	Stats.CellsRebuilt = 0;
+	Stats.CellsReused = 0;
+
+	// cells that lost all their entities
+	for (auto It = Cells.begin(); It != Cells.end();)
+	{
+		if (CellEntities.contains(It->first))
+		{
+			++It;
+			continue;
+		}
+		ReleaseCell(It->second);
+		It = Cells.erase(It);
+	}
+
+	Entities.clear();
+	for (auto& [Key, CellList] : CellEntities)
+	{
+		uint64 ContentHash = CellList.size();
+		for (const EEntity* Entity : CellList)
+			ContentHash = HashCombine(ContentHash, HashEntity(Entity));
+
+		// a cell that went stale is rebuilt even when it came back to the baked state, its entities could
+		// have been replaced by ones that happen to hash the same
+		RBatchCell& Cell = Cells[Key];
+		if (Cell.Valid && Cell.ContentHash == ContentHash)
+		{
+			Stats.CellsReused++;
+		}
+		else
+		{
+			Cell.ContentHash = ContentHash;
+			BuildCell(Cell, CellList);
+			Stats.CellsRebuilt++;
+		}
+
+		for (const EEntity* Entity : CellList)
+		{
+			RBatchedEntity& Baked = Entities[Entity];
+			Baked.Cell = &Cell;
+			Baked.ID = Entity->ID;
+			Baked.Version = Entity->ColliderVersion;
+			Baked.Mesh = Entity->Mesh;
+			Baked.Shader = Entity->Shader;
+			Baked.Diffuse = Entity->TextureDiffuse;
+			Baked.Specular = Entity->TextureSpecular;
+			Baked.Flags = Entity->Flags;
+		}
+	}
+
+	Stats.Cells = Cells.size();
+	Stats.Batches = 0;
+	for (const auto& [Key, Cell] : Cells)
+		Stats.Batches += Cell.Batches.size();
+	Stats.BatchedEntities = Entities.size();
+	Stats.StaleCells = 0;
+
+	Log("Static batches: %u entities in %u batches over %u cells, %u cells rebuilt, %u reused.",
+		Stats.BatchedEntities, Stats.Batches, Stats.Cells, Stats.CellsRebuilt, Stats.CellsReused);
+}
+
+void RStaticBatches::BeginFrame()
+{
+	Stats.BatchesDrawn = 0;
+	if (Cells.empty())
+		return;
+
+	for (auto& [Key, Cell] : Cells)
+		Cell.SeenEntities = 0;
+
+	// Entities are deleted from under us, so stored pointers are only looked at once the iterator
+	// handed them out again. A baked entity the iterator never returns was deleted.
+	REntityIterator It;
+	while (auto* Entity = It())
+	{
+		const auto Found = Entities.find(Entity);
+		if (Found == Entities.end())
+			continue;
+
+		RBatchedEntity& Baked = Found->second;
+		if (Matches(Baked, Entity))
+			Baked.Cell->SeenEntities++;
+		else
+			Baked.Cell->Valid = false;
+	}
+
+	Stats.StaleCells = 0;
+	for (auto& [Key, Cell] : Cells)
+	{
+		if (Cell.SeenEntities != Cell.EntityCount)
+			Cell.Valid = false;
+		if (!Cell.Valid)
+			Stats.StaleCells++;
+	}
+}
+
+bool RStaticBatches::IsBatched(const EEntity* Entity) const
+{
+	if (!Enabled)
+		return false;
+
+	const auto Found = Entities.find(Entity);
+	return Found != Entities.end() && Found->second.Cell->Valid;
+}
+
+void RStaticBatches::AddVisible(RRenderQueue& Queue, const RFrustum& Frustum)
+{
+	if (!Enabled)
+		return;
+
+	for (auto& [Key, Cell] : Cells)
+	{
+		if (!Cell.Valid)
+			continue;
+
+		for (const RBatch& Batch : Cell.Batches)
+		{
+			if (!Frustum.TestBox(Batch.Center, Batch.Extent))
+				continue;
+
+			RDrawItem Item;
+			Item.MatModel = &Mat4Identity;
+			Item.Mesh = &Batch.Mesh;
+			Item.Shader = Batch.Shader;
+			Item.Diffuse = Batch.Diffuse;
+			Item.Specular = Batch.Specular;
+			Queue.Add(Item);
+			Stats.BatchesDrawn++;
+		}
+	}
+}
+
+void RStaticBatches::Clear()
+{
+	for (auto& [Key, Cell] : Cells)
+		ReleaseCell(Cell);
+	Cells.clear();
+	Entities.clear();
+	Stats = {};
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/geometry/mesh.h"
+
+#include <unordered_map>
+
+struct RFrustum;
+struct RRenderQueue;
+
+/* ==========================================
+ *	Static Batches
+ * ========================================== */
+// Most of a level is EStaticMesh blocks the editor placed and nothing moves afterwards. Bake merges
+// those sharing shader and textures into one mesh per cell, vertices already in world space, so the
+// scene pass draws a handful of big batches instead of one mesh per block.
+//
+// Cells are CellSize cubes on the world grid. World chunks would be the natural unit, but at 5 km a
+// side a chunk is the whole level and its batches could never be culled.
+//
+// Baking happens when leaving the editor and on save, and only rebuilds cells whose static entities
+// changed since the last bake: one was added, deleted, moved, hidden or got another mesh or material.
+// Between bakes BeginFrame watches the batched entities, and a cell where any of them changed goes
+// back to drawing its entities one by one until the next bake.
+//
+// Only the scene pass uses the batches. Shadow passes still draw entities, they are cached anyway.
+
+struct RStaticBatchStats
+{
+	uint Cells = 0;
+	uint Batches = 0;
+	uint BatchedEntities = 0;
+	uint StaleCells = 0;				// cells drawn per entity until the next bake
+
+	// last bake
+	uint CellsRebuilt = 0;
+	uint CellsReused = 0;
+
+	// last frame
+	uint BatchesDrawn = 0;
+};
+
+struct RStaticBatches
+{
+	static RStaticBatches* Get()
+	{
+		static RStaticBatches Instance{};
+		return &Instance;
+	}
+
+	static constexpr float CellSize = 32.f;
+
+	// when off everything is drawn per entity, like before batching
+	bool Enabled = true;
+
+	// Rebuilds the batches of every cell whose static entities changed. Needs a GL context.
+	void Bake();
+
+	// Finds cells whose entities changed since the bake. Call once a frame, before the scene is queued.
+	void BeginFrame();
+
+	// true when the entity is drawn by a batch and must not be queued on its own
+	bool IsBatched(const EEntity* Entity) const;
+
+	// Queues the valid batches inside the frustum
+	void AddVisible(RRenderQueue& Queue, const RFrustum& Frustum);
+
+	void Clear();
+
+	const RStaticBatchStats& GetStats() const { return Stats; }
+
+	static bool CanBatch(const EEntity* Entity);
+
+private:
+	struct RBatch
+	{
+		RShader* Shader = nullptr;
+		RTextureHandle Diffuse;
+		RTextureHandle Specular;
+		RMesh Mesh;
+		vec3 Center;
+		vec3 Extent;
+	};
+
+	struct RBatchCell
+	{
+		uint64 ContentHash = 0;
+		uint EntityCount = 0;
+		uint SeenEntities = 0;
+		bool Valid = false;
+		vector<RBatch> Batches;
+	};
+
+	// what the entity looked like when it was baked
+	struct RBatchedEntity
+	{
+		RBatchCell* Cell = nullptr;
+		RUUID ID;
+		uint Version = 0;
+		const RMesh* Mesh = nullptr;
+		RShader* Shader = nullptr;
+		RTextureHandle Diffuse;
+		RTextureHandle Specular;
+		uint Flags = 0;
+	};
+
+	static uint64 GetCellKey(vec3 Position);
+	static uint64 HashEntity(const EEntity* Entity);
+	static bool Matches(const RBatchedEntity& Baked, const EEntity* Entity);
+
+	// Appends the entity's mesh to Batch in world space
+	static void AppendEntity(RBatch& Batch, const EEntity* Entity);
+	static void BuildCell(RBatchCell& Cell, vector<const EEntity*>& Entities);
+	static void ReleaseCell(RBatchCell& Cell);
+
+	std::unordered_map<uint64, RBatchCell> Cells;
+	std::unordered_map<const EEntity*, RBatchedEntity> Entities;
+	RStaticBatchStats Stats;
+};
@@ -2,7 +2,8 @@
 
 struct RCharacter
 {
-	uint TextureID;    // ID handle of the glyph texture
+	glm::vec2 UvMin;    // Glyph rectangle inside the font atlas, normalized
+	glm::vec2 UvMax;
 	uint Advance;       // Offset to advance to next glyph
 	glm::ivec2 Size;    // Size of glyph
 	glm::ivec2 Bearing; // Offset from baseline to left/top of glyph
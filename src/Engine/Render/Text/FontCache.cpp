@@ -0,0 +1,174 @@
+#include "FontCache.h"
+#include "engine/utils/utils.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Layout: RFontCacheHeader, then per font an RFontRecordHeader followed by NameLength bytes of name,
+// CharacterCount RCharacters and the atlas, AtlasWidth * AtlasHeight bytes.
+constexpr uint FontCacheMagic = 'R' | 'F' << 8 | 'N' << 16 | 'T' << 24;
+constexpr uint FontCacheVersion = 1;
+
+struct RFontCacheHeader
+{
+	uint Magic = FontCacheMagic;
+	uint Version = FontCacheVersion;
+	uint FontCount = 0;
+};
+
+struct RFontRecordHeader
+{
+	uint64 FileHash = 0;
+	uint64 GlyphSetHash = 0;
+	int Size = 0;
+	int AtlasWidth = 0;
+	int AtlasHeight = 0;
+	uint16 NameLength = 0;
+	uint16 CharacterCount = 0;
+};
+
+static_assert(sizeof(RFontCacheHeader) == 12);
+static_assert(sizeof(RFontRecordHeader) == 32);
+static_assert(sizeof(RCharacter) == 36);
+
+// an empty name and a 1x1 atlas
+constexpr uint MinFontRecordSize = sizeof(RFontRecordHeader) + sizeof(RCharacter) * RBakedFont::CharacterCount + 1;
+
+uint64 HashFontFile(const vector<uint8>& FileData)
+{
+	// FNV-1a
+	uint64 Hash = 0xcbf29ce484222325ull;
+	for (uint8 Byte : FileData)
+	{
+		Hash ^= Byte;
+		Hash *= 0x100000001b3ull;
+	}
+	return Hash;
+}
+
+uint64 GetGlyphSetHash()
+{
+	// first character and count, bump the first argument if the set ever stops being a range
+	return HashCombine(HashCombine(1, 0), RBakedFont::CharacterCount);
+}
+
+bool ReadFontCache(const string& Filepath, vector<RBakedFont>& OutFonts)
+{
+	OutFonts.clear();
+
+	FILE* File;
+	int ErrnoOpen = fopen_s(&File, Filepath.c_str(), "rb");
+	if (!File || ErrnoOpen != 0)
+		return false;
+
+	// the whole file in one read, then parsed from memory
+	vector<uint8> Data;
+	bool Read = fseek(File, 0, SEEK_END) == 0;
+	const long FileSize = ftell(File);
+	Read &= FileSize >= 0 && fseek(File, 0, SEEK_SET) == 0;
+	if (Read)
+	{
+		Data.resize(FileSize);
+		Read = fread(Data.data(), 1, Data.size(), File) == Data.size();
+	}
+	fclose(File);
+
+	if (!Read) {
+		Log("Error: Couldn't read font cache '%s'.", Filepath.c_str())
+		return false;
+	}
+
+	uint Cursor = 0;
+	auto Take = [&Data, &Cursor](void* Destination, uint Bytes)
+	{
+		if (Data.size() - Cursor < Bytes)
+			return false;
+		memcpy(Destination, Data.data() + Cursor, Bytes);
+		Cursor += Bytes;
+		return true;
+	};
+
+	RFontCacheHeader Header;
+	if (!Take(&Header, sizeof(RFontCacheHeader)) || Header.Magic != FontCacheMagic || Header.Version != FontCacheVersion) {
+		Log("Font cache '%s' is from an older version, fonts will be baked again.", Filepath.c_str())
+		return false;
+	}
+
+	// nothing is sized from the file before checking the bytes are there
+	if (Header.FontCount > (Data.size() - Cursor) / MinFontRecordSize) {
+		Log("Error: Font cache '%s' claims more fonts than it holds, fonts will be baked again.", Filepath.c_str())
+		return false;
+	}
+
+	OutFonts.resize(Header.FontCount);
+	for (RBakedFont& Font : OutFonts)
+	{
+		RFontRecordHeader Record;
+		bool Valid = Take(&Record, sizeof(RFontRecordHeader));
+		Valid &= Record.CharacterCount == RBakedFont::CharacterCount;
+		Valid &= Record.AtlasWidth > 0 && Record.AtlasWidth <= RBakedFont::MaxAtlasSize;
+		Valid &= Record.AtlasHeight > 0 && Record.AtlasHeight <= RBakedFont::MaxAtlasSize;
+		if (Valid)
+		{
+			const size_t AtlasBytes = static_cast<size_t>(Record.AtlasWidth) * Record.AtlasHeight;
+			const size_t RecordBytes = Record.NameLength + sizeof(RCharacter) * RBakedFont::CharacterCount + AtlasBytes;
+			Valid &= Data.size() - Cursor >= RecordBytes;
+			if (Valid)
+			{
+				Font.Name.resize(Record.NameLength);
+				Font.Key = RFontCacheKey{Record.FileHash, Record.GlyphSetHash, Record.Size};
+				Font.AtlasSize = glm::ivec2(Record.AtlasWidth, Record.AtlasHeight);
+				Font.Atlas.resize(AtlasBytes);
+				Valid &= Take(Font.Name.data(), Record.NameLength);
+				Valid &= Take(Font.Characters, sizeof(RCharacter) * RBakedFont::CharacterCount);
+				Valid &= Take(Font.Atlas.data(), Font.Atlas.size());
+			}
+		}
+
+		if (!Valid) {
+			Log("Error: Invalid font record in font cache '%s', fonts will be baked again.", Filepath.c_str())
+			OutFonts.clear();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WriteFontCache(const string& Filepath, const vector<RBakedFont>& Fonts)
+{
+	FILE* File;
+	int ErrnoOpen = fopen_s(&File, Filepath.c_str(), "wb");
+	if (!File || ErrnoOpen != 0) {
+		Log("Couldn't open font cache '%s' for writing. Error code: %i", Filepath.c_str(), ErrnoOpen)
+		return false;
+	}
+
+	RFontCacheHeader Header;
+	Header.FontCount = Fonts.size();
+	bool Written = fwrite(&Header, sizeof(RFontCacheHeader), 1, File) == 1;
+
+	for (const RBakedFont& Font : Fonts)
+	{
+		RFontRecordHeader Record;
+		Record.FileHash = Font.Key.FileHash;
+		Record.GlyphSetHash = Font.Key.GlyphSetHash;
+		Record.Size = Font.Key.Size;
+		Record.AtlasWidth = Font.AtlasSize.x;
+		Record.AtlasHeight = Font.AtlasSize.y;
+		Record.NameLength = Font.Name.size();
+		Record.CharacterCount = RBakedFont::CharacterCount;
+
+		Written &= fwrite(&Record, sizeof(RFontRecordHeader), 1, File) == 1;
+		Written &= fwrite(Font.Name.data(), 1, Font.Name.size(), File) == Font.Name.size();
+		Written &= fwrite(Font.Characters, sizeof(RCharacter), RBakedFont::CharacterCount, File) == RBakedFont::CharacterCount;
+		Written &= fwrite(Font.Atlas.data(), 1, Font.Atlas.size(), File) == Font.Atlas.size();
+	}
+
+	int ErrnoClose = fclose(File);
+	if (!Written || ErrnoClose != 0) {
+		Log("Error writing font cache '%s'.", Filepath.c_str()) DEBUG_BREAK
+		return false;
+	}
+	return true;
+}
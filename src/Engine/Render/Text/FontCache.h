@@ -0,0 +1,46 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include "engine/render/text/character.h"
+
+/* ==========================================
+ *	Font Cache
+ * ========================================== */
+// Rasterizing a font through FreeType and packing its atlas happens once per font file, size and
+// glyph set, then the result goes to a single cache file with every baked font in it. At startup that
+// file is read in one go, and asking for a font whose key matches an entry only uploads its atlas.
+//
+// The key hashes the font file contents, so replacing a .ttf bakes it again even under the same
+// name. Entries whose key doesn't match anymore get replaced the next time the font is baked.
+// Nothing in here touches GL.
+
+struct RFontCacheKey
+{
+	uint64 FileHash = 0;
+	uint64 GlyphSetHash = 0;
+	int Size = 0;
+
+	bool operator==(const RFontCacheKey&) const = default;
+};
+
+struct RBakedFont
+{
+	static constexpr uint CharacterCount = 128;
+	// per side, what the packer gives up at and what a cache file may claim
+	static constexpr int MaxAtlasSize = 4096;
+
+	string Name;
+	RFontCacheKey Key;
+	glm::ivec2 AtlasSize{0};
+	RCharacter Characters[CharacterCount]{};
+	vector<uint8> Atlas;	// R8, AtlasSize.x * AtlasSize.y
+};
+
+uint64 HashFontFile(const vector<uint8>& FileData);
+// for the ASCII set every font bakes
+uint64 GetGlyphSetHash();
+
+// false when the file is missing, unreadable, from an older format version or has any record that
+// doesn't fit in it, in which case OutFonts is left empty
+bool ReadFontCache(const string& Filepath, vector<RBakedFont>& OutFonts);
+bool WriteFontCache(const string& Filepath, const vector<RBakedFont>& Fonts);
@@ -1,23 +1,28 @@
 #include <engine/core/types.h>
 #include <string>
-#include <map>
 #include <engine/render/Shader.h>
 #include <engine/render/text/character.h>
 #ifndef GLAD_INCL
 #define GLAD_INCL
 #include <glad/glad.h>
 #endif
-#include "engine/geometry/mesh.h"
-#include <iostream>
-#include <glm/gtx/normal.hpp>
+#include <glm/gtc/packing.hpp>
 #include <engine/rvn.h>
 #include <engine/render/text/TextRenderer.h>
+#include "engine/render/RenderStats.h"
+#include "engine/render/RingBuffer.h"
+#include "engine/io/display.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-map<string, gl_charmap> FontCatalogue;
-
+// atlases start at this width and double until the glyphs fit in a square
+constexpr int MinAtlasSize = 128;
+constexpr int MaxAtlasSize = RBakedFont::MaxAtlasSize;
 
 void RenderText(float X, float Y, string Text)
 {
@@ -61,158 +66,361 @@ void RenderText(string Font, float X, float Y, vec3 Color, float Scale, string T
 
 void RenderText(string Font, float X, float Y, vec3 Color, float Scale, bool Center, string Text)
 {
-	// Finds text shader in catalogue and set variables 
-	auto TextShader = ShaderCatalogue.find("text")->second;
-	TextShader->Use();
-	TextShader->SetFloat3("textColor", Color.x, Color.y, Color.z);
+	auto* TextRenderer = RTextRenderer::Get();
+	TextRenderer->AddText(TextRenderer->GetFont(Font), X, Y, Color, Scale, Center, Text);
+}
 
-	// Finds text drawing geometry in geometry catalogue
-	auto TextGeometry = GeometryCatalogue.find("text")->second;
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(TextGeometry->GLData.VAO);
+void RenderText(RFontHandle Font, float X, float Y, const string& Text)
+{
+	RTextRenderer::Get()->AddText(Font, X, Y, vec3{1.0, 1.0, 1.0}, 1.0, false, Text);
+}
+
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, const string& Text)
+{
+	RTextRenderer::Get()->AddText(Font, X, Y, Color, 1.0, false, Text);
+}
+
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, bool Center, const string& Text)
+{
+	RTextRenderer::Get()->AddText(Font, X, Y, Color, 1.0, Center, Text);
+}
+
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text)
+{
+	RTextRenderer::Get()->AddText(Font, X, Y, Color, Scale, Center, Text);
+}
+
+RFontHandle RTextRenderer::GetFont(const string& Name)
+{
+	auto Query = FontsByName.find(Name);
+	if (Query != FontsByName.end())
+		return Query->second;
+
+	// search for font size in font name (e.g. Consola12)
+	RFontHandle Font;
+	uint Index = 0;
+	while (Index < Name.size() && isalpha(Name[Index]))
+		Index++;
+
+	if (Index == 0 || Index == Name.size())
+		Log("Font '%s' could not be loaded because no size was appended to its name in render_text function call.", Name.c_str())
+	else
+		Font = LoadFont(Name, Name.substr(0, Index) + ".ttf", std::stoi(Name.substr(Index)));
+
+	// failures are remembered too, so a missing font is reported once and not searched for every frame
+	FontsByName.insert({Name, Font});
+	return Font;
+}
+
+void RTextRenderer::LoadFontCache()
+{
+	if (ReadFontCache(Paths::FontCache, BakedFonts))
+		Log("Font cache: %u baked fonts", static_cast<uint>(BakedFonts.size()))
+}
+
+static bool ReadFontFile(const string& Filepath, vector<uint8>& OutData)
+{
+	FILE* File;
+	int ErrnoOpen = fopen_s(&File, Filepath.c_str(), "rb");
+	if (!File || ErrnoOpen != 0)
+		return false;
+
+	bool Read = fseek(File, 0, SEEK_END) == 0;
+	const long FileSize = ftell(File);
+	Read &= FileSize > 0 && fseek(File, 0, SEEK_SET) == 0;
+	if (Read)
+	{
+		OutData.resize(FileSize);
+		Read = fread(OutData.data(), 1, OutData.size(), File) == OutData.size();
+	}
+	fclose(File);
+	return Read;
+}
+
+RFontHandle RTextRenderer::LoadFont(const string& Name, const string& Filename, int Size)
+{
+	// the file is read to hash it anyway, and FreeType reads it from memory when it has to bake
+	vector<uint8> FileData;
+	const string Filepath = Paths::Fonts + Filename;
+	if (!ReadFontFile(Filepath, FileData))
+	{
+		Log("Freetype: Failed to load font '%s'", Filepath.c_str())
+		return {};
+	}
+
+	const RFontCacheKey Key{HashFontFile(FileData), GetGlyphSetHash(), Size};
+	auto Cached = std::find_if(BakedFonts.begin(), BakedFonts.end(), [&Name](const RBakedFont& Baked) { return Baked.Name == Name; });
+	if (Cached != BakedFonts.end() && Cached->Key == Key)
+		return UploadFont(*Cached);
+
+	RBakedFont Baked;
+	if (!BakeFont(Name, FileData, Key, Baked))
+		return {};
+
+	Log("Font '%s' baked, %ix%i atlas", Name.c_str(), Baked.AtlasSize.x, Baked.AtlasSize.y)
+	if (Cached != BakedFonts.end())
+		*Cached = std::move(Baked);
+	else
+		Cached = BakedFonts.insert(BakedFonts.end(), std::move(Baked));
+
+	WriteFontCache(Paths::FontCache, BakedFonts);
+	return UploadFont(*Cached);
+}
 
-	// Try finding font in catalogue, if doesn't find, tries loading it
-	gl_charmap Charmap;
-	auto FontQuery = FontCatalogue.find(Font);
-	if (FontQuery == FontCatalogue.end())
+bool RTextRenderer::BakeFont(const string& Name, const vector<uint8>& FileData, const RFontCacheKey& Key, RBakedFont& OutFont)
+{
+	FT_Library Ft;
+	if (FT_Init_FreeType(&Ft))
+		FatalError("Freetype: Could not init FreeType Library");
+
+	FT_Face Face;
+	if (FT_New_Memory_Face(Ft, FileData.data(), static_cast<FT_Long>(FileData.size()), 0, &Face))
 	{
-		// search for font size in font name (e.g. Consola12) and loads it
-		int Index = 0;
-		while (true)
+		Log("Freetype: Failed to load font '%s'", Name.c_str())
+		FT_Done_FreeType(Ft);
+		return false;
+	}
+
+	FT_Set_Pixel_Sizes(Face, 0, Key.Size);
+
+	OutFont.Name = Name;
+	OutFont.Key = Key;
+
+	// rasterizes every glyph first, the atlas size depends on all of them
+	vector<vector<uint8>> Bitmaps(RFont::CharacterCount);
+	vector<glm::ivec2> Sizes(RFont::CharacterCount, glm::ivec2(0));
+	for (uint C = 0; C < RFont::CharacterCount; C++)
+	{
+		if (FT_Load_Char(Face, C, FT_LOAD_RENDER))
 		{
-			if (!isalpha(Font[Index]))
+			Log("Freetype: Failed to load Glyph");
+			continue;
+		}
+
+		const FT_Bitmap& Bitmap = Face->glyph->bitmap;
+		Sizes[C] = glm::ivec2(Bitmap.width, Bitmap.rows);
+		Bitmaps[C].resize(Bitmap.width * Bitmap.rows);
+		for (uint Row = 0; Row < Bitmap.rows; Row++)
+			std::copy_n(Bitmap.buffer + Row * Bitmap.pitch, Bitmap.width, Bitmaps[C].data() + Row * Bitmap.width);
+
+		OutFont.Characters[C].Advance = static_cast<uint>(Face->glyph->advance.x);
+		OutFont.Characters[C].Size = Sizes[C];
+		OutFont.Characters[C].Bearing = glm::ivec2(Face->glyph->bitmap_left, Face->glyph->bitmap_top);
+	}
+
+	FT_Done_Face(Face);
+	FT_Done_FreeType(Ft);
+
+	const vector<glm::ivec2> Positions = PackGlyphs(Sizes, OutFont.AtlasSize);
+	if (Positions.empty())
+	{
+		Log("Font '%s' doesn't fit in a %ix%i atlas.", Name.c_str(), MaxAtlasSize, MaxAtlasSize)
+		return false;
+	}
+
+	OutFont.Atlas.assign(OutFont.AtlasSize.x * OutFont.AtlasSize.y, 0);
+	const vec2 AtlasSize = vec2(OutFont.AtlasSize);
+	for (uint C = 0; C < RFont::CharacterCount; C++)
+	{
+		const glm::ivec2 Position = Positions[C];
+		for (int Row = 0; Row < Sizes[C].y; Row++)
+			std::copy_n(Bitmaps[C].data() + Row * Sizes[C].x, Sizes[C].x, OutFont.Atlas.data() + (Position.y + Row) * OutFont.AtlasSize.x + Position.x);
+
+		OutFont.Characters[C].UvMin = vec2(Position) / AtlasSize;
+		OutFont.Characters[C].UvMax = vec2(Position + Sizes[C]) / AtlasSize;
+	}
+
+	return true;
+}
+
+RFontHandle RTextRenderer::UploadFont(const RBakedFont& Baked)
+{
+	RFont Font;
+	Font.Name = Baked.Name;
+	Font.Size = Baked.Key.Size;
+	Font.AtlasSize = Baked.AtlasSize;
+	std::copy_n(Baked.Characters, RFont::CharacterCount, Font.Characters);
+
+	glGenTextures(1, &Font.AtlasTexture);
+	glBindTexture(GL_TEXTURE_2D, Font.AtlasTexture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, Font.AtlasSize.x, Font.AtlasSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, Baked.Atlas.data());
+	// clamped, the padding between glyphs keeps linear filtering from picking up the neighbours
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	RFontHandle Handle{static_cast<uint>(Fonts.size())};
+	Fonts.push_back(std::move(Font));
+	Streams.emplace_back();
+	return Handle;
+}
+
+vector<glm::ivec2> RTextRenderer::PackGlyphs(const vector<glm::ivec2>& Sizes, glm::ivec2& OutAtlasSize)
+{
+	// tallest first, so each shelf wastes little height
+	vector<uint> Order(Sizes.size());
+	std::iota(Order.begin(), Order.end(), 0);
+	std::stable_sort(Order.begin(), Order.end(), [&Sizes](uint A, uint B) { return Sizes[A].y > Sizes[B].y; });
+
+	vector<glm::ivec2> Positions(Sizes.size());
+	for (int Width = MinAtlasSize; Width <= MaxAtlasSize; Width *= 2)
+	{
+		int X = 0;
+		int ShelfY = 0;
+		int ShelfHeight = 0;
+		bool Fits = true;
+		for (uint Glyph : Order)
+		{
+			const glm::ivec2 Size = Sizes[Glyph];
+			if (Size.x + 2 > Width)
+			{
+				Fits = false;
 				break;
-			if (Index + 1 == Font.size())
+			}
+			if (X + Size.x + 2 > Width)
 			{
-				Log("Font '%s' could not be loaded because no size was appended to its name in render_text function call.", Font.c_str());
-				return;
+				ShelfY += ShelfHeight;
+				X = 0;
+				ShelfHeight = 0;
 			}
 
-			Index++;
+			// the first row and column stay empty, so every glyph has a pixel of padding all around
+			Positions[Glyph] = glm::ivec2(X + 1, ShelfY + 1);
+			X += Size.x + 1;
+			ShelfHeight = std::max(ShelfHeight, Size.y + 1);
 		}
 
-		string SizeStr = Font.substr(Index, Font.size());
-		string FontFilename = Font.substr(0, Index) + ".ttf";
+		const int Height = ShelfY + ShelfHeight + 1;
+		if (Fits && Height <= Width)
+		{
+			// power of two height, as short as it can be
+			int AtlasHeight = 1;
+			while (AtlasHeight < Height)
+				AtlasHeight *= 2;
 
-		int FontSize = std::stoi(SizeStr);
-		Charmap = LoadTextTextures(FontFilename, FontSize);
+			OutAtlasSize = glm::ivec2(Width, AtlasHeight);
+			return Positions;
+		}
 	}
-	else
+
+	OutAtlasSize = glm::ivec2(0);
+	return {};
+}
+
+void RTextRenderer::LayoutText(const RFont& Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text, vector<RTextVertex>& Out)
+{
+	const uint PackedColor = glm::packUnorm4x8(vec4(Color, 1.f));
+	auto GetCharacter = [&Font](char C) -> const RCharacter*
 	{
-		Charmap = FontQuery->second;
-	}
+		const auto Code = static_cast<unsigned char>(C);
+		return Code < RFont::CharacterCount ? &Font.Characters[Code] : nullptr;
+	};
 
 	//@todo add enum to CENTER, LEFT ALIGN (default, no extra work) and RIGHT ALIGN
 	if (Center)
 	{
-		std::string::iterator It;
 		float XSum = 0;
-		for (It = Text.begin(); It != Text.end(); ++It)
+		for (char C : Text)
 		{
-			auto Ch = Charmap[*It];
-			XSum += Ch.Bearing.x * Scale + Ch.Size.x * Scale;
+			if (const RCharacter* Ch = GetCharacter(C))
+				XSum += Ch->Bearing.x * Scale + Ch->Size.x * Scale;
 		}
 		X -= XSum / 2.0;
 	}
 
-
-	glDepthFunc(GL_ALWAYS);
-	std::string::iterator CharIt;
-	for (CharIt = Text.begin(); CharIt != Text.end(); ++CharIt)
+	for (char C : Text)
 	{
-		RCharacter Ch = Charmap[*CharIt];
-
-		GLfloat Xpos = X + Ch.Bearing.x * Scale;
-		GLfloat Ypos = Y - (Ch.Size.y - Ch.Bearing.y) * Scale;
-		GLfloat W = Ch.Size.x * Scale;
-		GLfloat H = Ch.Size.y * Scale;
-		// Update VBO for each character
-		GLfloat Vertices[6][4] = {
-		{Xpos, Ypos + H, 0.0, 0.0},
-		{Xpos, Ypos, 0.0, 1.0},
-		{Xpos + W, Ypos, 1.0, 1.0},
-		{Xpos, Ypos + H, 0.0, 0.0},
-		{Xpos + W, Ypos, 1.0, 1.0},
-		{Xpos + W, Ypos + H, 1.0, 0.0}
-		};
-
-		// Render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, Ch.TextureID);
-		// Update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, TextGeometry->GLData.VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertices), Vertices);
-		// Render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-		X += (Ch.Advance >> 6) * Scale; // Bitshift by 6 to get value in pixels (2^6 = 64)
+		const RCharacter* Ch = GetCharacter(C);
+		if (!Ch)
+			continue;
+
+		const float Xpos = X + Ch->Bearing.x * Scale;
+		const float Ypos = Y - (Ch->Size.y - Ch->Bearing.y) * Scale;
+		const float W = Ch->Size.x * Scale;
+		const float H = Ch->Size.y * Scale;
+		X += (Ch->Advance >> 6) * Scale; // Bitshift by 6 to get value in pixels (2^6 = 64)
+		if (Ch->Size.x == 0 || Ch->Size.y == 0)
+			continue;
+
+		// atlas rows go top down, so the top of the quad takes the top of the glyph
+		const RTextVertex TopLeft{{Xpos, Ypos + H}, {Ch->UvMin.x, Ch->UvMin.y}, PackedColor};
+		const RTextVertex BottomLeft{{Xpos, Ypos}, {Ch->UvMin.x, Ch->UvMax.y}, PackedColor};
+		const RTextVertex BottomRight{{Xpos + W, Ypos}, {Ch->UvMax.x, Ch->UvMax.y}, PackedColor};
+		const RTextVertex TopRight{{Xpos + W, Ypos + H}, {Ch->UvMax.x, Ch->UvMin.y}, PackedColor};
+		Out.insert(Out.end(), {TopLeft, BottomLeft, BottomRight, TopLeft, BottomRight, TopRight});
 	}
-	glDepthFunc(GL_LESS);
 }
 
-gl_charmap LoadTextTextures(string Font, int Size)
+void RTextRenderer::AddText(RFontHandle Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text)
 {
-	// Load font
-	FT_Library Ft;
-	if (FT_Init_FreeType(&Ft))
-		FatalError("Freetype: Could not init FreeType Library");
+	if (!Font.IsValid())
+		return;
 
-	FT_Face Face;
-	string Filepath = Paths::Fonts + Font;
-	if (FT_New_Face(Ft, Filepath.c_str(), 0, &Face))
-		Log("Freetype: Failed to load font");
+	LayoutText(Fonts[Font.Index], X, Y, Color, Scale, Center, Text, Streams[Font.Index]);
+	TextCalls++;
+}
 
-	FT_Set_Pixel_Sizes(Face, 0, Size);
+void RTextRenderer::Flush()
+{
+	RRenderPassScope Pass(NStatsPass::Text);
+	Stats = {};
+	Stats.TextCalls = TextCalls;
+	TextCalls = 0;
 
-	gl_charmap FontCharmap;
-	//we will store all characters inside the Characters map
-	for (GLubyte C = 0; C < 128; C++)
-	{
-		//Load character glyph
-		if (FT_Load_Char(Face, C, FT_LOAD_RENDER))
-		{
-			Log("Freetype: Failed to load Glyph");
-			continue;
-		}
+	Upload.clear();
+	for (const auto& Stream : Streams)
+		Upload.insert(Upload.end(), Stream.begin(), Stream.end());
 
-		GLuint GylphTexture;
-		glGenTextures(1, &GylphTexture);
-		glBindTexture(GL_TEXTURE_2D, GylphTexture);
-		glTexImage2D(
-			GL_TEXTURE_2D,
-			0,
-			GL_RED,
-			Face->glyph->bitmap.width,
-			Face->glyph->bitmap.rows,
-			0,
-			GL_RED,
-			GL_UNSIGNED_BYTE,
-			Face->glyph->bitmap.buffer
-		);
-		// Set texture options
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		// Now store character for later use
-		RCharacter Character = {
-			.TextureID = GylphTexture,
-			.Advance = static_cast<uint>(Face->glyph->advance.x),
-			.Size = glm::ivec2(Face->glyph->bitmap.width, Face->glyph->bitmap.rows),
-			.Bearing = glm::ivec2(Face->glyph->bitmap_left, Face->glyph->bitmap_top)
-		};
-
-		FontCharmap.insert(std::pair<GLchar, RCharacter>(C, Character));
+	if (Upload.empty())
+		return;
+
+	const RRingAllocation Allocation = RDynamicBuffers::Get()->Vertices.Upload(Upload.data(), Upload.size() * sizeof(RTextVertex), sizeof(RTextVertex));
+	if (!Allocation.IsValid())
+	{
+		for (auto& Stream : Streams)
+			Stream.clear();
+		return;
 	}
 
-	// saves font chars to catalogue
-	auto Separator = Font.find('.');
-	string FontName = Font.substr(0, Separator);
-	string FontCatalogueName = FontName + std::to_string(Size);
+	if (VAO == 0)
+		glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
 
-	FontCatalogue.insert({FontCatalogueName, FontCharmap});
+	// the ring only changes buffer when it grows
+	if (VAOGeneration != Allocation.Generation)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, Allocation.Buffer);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(RTextVertex), reinterpret_cast<void*>(offsetof(RTextVertex, Position)));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(RTextVertex), reinterpret_cast<void*>(offsetof(RTextVertex, Color)));
+		glEnableVertexAttribArray(1);
+		VAOGeneration = Allocation.Generation;
+	}
 
-	glBindTexture(GL_TEXTURE_2D, 0);
-	FT_Done_Face(Face);
-	FT_Done_FreeType(Ft);
+	auto* TextShader = ShaderCatalogue.find("text")->second;
+	TextShader->Use();
+	TextShader->SetMatrix4(UniformIds::Projection, glm::ortho(0.0f, GlobalDisplayState::ViewportWidth, 0.0f, GlobalDisplayState::ViewportHeight));
 
-	return FontCharmap;
+	glActiveTexture(GL_TEXTURE0);
+	glDepthFunc(GL_ALWAYS);
+	uint First = Allocation.Offset / sizeof(RTextVertex);
+	for (uint FontIndex = 0; FontIndex < Streams.size(); FontIndex++)
+	{
+		auto& Stream = Streams[FontIndex];
+		if (Stream.empty())
+			continue;
+
+		glBindTexture(GL_TEXTURE_2D, Fonts[FontIndex].AtlasTexture);
+		glDrawArrays(GL_TRIANGLES, First, Stream.size());
+		RRenderStats::Get()->CountTextureBind();
+		RRenderStats::Get()->CountDraw(GL_TRIANGLES, Stream.size());
+		First += Stream.size();
+		Stats.Glyphs += Stream.size() / 6;
+		Stats.DrawCalls++;
+		Stream.clear();
+	}
+	glDepthFunc(GL_LESS);
+	glBindVertexArray(0);
 }
@@ -1,8 +1,105 @@
 #pragma once
 
-struct RCharacter;
+#include "engine/core/core.h"
+#include "engine/render/text/character.h"
+#include "engine/render/text/FontCache.h"
 
-using gl_charmap = map<char, RCharacter>;
+#include <unordered_map>
+
+/* ==========================================
+ *	Text Renderer
+ * ========================================== */
+// Every font, at every size, is baked once into a single atlas texture holding its ASCII glyphs.
+// RenderText doesn't draw anything: it lays out one quad per glyph, color included, and appends them
+// to this frame's stream for that font. Flush, at the end of the render phase, uploads the whole
+// stream at once into the vertex ring (see RingBuffer.h) and draws it with one call per atlas used
+// this frame.
+//
+// Fonts are named by file and pixel size, "consola18" being consola.ttf at 18 px. GetFont resolves a
+// name once, loading the font the first time it is asked for, and code drawing text every frame
+// keeps the handle it got. The string overloads of RenderText resolve on every call. Baked fonts are
+// kept in the font cache (see FontCache.h), so FreeType only runs for fonts it doesn't have yet.
+
+struct RFontHandle
+{
+	uint Index = MaxUint;
+
+	bool IsValid() const { return Index != MaxUint; }
+};
+
+struct RFont
+{
+	static constexpr uint CharacterCount = RBakedFont::CharacterCount;
+
+	string Name;
+	int Size = 0;
+	uint AtlasTexture = 0;
+	glm::ivec2 AtlasSize{0};
+	RCharacter Characters[CharacterCount]{};
+};
+
+struct RTextVertex
+{
+	vec2 Position;
+	vec2 TexCoords;
+	uint Color;		// RGBA8
+};
+
+struct RTextStats
+{
+	// last flush
+	uint Glyphs = 0;
+	uint DrawCalls = 0;
+	uint TextCalls = 0;
+};
+
+struct RTextRenderer
+{
+	static RTextRenderer* Get()
+	{
+		static RTextRenderer Instance{};
+		return &Instance;
+	}
+
+	// Reads the baked fonts from the cache file. Call once at startup, before asking for fonts.
+	void LoadFontCache();
+
+	// Invalid handle, logged once, when the name has no size or the font file can't be loaded
+	RFontHandle GetFont(const string& Name);
+	const RFont& GetFontData(RFontHandle Font) const { return Fonts[Font.Index]; }
+
+	void AddText(RFontHandle Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text);
+	// Draws and clears everything added since the last flush
+	void Flush();
+	const RTextStats& GetStats() const { return Stats; }
+
+	// Appends the quads of Text, two triangles per glyph, laid out from the baseline at X, Y. GL free, for tests.
+	static void LayoutText(const RFont& Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text, vector<RTextVertex>& Out);
+	// Shelf packs the glyph rectangles, a pixel apart, into a power of two atlas and returns where each went
+	static vector<glm::ivec2> PackGlyphs(const vector<glm::ivec2>& Sizes, glm::ivec2& OutAtlasSize);
+
+	// Rasterizes the glyphs of the font file in FileData and packs them into an atlas. GL free.
+	static bool BakeFont(const string& Name, const vector<uint8>& FileData, const RFontCacheKey& Key, RBakedFont& OutFont);
+
+private:
+	RFontHandle LoadFont(const string& Name, const string& Filename, int Size);
+	RFontHandle UploadFont(const RBakedFont& Baked);
+
+	vector<RFont> Fonts;
+	std::unordered_map<string, RFontHandle> FontsByName;
+
+	// everything in the cache file, what was read at startup plus what got baked since
+	vector<RBakedFont> BakedFonts;
+
+	// this frame's quads, one stream per font
+	vector<vector<RTextVertex>> Streams;
+	vector<RTextVertex> Upload;
+	uint TextCalls = 0;
+
+	uint VAO = 0;
+	uint VAOGeneration = 0;		// of the ring buffer VAO's attributes point into
+	RTextStats Stats;
+};
 
 void RenderText(float X, float Y, string Text);
 void RenderText(float X, float Y, vec3 Color, string Text);
@@ -13,7 +110,8 @@ void RenderText(string Font, float X, float Y, vec3 Color, bool Center, string T
 void RenderText(string Font, float X, float Y, float Scale, string Text);
 void RenderText(string Font, float X, float Y, vec3 Color, float Scale, string Text);
 void RenderText(string Font, float X, float Y, vec3 Color, float Scale, bool Center, string Text);
-gl_charmap LoadTextTextures(string Font, int Size);
-
 
-extern map<string, gl_charmap> FontCatalogue;
+void RenderText(RFontHandle Font, float X, float Y, const string& Text);
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, const string& Text);
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, bool Center, const string& Text);
+void RenderText(RFontHandle Font, float X, float Y, vec3 Color, float Scale, bool Center, const string& Text);
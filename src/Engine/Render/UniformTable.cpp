@@ -0,0 +1,62 @@
+#include "UniformTable.h"
+
+bool RUniformTable::Add(std::string_view Name, int Location)
+{
+	// keep the load factor at or below one half so probes stay short
+	if ((Count + 1) * 2 > Slots.size())
+		Grow();
+
+	const RUniformId Id = RUniformId::FromHash(HashUniformName(Name));
+	const uint Mask = static_cast<uint>(Slots.size()) - 1;
+	for (uint Index = Id.Hash & Mask;; Index = (Index + 1) & Mask)
+	{
+		auto& Slot = Slots[Index];
+		if (Slot.Hash == 0)
+		{
+			Slot.Hash = Id.Hash;
+			Slot.Location = Location;
+			Slot.NameIndex = static_cast<uint>(Names.size());
+			Names.emplace_back(Name);
+			Count++;
+			return true;
+		}
+
+		if (Slot.Hash == Id.Hash)
+		{
+			if (Names[Slot.NameIndex] == Name)
+			{
+				Slot.Location = Location;
+				return true;
+			}
+
+			Log("WARNING: uniform '%.*s' has the same hash as '%s', it won't be settable through its id.",
+				static_cast<int>(Name.size()), Name.data(), Names[Slot.NameIndex].c_str());
+			return false;
+		}
+	}
+}
+
+void RUniformTable::Clear()
+{
+	Slots.clear();
+	Names.clear();
+	Count = 0;
+}
+
+void RUniformTable::Grow()
+{
+	vector<RSlot> OldSlots = std::move(Slots);
+	Slots.assign(OldSlots.empty() ? 16 : OldSlots.size() * 2, RSlot{});
+
+	const uint Mask = static_cast<uint>(Slots.size()) - 1;
+	for (const auto& OldSlot : OldSlots)
+	{
+		if (OldSlot.Hash == 0)
+			continue;
+
+		uint Index = OldSlot.Hash & Mask;
+		while (Slots[Index].Hash != 0)
+			Index = (Index + 1) & Mask;
+		Slots[Index] = OldSlot;
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "engine/core/core.h"
+#include <array>
+#include <string_view>
+
+/* ==========================================
+ *	Uniform Table
+ * ========================================== */
+// Uniform locations are reflected once after linking (see RShader::ReflectUniforms) and kept in a
+// small open-addressed table keyed by a FNV-1a hash of the uniform name. Setting a uniform then is a
+// hash probe instead of a string copy + glGetUniformLocation round trip.
+//
+// RUniformId carries the hash. Built from a literal it's always computed at compile time, the
+// const char* constructor is consteval and names only known at runtime go through the string one.
+// Indexed names like "pointLights[3].diffuse" can be generated as constexpr arrays with
+// MakeIndexedUniformIds, so the frame loop never has to build the name. Nothing in here touches GL.
+
+constexpr uint HashUniformName(std::string_view Name, uint Hash = 2166136261u)
+{
+	for (char C : Name)
+	{
+		Hash ^= static_cast<uint8>(C);
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+struct RUniformId
+{
+	uint Hash = 0;
+
+	constexpr RUniformId() = default;
+	consteval RUniformId(const char* Name) : Hash(FinalizeHash(HashUniformName(Name))) {}
+	RUniformId(const string& Name) : Hash(FinalizeHash(HashUniformName(Name))) {}
+
+	// the table uses 0 to mark empty slots
+	static constexpr uint FinalizeHash(uint Hash) { return Hash == 0 ? 1 : Hash; }
+	static constexpr RUniformId FromHash(uint Hash)
+	{
+		RUniformId Id;
+		Id.Hash = FinalizeHash(Hash);
+		return Id;
+	}
+
+	constexpr bool operator==(const RUniformId& Other) const { return Hash == Other.Hash; }
+};
+
+// Hashes Prefix + "[" + Index + "]" + Field without ever building the string
+constexpr RUniformId MakeIndexedUniformId(std::string_view Prefix, uint Index, std::string_view Field)
+{
+	char Digits[10] = {};
+	uint DigitCount = 0;
+	do
+	{
+		Digits[DigitCount++] = static_cast<char>('0' + Index % 10);
+		Index /= 10;
+	}
+	while (Index > 0);
+
+	uint Hash = HashUniformName(Prefix);
+	Hash = HashUniformName("[", Hash);
+	while (DigitCount > 0)
+		Hash = HashUniformName(std::string_view(&Digits[--DigitCount], 1), Hash);
+	Hash = HashUniformName("]", Hash);
+	Hash = HashUniformName(Field, Hash);
+	return RUniformId::FromHash(Hash);
+}
+
+template<uint N>
+constexpr std::array<RUniformId, N> MakeIndexedUniformIds(std::string_view Prefix, std::string_view Field)
+{
+	std::array<RUniformId, N> Ids{};
+	for (uint I = 0; I < N; I++)
+		Ids[I] = MakeIndexedUniformId(Prefix, I, Field);
+	return Ids;
+}
+
+struct RUniformTable
+{
+	// Returns false if the name collides with a different one already in the table (the first one wins)
+	bool Add(std::string_view Name, int Location);
+	void Clear();
+
+	int Find(RUniformId Id) const
+	{
+		if (Slots.empty())
+			return -1;
+
+		const uint Mask = static_cast<uint>(Slots.size()) - 1;
+		for (uint Index = Id.Hash & Mask;; Index = (Index + 1) & Mask)
+		{
+			const auto& Slot = Slots[Index];
+			if (Slot.Hash == Id.Hash)
+				return Slot.Location;
+			if (Slot.Hash == 0)
+				return -1;
+		}
+	}
+
+	bool Contains(RUniformId Id) const { return Find(Id) != -1; }
+	uint Size() const { return Count; }
+	const vector<string>& GetNames() const { return Names; }
+
+private:
+	struct RSlot
+	{
+		uint Hash = 0;
+		int Location = -1;
+		uint NameIndex = 0;
+	};
+
+	void Grow();
+
+	vector<RSlot> Slots;
+	vector<string> Names;
+	uint Count = 0;
+};
@@ -53,13 +53,15 @@ void REditorMsgManager::Update()
 
 void REditorMsgManager::Render()
 {
+	static const RFontHandle Font = RTextRenderer::Get()->GetFont("consola20");
+
 	int ItemsRendered = 0;
 	for (auto& Msg : Messages)
 	{
 		if (ItemsRendered == MaxMessagesToRender) break;
 
 		RenderText(
-			"consola20",
+			Font,
 			GlobalDisplayState::ViewportWidth / 2,
 			GlobalDisplayState::ViewportHeight - 120 - ItemsRendered * 25,
 			Msg.Color == vec3(-1) ? vec3(0.8, 0.8, 0.2) : Msg.Color,
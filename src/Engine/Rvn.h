@@ -19,6 +19,7 @@ namespace Paths
 	const static string SceneTemplate = "template_scene";
 	const static string InputRecordings = Project + "/recordings/";
 	const static string MeshExports = Project + "/bin/models/";
+	const static string FontCache = Project + "/bin/fonts.rfont";
 }
 
 // TODO: Get Rid of this
@@ -34,6 +35,8 @@ struct ProgramConfig
 	float Camspeed = 1;
 	vec3 AmbientLight;
 	float AmbientIntensity = 0;
+	uint ShadowAtlasSize = 4096;
+	uint ShadowAtlasFaceBudget = 6;
 };
 
 
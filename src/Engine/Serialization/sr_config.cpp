@@ -58,6 +58,18 @@ void ConfigSerializer::LoadGlobalConfigs()
 			Parse.ParseFloat();
 			Config.AmbientIntensity = GetParsed<float>(Parse);
 		}
+		else if (Attribute == "shadow_atlas_size")
+		{
+			Parse.ParseAllWhitespace();
+			Parse.ParseUint();
+			Config.ShadowAtlasSize = GetParsed<uint>(Parse);
+		}
+		else if (Attribute == "shadow_atlas_face_budget")
+		{
+			Parse.ParseAllWhitespace();
+			Parse.ParseUint();
+			Config.ShadowAtlasFaceBudget = GetParsed<uint>(Parse);
+		}
 	}
 }
 
@@ -93,6 +105,8 @@ bool ConfigSerializer::Save(const ProgramConfig& Config)
 	<< Config.AmbientLight.z << "\n";
 
 	Writer << "ambient_intensity = " << Config.AmbientIntensity << "\n";
+	Writer << "shadow_atlas_size = " << Config.ShadowAtlasSize << "\n";
+	Writer << "shadow_atlas_face_budget = " << Config.ShadowAtlasFaceBudget << "\n";
 
 	Writer.close();
 	std::cout << "Config file saved succesfully.\n";
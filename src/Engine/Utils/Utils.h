@@ -214,3 +214,15 @@ inline float Max(float a, float b, float c)
 {
 	return Max(a, Max(b, c));
 }
+
+// Mixes Value into Hash, splitmix64 finalizer. For change detection, not for anything adversarial.
+inline uint64 HashCombine(uint64 Hash, uint64 Value)
+{
+	Hash ^= Value + 0x9e3779b97f4a7c15ull + (Hash << 6) + (Hash >> 2);
+	Hash ^= Hash >> 30;
+	Hash *= 0xbf58476d1ce4e5b9ull;
+	Hash ^= Hash >> 27;
+	Hash *= 0x94d049bb133111ebull;
+	Hash ^= Hash >> 31;
+	return Hash;
+}
@@ -2,6 +2,8 @@
 #include "engine/catalogues.h"
 #include "Engine/RavenousEngine.h"
 #include "engine/entities/Entity.h"
+#include "engine/collision/ColliderCache.h"
+#include "engine/core/JobSystem.h"
 #include "engine/entities/lights.h"
 #include "engine/render/ImRender.h"
 #include "engine/utils/utils.h"
@@ -31,13 +33,57 @@ void RWorld::Erase()
 		delete EntitySlot.Value;
 		EntityStorage.Empty(&EntitySlot);
 	}
+
+	// slots hold raw pointers to the entities we just deleted
+	RColliderCache::Get()->Clear();
+	MarkLightsDirty();
+}
+
+void RWorld::MarkLightsDirty()
+{
+	PointLightsDirty.MarkAll();
+	SpotLightsDirty.MarkAll();
+	DirectionalLightsDirty.MarkAll();
 }
 
 void RWorld::UpdateTransforms()
 {
+	TransformEntities.clear();
 	REntityIterator It;
 	while (auto* Entity = It()) {
-		Entity->Update();
+		TransformEntities.push_back(Entity);
+	}
+
+	UpdateTransforms(TransformEntities);
+}
+
+void RWorld::UpdateTransforms(const vector<EEntity*>& Entities)
+{
+	// Same result as calling Update() on each entity, but the matrices and AABBs are computed
+	// by the batch kernel, split across the job system for big batches.
+	const uint Count = static_cast<uint>(Entities.size());
+
+	TransformBatch.Clear();
+	TransformBatch.Reserve(Count);
+	for (auto* Entity : Entities) {
+		const RBoundingBox* LocalBounds = Entity->CollisionMesh ? &Entity->CollisionMesh->GetBounds() : nullptr;
+		TransformBatch.Add(Entity->Position, Entity->Rotation, Entity->Scale, LocalBounds);
+	}
+
+	TransformMatrices.resize(Count);
+	TransformBoxes.resize(Count);
+	RJobSystem::Get()->ParallelFor(Count, TransformJobBatchSize, [this](uint Begin, uint End)
+	{
+		ComputeTransformBatch(TransformBatch, Begin, End, TransformMatrices.data(), TransformBoxes.data());
+	});
+
+	for (uint i = 0; i < Count; i++) {
+		auto* Entity = Entities[i];
+		Entity->MatModel = TransformMatrices[i];
+		Entity->UpdateCollider();
+		if (Entity->CollisionMesh) {
+			Entity->BoundingBox = TransformBoxes[i];
+		}
 	}
 }
 
@@ -279,13 +325,13 @@ CellUpdate RWorld::UpdateEntityWorldChunk(EEntity* Entity)
 
 
 	bool BChangedWc =
-		Entity->WorldChunksCount == 0 ||
-		Entity->WorldChunks[0]->i != i0 ||
-		Entity->WorldChunks[0]->j != j0 ||
-		Entity->WorldChunks[0]->k != k0 ||
-		Entity->WorldChunks[Entity->WorldChunksCount - 1]->i != i1 ||
-		Entity->WorldChunks[Entity->WorldChunksCount - 1]->j != j1 ||
-		Entity->WorldChunks[Entity->WorldChunksCount - 1]->k != k1;
+		Entity->Cold->WorldChunksCount == 0 ||
+		Entity->Cold->WorldChunks[0]->i != i0 ||
+		Entity->Cold->WorldChunks[0]->j != j0 ||
+		Entity->Cold->WorldChunks[0]->k != k0 ||
+		Entity->Cold->WorldChunks[Entity->Cold->WorldChunksCount - 1]->i != i1 ||
+		Entity->Cold->WorldChunks[Entity->Cold->WorldChunksCount - 1]->j != j1 ||
+		Entity->Cold->WorldChunks[Entity->Cold->WorldChunksCount - 1]->k != k1;
 
 	if (!BChangedWc)
 	{
@@ -304,11 +350,11 @@ CellUpdate RWorld::UpdateEntityWorldChunk(EEntity* Entity)
 	}
 
 	// Remove entity from all world cells (inneficient due to defrag)
-	for (int I = 0; I < Entity->WorldChunksCount; I++)
+	for (int I = 0; I < Entity->Cold->WorldChunksCount; I++)
 	{
-		Entity->WorldChunks[I]->RemoveEntity(Entity);
+		Entity->Cold->WorldChunks[I]->RemoveEntity(Entity);
 	}
-	Entity->WorldChunksCount = 0;
+	Entity->Cold->WorldChunksCount = 0;
 
 	auto OriginChunk = WorldCoordsToCells(Entity->Position);
 
@@ -324,7 +370,7 @@ CellUpdate RWorld::UpdateEntityWorldChunk(EEntity* Entity)
 					return CellUpdate{CellUpdate_OUT_OF_BOUNDS, "Coordinates not found in chunks_map.", true};
 
 				auto* Chunk = ChunkIt->second;
-				Entity->WorldChunks.push_back(Chunk);
+				Entity->Cold->WorldChunks.push_back(Chunk);
 			}
 		}
 	}
@@ -354,7 +400,6 @@ void SetEntityDefaultAssets(EEntity* Entity)
 	Entity->Mesh =  Mesh;
 	Entity->Scale = Attrs.Scale;
 	Entity->CollisionMesh =  CollisionMesh;
-	Entity->Collider = * CollisionMesh;
 	Entity->TextureDiffuse = Textures[0];
 }
 
@@ -366,6 +411,5 @@ void SetEntityAssets(EEntity* Entity, REntityAttributes Attrs)
 	Entity->Mesh =  Mesh;
 	Entity->Scale = Attrs.Scale;
 	Entity->CollisionMesh =  CollisionMesh;
-	Entity->Collider = * CollisionMesh;
 	Entity->TextureDiffuse = Textures[0];
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "engine/core/core.h"
 #include "Engine/Core/UUIDGenerator.h"
 #include "Engine/Entities/EHandle.h"
+#include "Engine/Entities/TransformBatch.h"
 
 namespace RavenousEngine
 {
@@ -28,6 +29,31 @@ struct CellUpdate
 	bool EntityChangedCell = false;
 };
 
+// Indices [Begin, End) of a light vector that changed since the last upload. Starts out fully dirty.
+struct RLightDirtyRange
+{
+	uint Begin = 0;
+	uint End = MaxUint;
+
+	void Mark(uint Index)
+	{
+		Begin = std::min(Begin, Index);
+		End = std::max(End, Index + 1);
+	}
+	// for erase/insert, everything after Index moved
+	void MarkFrom(uint Index)
+	{
+		Begin = std::min(Begin, Index);
+		End = MaxUint;
+	}
+	void MarkAll() { MarkFrom(0); }
+	void Reset()
+	{
+		Begin = MaxUint;
+		End = 0;
+	}
+	bool IsDirty() const { return Begin < End; }
+};
 
 struct RWorld
 {
@@ -48,6 +74,8 @@ struct RWorld
 	// ====================
 	// static constexpr u8 world_chunk_matrix_order = 10;
 	static constexpr uint WorldSizeInChunks = WorldChunkNumX * WorldChunkNumY * WorldChunkNumZ;
+	// entities per job when batching transform updates
+	static constexpr uint TransformJobBatchSize = 1024;
 
 	// TODO: deleteme
 	string SceneName;
@@ -67,12 +95,19 @@ struct RWorld
 	vector<EDirectionalLight*> DirectionalLights;
 	// end temp
 
+	// Lights only reach the GPU when marked here (see RLightsBuffer). Whoever changes a light or
+	// the order of a light vector must mark it.
+	RLightDirtyRange PointLightsDirty;
+	RLightDirtyRange SpotLightsDirty;
+	RLightDirtyRange DirectionalLightsDirty;
+
 	// ====================
 	//	METHODS
 	// ====================
 public:
 	void Update();
 	void Erase();
+	void MarkLightsDirty();
 	void DeleteEntitiesMarkedForDeletion();
 
 	TIterator<RWorldChunk> GetChunkIterator();
@@ -90,12 +125,19 @@ public:
 
 	void UpdateTraits();
 	void UpdateTransforms();
+	void UpdateTransforms(const vector<EEntity*>& Entities);
 	
 private:
 	RWorld();
 
 	REntityStorage EntityStorage;
 	vector<RView<REntitySlot>> EntitiesToDelete;
+
+	// scratch for UpdateTransforms, kept around so steady state updates don't allocate
+	vector<EEntity*> TransformEntities;
+	RTransformBatch TransformBatch;
+	vector<mat4> TransformMatrices;
+	vector<RBoundingBox> TransformBoxes;
 };
 
 struct REntityIterator
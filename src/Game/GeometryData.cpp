@@ -21,25 +21,6 @@ void LoadModels()
 		}
 	}
 	
-	//TEXT
-	{
-		RGLData TextGlData;
-		glGenVertexArrays(1, &TextGlData.VAO);
-		glGenBuffers(1, &TextGlData.VBO);
-		glBindVertexArray(TextGlData.VAO);
-		glBindBuffer(GL_ARRAY_BUFFER, TextGlData.VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, nullptr, GL_DYNAMIC_DRAW);
-		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, static_cast<void*>(nullptr));
-		glEnableVertexAttribArray(0);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindVertexArray(0);
-
-		auto* TextMesh = new RMesh();
-		TextMesh->Name = "text";
-		TextMesh->GLData = TextGlData;
-		GeometryCatalogue.insert({TextMesh->Name, TextMesh});
-	}
-
 	// SLOPE
 	// with Z coming at the screen, X to the right, slope starts at x=0 high and goes low on x=1
 	std::vector<RVertex> slope_vertex_vec = {
@@ -23,8 +23,12 @@
 #include "Engine/MainLoop.h"
 #include "Engine/RavenousEngine.h"
 #include "Engine/Collision/ClController.h"
+#include "Engine/Core/Profiler.h"
 #include "Engine/Render/ImRender.h"
+#include "Engine/Render/RingBuffer.h"
 #include "engine/render/Shader.h"
+#include "Engine/Render/ShadowAtlas.h"
+#include "Engine/Render/Text/TextRenderer.h"
 #include "Engine/Serialization/sr_config.h"
 #include "Engine/World/World.h"
 
@@ -42,18 +46,22 @@ int main()
 	
 	auto* World = RWorld::Get();
 
-	// load shaders, textures and geometry
+	// load shaders, textures, geometry and baked fonts
 	stbi_set_flip_vertically_on_load(true);
 	LoadTexturesFromAssetsFolder();
 	LoadShaders();
 	LoadModels();
+	RTextRenderer::Get()->LoadFontCache();
 
 	// Allocate buffers and logs
 	Rvn::Init();
 	InitializeConsoleBuffers();
 
 	// Initialises immediate draw
+	RDynamicBuffers::Get()->Init();
 	RImDraw::Init();
+	RProfiler::SetThreadName("Main");
+	RProfiler::Get()->InitGpuTimers();
 
 	// loads initial scene
 	ConfigSerializer::LoadGlobalConfigs();
@@ -67,6 +75,7 @@ int main()
 	RCameraManager::Get()->GetCurrentCamera()->Acceleration = ProgramConfig.Camspeed;
 	World->AmbientLight = ProgramConfig.AmbientLight;
 	World->AmbientIntensity = ProgramConfig.AmbientIntensity;
+	RShadowAtlas::Get()->Configure(ProgramConfig.ShadowAtlasSize, ProgramConfig.ShadowAtlasFaceBudget);
 
 	World->UpdateEntityWorldChunk(Player); // sets player to the world
 	ClRecomputeCollisionBufferEntities(); // populates collision buffer and others
@@ -0,0 +1,38 @@
+#include "TestAll.h"
+
+#include "TestCommandList.h"
+#include "TestImRender.h"
+#include "TestLightClusters.h"
+#include "TestMeshCooker.h"
+#include "TestMeshLod.h"
+#include "TestOcclusion.h"
+#include "TestProfiler.h"
+#include "TestRenderStats.h"
+#include "TestRingBuffer.h"
+#include "TestTextRenderer.h"
+#include "TestUniformTable.h"
+
+// Serialization isn't in here, its test still trips over fields the reflection doesn't resolve
+void RavenousTest::RunAllTestSuites()
+{
+	const std::pair<const char*, void(*)()> Suites[] = {
+		{"UniformTable", &RunUniformTableTestSuite},
+		{"LightClusters", &RunLightClustersTestSuite},
+		{"MeshCooker", &RunMeshCookerTestSuite},
+		{"MeshLod", &RunMeshLodTestSuite},
+		{"TextRenderer", &RunTextRendererTestSuite},
+		{"ImRender", &RunImRenderTestSuite},
+		{"RingBuffer", &RunRingBufferTestSuite},
+		{"CommandList", &RunCommandListTestSuite},
+		{"Occlusion", &RunOcclusionTestSuite},
+		{"RenderStats", &RunRenderStatsTestSuite},
+		{"Profiler", &RunProfilerTestSuite},
+	};
+
+	for (const auto& [Name, Run] : Suites)
+	{
+		Log("tests: %s", Name)
+		Run();
+	}
+	Log("tests: %u suites passed.", static_cast<uint>(std::size(Suites)))
+}
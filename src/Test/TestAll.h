@@ -0,0 +1,9 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	// The test suites, one after the other. Failures are asserts, so build without NDEBUG.
+	// Run through the benchmark executable: tools/bench.bat --suite tests
+	void RunAllTestSuites();
+}
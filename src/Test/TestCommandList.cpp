@@ -0,0 +1,244 @@
+#include "TestCommandList.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/geometry/mesh.h"
+#include "engine/render/CommandList.h"
+#include "engine/render/RenderQueue.h"
+#include "engine/render/RingBuffer.h"
+#include "engine/render/Shader.h"
+
+#include <glad/glad.h>
+
+void RavenousTest::RunCommandListTestSuite()
+{
+	RRenderBackend::Get()->Type = NRenderBackend::Null;
+	RDynamicBuffers::Get()->Init(NRingBufferBackend::Memory);
+
+	Test_RenderQueueRecording();
+	Test_NullBackendCounts();
+	Test_ParallelRecording();
+	Test_StateChangeAccounting();
+}
+
+// three items sharing everything and one on its own, through a shader with an instanced variant
+struct RRecordingScene
+{
+	RMesh Shared;
+	RMesh Single;
+	RShader Shader;
+	RShader Instanced;
+	mat4 Matrices[4];
+	RRenderQueue Queue;
+
+	RRecordingScene()
+	{
+		Shared.GLData.VAO = 7;
+		Shared.Indices.resize(36);
+		Single.GLData.VAO = 8;
+		Single.Indices.resize(12);
+		Single.ShortIndices = true;
+		Shader.GLProgramID = 3;
+		Shader.Instanced = &Instanced;
+		Instanced.GLProgramID = 4;
+
+		for (uint Index = 0; Index < 4; Index++)
+		{
+			Matrices[Index] = glm::translate(Mat4Identity, vec3(Index));
+
+			RDrawItem Item;
+			Item.MatModel = &Matrices[Index];
+			Item.Mesh = Index < 3 ? &Shared : &Single;
+			Item.Shader = &Shader;
+			Item.SortKey = RRenderQueue::MakeSortKey(Item);
+			Queue.Add(Item);
+		}
+		Queue.Sort();
+	}
+};
+
+void RavenousTest::Test_RenderQueueRecording()
+{
+	RRecordingScene Scene;
+	RDynamicBuffers::Get()->BeginFrame();
+	Scene.Queue.Record(NSubmitMode::DepthOnly);
+	RDynamicBuffers::Get()->EndFrame();
+
+	using enum NRenderCommand;
+	const vector<NRenderCommand> Expected = {
+		UseProgram, BindVertexArray, SetInstanceMatrices, DrawElements, ClearInstanceMatrices,
+		UseProgram, BindVertexArray, SetMatrix4, DrawElements,
+		BindVertexArray
+	};
+
+	const auto& Commands = Scene.Queue.GetCommands().GetCommands();
+	assert(Commands.size() == Expected.size());
+	for (uint Index = 0; Index < Commands.size(); Index++)
+		assert(Commands[Index].Type == Expected[Index]);
+
+	// the instanced run draws its three items from the instanced program
+	assert(Commands[0].A == 4 && Commands[1].A == 7);
+	assert(Commands[3].A == GL_TRIANGLES && Commands[3].B == 36 && Commands[3].C == GL_UNSIGNED_INT && Commands[3].E == 3);
+	assert(Commands[2].B % sizeof(mat4) == 0);
+
+	// and the single one from the plain program, 16 bit indices, with its own matrix
+	assert(Commands[5].A == 3 && Commands[6].A == 8);
+	assert(Commands[7].Matrix == &Scene.Matrices[3]);
+	assert(Commands[8].B == 12 && Commands[8].C == GL_UNSIGNED_SHORT && Commands[8].E == 1);
+	assert(Commands[9].A == 0);
+}
+
+void RavenousTest::Test_NullBackendCounts()
+{
+	RRecordingScene Scene;
+	auto* Backend = RRenderBackend::Get();
+	Backend->ResetStats();
+
+	RDynamicBuffers::Get()->BeginFrame();
+	Scene.Queue.Submit(NSubmitMode::DepthOnly);
+	RDynamicBuffers::Get()->EndFrame();
+
+	// the Null backend keeps what it was given and agrees with the queue on what it cost
+	const auto& Stats = Backend->GetStats();
+	const auto& QueueStats = Scene.Queue.GetStats();
+	assert(Backend->GetRecording().size() == Scene.Queue.GetCommands().GetCommands().size());
+	assert(Stats.Lists == 1 && Stats.Commands == Backend->GetRecording().size());
+	assert(Stats.DrawCalls == QueueStats.DrawCalls && Stats.DrawCalls == 2);
+	assert(Stats.ProgramBinds == QueueStats.ProgramBinds && Stats.VertexArrayBinds == QueueStats.VaoBinds);
+	assert(Stats.Instances == 3);
+	assert(Stats.CommandsByType[static_cast<uint>(NRenderCommand::SetInstanceMatrices)] == 1);
+
+	Backend->ResetStats();
+	assert(Backend->GetRecording().empty() && Backend->GetStats().Commands == 0);
+}
+
+void RavenousTest::Test_ParallelRecording()
+{
+	// enough items for both the gathering and the recording to go wide, over a handful of meshes and programs
+	constexpr uint ItemCount = RRenderQueue::ParallelThreshold * 4 + 17;
+	RMesh Meshes[5];
+	RShader Shaders[3];
+	RShader Instanced[2];
+	for (uint Index = 0; Index < 5; Index++)
+	{
+		Meshes[Index].GLData.VAO = 10 + Index;
+		Meshes[Index].Indices.resize(3 * (Index + 1));
+	}
+	for (uint Index = 0; Index < 3; Index++)
+		Shaders[Index].GLProgramID = 20 + Index;
+	for (uint Index = 0; Index < 2; Index++)
+	{
+		Instanced[Index].GLProgramID = 30 + Index;
+		Shaders[Index].Instanced = &Instanced[Index];
+	}
+
+	vector<mat4> Matrices(ItemCount, Mat4Identity);
+	auto Fill = [&Matrices, &Meshes, &Shaders](uint Index, RDrawItem& OutItem)
+	{
+		// every seventh source draws nothing
+		if (Index % 7 == 3)
+			return false;
+
+		OutItem = RDrawItem{};
+		OutItem.MatModel = &Matrices[Index];
+		OutItem.Mesh = &Meshes[Index * 31 % 5];
+		OutItem.Shader = &Shaders[Index * 17 % 3];
+		OutItem.Pass = Index % 13 == 0 ? NRenderPass::Wireframe : NRenderPass::Opaque;
+		return true;
+	};
+
+	// AddParallel keeps the source order and skips what Fill turns down
+	RRenderQueue Serial;
+	RDrawItem Item;
+	for (uint Index = 0; Index < ItemCount; Index++)
+	{
+		if (Fill(Index, Item))
+			Serial.Add(Item);
+	}
+
+	auto Record = [&Fill](RRenderQueue& Queue)
+	{
+		Queue.Clear();
+		Queue.AddParallel(ItemCount, Fill);
+		Queue.Sort();
+		RDynamicBuffers::Get()->BeginFrame();
+		Queue.Record(NSubmitMode::Lit);
+		RDynamicBuffers::Get()->EndFrame();
+	};
+
+	RJobSystem::Get()->Initialize(1);
+	RRenderQueue Reference;
+	Record(Reference);
+	RJobSystem::Get()->Shutdown();
+
+	assert(Reference.GetItems().size() == Serial.GetItems().size());
+	Serial.Sort();
+	for (uint Index = 0; Index < Serial.GetItems().size(); Index++)
+		assert(Reference.GetItems()[Index].MatModel == Serial.GetItems()[Index].MatModel);
+
+	// the same commands whatever the number of workers, and every item drawn once
+	RJobSystem::Get()->Initialize(3);
+	RRenderQueue Parallel;
+	for (uint Run = 0; Run < 4; Run++)
+	{
+		Record(Parallel);
+		const auto& Expected = Reference.GetCommands().GetCommands();
+		const auto& Commands = Parallel.GetCommands().GetCommands();
+		assert(Commands.size() == Expected.size());
+		for (uint Index = 0; Index < Commands.size(); Index++)
+		{
+			assert(Commands[Index].Type == Expected[Index].Type && Commands[Index].A == Expected[Index].A);
+			assert(Commands[Index].Matrix == Expected[Index].Matrix && Commands[Index].E == Expected[Index].E);
+		}
+	}
+	RJobSystem::Get()->Shutdown();
+
+	uint Drawn = 0;
+	bool Wireframe = false;
+	for (const RRenderCommand& Command : Parallel.GetCommands().GetCommands())
+	{
+		if (Command.Type == NRenderCommand::DrawElements)
+			Drawn += Command.E;
+		if (Command.Type == NRenderCommand::SetPolygonMode)
+			Wireframe = Command.A != 0;
+	}
+	assert(Drawn == Serial.GetItems().size() && !Wireframe);
+	assert(Parallel.GetStats().DrawCalls == Reference.GetStats().DrawCalls);
+	assert(Parallel.GetStats().Items == Drawn);
+}
+
+void RavenousTest::Test_StateChangeAccounting()
+{
+	// every item on a program of its own, the worst case for the queue
+	constexpr uint ItemCount = 16;
+	RMesh Mesh;
+	Mesh.GLData.VAO = 9;
+	Mesh.Indices.resize(6);
+	RShader Shaders[ItemCount];
+	mat4 Matrix = Mat4Identity;
+
+	RRenderQueue Queue;
+	for (uint Index = 0; Index < ItemCount; Index++)
+	{
+		Shaders[Index].GLProgramID = 40 + Index;
+		RDrawItem Item;
+		Item.MatModel = &Matrix;
+		Item.Mesh = &Mesh;
+		Item.Shader = &Shaders[Index];
+		Item.SortKey = RRenderQueue::MakeSortKey(Item);
+		Queue.Add(Item);
+	}
+	Queue.Sort();
+
+	for (NSubmitMode Mode : {NSubmitMode::Lit, NSubmitMode::DepthOnly})
+	{
+		RDynamicBuffers::Get()->BeginFrame();
+		Queue.Record(Mode);
+		RDynamicBuffers::Get()->EndFrame();
+
+		// a program switch doesn't look up more uniforms than drawing the entity on its own did
+		const auto& Stats = Queue.GetStats();
+		assert(Stats.ProgramBinds == ItemCount);
+		assert(Stats.UniformLookups <= Stats.NaiveUniformLookups);
+		assert(Stats.GetEliminatedStateChanges() >= 0);
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunCommandListTestSuite();
+
+	void Test_RenderQueueRecording();
+	void Test_NullBackendCounts();
+	void Test_ParallelRecording();
+	void Test_StateChangeAccounting();
+}
@@ -0,0 +1,100 @@
+#include "TestImRender.h"
+
+#include "engine/render/ImRender.h"
+
+#include <glad/glad.h>
+#include <unordered_map>
+
+void RavenousTest::RunImRenderTestSuite()
+{
+	Test_ImHashIsCompileTime();
+	Test_ImSlotTable();
+	Test_ImDrawStream();
+}
+
+void RavenousTest::Test_ImHashIsCompileTime()
+{
+	constexpr uint First = IMHASH;
+	constexpr uint Second = IMHASH;
+	static_assert(First != Second && First != 0);
+	static_assert(ImHashCallSite("file.cpp", 10) != ImHashCallSite("file.cpp", 11));
+	static_assert(ImHashCallSite("file.cpp", 10) != ImHashCallSite("other.cpp", 10));
+
+	// loop iterations differ from each other and from the plain call site
+	const uint Base = ImHashCallSite(__FILE__, __LINE__ + 1);
+	uint Iterations[3] = {IM_ITERHASH(0), IM_ITERHASH(1), IM_ITERHASH(2)};
+	assert(Iterations[0] != Iterations[1] && Iterations[1] != Iterations[2] && Iterations[0] != Base);
+	assert(ImHashCombine(Base, 1) == Iterations[1]);
+	assert(IMCUSTOMHASH("poly-1") == ImHashName(string("poly-1")));
+}
+
+void RavenousTest::Test_ImSlotTable()
+{
+	// against std::unordered_map, with keys crowding a few home slots so removals have to shift chains back
+	RImSlotTable Table;
+	std::unordered_map<uint, int> Reference;
+	uint Seed = 12345;
+	for (uint Step = 0; Step < 20000; Step++)
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		const uint Hash = 1 + (Seed >> 8) % 300 * 64;
+		if (Seed % 3 == 0)
+		{
+			Table.Remove(Hash);
+			Reference.erase(Hash);
+		}
+		else
+		{
+			Table.Add(Hash, Step);
+			Reference[Hash] = Step;
+		}
+	}
+
+	assert(Table.Size() == Reference.size());
+	for (uint Key = 0; Key < 300; Key++)
+	{
+		const uint Hash = 1 + Key * 64;
+		auto Query = Reference.find(Hash);
+		assert(Table.Find(Hash) == (Query == Reference.end() ? -1 : Query->second));
+	}
+}
+
+void RavenousTest::Test_ImDrawStream()
+{
+	// way past the 200 elements the old fixed buffer had
+	for (uint i = 0; i < 500; i++)
+		RImDraw::AddPoint(IM_ITERHASH(i), vec3(i, 0, 0), 0, COLOR_RED_1, 2.0, i % 2 == 0);
+	RImDraw::AddLine(IMHASH, vec3(0), vec3(1), 0, COLOR_BLUE_1, 3.f);
+	RImDraw::AddLine(IMHASH, vec3(0), vec3(2), 0, COLOR_BLUE_1, 1.f);
+	RImDraw::AddLine(IMHASH, vec3(0), vec3(3), 0, COLOR_BLUE_1, 3.f);
+
+	vector<RVertex> Loop{RVertex{vec3(0)}, RVertex{vec3(1, 0, 0)}, RVertex{vec3(0, 1, 0)}};
+	RImDraw::AddLineLoop(IMHASH, Loop, 0, COLOR_GREEN_1, RRenderOptions{.LineWidth = 1.f});
+	assert(RImDraw::GetElementCount() == 504);
+
+	vector<RImVertex> Vertices;
+	vector<RImBatch> Batches;
+	RImDraw::BuildStream(Vertices, Batches);
+
+	// width 1 lines (one line, a three segment loop), width 3 lines, then every point in one call
+	assert(Batches.size() == 3);
+	assert(Batches[0].Mode == GL_LINES && Batches[0].LineWidth == 1.f && Batches[0].VertexCount == 2 + 6);
+	assert(Batches[1].Mode == GL_LINES && Batches[1].LineWidth == 3.f && Batches[1].VertexCount == 4);
+	assert(Batches[2].Mode == GL_POINTS && Batches[2].VertexCount == 500 && Batches[2].FirstVertex == 12);
+	assert(Vertices.size() == 512);
+	assert(Vertices[12].PointSize == 10.f && Vertices[12].AlwaysOnTop == 1.f && Vertices[13].AlwaysOnTop == 0.f);
+
+	// the same hash again takes the new values instead of adding another element
+	for (uint Frame = 0; Frame < 2; Frame++)
+		RImDraw::AddPoint(IM_ITERHASH(7), vec3(Frame), 1000, COLOR_RED_1, 2.0, false);
+	assert(RImDraw::GetElementCount() == 505);
+
+	// zero duration elements are gone after a frame, the rest stay
+	RImDraw::Update(1.f / 60.f);
+	assert(RImDraw::GetElementCount() == 1);
+	RImDraw::BuildStream(Vertices, Batches);
+	assert(Vertices.size() == 1 && Vertices[0].Position == vec3(1));
+
+	RImDraw::Update(2.f);
+	assert(RImDraw::GetElementCount() == 0);
+}
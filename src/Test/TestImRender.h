@@ -0,0 +1,11 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunImRenderTestSuite();
+
+	void Test_ImHashIsCompileTime();
+	void Test_ImSlotTable();
+	void Test_ImDrawStream();
+}
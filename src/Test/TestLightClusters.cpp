@@ -0,0 +1,231 @@
+#include "TestLightClusters.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/entities/lights.h"
+#include "engine/render/LightClusters.h"
+
+#include <algorithm>
+
+static constexpr float TestNear = 0.1f;
+static constexpr float TestFar = 100.f;
+
+static mat4 GetTestProjection()
+{
+	return glm::perspective(glm::radians(45.f), 16.f / 9.f, TestNear, TestFar);
+}
+
+// lights scattered in front of the camera, some straddling the near plane and the screen edges
+static vector<RLightSphere> MakeTestLights(uint Count, uint Seed)
+{
+	vector<RLightSphere> Lights;
+	uint State = Seed;
+	auto Random = [&State](float Min, float Max)
+	{
+		State = State * 1664525u + 1013904223u;
+		return Min + (Max - Min) * (State >> 8) / static_cast<float>(1 << 24);
+	};
+
+	for (uint i = 0; i < Count; i++)
+	{
+		const float Depth = Random(-2.f, 80.f);
+		const float HalfWidth = std::max(Depth, 1.f);
+		Lights.push_back(RLightSphere{vec3{Random(-HalfWidth, HalfWidth), Random(-HalfWidth, HalfWidth), -Depth}, Random(0.5f, 10.f)});
+	}
+	return Lights;
+}
+
+// the lights of one type listed for a cluster, in the order they were binned
+static vector<uint> GetClusterLights(const RLightClusters& Clusters, uint Cluster, bool Spots)
+{
+	const auto& Grid = Clusters.GetGrid();
+	const uint Offset = Grid[Cluster * 2];
+	const uint PointCount = Grid[Cluster * 2 + 1] & 0xFFFF;
+	const uint SpotCount = Grid[Cluster * 2 + 1] >> 16;
+
+	const uint First = Offset + (Spots ? PointCount : 0);
+	const uint Count = Spots ? SpotCount : PointCount;
+	return vector<uint>(Clusters.GetIndices().begin() + First, Clusters.GetIndices().begin() + First + Count);
+}
+
+void RavenousTest::RunLightClustersTestSuite()
+{
+	Test_LightClustersInsideBoxes();
+	Test_LightClustersNoMisses();
+	Test_LightClustersDeterministic();
+	Test_LightClustersCapacity();
+	Test_LightClustersSpotBounds();
+}
+
+void RavenousTest::Test_LightClustersInsideBoxes()
+{
+	RLightClusters Clusters;
+	Clusters.SetProjection(GetTestProjection(), TestNear, TestFar);
+
+	const vector<RLightSphere> Points = MakeTestLights(200, 7);
+	const vector<RLightSphere> Spots = MakeTestLights(50, 11);
+	Clusters.Bin(Points, Spots);
+	assert(Clusters.GetStats().Dropped == 0);
+
+	// every cluster against every light, with the cluster box built the slow way
+	const mat4 Projection = GetTestProjection();
+	const float Ratio = TestFar / TestNear;
+	for (uint Z = 0; Z < RLightClusters::DimZ; Z++)
+	{
+		const float SliceNear = TestNear * std::pow(Ratio, static_cast<float>(Z) / RLightClusters::DimZ);
+		const float SliceFar = TestNear * std::pow(Ratio, static_cast<float>(Z + 1) / RLightClusters::DimZ);
+		for (uint Y = 0; Y < RLightClusters::DimY; Y++)
+		{
+			for (uint X = 0; X < RLightClusters::DimX; X++)
+			{
+				vec3 Min(FLT_MAX), Max(-FLT_MAX);
+				for (uint Corner = 0; Corner < 8; Corner++)
+				{
+					const float NdcX = -1.f + 2.f * (X + (Corner & 1)) / RLightClusters::DimX;
+					const float NdcY = -1.f + 2.f * (Y + (Corner >> 1 & 1)) / RLightClusters::DimY;
+					const float Depth = Corner & 4 ? SliceFar : SliceNear;
+					const vec3 Point{NdcX * Depth / Projection[0][0], NdcY * Depth / Projection[1][1], -Depth};
+					Min = glm::min(Min, Point);
+					Max = glm::max(Max, Point);
+				}
+
+				auto Touches = [&](const RLightSphere& Light)
+				{
+					const vec3 Closest = glm::clamp(Light.Center, Min, Max);
+					const vec3 Delta = Closest - Light.Center;
+					return glm::dot(Delta, Delta) <= Light.Radius * Light.Radius;
+				};
+
+				const uint Cluster = RLightClusters::GetClusterIndex(X, Y, Z);
+				for (bool Spot : {false, true})
+				{
+					const auto& Lights = Spot ? Spots : Points;
+					vector<uint> Expected;
+					for (uint i = 0; i < Lights.size(); i++)
+						if (Touches(Lights[i]))
+							Expected.push_back(i);
+
+					// the range prepass is tighter than the box test, but nothing may be listed the box test rejects
+					const vector<uint> Actual = GetClusterLights(Clusters, Cluster, Spot);
+					vector<uint> Extra;
+					std::set_difference(Actual.begin(), Actual.end(), Expected.begin(), Expected.end(), std::back_inserter(Extra));
+					for (uint Light : Extra)
+					{
+						// up to rounding, for lights grazing the box
+						const vec3 Closest = glm::clamp(Lights[Light].Center, Min, Max);
+						assert(std::abs(glm::length(Closest - Lights[Light].Center) - Lights[Light].Radius) < 1e-3f);
+					}
+					assert(std::is_sorted(Actual.begin(), Actual.end()));
+				}
+			}
+		}
+	}
+}
+
+void RavenousTest::Test_LightClustersNoMisses()
+{
+	RLightClusters Clusters;
+	Clusters.SetProjection(GetTestProjection(), TestNear, TestFar);
+
+	const vector<RLightSphere> Points = MakeTestLights(200, 13);
+	Clusters.Bin(Points, {});
+
+	// points inside each light, found the way the lit shaders find their cluster, must list the light
+	const mat4 Projection = GetTestProjection();
+	constexpr int Steps = 6;
+	for (uint i = 0; i < Points.size(); i++)
+	{
+		for (int X = -Steps; X <= Steps; X++)
+		for (int Y = -Steps; Y <= Steps; Y++)
+		for (int Z = -Steps; Z <= Steps; Z++)
+		{
+			const vec3 Offset = vec3(X, Y, Z) / static_cast<float>(Steps);
+			if (glm::length(Offset) > 1.f)
+				continue;
+
+			const vec3 Point = Points[i].Center + Offset * Points[i].Radius;
+			const vec4 Clip = Projection * vec4(Point, 1.f);
+			const float Depth = -Point.z;
+			if (Depth < TestNear || Depth > TestFar || std::abs(Clip.x) > Clip.w || std::abs(Clip.y) > Clip.w)
+				continue;
+
+			const uint TileX = std::min(static_cast<uint>((Clip.x / Clip.w * 0.5f + 0.5f) * RLightClusters::DimX), RLightClusters::DimX - 1);
+			const uint TileY = std::min(static_cast<uint>((Clip.y / Clip.w * 0.5f + 0.5f) * RLightClusters::DimY), RLightClusters::DimY - 1);
+			const uint Cluster = RLightClusters::GetClusterIndex(TileX, TileY, Clusters.GetSlice(Depth));
+
+			const vector<uint> Lights = GetClusterLights(Clusters, Cluster, false);
+			assert(std::find(Lights.begin(), Lights.end(), i) != Lights.end());
+		}
+	}
+}
+
+void RavenousTest::Test_LightClustersDeterministic()
+{
+	const vector<RLightSphere> Points = MakeTestLights(256, 3);
+	const vector<RLightSphere> Spots = MakeTestLights(128, 5);
+
+	RLightClusters Inline;
+	Inline.SetProjection(GetTestProjection(), TestNear, TestFar);
+	RJobSystem::Get()->Shutdown();
+	Inline.Bin(Points, Spots);
+
+	// same result with workers, over and over
+	RJobSystem::Get()->Initialize(3);
+	RLightClusters Parallel;
+	Parallel.SetProjection(GetTestProjection(), TestNear, TestFar);
+	for (uint Run = 0; Run < 8; Run++)
+	{
+		Parallel.Bin(Points, Spots);
+		assert(Parallel.GetGrid() == Inline.GetGrid());
+		assert(Parallel.GetIndices() == Inline.GetIndices());
+	}
+	RJobSystem::Get()->Shutdown();
+}
+
+void RavenousTest::Test_LightClustersCapacity()
+{
+	RLightClusters Clusters;
+	Clusters.SetProjection(GetTestProjection(), TestNear, TestFar);
+
+	// all on top of each other, more than a cluster can hold
+	const uint Count = RLightClusters::MaxPointLightsPerCluster + 10;
+	const vector<RLightSphere> Points(Count, RLightSphere{vec3{0, 0, -10}, 0.5f});
+	Clusters.Bin(Points, {});
+
+	const auto& Stats = Clusters.GetStats();
+	assert(Stats.MaxLightsInCluster == Count);
+	assert(Stats.Dropped == Stats.OccupiedClusters * 10);
+
+	// the ones kept are the lowest indices
+	for (uint Cluster = 0; Cluster < RLightClusters::ClusterCount; Cluster++)
+	{
+		const vector<uint> Lights = GetClusterLights(Clusters, Cluster, false);
+		assert(Lights.empty() || Lights.size() == RLightClusters::MaxPointLightsPerCluster);
+		for (uint i = 0; i < Lights.size(); i++)
+			assert(Lights[i] == i);
+	}
+}
+
+void RavenousTest::Test_LightClustersSpotBounds()
+{
+	ESpotLight Light;
+	Light.Position = vec3(1, 2, 3);
+	Light.Direction = vec3(0, 0, -1);
+	Light.Outercone = 0.9f;
+	const RLightSphere Sphere = RLightClusters::GetSpotLightBounds(Light, mat4(1.f));
+
+	// the sphere goes through the apex and the rim of the cap, so its diameter along the axis gives the range back
+	const float Range = 2.f * Sphere.Radius * Light.Outercone;
+	const float Sin = std::sqrt(1.f - Light.Outercone * Light.Outercone);
+	const vec3 Tip = Light.Position + Light.Direction * Range;
+	const vec3 Rim = Light.Position + Range * vec3(Sin, 0, -Light.Outercone);
+
+	assert(glm::length(Sphere.Center - Light.Position) <= Sphere.Radius + 1e-4f);
+	assert(glm::length(Sphere.Center - Tip) <= Sphere.Radius + 1e-4f);
+	assert(glm::length(Sphere.Center - Rim) <= Sphere.Radius + 1e-4f);
+	assert(Sphere.Radius < Range);
+
+	// wide cones just use the range sphere around the apex
+	Light.Outercone = 0.2f;
+	const RLightSphere Wide = RLightClusters::GetSpotLightBounds(Light, mat4(1.f));
+	assert(Wide.Center == Light.Position);
+}
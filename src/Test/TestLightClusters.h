@@ -0,0 +1,13 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunLightClustersTestSuite();
+
+	void Test_LightClustersInsideBoxes();
+	void Test_LightClustersNoMisses();
+	void Test_LightClustersDeterministic();
+	void Test_LightClustersCapacity();
+	void Test_LightClustersSpotBounds();
+}
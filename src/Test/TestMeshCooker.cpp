@@ -0,0 +1,256 @@
+#include "TestMeshCooker.h"
+
+#include "engine/geometry/mesh.h"
+#include "engine/geometry/MeshCooker.h"
+#include "engine/collision/raycast.h"
+#include "engine/io/loaders.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+// a wavy grid laid out the way the OBJ loader does it, 4 corners per quad face and nothing shared
+static RMesh MakeTestGrid(uint Size, float UVScale)
+{
+	RMesh Mesh;
+	auto Position = [](uint X, uint Y) { return vec3{X, 0.2f * sin(X * 0.3f) + 0.1f * Y, Y}; };
+
+	for (uint Y = 0; Y < Size; Y++)
+	{
+		for (uint X = 0; X < Size; X++)
+		{
+			const uint First = Mesh.Vertices.size();
+			const uint Corners[4][2] = {{X, Y}, {X + 1, Y}, {X + 1, Y + 1}, {X, Y + 1}};
+			for (const auto& Corner : Corners)
+			{
+				RVertex& Vertex = Mesh.Vertices.emplace_back(Position(Corner[0], Corner[1]), vec3{0, 1, 0}, vec2{Corner[0], Corner[1]} * UVScale / static_cast<float>(Size));
+				Vertex.Tangent = vec3{2, 0, 0};
+				Vertex.Bitangent = vec3{0, 0, 1};
+			}
+
+			for (uint Index : {0u, 1u, 2u, 2u, 3u, 0u})
+				Mesh.Indices.push_back(First + Index);
+		}
+	}
+
+	Mesh.FacesCount = Mesh.Indices.size() / 3;
+	return Mesh;
+}
+
+// the triangles as position triples, each rotated to start at its smallest corner, sorted
+static vector<std::array<float, 9>> GetSortedTriangles(const RMesh& Mesh)
+{
+	vector<std::array<float, 9>> Triangles;
+	for (uint t = 0; t < Mesh.Indices.size() / 3; t++)
+	{
+		vec3 Corners[3];
+		for (uint k = 0; k < 3; k++)
+			Corners[k] = Mesh.Vertices[Mesh.Indices[t * 3 + k]].Position;
+
+		auto Less = [](const vec3& A, const vec3& B) { return std::tie(A.x, A.y, A.z) < std::tie(B.x, B.y, B.z); };
+		const uint First = std::min_element(Corners, Corners + 3, Less) - Corners;
+
+		std::array<float, 9>& Triangle = Triangles.emplace_back();
+		for (uint k = 0; k < 3; k++)
+		{
+			const vec3& Corner = Corners[(First + k) % 3];
+			Triangle[k * 3] = Corner.x;
+			Triangle[k * 3 + 1] = Corner.y;
+			Triangle[k * 3 + 2] = Corner.z;
+		}
+	}
+
+	std::sort(Triangles.begin(), Triangles.end());
+	return Triangles;
+}
+
+void RavenousTest::RunMeshCookerTestSuite()
+{
+	Test_MeshCookerKeepsTriangles();
+	Test_MeshCookerImprovesACMR();
+	Test_MeshCookerPackRoundTrip();
+	Test_MeshCookerFloatFallback();
+	Test_MeshCookerRefreshesTriangleBlocks();
+	Test_MeshBinaryRejectsCorruptFiles();
+}
+
+void RavenousTest::Test_MeshCookerKeepsTriangles()
+{
+	RMesh Mesh = MakeTestGrid(40, 1.f);
+	const auto Before = GetSortedTriangles(Mesh);
+
+	const RMeshCookStats Stats = CookMesh(Mesh);
+
+	// every grid point is shared by up to 4 quads, welding leaves one vertex per point
+	assert(Stats.SourceVertices == 40 * 40 * 4);
+	assert(Stats.Vertices == 41 * 41);
+	assert(Stats.Triangles == 40 * 40 * 2);
+	assert(GetSortedTriangles(Mesh) == Before);
+
+	// vertices come in the order the index buffer first uses them
+	uint NextNew = 0;
+	for (uint Index : Mesh.Indices)
+	{
+		assert(Index <= NextNew);
+		if (Index == NextNew)
+			NextNew++;
+	}
+	assert(NextNew == Mesh.Vertices.size());
+}
+
+void RavenousTest::Test_MeshCookerImprovesACMR()
+{
+	RMesh Mesh = MakeTestGrid(60, 1.f);
+	const RMeshCookStats Stats = CookMesh(Mesh);
+
+	// unwelded every corner misses, a cache optimized grid gets well under one miss per triangle
+	assert(Stats.AcmrBefore == 2.f);
+	assert(Stats.AcmrAfter < 0.75f);
+	assert(Stats.AcmrAfter == ComputeACMR(Mesh.Indices, Mesh.Vertices.size()));
+
+	// the overdraw order may only cost up to OverdrawThreshold over the plain cache order
+	RMesh CacheOnly = MakeTestGrid(60, 1.f);
+	WeldVertices(CacheOnly);
+	OptimizeVertexCache(CacheOnly.Indices, CacheOnly.Vertices.size());
+	assert(Stats.AcmrAfter <= ComputeACMR(CacheOnly.Indices, CacheOnly.Vertices.size()) * OverdrawThreshold);
+}
+
+void RavenousTest::Test_MeshCookerPackRoundTrip()
+{
+	const RVertex Vertex{vec3{1.5f, -2.25f, 1000.f}, vec3{0.f, 0.6f, 0.8f}, vec2{0.3f, 1.75f}, vec3{3.f, 0.f, 0.f}, vec3{0.f, 0.f, 0.f}};
+	const RVertex Unpacked = UnpackVertex(PackVertex(Vertex));
+
+	assert(Unpacked.Position == Vertex.Position);
+	assert(glm::length(Unpacked.Normal - Vertex.Normal) < 0.005f);
+	assert(glm::length(Unpacked.TexCoords - Vertex.TexCoords) < 0.001f);
+	// directions are stored normalized, a zero tangent frame stays zero
+	assert(glm::length(Unpacked.Tangent - vec3{1.f, 0.f, 0.f}) < 0.005f);
+	assert(Unpacked.Bitangent == vec3{0.f});
+
+	// packing again gives the same bits, so cooking a cooked mesh changes nothing
+	const RPackedVertex Once = PackVertex(Vertex);
+	const RPackedVertex Twice = PackVertex(UnpackVertex(Once));
+	assert(Once.Normal == Twice.Normal && Once.TexCoords == Twice.TexCoords && Once.Tangent == Twice.Tangent);
+}
+
+void RavenousTest::Test_MeshCookerFloatFallback()
+{
+	RMesh Small = MakeTestGrid(8, 1.f);
+	const RMeshCookStats SmallStats = CookMesh(Small);
+	assert(Small.VertexFormat == NVertexFormat::Packed && SmallStats.BytesPerVertex == sizeof(RPackedVertex));
+	assert(Small.ShortIndices);
+
+	// UVs tiling past MaxPackedTexCoord would lose texels in half floats
+	RMesh Tiled = MakeTestGrid(8, 16.f);
+	const RMeshCookStats TiledStats = CookMesh(Tiled);
+	assert(Tiled.VertexFormat == NVertexFormat::Float && TiledStats.BytesPerVertex == sizeof(RVertex));
+
+	// past 65536 vertices indices stay 32 bit
+	RMesh Large = MakeTestGrid(260, 1.f);
+	CookMesh(Large);
+	assert(Large.Vertices.size() > 0x10000 && !Large.ShortIndices);
+}
+
+void RavenousTest::Test_MeshCookerRefreshesTriangleBlocks()
+{
+	// the weld leaves the triangle count alone but moves every triangle to another block lane
+	RMesh Mesh = MakeTestGrid(12, 1.f);
+	const RRay Ray{vec3{5.5f, 10.f, 6.5f}, vec3{0.f, -1.f, 0.f}};
+	const RRaycastTest Before = TestRayAgainstMesh(Ray, &Mesh, Mat4Identity, RayCast_TestBothSidesOfTriangle);
+	assert(Before.Hit);
+
+	CookMesh(Mesh);
+	vector<RTriangleBlock> Fresh;
+	CookTriangleBlocks(Fresh, Mesh);
+	const vector<RTriangleBlock>& Cached = Mesh.GetTriangleBlocks();
+	assert(Cached.size() == Fresh.size());
+	assert(memcmp(Cached.data(), Fresh.data(), Fresh.size() * sizeof(RTriangleBlock)) == 0);
+
+	// and the hit triangle is one the cooked mesh actually has
+	const RRaycastTest After = TestRayAgainstMesh(Ray, &Mesh, Mat4Identity, RayCast_TestBothSidesOfTriangle);
+	assert(After.Hit && abs(After.Distance - Before.Distance) < 0.0001f);
+	assert(After.Triangle.A == Before.Triangle.A || After.Triangle.A == Before.Triangle.B || After.Triangle.A == Before.Triangle.C);
+
+	// edits in place go through MarkDirty
+	for (RVertex& Vertex : Mesh.Vertices)
+		Vertex.Position.y -= 1.f;
+	Mesh.MarkDirty();
+	const RRaycastTest Moved = TestRayAgainstMesh(Ray, &Mesh, Mat4Identity, RayCast_TestBothSidesOfTriangle);
+	assert(Moved.Hit && abs(Moved.Distance - Before.Distance - 1.f) < 0.0001f);
+}
+
+void RavenousTest::Test_MeshBinaryRejectsCorruptFiles()
+{
+	// a .rmesh by hand: a single triangle with 32 bit indices and float vertices, no LODs
+	struct RHeader
+	{
+		uint Magic = 'R' | 'M' << 8 | 'S' << 16 | 'H' << 24;
+		uint Version = 3;
+		uint VertexCount = 3;
+		uint IndexCount = 3;
+		uint LodIndexCount = 0;
+		uint FacesCount = 1;
+		uint8 VertexFormat = 0;
+		uint8 IndexSize = sizeof(uint);
+		uint16 LodCount = 0;
+	};
+	static_assert(sizeof(RHeader) == 28);
+
+	const string Filepath = "test_mesh.rmesh";
+	auto Write = [&Filepath](const RHeader& Header, const uint (&Indices)[3], size_t Truncate = 0)
+	{
+		vector<uint8> Bytes(sizeof(RHeader) + sizeof(RVertex) * 3 + sizeof(Indices));
+		memcpy(Bytes.data(), &Header, sizeof(RHeader));
+		for (uint i = 0; i < 3; i++)
+		{
+			const RVertex Vertex(vec3(i, 0, 1), vec3(0, 1, 0), vec2(0), vec3(1, 0, 0), vec3(0, 0, 1));
+			memcpy(Bytes.data() + sizeof(RHeader) + sizeof(RVertex) * i, &Vertex, sizeof(RVertex));
+		}
+		memcpy(Bytes.data() + sizeof(RHeader) + sizeof(RVertex) * 3, Indices, sizeof(Indices));
+
+		FILE* File = fopen(Filepath.c_str(), "wb");
+		fwrite(Bytes.data(), 1, Bytes.size() - Truncate, File);
+		fclose(File);
+	};
+
+	RMesh Mesh;
+	Write(RHeader{}, {0, 1, 2});
+	assert(ReadMeshBinary(Filepath, Mesh));
+	assert(Mesh.Vertices.size() == 3 && Mesh.Indices == vector<uint>({0, 1, 2}));
+	assert(Mesh.Vertices[2].Position == vec3(2, 0, 1));
+
+	// counts the file doesn't hold are turned down before anything is allocated for them
+	for (const uint Count : {4u, 0x7fffffffu, 0xffffffffu})
+	{
+		RHeader Header;
+		Header.VertexCount = Count;
+		Write(Header, {0, 1, 2});
+		RMesh Rejected;
+		assert(!ReadMeshBinary(Filepath, Rejected) && Rejected.Vertices.empty());
+
+		Header = RHeader{};
+		Header.IndexCount = Count;
+		Write(Header, {0, 1, 2});
+		assert(!ReadMeshBinary(Filepath, Rejected) && Rejected.Indices.empty());
+
+		Header = RHeader{};
+		Header.LodCount = 1;
+		Header.LodIndexCount = Count;
+		Write(Header, {0, 1, 2});
+		assert(!ReadMeshBinary(Filepath, Rejected) && Rejected.Lods.Indices.empty());
+	}
+
+	// so are truncated files, unknown vertex formats and indices past the last vertex
+	RMesh Rejected;
+	Write(RHeader{}, {0, 1, 2}, 4);
+	assert(!ReadMeshBinary(Filepath, Rejected));
+	RHeader Header;
+	Header.VertexFormat = 7;
+	Write(Header, {0, 1, 2});
+	assert(!ReadMeshBinary(Filepath, Rejected));
+	Write(RHeader{}, {0, 3, 2});
+	assert(!ReadMeshBinary(Filepath, Rejected));
+
+	remove(Filepath.c_str());
+	assert(!ReadMeshBinary(Filepath, Rejected));
+}
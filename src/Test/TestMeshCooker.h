@@ -0,0 +1,14 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunMeshCookerTestSuite();
+
+	void Test_MeshCookerKeepsTriangles();
+	void Test_MeshCookerImprovesACMR();
+	void Test_MeshCookerPackRoundTrip();
+	void Test_MeshCookerFloatFallback();
+	void Test_MeshCookerRefreshesTriangleBlocks();
+	void Test_MeshBinaryRejectsCorruptFiles();
+}
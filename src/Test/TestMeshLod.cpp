@@ -0,0 +1,180 @@
+#include "TestMeshLod.h"
+
+#include "engine/geometry/mesh.h"
+#include "engine/geometry/MeshCooker.h"
+#include "engine/geometry/MeshSimplifier.h"
+#include "engine/render/LodSelector.h"
+#include "engine/render/ShadowCache.h"
+#include "engine/camera/camera.h"
+#include "engine/entities/StaticMesh.h"
+
+#include <set>
+
+// unit sphere, smooth normals, laid out one vertex per face corner like the OBJ loader does
+static RMesh MakeTestSphere(uint Rings, uint Segments)
+{
+	RMesh Mesh;
+	auto Position = [=](uint Ring, uint Segment)
+	{
+		const float Theta = glm::pi<float>() * Ring / Rings;
+		const float Phi = glm::two_pi<float>() * (Segment % Segments) / Segments;
+		return vec3{sin(Theta) * cos(Phi), cos(Theta), sin(Theta) * sin(Phi)};
+	};
+
+	for (uint Ring = 0; Ring < Rings; Ring++)
+	{
+		for (uint Segment = 0; Segment < Segments; Segment++)
+		{
+			const uint First = Mesh.Vertices.size();
+			for (const vec3& Corner : {Position(Ring, Segment), Position(Ring + 1, Segment), Position(Ring + 1, Segment + 1), Position(Ring, Segment + 1)})
+				Mesh.Vertices.emplace_back(Corner, Corner, vec2{0.f});
+
+			for (uint Index : {0u, 1u, 2u, 2u, 3u, 0u})
+				Mesh.Indices.push_back(First + Index);
+		}
+	}
+
+	Mesh.FacesCount = Mesh.Indices.size() / 3;
+	return Mesh;
+}
+
+void RavenousTest::RunMeshLodTestSuite()
+{
+	Test_MeshLodGeneration();
+	Test_MeshLodKeepsBorders();
+	Test_MeshLodSelection();
+	Test_ShadowCacheFollowsShadowLod();
+}
+
+void RavenousTest::Test_MeshLodGeneration()
+{
+	RMesh Mesh = MakeTestSphere(40, 80);
+	CookMesh(Mesh);
+	assert(Mesh.GetLodCount() == MaxMeshLods);
+
+	uint TotalIndices = Mesh.Indices.size() + Mesh.Lods.Indices.size();
+	for (uint Lod = 1; Lod < Mesh.GetLodCount(); Lod++)
+	{
+		const RMeshLod Level = Mesh.GetLod(Lod);
+		const RMeshLod Finer = Mesh.GetLod(Lod - 1);
+		assert(Level.IndexCount <= Finer.IndexCount * MaxLodTriangleRatio);
+		assert(Level.Error >= Finer.Error);
+		assert(Level.IndexOffset + Level.IndexCount <= TotalIndices);
+
+		// every triangle still lies on the sphere, within the error the LOD claims
+		for (uint i = 0; i < Level.IndexCount; i += 3)
+		{
+			const uint* Triangle = &Mesh.Lods.Indices[Level.IndexOffset - Mesh.Indices.size() + i];
+			const vec3 Centroid = (Mesh.Vertices[Triangle[0]].Position + Mesh.Vertices[Triangle[1]].Position + Mesh.Vertices[Triangle[2]].Position) / 3.f;
+			assert(1.f - glm::length(Centroid) <= Level.Error * 4.f + 0.005f);
+		}
+	}
+
+	// past the coarsest LOD selection clamps
+	assert(Mesh.GetLod(MaxMeshLods + 2).IndexOffset == Mesh.GetLod(MaxMeshLods - 1).IndexOffset);
+	// the bounding sphere LOD selection measures from holds the whole mesh
+	for (const RVertex& Vertex : Mesh.Vertices)
+		assert(glm::length(Vertex.Position - Mesh.Lods.Center) <= Mesh.Lods.Radius);
+}
+
+void RavenousTest::Test_MeshLodKeepsBorders()
+{
+	// a flat open grid: everything inside can go, the outline can't
+	constexpr uint Size = 20;
+	vector<RVertex> Vertices;
+	vector<uint> Indices;
+	for (uint Y = 0; Y <= Size; Y++)
+		for (uint X = 0; X <= Size; X++)
+			Vertices.emplace_back(vec3{X, 0, Y}, vec3{0, 1, 0}, vec2{0.f});
+	for (uint Y = 0; Y < Size; Y++)
+	{
+		for (uint X = 0; X < Size; X++)
+		{
+			const uint V = Y * (Size + 1) + X;
+			for (uint Index : {V, V + Size + 1, V + Size + 2, V + Size + 2, V + 1, V})
+				Indices.push_back(Index);
+		}
+	}
+
+	float Error;
+	const vector<uint> Simplified = SimplifyMesh(Vertices, Indices, 0, Error);
+	assert(Simplified.size() < Indices.size() / 4);
+	assert(Error < 1e-4f);
+
+	std::set<uint> Used(Simplified.begin(), Simplified.end());
+	for (uint i = 0; i <= Size; i++)
+	{
+		assert(Used.contains(i) && Used.contains(Size * (Size + 1) + i));
+		assert(Used.contains(i * (Size + 1)) && Used.contains(i * (Size + 1) + Size));
+	}
+
+	// no triangle turned over
+	for (uint i = 0; i < Simplified.size(); i += 3)
+	{
+		const vec3 Normal = glm::cross(Vertices[Simplified[i + 1]].Position - Vertices[Simplified[i]].Position,
+			Vertices[Simplified[i + 2]].Position - Vertices[Simplified[i]].Position);
+		assert(Normal.y > 0.f);
+	}
+}
+
+void RavenousTest::Test_MeshLodSelection()
+{
+	RMesh Mesh;
+	Mesh.Indices.resize(300);
+	Mesh.Lods.Levels = {RMeshLod{300, 150, 0.01f}, RMeshLod{450, 75, 0.02f}, RMeshLod{525, 36, 0.04f}};
+
+	constexpr float PixelError = 1.f;
+	constexpr float Hysteresis = 0.25f;
+	auto Select = [&](float PixelsPerUnit, uint Current) { return RLodSelector::SelectLod(&Mesh, PixelsPerUnit, Current, PixelError, Hysteresis); };
+
+	// close up, full detail; far away, the coarsest
+	assert(Select(1000.f, 0) == 0);
+	assert(Select(10.f, 0) == 3);
+
+	// LOD 1 fits at 90 pixels per unit (0.9 px) but not with the hysteresis margin, so it takes 75 to get there
+	assert(Select(90.f, 0) == 0);
+	assert(Select(75.f, 0) == 1);
+	// and once there it stays until the error really goes over a pixel
+	assert(Select(90.f, 1) == 1);
+	assert(Select(101.f, 1) == 0);
+
+	// same band going from LOD 1 to 2
+	assert(Select(45.f, 1) == 1);
+	assert(Select(37.5f, 1) == 2);
+	assert(Select(45.f, 2) == 2);
+
+	// a mesh without LODs only has LOD 0
+	RMesh Plain;
+	Plain.Indices.resize(30);
+	assert(RLodSelector::SelectLod(&Plain, 0.001f, 0, PixelError, Hysteresis) == 0);
+}
+
+void RavenousTest::Test_ShadowCacheFollowsShadowLod()
+{
+	RMesh Mesh;
+	Mesh.Indices.resize(300);
+	Mesh.Lods.Levels = {RMeshLod{300, 150, 0.01f}, RMeshLod{450, 75, 0.02f}, RMeshLod{525, 36, 0.04f}};
+	Mesh.Lods.Radius = 1.f;
+	EStaticMesh Wall;
+	Wall.Mesh = &Mesh;
+	Wall.MatModel = Mat4Identity;
+	const vector<EEntity*> Casters = {&Wall};
+
+	auto* LodSelector = RLodSelector::Get();
+	RCamera Camera;
+	Camera.Position = vec3(0, 0, 3);
+	LodSelector->BeginFrame(&Camera, 1000.f);
+	assert(LodSelector->SelectShadowLod(&Wall) == 1);
+
+	RShadowCache Cache;
+	assert(Cache.Update(NShadowMap::Directional, 1, Casters).RedrawStatic);
+	assert(!Cache.Update(NShadowMap::Directional, 1, Casters).RedrawStatic);
+
+	// nothing about the wall changed, but from over here it casts from the coarsest LOD
+	Camera.Position = vec3(0, 0, 1000);
+	LodSelector->BeginFrame(&Camera, 1000.f);
+	assert(LodSelector->SelectShadowLod(&Wall) == 3);
+	assert(Cache.Update(NShadowMap::Directional, 1, Casters).RedrawStatic);
+	assert(!Cache.Update(NShadowMap::Directional, 1, Casters).RedrawStatic);
+	assert(Cache.GetStats(NShadowMap::Directional).CasterInvalidations == 1);
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunMeshLodTestSuite();
+
+	void Test_MeshLodGeneration();
+	void Test_MeshLodKeepsBorders();
+	void Test_MeshLodSelection();
+	void Test_ShadowCacheFollowsShadowLod();
+}
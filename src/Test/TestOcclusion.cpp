@@ -0,0 +1,227 @@
+#include "TestOcclusion.h"
+
+#include "engine/collision/CollisionMesh.h"
+#include "engine/entities/StaticMesh.h"
+#include "engine/geometry/mesh.h"
+#include "engine/render/Occlusion.h"
+
+static RCollisionMesh MakeTestBox(vec3 Min, vec3 Max)
+{
+	RCollisionMesh Box;
+	Box.Vertices = {
+		vec3{Min.x, Min.y, Min.z}, vec3{Max.x, Min.y, Min.z}, vec3{Max.x, Max.y, Min.z}, vec3{Min.x, Max.y, Min.z},
+		vec3{Min.x, Min.y, Max.z}, vec3{Max.x, Min.y, Max.z}, vec3{Max.x, Max.y, Max.z}, vec3{Min.x, Max.y, Max.z},
+	};
+	Box.Indices = {
+		0, 3, 2,  0, 2, 1,
+		4, 5, 6,  4, 6, 7,
+		0, 4, 7,  0, 7, 3,
+		1, 2, 6,  1, 6, 5,
+		0, 1, 5,  0, 5, 4,
+		3, 7, 6,  3, 6, 2,
+	};
+	return Box;
+}
+
+// boxes put together into one render mesh
+static RMesh MakeTestRenderMesh(std::initializer_list<std::pair<vec3, vec3>> Boxes)
+{
+	RMesh Mesh;
+	for (const auto& [Min, Max] : Boxes)
+	{
+		const RCollisionMesh Box = MakeTestBox(Min, Max);
+		const uint First = Mesh.Vertices.size();
+		for (const vec3& Vertex : Box.Vertices)
+			Mesh.Vertices.emplace_back(Vertex);
+		for (const uint Index : Box.Indices)
+			Mesh.Indices.push_back(First + Index);
+	}
+	Mesh.FacesCount = Mesh.Indices.size() / 3;
+	return Mesh;
+}
+
+static RBoundingBox MakeTestBounds(vec3 Min, vec3 Max)
+{
+	RBoundingBox Box;
+	Box.MinX = Min.x;
+	Box.MinY = Min.y;
+	Box.MinZ = Min.z;
+	Box.MaxX = Max.x;
+	Box.MaxY = Max.y;
+	Box.MaxZ = Max.z;
+	return Box;
+}
+
+// at the origin looking down -z
+static mat4 GetTestViewProjection()
+{
+	return glm::perspective(glm::radians(60.f), 2.f, 0.1f, 100.f) * glm::lookAt(vec3(0.f), vec3(0, 0, -1), vec3(0, 1, 0));
+}
+
+void RavenousTest::RunOcclusionTestSuite()
+{
+	Test_OcclusionWall();
+	Test_OcclusionNearPlane();
+	Test_OcclusionPyramid();
+	Test_OcclusionHiddenOccluder();
+	Test_OcclusionRenderMeshOccluder();
+}
+
+void RavenousTest::Test_OcclusionWall()
+{
+	ROcclusionCulling Occlusion;
+	Occlusion.Begin(GetTestViewProjection());
+
+	// nothing rasterized yet, nothing can be hidden
+	Occlusion.BuildPyramid();
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1, -1, -20), vec3(1, 1, -18))));
+
+	const RCollisionMesh Wall = MakeTestBox(vec3(-2, -2, -5.5f), vec3(2, 2, -5));
+	Occlusion.RasterizeOccluder(Wall, Mat4Identity);
+	Occlusion.BuildPyramid();
+	assert(Occlusion.GetStats().Occluders == 1 && Occlusion.GetStats().OccluderTriangles == 12);
+
+	// right behind the wall
+	assert(!Occlusion.TestBox(MakeTestBounds(vec3(-1, -1, -20), vec3(1, 1, -18))));
+	assert(!Occlusion.TestBox(MakeTestBounds(vec3(-0.5f, -0.5f, -7), vec3(0.5f, 0.5f, -6))));
+	// in front of it
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1, -1, -3), vec3(1, 1, -2))));
+	// behind it but sticking out past its edge
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(1, -1, -20), vec3(12, 1, -18))));
+	// beside it
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(20, -1, -20), vec3(22, 1, -18))));
+	// going through the wall and out the front of it
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1, -1, -6), vec3(1, 1, -4.8f))));
+}
+
+void RavenousTest::Test_OcclusionNearPlane()
+{
+	ROcclusionCulling Occlusion;
+	Occlusion.Begin(GetTestViewProjection());
+
+	// a floor under the camera going behind it, its triangles cross the near plane and get clipped
+	const RCollisionMesh Floor = MakeTestBox(vec3(-50, -2, -50), vec3(50, -1, 50));
+	Occlusion.RasterizeOccluder(Floor, Mat4Identity);
+	Occlusion.BuildPyramid();
+
+	assert(!Occlusion.TestBox(MakeTestBounds(vec3(-1, -10, -20), vec3(1, -8, -18))));
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1, 1, -20), vec3(1, 3, -18))));
+
+	// a box around the camera is always visible
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1), vec3(1))));
+	// so is one that's all behind it
+	assert(Occlusion.TestBox(MakeTestBounds(vec3(-1, -10, 8), vec3(1, -8, 10))));
+}
+
+void RavenousTest::Test_OcclusionPyramid()
+{
+	ROcclusionCulling Occlusion;
+	Occlusion.Begin(GetTestViewProjection());
+
+	const RCollisionMesh Wall = MakeTestBox(vec3(-2, -2, -5.5f), vec3(2, 2, -5));
+	Occlusion.RasterizeOccluder(Wall, Mat4Identity);
+	Occlusion.RasterizeOccluder(MakeTestBox(vec3(3, 0, -9), vec3(6, 3, -8)), Mat4Identity);
+	Occlusion.BuildPyramid();
+
+	const uint LevelCount = Occlusion.GetLevelCount();
+	assert(Occlusion.GetLevelWidth(0) == ROcclusionCulling::Width && Occlusion.GetLevelHeight(0) == ROcclusionCulling::Height);
+	assert(Occlusion.GetLevelWidth(LevelCount - 1) == 1 && Occlusion.GetLevelHeight(LevelCount - 1) == 1);
+
+	uint Covered = 0;
+	for (uint y = 0; y < ROcclusionCulling::Height; y++)
+	{
+		for (uint x = 0; x < ROcclusionCulling::Width; x++)
+		{
+			const float Depth = Occlusion.GetDepth(0, x, y);
+			assert(Depth >= 0.f && Depth <= 1.f);
+			Covered += Depth < 1.f;
+		}
+	}
+	assert(Covered > 0 && Covered < ROcclusionCulling::Width * ROcclusionCulling::Height);
+
+	// every texel is the furthest of the ones it covers in the level below
+	for (uint Level = 1; Level < LevelCount; Level++)
+	{
+		const uint SourceWidth = Occlusion.GetLevelWidth(Level - 1);
+		const uint SourceHeight = Occlusion.GetLevelHeight(Level - 1);
+		for (uint y = 0; y < Occlusion.GetLevelHeight(Level); y++)
+		{
+			for (uint x = 0; x < Occlusion.GetLevelWidth(Level); x++)
+			{
+				float Expected = 0.f;
+				for (uint Y = y * 2; Y < std::min(y * 2 + 2, SourceHeight); Y++)
+					for (uint X = x * 2; X < std::min(x * 2 + 2, SourceWidth); X++)
+						Expected = std::max(Expected, Occlusion.GetDepth(Level - 1, X, Y));
+				assert(Occlusion.GetDepth(Level, x, y) == Expected);
+			}
+		}
+	}
+
+	// the screen isn't all covered, so the top of the pyramid is the clear depth
+	assert(Occlusion.GetDepth(LevelCount - 1, 0, 0) == 1.f);
+}
+
+void RavenousTest::Test_OcclusionHiddenOccluder()
+{
+	// a flagged wall with a box behind it
+	RCollisionMesh WallMesh = MakeTestBox(vec3(-2, -2, -5.5f), vec3(2, 2, -5));
+	RCollisionMesh BoxMesh = MakeTestBox(vec3(-0.5f, -0.5f, -7), vec3(0.5f, 0.5f, -6));
+	EStaticMesh Wall;
+	Wall.CollisionMesh = &WallMesh;
+	Wall.Occluder = true;
+	Wall.Update();
+	EStaticMesh Box;
+	Box.CollisionMesh = &BoxMesh;
+	Box.Update();
+	const vector<EEntity*> Visible = {&Wall, &Box};
+
+	ROcclusionCulling Occlusion;
+	assert(Occlusion.Cull(Visible, GetTestViewProjection()).size() == 1);
+	assert(Occlusion.GetStats().Occluders == 1 && Occlusion.GetStats().Occluded == 1);
+
+	// hiding the wall in the editor, or drawing it as wireframe, shows what's behind it
+	for (const Flags Flag : {EntityFlags_HiddenEntity, EntityFlags_RenderWireframe, EntityFlags_InvisibleEntity})
+	{
+		Wall.Flags = Flag;
+		assert(Occlusion.Cull(Visible, GetTestViewProjection()).size() == 2);
+		assert(Occlusion.GetStats().Occluders == 0 && Occlusion.GetStats().Occluded == 0);
+	}
+}
+
+void RavenousTest::Test_OcclusionRenderMeshOccluder()
+{
+	// an arch, two pillars and a lintel, with the bounding box as its collision mesh like the editor gives it
+	RMesh ArchMesh = MakeTestRenderMesh({
+		{vec3(-6, -3, -5.5f), vec3(-1, 3, -5)}, {vec3(1, -3, -5.5f), vec3(6, 3, -5)}, {vec3(-1, 2, -5.5f), vec3(1, 3, -5)}
+	});
+	RCollisionMesh ArchCollider = MakeTestBox(vec3(-6, -3, -5.5f), vec3(6, 3, -5));
+	EStaticMesh Arch;
+	Arch.Mesh = &ArchMesh;
+	Arch.CollisionMesh = &ArchCollider;
+	Arch.Update();
+
+	// one box seen through the opening, one behind a pillar
+	RCollisionMesh ThroughMesh = MakeTestBox(vec3(-0.2f, -0.5f, -8), vec3(0.2f, 0.5f, -7));
+	RCollisionMesh BehindMesh = MakeTestBox(vec3(2.5f, -0.5f, -8), vec3(3.5f, 0.5f, -7));
+	EStaticMesh Through;
+	Through.CollisionMesh = &ThroughMesh;
+	Through.Update();
+	EStaticMesh Behind;
+	Behind.CollisionMesh = &BehindMesh;
+	Behind.Update();
+	const vector<EEntity*> Visible = {&Arch, &Through, &Behind};
+
+	// picked for its size, the arch is rasterized from what's drawn and not from its collider
+	ROcclusionCulling Occlusion;
+	const vector<EEntity*> Drawn = Occlusion.Cull(Visible, GetTestViewProjection());
+	assert(Occlusion.GetStats().Occluders == 1 && Occlusion.GetStats().OccluderTriangles == 36);
+	assert(Drawn.size() == 2 && Drawn[0] == &Arch && Drawn[1] == &Through);
+
+	// a render mesh too big to rasterize every frame isn't picked at all
+	RMesh Dense = ArchMesh;
+	while (Dense.Indices.size() / 3 <= ROcclusionCulling::MaxOccluderTriangles)
+		Dense.Indices.insert(Dense.Indices.end(), ArchMesh.Indices.begin(), ArchMesh.Indices.end());
+	Arch.Mesh = &Dense;
+	assert(Occlusion.Cull(Visible, GetTestViewProjection()).size() == 3);
+	assert(Occlusion.GetStats().Occluders == 0);
+}
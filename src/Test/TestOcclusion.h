@@ -0,0 +1,13 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunOcclusionTestSuite();
+
+	void Test_OcclusionWall();
+	void Test_OcclusionNearPlane();
+	void Test_OcclusionPyramid();
+	void Test_OcclusionHiddenOccluder();
+	void Test_OcclusionRenderMeshOccluder();
+}
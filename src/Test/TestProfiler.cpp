@@ -0,0 +1,113 @@
+#include "TestProfiler.h"
+
+#include "engine/core/JobSystem.h"
+#include "engine/core/Profiler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+static const string TracePath = "test_profiler_trace.json";
+
+void RavenousTest::RunProfilerTestSuite()
+{
+	Test_ProfilerIdle();
+	Test_ProfilerCapture();
+	Test_ProfilerTrace();
+	remove(TracePath.c_str());
+}
+
+static uint CountOccurrences(const string& Text, const string& Pattern)
+{
+	uint Count = 0;
+	for (size_t At = Text.find(Pattern); At != string::npos; At = Text.find(Pattern, At + Pattern.size()))
+		Count++;
+	return Count;
+}
+
+static string ReadTrace()
+{
+	std::ifstream File(TracePath);
+	std::stringstream Stream;
+	Stream << File.rdbuf();
+	return Stream.str();
+}
+
+void RavenousTest::Test_ProfilerIdle()
+{
+	// outside of a capture zones don't record, nor give their thread a buffer
+	auto* Profiler = RProfiler::Get();
+	const uint Threads = Profiler->GetThreadCount();
+	{
+		PROFILE_ZONE("Idle");
+		PROFILE_GPU_ZONE("Idle");
+	}
+	assert(!Profiler->IsCapturing());
+	assert(Profiler->GetThreadCount() == Threads);
+
+	// and the capture only starts at the end of the frame
+	assert(Profiler->Capture(1, TracePath));
+	assert(!Profiler->Capture(1, TracePath));
+	assert(!Profiler->IsCapturing());
+	Profiler->EndFrame();
+	assert(Profiler->IsCapturing());
+	Profiler->EndFrame();
+	assert(!Profiler->IsCapturing());
+}
+
+void RavenousTest::Test_ProfilerCapture()
+{
+	constexpr uint ItemCount = 64;
+	auto* Profiler = RProfiler::Get();
+	RJobSystem::Get()->Initialize(3);
+
+	assert(Profiler->Capture(2, TracePath));
+	Profiler->EndFrame();
+	for (uint Frame = 0; Frame < 2; Frame++)
+	{
+		assert(Profiler->IsCapturing());
+		{
+			PROFILE_ZONE("Outer");
+			{
+				PROFILE_ZONE("Inner");
+			}
+			RJobSystem::Get()->ParallelFor(ItemCount, 1, [](uint Begin, uint End)
+			{
+				PROFILE_ZONE("Work");
+			});
+		}
+		Profiler->EndFrame();
+	}
+	assert(!Profiler->IsCapturing());
+
+	// Outer and Inner once a frame, Work and Job once per item and frame
+	constexpr uint Expected = 2 * (2 + ItemCount * 2);
+	assert(Profiler->GetEventCount() == Expected);
+	assert(Profiler->GetDroppedCount() == 0);
+	assert(Profiler->GetGpuEventCount() == 0);
+
+	// nothing recorded past the end of the capture
+	{
+		PROFILE_ZONE("After");
+	}
+	assert(Profiler->GetEventCount() == Expected);
+
+	RJobSystem::Get()->Shutdown();
+}
+
+void RavenousTest::Test_ProfilerTrace()
+{
+	// what Test_ProfilerCapture wrote when the capture stopped
+	const string Trace = ReadTrace();
+	assert(Trace.find("\"traceEvents\"") != string::npos);
+	assert(CountOccurrences(Trace, "\"name\": \"Outer\"") == 2);
+	assert(CountOccurrences(Trace, "\"name\": \"Inner\"") == 2);
+	// the calling thread runs batches too, which of the threads recorded them is up to scheduling
+	assert(CountOccurrences(Trace, "\"name\": \"Work\"") == 128);
+	assert(CountOccurrences(Trace, "\"name\": \"Job\"") == 128);
+	assert(CountOccurrences(Trace, "\"name\": \"Frame\"") == 2);
+	assert(CountOccurrences(Trace, "\"name\": \"After\"") == 0);
+	assert(CountOccurrences(Trace, "\"ph\": \"X\"") == RProfiler::Get()->GetEventCount() + 2);
+	assert(Trace.find("\"name\": \"Main") != string::npos);
+	assert(Trace.find("\"name\": \"GPU\"") == string::npos);
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunProfilerTestSuite();
+
+	void Test_ProfilerIdle();
+	void Test_ProfilerCapture();
+	void Test_ProfilerTrace();
+}
@@ -0,0 +1,146 @@
+#include "TestRenderStats.h"
+
+#include "engine/core/FrameMetrics.h"
+#include "engine/render/CommandList.h"
+#include "engine/render/RenderStats.h"
+
+#include <glad/glad.h>
+#include <thread>
+
+void RavenousTest::RunRenderStatsTestSuite()
+{
+	RRenderBackend::Get()->Type = NRenderBackend::Null;
+
+	Test_RenderStatsPasses();
+	Test_RenderStatsNestedTiming();
+	Test_RenderStatsBackend();
+	Test_FrameMetricsRecord();
+}
+
+static double GetLastFrameMetric(const string& Name)
+{
+	for (const RFrameMetric& Metric : RFrameMetrics::Get()->GetLastFrame())
+	{
+		if (Metric.Name == Name)
+			return Metric.Value;
+	}
+	return -1;
+}
+
+void RavenousTest::Test_RenderStatsPasses()
+{
+	auto* Stats = RRenderStats::Get();
+	Stats->BeginFrame();
+	{
+		RRenderPassScope Pass(NStatsPass::Main);
+		Stats->CountProgramBind();
+		Stats->CountDraw(GL_TRIANGLES, 300, 2);
+		Stats->CountDraw(GL_TRIANGLE_STRIP, 4);
+		Stats->CountDraw(GL_LINES, 10);
+		{
+			RRenderPassScope Inner(NStatsPass::Text);
+			Stats->CountTextureBind();
+			Stats->CountUpload(64);
+		}
+		Stats->CountUniformSet();
+	}
+	// entered a second time in the same frame, adds up
+	{
+		RRenderPassScope Pass(NStatsPass::Main);
+		Stats->CountDraw(GL_TRIANGLES, 3);
+	}
+	Stats->CountUpload(16);
+	Stats->EndFrame();
+
+	const RRenderPassStats& Main = Stats->GetPass(NStatsPass::Main);
+	assert(Main.DrawCalls == 4 && Main.ProgramBinds == 1 && Main.UniformSets == 1 && Main.TextureBinds == 0);
+	assert(Main.Triangles == 200 + 2 + 1 && Main.UploadBytes == 0);
+
+	const RRenderPassStats& Text = Stats->GetPass(NStatsPass::Text);
+	assert(Text.DrawCalls == 0 && Text.TextureBinds == 1 && Text.UploadBytes == 64);
+
+	// outside of any pass
+	assert(Stats->GetPass(NStatsPass::Other).UploadBytes == 16);
+	assert(Stats->GetTotal().DrawCalls == 4 && Stats->GetTotal().UploadBytes == 80);
+
+	// the published frame stays until the next EndFrame, not the next BeginFrame
+	Stats->BeginFrame();
+	assert(Stats->GetPass(NStatsPass::Main).DrawCalls == 4);
+	Stats->EndFrame();
+	assert(Stats->GetPass(NStatsPass::Main).DrawCalls == 0);
+}
+
+void RavenousTest::Test_RenderStatsNestedTiming()
+{
+	using namespace std::chrono_literals;
+
+	auto* Stats = RRenderStats::Get();
+	Stats->BeginFrame();
+	{
+		RRenderPassScope Outer(NStatsPass::Editor);
+		{
+			RRenderPassScope Inner(NStatsPass::ImDraw);
+			std::this_thread::sleep_for(20ms);
+		}
+	}
+	Stats->EndFrame();
+
+	// the inner pass' time isn't counted again in the outer one
+	const double Inner = Stats->GetPass(NStatsPass::ImDraw).CpuMs;
+	const double Outer = Stats->GetPass(NStatsPass::Editor).CpuMs;
+	assert(Inner >= 20.0);
+	assert(Outer >= 0.0 && Outer < 10.0);
+}
+
+void RavenousTest::Test_RenderStatsBackend()
+{
+	RCommandList List;
+	List.UseProgram(3);
+	List.SetInt(0, 1);
+	List.BindTexture(0, GL_TEXTURE_2D, 5);
+	List.BindTexture(1, GL_TEXTURE_2D, 6);
+	List.BindVertexArray(7);
+	List.DrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, 4);
+	List.DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	// what goes through a backend counts for the active pass, the Null one included
+	auto* Stats = RRenderStats::Get();
+	Stats->BeginFrame();
+	{
+		RRenderPassScope Pass(NStatsPass::DirectionalShadow);
+		RRenderBackend::Get()->Execute(List);
+	}
+	Stats->EndFrame();
+
+	const RRenderPassStats& Shadow = Stats->GetPass(NStatsPass::DirectionalShadow);
+	assert(Shadow.DrawCalls == 2 && Shadow.ProgramBinds == 1 && Shadow.UniformSets == 1 && Shadow.TextureBinds == 2);
+	assert(Shadow.Triangles == 12 * 4 + 2);
+	assert(Stats->GetPass(NStatsPass::Main).DrawCalls == 0);
+}
+
+void RavenousTest::Test_FrameMetricsRecord()
+{
+	auto* Metrics = RFrameMetrics::Get();
+	auto* Stats = RRenderStats::Get();
+
+	Stats->BeginFrame();
+	{
+		RRenderPassScope Pass(NStatsPass::PointShadow);
+		Stats->CountDraw(GL_TRIANGLES, 6, 3);
+	}
+	Stats->EndFrame();
+	Metrics->Set("frame.ms", 16.5);
+
+	const uint64 Frame = Metrics->GetFrameIndex();
+	Metrics->EndFrame();
+	assert(Metrics->GetFrameIndex() == Frame + 1);
+
+	assert(GetLastFrameMetric("frame.ms") == 16.5);
+	assert(GetLastFrameMetric("render.shadow_cube.draws") == 1);
+	assert(GetLastFrameMetric("render.shadow_cube.triangles") == 6);
+	assert(GetLastFrameMetric("render.main.draws") == 0);
+
+	// a value not set again reads zero the next frame
+	Metrics->EndFrame();
+	assert(GetLastFrameMetric("frame.ms") == 0);
+}
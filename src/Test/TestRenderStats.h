@@ -0,0 +1,12 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunRenderStatsTestSuite();
+
+	void Test_RenderStatsPasses();
+	void Test_RenderStatsNestedTiming();
+	void Test_RenderStatsBackend();
+	void Test_FrameMetricsRecord();
+}
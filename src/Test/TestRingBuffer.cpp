@@ -0,0 +1,102 @@
+#include "TestRingBuffer.h"
+
+#include "engine/render/RingBuffer.h"
+
+#include <cstring>
+
+void RavenousTest::RunRingBufferTestSuite()
+{
+	Test_RingBufferAlignment();
+	Test_RingBufferFrames();
+	Test_RingBufferGrow();
+}
+
+void RavenousTest::Test_RingBufferAlignment()
+{
+	RRingBuffer Ring;
+	Ring.Init(NRingBufferBackend::Memory, 0, 1000);
+
+	// strides that aren't powers of two, in every region so the region start isn't a multiple of them either
+	for (uint Frame = 0; Frame < RRingBuffer::FrameCount; Frame++)
+	{
+		Ring.BeginFrame();
+		const uint Alignments[] = {1, 20, 24, 64, 4, 20};
+		uint PreviousEnd = Frame * Ring.GetFrameSize();
+		for (uint Alignment : Alignments)
+		{
+			RRingAllocation Allocation = Ring.Allocate(7, Alignment);
+			assert(Allocation.IsValid());
+			assert(Allocation.Offset % Alignment == 0);
+			assert(Allocation.Offset >= PreviousEnd && Allocation.Offset - PreviousEnd < Alignment);
+			assert(Allocation.Offset + Allocation.Size <= (Frame + 1) * Ring.GetFrameSize());
+			Ring.Commit(Allocation);
+			PreviousEnd = Allocation.Offset + Allocation.Size;
+		}
+		assert(Ring.GetStats().Allocations == 6 && Ring.GetStats().Bytes == 42);
+		Ring.EndFrame();
+	}
+
+	assert(!Ring.Allocate(0).IsValid());
+}
+
+void RavenousTest::Test_RingBufferFrames()
+{
+	RRingBuffer Ring;
+	Ring.Init(NRingBufferBackend::Memory, 0, 256);
+
+	// each frame writes its own region, and a region's bytes survive until FrameCount frames later
+	uint8* Written[RRingBuffer::FrameCount]{};
+	for (uint Frame = 0; Frame < RRingBuffer::FrameCount * 4; Frame++)
+	{
+		const uint Region = Frame % RRingBuffer::FrameCount;
+		Ring.BeginFrame();
+		assert(Ring.GetRegion() == Region);
+
+		for (uint Other = 0; Other < RRingBuffer::FrameCount; Other++)
+		{
+			if (Other != Region && Written[Other])
+				assert(Written[Other][0] == Frame - (Frame + RRingBuffer::FrameCount - Other) % RRingBuffer::FrameCount);
+		}
+
+		uint8 Data[200];
+		memset(Data, Frame, sizeof(Data));
+		RRingAllocation Allocation = Ring.Upload(Data, sizeof(Data), 16);
+		assert(Allocation.Offset == Region * Ring.GetFrameSize());
+		Written[Region] = Allocation.Data;
+		Ring.EndFrame();
+	}
+	assert(Ring.GetStats().Grows == 0);
+}
+
+void RavenousTest::Test_RingBufferGrow()
+{
+	RRingBuffer Ring;
+	Ring.Init(NRingBufferBackend::Memory, 0, 128);
+
+	Ring.BeginFrame();
+	Ring.EndFrame();
+	Ring.BeginFrame();
+	assert(Ring.GetRegion() == 1);
+
+	// more than a region holds moves the frame to the start of a bigger ring
+	const uint Generation = Ring.GetGeneration();
+	RRingAllocation Small = Ring.Allocate(100);
+	memset(Small.Data, 0xAB, Small.Size);
+	RRingAllocation Big = Ring.Allocate(300, 64);
+	assert(Big.IsValid() && Big.Offset == 0);
+	assert(Ring.GetFrameSize() >= 364 && Ring.GetRegion() == 0);
+	assert(Ring.GetStats().Grows == 1);
+	assert(Small.Generation == Generation && Big.Generation == Generation + 1 && Ring.GetGeneration() == Generation + 1);
+
+	// what was written before the grow is still there until the end of the frame
+	memset(Big.Data, 0xCD, Big.Size);
+	for (uint Index = 0; Index < Small.Size; Index++)
+		assert(Small.Data[Index] == 0xAB);
+
+	// and the frames after it use the new regions in order
+	Ring.EndFrame();
+	Ring.BeginFrame();
+	assert(Ring.GetRegion() == 1);
+	assert(Ring.Allocate(300).Offset == Ring.GetFrameSize());
+	Ring.EndFrame();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunRingBufferTestSuite();
+
+	void Test_RingBufferAlignment();
+	void Test_RingBufferFrames();
+	void Test_RingBufferGrow();
+}
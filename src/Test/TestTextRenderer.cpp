@@ -0,0 +1,156 @@
+#include "TestTextRenderer.h"
+
+#include "engine/render/text/TextRenderer.h"
+#include "engine/render/text/FontCache.h"
+
+#include <glm/gtc/packing.hpp>
+#include <cstdio>
+#include <cstring>
+
+void RavenousTest::RunTextRendererTestSuite()
+{
+	Test_TextAtlasPacking();
+	Test_TextLayout();
+	Test_FontCacheRoundTrip();
+}
+
+void RavenousTest::Test_TextAtlasPacking()
+{
+	// glyph sizes of a typical 18 px font, blanks included
+	vector<glm::ivec2> Sizes;
+	for (uint C = 0; C < RFont::CharacterCount; C++)
+		Sizes.push_back(C <= 32 ? glm::ivec2(0) : glm::ivec2(4 + C % 9, 6 + C % 13));
+
+	glm::ivec2 AtlasSize;
+	const vector<glm::ivec2> Positions = RTextRenderer::PackGlyphs(Sizes, AtlasSize);
+	assert(Positions.size() == Sizes.size());
+	assert(AtlasSize.x == 128 && AtlasSize.y <= AtlasSize.x);
+	assert((AtlasSize.y & (AtlasSize.y - 1)) == 0);
+
+	for (uint A = 0; A < Sizes.size(); A++)
+	{
+		// inside the atlas, with a pixel to spare on every side
+		assert(Positions[A].x >= 1 && Positions[A].y >= 1);
+		assert(Positions[A].x + Sizes[A].x < AtlasSize.x && Positions[A].y + Sizes[A].y < AtlasSize.y);
+
+		for (uint B = A + 1; B < Sizes.size(); B++)
+		{
+			if (Sizes[A].x == 0 || Sizes[B].x == 0)
+				continue;
+
+			const bool Apart = Positions[A].x + Sizes[A].x < Positions[B].x || Positions[B].x + Sizes[B].x < Positions[A].x
+				|| Positions[A].y + Sizes[A].y < Positions[B].y || Positions[B].y + Sizes[B].y < Positions[A].y;
+			assert(Apart);
+		}
+	}
+
+	// bigger glyphs move to a bigger atlas, too big ones don't fit at all
+	Sizes.assign(RFont::CharacterCount, glm::ivec2(60, 80));
+	assert(!RTextRenderer::PackGlyphs(Sizes, AtlasSize).empty() && AtlasSize.x == 1024);
+	Sizes.assign(1, glm::ivec2(5000, 10));
+	assert(RTextRenderer::PackGlyphs(Sizes, AtlasSize).empty());
+}
+
+void RavenousTest::Test_TextLayout()
+{
+	RFont Font;
+	Font.AtlasSize = glm::ivec2(64, 64);
+	for (auto& Character : Font.Characters)
+		Character = RCharacter{vec2(0.25f, 0.5f), vec2(0.375f, 0.75f), 10 << 6, glm::ivec2(8, 16), glm::ivec2(1, 12)};
+	Font.Characters[' '].Size = glm::ivec2(0);
+
+	const vec3 Color{1.f, 0.5f, 0.f};
+	vector<RTextVertex> Vertices;
+	RTextRenderer::LayoutText(Font, 100, 50, Color, 1.f, false, "ab c", Vertices);
+
+	// the space only advances, and every stream of the frame appends to the same vector
+	assert(Vertices.size() == 3 * 6);
+	RTextRenderer::LayoutText(Font, 0, 0, Color, 1.f, false, "\xE9", Vertices);
+	assert(Vertices.size() == 3 * 6);
+
+	// first glyph: two triangles on the baseline, top of the quad takes the top of the glyph in the atlas
+	assert(Vertices[0].Position == vec2(101, 62) && Vertices[0].TexCoords == vec2(0.25f, 0.5f));
+	assert(Vertices[1].Position == vec2(101, 46) && Vertices[1].TexCoords == vec2(0.25f, 0.75f));
+	assert(Vertices[2].Position == vec2(109, 46) && Vertices[2].TexCoords == vec2(0.375f, 0.75f));
+	assert(Vertices[5].Position == vec2(109, 62) && Vertices[5].TexCoords == vec2(0.375f, 0.5f));
+	assert(Vertices[0].Color == glm::packUnorm4x8(vec4(Color, 1.f)));
+
+	// 'c' comes after two advances and the space
+	assert(Vertices[12].Position.x == 131);
+
+	// centered text moves left by half its width
+	vector<RTextVertex> Centered;
+	RTextRenderer::LayoutText(Font, 100, 50, Color, 2.f, true, "ab", Centered);
+	assert(Centered[0].Position.x == 100 - 18 + 2);
+}
+
+void RavenousTest::Test_FontCacheRoundTrip()
+{
+	vector<RBakedFont> Fonts(2);
+	for (uint i = 0; i < Fonts.size(); i++)
+	{
+		RBakedFont& Font = Fonts[i];
+		Font.Name = "consola" + std::to_string(12 + i * 6);
+		Font.Key = RFontCacheKey{HashFontFile({1, 2, 3}), GetGlyphSetHash(), static_cast<int>(12 + i * 6)};
+		Font.AtlasSize = glm::ivec2(128, 64 << i);
+		Font.Atlas.resize(Font.AtlasSize.x * Font.AtlasSize.y);
+		for (uint Pixel = 0; Pixel < Font.Atlas.size(); Pixel++)
+			Font.Atlas[Pixel] = static_cast<uint8>(Pixel * 7 + i);
+		for (uint C = 0; C < RBakedFont::CharacterCount; C++)
+			Font.Characters[C] = RCharacter{vec2(C / 128.f, 0.f), vec2(C / 128.f, 0.5f), C << 6, glm::ivec2(C % 9, i), glm::ivec2(1, C % 13)};
+	}
+
+	const string Filepath = "test_font_cache.rfont";
+	assert(WriteFontCache(Filepath, Fonts));
+
+	vector<RBakedFont> Read;
+	assert(ReadFontCache(Filepath, Read));
+	assert(Read.size() == Fonts.size());
+	for (uint i = 0; i < Fonts.size(); i++)
+	{
+		assert(Read[i].Name == Fonts[i].Name && Read[i].Key == Fonts[i].Key);
+		assert(Read[i].AtlasSize == Fonts[i].AtlasSize && Read[i].Atlas == Fonts[i].Atlas);
+		assert(memcmp(Read[i].Characters, Fonts[i].Characters, sizeof(RBakedFont::Characters)) == 0);
+	}
+
+	// a different font file or size is another key
+	assert(HashFontFile({1, 2, 3}) != HashFontFile({1, 2, 4}));
+	assert(!(Fonts[0].Key == Fonts[1].Key));
+
+	// a truncated file is rejected as a whole
+	FILE* File = fopen(Filepath.c_str(), "rb");
+	fseek(File, 0, SEEK_END);
+	vector<uint8> Data(ftell(File));
+	fseek(File, 0, SEEK_SET);
+	fread(Data.data(), 1, Data.size(), File);
+	fclose(File);
+	File = fopen(Filepath.c_str(), "wb");
+	fwrite(Data.data(), 1, Data.size() - 100, File);
+	fclose(File);
+	assert(!ReadFontCache(Filepath, Read) && Read.empty());
+
+	// so is one claiming more than it holds, without allocating for it first
+	auto WriteBytes = [&Filepath](const void* Bytes, size_t Size)
+	{
+		FILE* Out = fopen(Filepath.c_str(), "wb");
+		fwrite(Bytes, 1, Size, Out);
+		fclose(Out);
+	};
+	const uint Magic = 'R' | 'F' << 8 | 'N' << 16 | 'T' << 24;
+	const uint Header[3] = {Magic, 1, 0x7fffffff};
+	WriteBytes(Header, sizeof(Header));
+	assert(!ReadFontCache(Filepath, Read) && Read.empty());
+
+	// and a record with an atlas bigger than the file, or than any font is baked to
+	for (const int Side : {4000, 0x10000})
+	{
+		vector<uint8> Bytes = Data;
+		int AtlasSize[2] = {Side, Side};
+		memcpy(Bytes.data() + sizeof(Header) + 20, AtlasSize, sizeof(AtlasSize));
+		WriteBytes(Bytes.data(), Bytes.size());
+		assert(!ReadFontCache(Filepath, Read) && Read.empty());
+	}
+
+	remove(Filepath.c_str());
+	assert(!ReadFontCache(Filepath, Read));
+}
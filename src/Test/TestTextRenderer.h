@@ -0,0 +1,11 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunTextRendererTestSuite();
+
+	void Test_TextAtlasPacking();
+	void Test_TextLayout();
+	void Test_FontCacheRoundTrip();
+}
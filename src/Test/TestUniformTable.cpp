@@ -0,0 +1,60 @@
+#include "TestUniformTable.h"
+
+#include "engine/render/UniformTable.h"
+
+// compile time ids must agree with the runtime hash used when the table is filled from GL reflection
+static_assert(RUniformId("model") == RUniformId::FromHash(HashUniformName("model")));
+static_assert(MakeIndexedUniformId("pointLights", 3, ".diffuse") == RUniformId("pointLights[3].diffuse"));
+static_assert(MakeIndexedUniformId("spotLights", 17, ".outercone") == RUniformId("spotLights[17].outercone"));
+static_assert(MakeIndexedUniformIds<32>("dirLights", ".direction")[31] == RUniformId("dirLights[31].direction"));
+
+void RavenousTest::RunUniformTableTestSuite()
+{
+	Test_UniformIdHashing();
+	Test_UniformTableLookup();
+	Test_UniformTableGrowth();
+}
+
+void RavenousTest::Test_UniformIdHashing()
+{
+	const string Name = "pointLights[" + std::to_string(12) + "].quadratic";
+	assert(RUniformId(Name) == MakeIndexedUniformId("pointLights", 12, ".quadratic"));
+	assert(!(RUniformId("model") == RUniformId("view")));
+}
+
+void RavenousTest::Test_UniformTableLookup()
+{
+	RUniformTable Table;
+	assert(Table.Find("model") == -1);
+
+	Table.Add("model", 4);
+	Table.Add("view", 7);
+	Table.Add("pointLights[0].position", 12);
+
+	assert(Table.Size() == 3);
+	assert(Table.Find("model") == 4);
+	assert(Table.Find("view") == 7);
+	assert(Table.Find(MakeIndexedUniformId("pointLights", 0, ".position")) == 12);
+	assert(Table.Find("projection") == -1);
+
+	// re-adding a name updates its location instead of duplicating it
+	Table.Add("model", 5);
+	assert(Table.Size() == 3);
+	assert(Table.Find("model") == 5);
+
+	Table.Clear();
+	assert(Table.Size() == 0);
+	assert(Table.Find("view") == -1);
+}
+
+void RavenousTest::Test_UniformTableGrowth()
+{
+	// more than a lit shader has, so the table has to grow a few times
+	RUniformTable Table;
+	for (int I = 0; I < 1000; I++)
+		Table.Add("spotLights[" + std::to_string(I) + "].diffuse", I);
+
+	assert(Table.Size() == 1000);
+	for (uint I = 0; I < 1000; I++)
+		assert(Table.Find(MakeIndexedUniformId("spotLights", I, ".diffuse")) == static_cast<int>(I));
+}
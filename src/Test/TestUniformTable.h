@@ -0,0 +1,11 @@
+#pragma once
+#include "Engine/Core/Core.h"
+
+namespace RavenousTest
+{
+	void RunUniformTableTestSuite();
+
+	void Test_UniformIdHashing();
+	void Test_UniformTableLookup();
+	void Test_UniformTableGrowth();
+}
@@ -0,0 +1,29 @@
+@echo off
+REM Builds and runs the headless benchmark executable (src/Benchmark).
+REM Usage: bench.bat [benchmark args], e.g. bench.bat --boxes 500 --iterations 1000 --out collision.json
+REM bench.bat --suite tests runs the test suites in src/Test instead.
+
+IF NOT EXIST "%~dp0..\build" mkdir %~dp0..\build
+pushd %~dp0..\build
+
+setlocal EnableDelayedExpansion
+set SOURCES=
+for /r %~dp0..\src %%f in (*.cpp) do (
+	if /I not "%%~nxf"=="Ravenous.cpp" set SOURCES=!SOURCES! "%%f"
+)
+
+cl.exe /std:c++20 /MD /O2 /DRAVENOUS_BENCHMARK /nologo /MP ^
+!SOURCES! ^
+%~dp0..\depsrc\glad.c ^
+glfw3.lib glad.lib IrrXMLd.lib zlibd.lib zlibstaticd.lib freetyped.lib opengl32.lib imgui.lib ^
+kernel32.lib user32.lib gdi32.lib winspool.lib comdlg32.lib advapi32.lib shell32.lib ole32.lib oleaut32.lib uuid.lib odbc32.lib odbccp32.lib ^
+/EHsc /Zi ^
+/I %~dp0..\include ^
+/I %~dp0..\src ^
+/Fe:RavenousBenchmark.exe ^
+/link /LIBPATH:%~dp0..\lib
+
+IF %ERRORLEVEL% EQU 0 RavenousBenchmark.exe %*
+
+endlocal
+popd